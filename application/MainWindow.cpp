@@ -39,6 +39,7 @@ public:
 	QAction *actionAddInstance;
 	QAction *actionViewInstanceFolder;
 	QAction *actionRefresh;
+	QAction *actionUpdateAllInstances;
 	QAction *actionViewCentralModsFolder;
 	QAction *actionCheckUpdate;
 	QAction *actionSettings;
@@ -86,6 +87,8 @@ public:
 		actionRefresh = new QAction(MainWindow);
 		actionRefresh->setObjectName(QStringLiteral("actionRefresh"));
 		actionRefresh->setIcon(MMC->getThemedIcon("refresh"));
+		actionUpdateAllInstances = new QAction(MainWindow);
+		actionUpdateAllInstances->setObjectName(QStringLiteral("actionUpdateAllInstances"));
 		actionViewCentralModsFolder = new QAction(MainWindow);
 		actionViewCentralModsFolder->setObjectName(QStringLiteral("actionViewCentralModsFolder"));
 		actionViewCentralModsFolder->setIcon(MMC->getThemedIcon("centralmods"));
@@ -189,6 +192,7 @@ public:
 		mainToolBar->addAction(actionViewInstanceFolder);
 		mainToolBar->addAction(actionViewCentralModsFolder);
 		mainToolBar->addAction(actionRefresh);
+		mainToolBar->addAction(actionUpdateAllInstances);
 		mainToolBar->addSeparator();
 		mainToolBar->addAction(actionCheckUpdate);
 		mainToolBar->addAction(actionSettings);
@@ -232,6 +236,9 @@ public:
 		actionRefresh->setText(QApplication::translate("MainWindow", "Refresh", 0));
 		actionRefresh->setToolTip(QApplication::translate("MainWindow", "Reload the instance list.", 0));
 		actionRefresh->setStatusTip(QApplication::translate("MainWindow", "Reload the instance list.", 0));
+		actionUpdateAllInstances->setText(QApplication::translate("MainWindow", "Update All", 0));
+		actionUpdateAllInstances->setToolTip(QApplication::translate("MainWindow", "Download everything all the instances need to launch.", 0));
+		actionUpdateAllInstances->setStatusTip(QApplication::translate("MainWindow", "Download everything all the instances need to launch.", 0));
 		actionViewCentralModsFolder->setText(QApplication::translate("MainWindow", "View Central Mods Folder", 0));
 		actionViewCentralModsFolder->setToolTip(QApplication::translate("MainWindow", "Open the central mods folder in a file browser.", 0));
 		actionViewCentralModsFolder->setStatusTip(QApplication::translate("MainWindow", "Open the central mods folder in a file browser.", 0));
@@ -364,6 +371,7 @@ namespace Ui {
 #include "InstanceList.h"
 #include "minecraft/MinecraftVersionList.h"
 #include "minecraft/LwjglVersionList.h"
+#include "VersionListRefresher.h"
 #include "icons/IconList.h"
 #include "java/JavaVersionList.h"
 
@@ -384,6 +392,7 @@ namespace Ui {
 #include "NagUtils.h"
 #include "InstancePageProvider.h"
 #include "minecraft/SkinUtils.h"
+#include "minecraft/BatchUpdate.h"
 
 //#include "minecraft/LegacyInstance.h"
 
@@ -584,6 +593,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
 	if (!skin_dls.isEmpty())
 	{
 		auto job = new NetJob("Startup player skins download");
+		job->setPriority(Priority_Background);
 		connect(job, SIGNAL(succeeded()), SLOT(skinJobFinished()));
 		connect(job, SIGNAL(failed()), SLOT(skinJobFinished()));
 		for (auto action : skin_dls)
@@ -597,15 +607,8 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
 	// run the things that load and download other things... FIXME: this is NOT the place
 	// FIXME: invisible actions in the background = NOPE.
 	{
-		if (!MMC->minecraftlist()->isLoaded())
-		{
-			m_versionLoadTask = MMC->minecraftlist()->getLoadTask();
-			startTask(m_versionLoadTask);
-		}
-		if (!MMC->lwjgllist()->isLoaded())
-		{
-			MMC->lwjgllist()->loadList();
-		}
+		// the version lists start with what they have locally, refresh them once we are up
+		QTimer::singleShot(0, this, SLOT(refreshVersionLists()));
 
 		m_newsChecker->reloadNews();
 		updateNewsLabel();
@@ -715,6 +718,14 @@ void MainWindow::updateToolsMenu()
 	QAction *normalLaunch = launchMenu->addAction(tr("Launch"));
 	connect(normalLaunch, &QAction::triggered, [this]()
 	{ doLaunch(); });
+	QAction *verifyLaunch = launchMenu->addAction(tr("Verify files and launch"));
+	connect(verifyLaunch, &QAction::triggered, [this]()
+	{
+		if (!m_selectedInstance)
+			return;
+		m_selectedInstance->requestFullUpdate();
+		doLaunch();
+	});
 	launchMenu->addSeparator()->setText(tr("Profilers"));
 	for (auto profiler : MMC->profilers().values())
 	{
@@ -918,6 +929,11 @@ void MainWindow::updateNewsLabel()
 
 void MainWindow::updateAvailable(GoUpdate::Status status)
 {
+	// work out what has to be downloaded while the user reads the changelog
+	status.rootPath = MMC->rootPath;
+	GoUpdate::DownloadTask updateTask(status);
+	updateTask.prepare();
+
 	UpdateDialog dlg;
 	UpdateAction action = (UpdateAction)dlg.exec();
 	switch (action)
@@ -926,10 +942,10 @@ void MainWindow::updateAvailable(GoUpdate::Status status)
 		qDebug() << "Update will be installed later.";
 		break;
 	case UPDATE_NOW:
-		downloadUpdates(status);
+		downloadUpdates(updateTask);
 		break;
 	case UPDATE_ONEXIT:
-		downloadUpdates(status, true);
+		downloadUpdates(updateTask, true);
 		break;
 	}
 }
@@ -980,7 +996,7 @@ void MainWindow::notificationsChanged()
 	MMC->settings()->set("ShownNotifications", intListToString(shownNotifications));
 }
 
-void MainWindow::downloadUpdates(GoUpdate::Status status, bool installOnExit)
+void MainWindow::downloadUpdates(GoUpdate::DownloadTask &updateTask, bool installOnExit)
 {
 	qDebug() << "Downloading updates.";
 	// TODO: If the user chooses to update on exit, we should download updates in the
@@ -988,9 +1004,7 @@ void MainWindow::downloadUpdates(GoUpdate::Status status, bool installOnExit)
 	// Doing so is a bit complicated, because we'd have to make sure it finished downloading
 	// before actually exiting MultiMC.
 	ProgressDialog updateDlg(this);
-	status.rootPath = MMC->rootPath;
 
-	GoUpdate::DownloadTask updateTask(status, &updateDlg);
 	// If the task succeeds, install the updates.
 	if (updateDlg.exec(&updateTask))
 	{
@@ -1053,16 +1067,31 @@ static QFileInfo findRecursive(const QString &dir, const QString &name)
 // FIXME: eliminate, should not be needed
 void MainWindow::waitForMinecraftVersions()
 {
-	if (!MMC->minecraftlist()->isLoaded() && m_versionLoadTask &&
-		m_versionLoadTask->isRunning())
+	auto list = MMC->minecraftlist();
+	// the cached list is good enough as long as it knows the latest release
+	if (list->getLatestStable())
+	{
+		return;
+	}
+	Task *task = MMC->versionListRefresher()->runningTask(list.get());
+	if (task && task->isRunning())
 	{
 		QEventLoop waitLoop;
-		waitLoop.connect(m_versionLoadTask, SIGNAL(failed(QString)), SLOT(quit()));
-		waitLoop.connect(m_versionLoadTask, SIGNAL(succeeded()), SLOT(quit()));
+		waitLoop.connect(task, SIGNAL(failed(QString)), SLOT(quit()));
+		waitLoop.connect(task, SIGNAL(succeeded()), SLOT(quit()));
 		waitLoop.exec();
 	}
 }
 
+void MainWindow::refreshVersionLists()
+{
+	MMC->versionListRefresher()->start();
+	if (!MMC->lwjgllist()->isLoading())
+	{
+		MMC->lwjgllist()->loadList();
+	}
+}
+
 void MainWindow::instanceFromZipPack(QString instName, QString instGroup, QString instIcon, QUrl url)
 {
 	InstancePtr newInstance;
@@ -1082,6 +1111,7 @@ void MainWindow::instanceFromZipPack(QString instName, QString instGroup, QStrin
 		auto entry = ENV.metacache()->resolveEntry("general", path);
 		CacheDownloadPtr dl = CacheDownload::make(url, entry);
 		NetJob job(tr("Modpack download"));
+		job.setRateLimit(MMC->settings()->get("ModpackDownloadRateLimit").toLongLong() * 1024);
 		job.addNetAction(dl);
 
 		// FIXME: possibly causes endless loop problems
@@ -1348,6 +1378,40 @@ void MainWindow::on_actionRefresh_triggered()
 	MMC->instances()->loadList();
 }
 
+void MainWindow::on_actionUpdateAllInstances_triggered()
+{
+	if (!MMC->accounts()->anyAccountIsValid())
+	{
+		CustomMessageBox::selectable(
+			this, tr("Error"),
+			tr("MultiMC cannot download Minecraft or update instances unless you have at least "
+			   "one account added.\nPlease add your Mojang or Minecraft account."),
+			QMessageBox::Warning)->show();
+		return;
+	}
+	waitForMinecraftVersions();
+
+	auto instances = MMC->instances();
+	QList<InstancePtr> all;
+	for (int i = 0; i < instances->count(); i++)
+	{
+		all.append(instances->at(i));
+	}
+	ProgressDialog updateDialog(this);
+	BatchUpdate update(all);
+	connect(&update, &BatchUpdate::instanceFinished, [this, instances](QString id, bool success)
+	{
+		auto instance = instances->getInstanceById(id);
+		if (instance)
+		{
+			statusBar()->showMessage(success ? tr("Updated %1").arg(instance->name())
+											 : tr("Failed to update %1").arg(instance->name()));
+		}
+	});
+	connect(&update, SIGNAL(failed(QString)), SLOT(onGameUpdateError(QString)));
+	updateDialog.exec(&update);
+}
+
 void MainWindow::on_actionViewCentralModsFolder_triggered()
 {
 	openDirInDefaultProgram(MMC->settings()->get("CentralModsDir").toString(), true);
@@ -1695,27 +1759,35 @@ void MainWindow::doLaunch(bool online, BaseProfilerFactory *profiler)
 void MainWindow::updateInstance(InstancePtr instance, AuthSessionPtr session,
 								BaseProfilerFactory *profiler)
 {
+	auto timeline = std::make_shared<Timeline>();
 	auto updateTask = instance->doUpdate();
 	if (!updateTask)
 	{
-		launchInstance(instance, session, profiler);
+		launchInstance(instance, session, profiler, timeline);
 		return;
 	}
+	updateTask->setTimeline(timeline);
 	ProgressDialog tDialog(this);
-	connect(updateTask.get(), &Task::succeeded, [this, instance, session, profiler]
-	{ launchInstance(instance, session, profiler); });
+	connect(updateTask.get(), &Task::succeeded, [this, instance, session, profiler, timeline]
+	{ launchInstance(instance, session, profiler, timeline); });
 	connect(updateTask.get(), SIGNAL(failed(QString)), SLOT(onGameUpdateError(QString)));
 	tDialog.exec(updateTask.get());
 }
 
 void MainWindow::launchInstance(InstancePtr instance, AuthSessionPtr session,
-								BaseProfilerFactory *profiler)
+								BaseProfilerFactory *profiler, TimelinePtr timeline)
 {
 	Q_ASSERT_X(instance != NULL, "launchInstance", "instance is NULL");
 	Q_ASSERT_X(session.get() != nullptr, "launchInstance", "session is NULL");
 
 	QString launchScript;
 
+	if (!timeline)
+	{
+		timeline = std::make_shared<Timeline>();
+	}
+	int preparePhase = timeline->begin(tr("Preparing launch"));
+
 	if(!instance->reload())
 	{
 		QMessageBox::critical(this, tr("Error"), tr("Couldn't load the instance profile."));
@@ -1723,8 +1795,10 @@ void MainWindow::launchInstance(InstancePtr instance, AuthSessionPtr session,
 	}
 
 	BaseProcess *proc = instance->prepareForLaunch(session);
+	timeline->end(preparePhase);
 	if (!proc)
 		return;
+	proc->setTimeline(timeline);
 
 	this->hide();
 
@@ -1792,9 +1866,6 @@ void MainWindow::taskStart()
 void MainWindow::taskEnd()
 {
 	QObject *sender = QObject::sender();
-	if (sender == m_versionLoadTask)
-		m_versionLoadTask = NULL;
-
 	sender->deleteLater();
 }
 
@@ -1970,3 +2041,29 @@ void MainWindow::checkInstancePathForProblems()
 		warning.exec();
 	}
 }
+
+void MainWindow::checkInterruptedDownloads()
+{
+	QStringList ids = NetJob::interruptedJournals();
+	if (ids.isEmpty())
+		return;
+	auto response = CustomMessageBox::selectable(
+		this, tr("Unfinished downloads"),
+		tr("MultiMC was closed while %n download(s) were still running.\n"
+		   "Do you want to finish them now?", "", ids.size()),
+		QMessageBox::Question, QMessageBox::Yes | QMessageBox::No)->exec();
+	if (response != QMessageBox::Yes)
+	{
+		for (auto id : ids)
+			NetJob::discardJournal(id);
+		return;
+	}
+	for (auto id : ids)
+	{
+		NetJobPtr job = NetJob::resume(id);
+		if (!job)
+			continue;
+		ProgressDialog resumeDialog(this);
+		resumeDialog.exec(job.get());
+	}
+}
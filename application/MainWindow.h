@@ -22,6 +22,7 @@
 #include "BaseInstance.h"
 #include "auth/MojangAccount.h"
 #include "net/NetJob.h"
+#include "tasks/Timeline.h"
 #include "updater/GoUpdate.h"
 
 class NewsChecker;
@@ -35,6 +36,11 @@ class ConsoleWindow;
 class BaseProfilerFactory;
 class GenericPageProvider;
 
+namespace GoUpdate
+{
+class DownloadTask;
+}
+
 namespace Ui
 {
 class MainWindow;
@@ -56,6 +62,8 @@ public:
 	void checkSetDefaultJava();
 	void checkInstancePathForProblems();
 
+	void checkInterruptedDownloads();
+
 private
 slots:
 	void onCatToggled(bool);
@@ -78,6 +86,8 @@ slots:
 
 	void on_actionRefresh_triggered();
 
+	void on_actionUpdateAllInstances_triggered();
+
 	void on_actionViewCentralModsFolder_triggered();
 
 	void on_actionCheckUpdate_triggered();
@@ -126,7 +136,8 @@ slots:
 	 * Launches the given instance with the given account.
 	 * This function assumes that the given account has a valid, usable access token.
 	 */
-	void launchInstance(InstancePtr instance, AuthSessionPtr session, BaseProfilerFactory *profiler = 0);
+	void launchInstance(InstancePtr instance, AuthSessionPtr session, BaseProfilerFactory *profiler = 0,
+						TimelinePtr timeline = nullptr);
 
 	/*!
 	 * Prepares the given instance for launch with the given account.
@@ -138,6 +149,9 @@ slots:
 	void taskStart();
 	void taskEnd();
 
+	/// refresh the version lists in the background, once the window is up
+	void refreshVersionLists();
+
 	void instanceEnded();
 
 	// called when an icon is changed in the icon model.
@@ -174,12 +188,12 @@ slots:
 
 	void updateNewsLabel();
 
+protected:
 	/*!
-	 * Runs the DownloadTask and installs updates.
+	 * Runs the DownloadTask, prepared or not, and installs updates.
 	 */
-	void downloadUpdates(GoUpdate::Status status, bool installOnExit = false);
+	void downloadUpdates(GoUpdate::DownloadTask &updateTask, bool installOnExit = false);
 
-protected:
 	bool eventFilter(QObject *obj, QEvent *ev);
 	void setCatBackground(bool enabled);
 	void updateInstanceToolIcon(QString new_icon);
@@ -209,8 +223,6 @@ private:
 	InstancePtr m_selectedInstance;
 	QString m_currentInstIcon;
 
-	Task *m_versionLoadTask;
-
 	QLabel *m_statusLeft;
 	class ServerStatus *m_statusRight;
 
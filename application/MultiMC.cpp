@@ -21,9 +21,11 @@
 #include "liteloader/LiteLoaderVersionList.h"
 
 #include "forge/ForgeVersionList.h"
+#include "VersionListRefresher.h"
 
 #include "net/HttpMetaCache.h"
 #include "net/URLConstants.h"
+#include "net/NetScheduler.h"
 #include "Env.h"
 
 #include "java/JavaUtils.h"
@@ -224,6 +226,18 @@ MultiMC::MultiMC(int &argc, char **argv, bool test_mode) : QApplication(argc, ar
 	// init the http meta cache
 	ENV.initHttpMetaCache(rootPath, staticDataPath);
 
+	// init the cache of detected java installations
+	ENV.initJavaCheckCache("javacheck.json");
+
+	// remember which Forge mirrors are fast
+	ENV.initForgeMirrorRanking("forgemirrors.json");
+
+	// share the FML libraries between instances
+	ENV.initLibraryStore("librarystore");
+
+	// remember what long downloads still have to do
+	ENV.initNetJournals("journals");
+
 	// create the global network manager
 	ENV.m_qnam.reset(new QNetworkAccessManager(this));
 
@@ -237,6 +251,13 @@ MultiMC::MultiMC(int &argc, char **argv, bool test_mode) : QApplication(argc, ar
 		ENV.updateProxySettings(proxyTypeStr, addr, port, user, pass);
 	}
 
+	// KiB/s, 0 for no limit
+	NetScheduler::instance().setRateLimit(settings()->get("DownloadRateLimit").toLongLong() * 1024);
+
+	// a local mirror or nothing at all instead of the internet
+	ENV.updateMirrorSettings(settings()->get("MirrorLocation").toString(),
+							 settings()->get("OfflineMode").toBool());
+
 	m_translationChecker->downloadTranslations();
 
 	//FIXME: what to do with these?
@@ -447,11 +468,25 @@ void MultiMC::initGlobalSettings(bool test_mode)
 	m_settings->registerSetting({"ProxyUser", "ProxyUsername"}, "");
 	m_settings->registerSetting({"ProxyPass", "ProxyPassword"}, "");
 
+	// Download speed limits in KiB/s, 0 for none
+	m_settings->registerSetting("DownloadRateLimit", 0);
+	m_settings->registerSetting("ModpackDownloadRateLimit", 0);
+
+	// Local mirror (URL or folder) and strict offline mode
+	m_settings->registerSetting("MirrorLocation", "");
+	m_settings->registerSetting("OfflineMode", false);
+
 	// Memory
 	m_settings->registerSetting({"MinMemAlloc", "MinMemoryAlloc"}, 512);
 	m_settings->registerSetting({"MaxMemAlloc", "MaxMemoryAlloc"}, 1024);
 	m_settings->registerSetting("PermGen", 128);
 
+	// Performance profile - generated JVM flags
+	m_settings->registerSetting("AutoTuneJava", false);
+	m_settings->registerSetting("AutoTuneHeap", true);
+	m_settings->registerSetting("AutoTuneGC", true);
+	m_settings->registerSetting("AutoTuneJIT", true);
+
 	// Java Settings
 	m_settings->registerSetting("JavaPath", "");
 	m_settings->registerSetting("LastHostname", "");
@@ -530,6 +565,18 @@ std::shared_ptr<JavaVersionList> MultiMC::javalist()
 	return m_javalist;
 }
 
+std::shared_ptr<VersionListRefresher> MultiMC::versionListRefresher()
+{
+	if (!m_versionListRefresher)
+	{
+		m_versionListRefresher.reset(new VersionListRefresher());
+		m_versionListRefresher->addList(minecraftlist());
+		m_versionListRefresher->addList(forgelist());
+		m_versionListRefresher->addList(liteloaderlist());
+	}
+	return m_versionListRefresher;
+}
+
 void MultiMC::installUpdates(const QString updateFilesDir, UpdateFlags flags)
 {
 	// if we are going to update on exit, save the params now
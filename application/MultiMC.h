@@ -19,6 +19,7 @@ class QNetworkAccessManager;
 class ForgeVersionList;
 class LiteLoaderVersionList;
 class JavaVersionList;
+class VersionListRefresher;
 class UpdateChecker;
 class BaseProfilerFactory;
 class BaseDetachedToolFactory;
@@ -83,6 +84,8 @@ public:
 	std::shared_ptr<ForgeVersionList> forgelist();
 	std::shared_ptr<LiteLoaderVersionList> liteloaderlist();
 	std::shared_ptr<JavaVersionList> javalist();
+	/// refreshes the Minecraft, Forge and LiteLoader lists in the background
+	std::shared_ptr<VersionListRefresher> versionListRefresher();
 
 	// APPLICATION ONLY
 	std::shared_ptr<InstanceList> instances()
@@ -170,6 +173,7 @@ private:
 	std::shared_ptr<LiteLoaderVersionList> m_liteloaderlist;
 	std::shared_ptr<MinecraftVersionList> m_minecraftlist;
 	std::shared_ptr<JavaVersionList> m_javalist;
+	std::shared_ptr<VersionListRefresher> m_versionListRefresher;
 	std::shared_ptr<TranslationDownloader> m_translationChecker;
 
 	QMap<QString, std::shared_ptr<BaseProfilerFactory>> m_profilers;
@@ -0,0 +1,85 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MirrorExportDialog.h"
+#include "ui_MirrorExportDialog.h"
+
+#include <QFileDialog>
+#include <QListWidgetItem>
+#include <QPushButton>
+
+#include "BaseInstance.h"
+#include "InstanceList.h"
+
+MirrorExportDialog::MirrorExportDialog(std::shared_ptr<InstanceList> instances, QWidget *parent)
+	: QDialog(parent), ui(new Ui::MirrorExportDialog), m_instances(instances)
+{
+	ui->setupUi(this);
+	for (int i = 0; i < m_instances->count(); i++)
+	{
+		auto instance = m_instances->at(i);
+		auto item = new QListWidgetItem(instance->name(), ui->instanceList);
+		item->setData(Qt::UserRole, instance->id());
+		item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+		item->setCheckState(Qt::Checked);
+	}
+	connect(ui->instanceList, SIGNAL(itemChanged(QListWidgetItem *)), SLOT(updateOkButton()));
+	connect(ui->destinationEdit, SIGNAL(textChanged(QString)), SLOT(updateOkButton()));
+	updateOkButton();
+}
+
+MirrorExportDialog::~MirrorExportDialog()
+{
+	delete ui;
+}
+
+QList<InstancePtr> MirrorExportDialog::selectedInstances() const
+{
+	QList<InstancePtr> selected;
+	for (int i = 0; i < ui->instanceList->count(); i++)
+	{
+		auto item = ui->instanceList->item(i);
+		if (item->checkState() != Qt::Checked)
+			continue;
+		auto instance = m_instances->getInstanceById(item->data(Qt::UserRole).toString());
+		if (instance)
+			selected.append(instance);
+	}
+	return selected;
+}
+
+QString MirrorExportDialog::destination() const
+{
+	return ui->destinationEdit->text();
+}
+
+void MirrorExportDialog::on_browseBtn_clicked()
+{
+	QString dir = QFileDialog::getExistingDirectory(this, tr("Mirror folder"),
+													ui->destinationEdit->text());
+	if (!dir.isEmpty())
+		ui->destinationEdit->setText(dir);
+}
+
+void MirrorExportDialog::updateOkButton()
+{
+	bool anySelected = false;
+	for (int i = 0; i < ui->instanceList->count(); i++)
+	{
+		anySelected |= ui->instanceList->item(i)->checkState() == Qt::Checked;
+	}
+	ui->buttonBox->button(QDialogButtonBox::Ok)
+		->setEnabled(anySelected && !ui->destinationEdit->text().isEmpty());
+}
@@ -0,0 +1,50 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QDialog>
+#include <memory>
+
+class BaseInstance;
+class InstanceList;
+typedef std::shared_ptr<BaseInstance> InstancePtr;
+
+namespace Ui
+{
+class MirrorExportDialog;
+}
+
+/// Asks which instances go into an exported mirror, and where it goes.
+class MirrorExportDialog : public QDialog
+{
+	Q_OBJECT
+
+public:
+	explicit MirrorExportDialog(std::shared_ptr<InstanceList> instances, QWidget *parent = 0);
+	~MirrorExportDialog();
+
+	QList<InstancePtr> selectedInstances() const;
+	QString destination() const;
+
+private
+slots:
+	void on_browseBtn_clicked();
+	void updateOkButton();
+
+private:
+	Ui::MirrorExportDialog *ui;
+	std::shared_ptr<InstanceList> m_instances;
+};
@@ -20,6 +20,8 @@
 
 #include <dialogs/ProgressDialog.h>
 #include "Platform.h"
+#include "MultiMC.h"
+#include "VersionListRefresher.h"
 
 #include <BaseVersion.h>
 #include <BaseVersionList.h>
@@ -133,7 +135,15 @@ int VersionSelectDialog::exec()
 	QDialog::open();
 	if (!m_vlist->isLoaded())
 	{
-		loadList();
+		// a list with cached versions is shown right away, the refresh updates it in place
+		if (m_vlist->count() == 0)
+		{
+			loadList();
+		}
+		else
+		{
+			MMC->versionListRefresher()->refresh(m_vlist);
+		}
 	}
 	m_proxyModel->invalidate();
 	return QDialog::exec();
@@ -141,6 +151,14 @@ int VersionSelectDialog::exec()
 
 void VersionSelectDialog::loadList()
 {
+	// don't start another download if the list is being refreshed in the background
+	Task *running = MMC->versionListRefresher()->runningTask(m_vlist);
+	if (running)
+	{
+		ProgressDialog taskDlg(this);
+		taskDlg.exec(running);
+		return;
+	}
 	Task *loadTask = m_vlist->getLoadTask();
 	if (!loadTask)
 	{
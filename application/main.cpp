@@ -11,6 +11,7 @@ int main_gui(MultiMC &app)
 	mainWin.show();
 	mainWin.checkSetDefaultJava();
 	mainWin.checkInstancePathForProblems();
+	mainWin.checkInterruptedDownloads();
 	return app.exec();
 }
 
@@ -82,6 +82,24 @@ void InstanceSettingsPage::applySettings()
 		m_settings->reset("PermGen");
 	}
 
+	// Performance profile
+	bool autoTune = ui->autoTuneGroupBox->isChecked();
+	m_settings->set("OverrideAutoTune", autoTune);
+	if (autoTune)
+	{
+		m_settings->set("AutoTuneJava", ui->autoTuneCheck->isChecked());
+		m_settings->set("AutoTuneHeap", ui->autoTuneHeapCheck->isChecked());
+		m_settings->set("AutoTuneGC", ui->autoTuneGCCheck->isChecked());
+		m_settings->set("AutoTuneJIT", ui->autoTuneJITCheck->isChecked());
+	}
+	else
+	{
+		m_settings->reset("AutoTuneJava");
+		m_settings->reset("AutoTuneHeap");
+		m_settings->reset("AutoTuneGC");
+		m_settings->reset("AutoTuneJIT");
+	}
+
 	// Java Install Settings
 	bool javaInstall = ui->javaSettingsGroupBox->isChecked();
 	m_settings->set("OverrideJavaLocation", javaInstall);
@@ -144,6 +162,13 @@ void InstanceSettingsPage::loadSettings()
 	ui->maxMemSpinBox->setValue(m_settings->get("MaxMemAlloc").toInt());
 	ui->permGenSpinBox->setValue(m_settings->get("PermGen").toInt());
 
+	// Performance profile
+	ui->autoTuneGroupBox->setChecked(m_settings->get("OverrideAutoTune").toBool());
+	ui->autoTuneCheck->setChecked(m_settings->get("AutoTuneJava").toBool());
+	ui->autoTuneHeapCheck->setChecked(m_settings->get("AutoTuneHeap").toBool());
+	ui->autoTuneGCCheck->setChecked(m_settings->get("AutoTuneGC").toBool());
+	ui->autoTuneJITCheck->setChecked(m_settings->get("AutoTuneJIT").toBool());
+
 	// Java Settings
 	bool overrideJava = m_settings->get("OverrideJava").toBool();
 	bool overrideLocation = m_settings->get("OverrideJavaLocation").toBool() || overrideJava;
@@ -66,6 +66,12 @@ void JavaPage::applySettings()
 	s->set("MaxMemAlloc", ui->maxMemSpinBox->value());
 	s->set("PermGen", ui->permGenSpinBox->value());
 
+	// Performance profile
+	s->set("AutoTuneJava", ui->autoTuneCheck->isChecked());
+	s->set("AutoTuneHeap", ui->autoTuneHeapCheck->isChecked());
+	s->set("AutoTuneGC", ui->autoTuneGCCheck->isChecked());
+	s->set("AutoTuneJIT", ui->autoTuneJITCheck->isChecked());
+
 	// Java Settings
 	s->set("JavaPath", ui->javaPathTextBox->text());
 	s->set("JvmArgs", ui->jvmArgsTextBox->text());
@@ -83,6 +89,12 @@ void JavaPage::loadSettings()
 	ui->maxMemSpinBox->setValue(s->get("MaxMemAlloc").toInt());
 	ui->permGenSpinBox->setValue(s->get("PermGen").toInt());
 
+	// Performance profile
+	ui->autoTuneCheck->setChecked(s->get("AutoTuneJava").toBool());
+	ui->autoTuneHeapCheck->setChecked(s->get("AutoTuneHeap").toBool());
+	ui->autoTuneGCCheck->setChecked(s->get("AutoTuneGC").toBool());
+	ui->autoTuneJITCheck->setChecked(s->get("AutoTuneJIT").toBool());
+
 	// Java Settings
 	ui->javaPathTextBox->setText(s->get("JavaPath").toString());
 	ui->jvmArgsTextBox->setText(s->get("JvmArgs").toString());
@@ -40,6 +40,11 @@
 
 #include "settings/SettingsObject.h"
 #include "MultiMC.h"
+#include "Env.h"
+#include "InstanceList.h"
+#include "minecraft/LibraryDedupeTask.h"
+#include "minecraft/CacheCleanupTask.h"
+#include "dialogs/ProgressDialog.h"
 
 // FIXME: possibly move elsewhere
 enum InstSortMode
@@ -160,6 +165,95 @@ void MultiMCPage::on_iconsDirBrowseBtn_clicked()
 		ui->iconsDirTextBox->setText(cooked_dir);
 	}
 }
+void MultiMCPage::on_dedupeLibrariesBtn_clicked()
+{
+	auto store = ENV.libraryStore();
+	if (!store)
+		return;
+	LibraryDedupeTask task(store, LibraryDedupeTask::fmlLibraries(MMC->instances()));
+	ProgressDialog dialog(this);
+	dialog.exec(&task);
+	auto result = task.result();
+	QString message = tr("Checked %1 library files, %2 of them are now shared.\n%3 MiB of disk space "
+						 "reclaimed.")
+						  .arg(result.files)
+						  .arg(result.linked)
+						  .arg(result.reclaimed / 1048576.0, 0, 'f', 1);
+	if (!result.verification.damaged.isEmpty())
+	{
+		message += "\n\n" + tr("%1 damaged libraries were removed. They will be downloaded again "
+								 "when the instances using them are launched.")
+								  .arg(result.verification.damaged.size());
+	}
+	if (!task.successful())
+	{
+		message += "\n\n" + tr("Some files couldn't be deduplicated:\n%1").arg(task.failReason());
+	}
+	CustomMessageBox::selectable(this, tr("Libraries deduplicated"), message,
+								 task.successful() ? QMessageBox::Information
+												   : QMessageBox::Warning)->exec();
+}
+
+void MultiMCPage::on_cleanCacheBtn_clicked()
+{
+	QStringList problems;
+	auto live = CacheCleanupTask::liveFiles(MMC->instances(), ENV.metacache(), &problems);
+	CacheCleanupTask::Budget budget;
+
+	// see what would go first
+	CacheCleanupTask dryRun(ENV.metacache(), live, budget, true);
+	ProgressDialog dryRunDialog(this);
+	dryRunDialog.setSkipButton(true, tr("Cancel"));
+	dryRunDialog.exec(&dryRun);
+	if (!dryRun.successful())
+		return;
+	auto report = dryRun.result();
+	problems.append(report.unreadableIndexes);
+	// what these use isn't known, so anything might be theirs
+	if (!problems.isEmpty())
+	{
+		CustomMessageBox::selectable(
+			this, tr("Clean up the download cache"),
+			tr("The files used by these couldn't be worked out, so nothing was removed. Update "
+			   "or fix them first:\n%1").arg(problems.join("\n")),
+			QMessageBox::Warning)->exec();
+		return;
+	}
+	if (report.removed.isEmpty())
+	{
+		CustomMessageBox::selectable(this, tr("Clean up the download cache"),
+									 tr("There is nothing to clean up."),
+									 QMessageBox::Information)->exec();
+		return;
+	}
+	QString question = tr("%1 files (%2 MiB) aren't used by any instance and weren't used in the "
+						  "last %3 days. Remove them?")
+						   .arg(report.removed.size())
+						   .arg(report.removedBytes / 1048576.0, 0, 'f', 1)
+						   .arg(budget.maxAgeDays);
+	auto answer = CustomMessageBox::selectable(this, tr("Clean up the download cache"), question,
+											   QMessageBox::Question,
+											   QMessageBox::Yes | QMessageBox::No)->exec();
+	if (answer != QMessageBox::Yes)
+		return;
+
+	CacheCleanupTask cleanup(ENV.metacache(), live, budget, false);
+	ProgressDialog dialog(this);
+	dialog.setSkipButton(true, tr("Cancel"));
+	dialog.exec(&cleanup);
+	auto result = cleanup.result();
+	QString message = tr("Removed %1 files, %2 MiB of disk space reclaimed.")
+						  .arg(result.removed.size())
+						  .arg(result.freedBytes / 1048576.0, 0, 'f', 1);
+	if (!cleanup.successful())
+	{
+		message += "\n\n" + cleanup.failReason();
+	}
+	CustomMessageBox::selectable(this, tr("Download cache cleaned up"), message,
+								 cleanup.successful() ? QMessageBox::Information
+													  : QMessageBox::Warning)->exec();
+}
+
 void MultiMCPage::on_modsDirBrowseBtn_clicked()
 {
 	QString raw_dir = QFileDialog::getExistingDirectory(this, tr("Mods Directory"),
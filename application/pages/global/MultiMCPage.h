@@ -69,6 +69,8 @@ slots:
 	void on_modsDirBrowseBtn_clicked();
 	void on_lwjglDirBrowseBtn_clicked();
 	void on_iconsDirBrowseBtn_clicked();
+	void on_dedupeLibrariesBtn_clicked();
+	void on_cleanCacheBtn_clicked();
 
 	/*!
 	 * Updates the list of update channels in the combo box.
@@ -16,8 +16,17 @@
 #include "ProxyPage.h"
 #include "ui_ProxyPage.h"
 
+#include <QFileDialog>
+
 #include "settings/SettingsObject.h"
 #include "MultiMC.h"
+#include "net/NetScheduler.h"
+#include "minecraft/MirrorExportTask.h"
+#include "dialogs/MirrorExportDialog.h"
+#include "dialogs/ProgressDialog.h"
+#include "dialogs/CustomMessageBox.h"
+#include "InstanceList.h"
+#include "Env.h"
 
 ProxyPage::ProxyPage(QWidget *parent) : QWidget(parent), ui(new Ui::ProxyPage)
 {
@@ -73,6 +82,16 @@ void ProxyPage::applySettings()
 	s->set("ProxyPort", ui->proxyPortEdit->value());
 	s->set("ProxyUser", ui->proxyUserEdit->text());
 	s->set("ProxyPass", ui->proxyPassEdit->text());
+
+	// Download speed
+	s->set("DownloadRateLimit", ui->downloadLimitSpinBox->value());
+	NetScheduler::instance().setRateLimit(qint64(ui->downloadLimitSpinBox->value()) * 1024);
+	s->set("ModpackDownloadRateLimit", ui->modpackLimitSpinBox->value());
+
+	// Without internet
+	s->set("MirrorLocation", ui->mirrorEdit->text());
+	s->set("OfflineMode", ui->offlineCheck->isChecked());
+	ENV.updateMirrorSettings(ui->mirrorEdit->text(), ui->offlineCheck->isChecked());
 }
 void ProxyPage::loadSettings()
 {
@@ -92,4 +111,60 @@ void ProxyPage::loadSettings()
 	ui->proxyPortEdit->setValue(s->get("ProxyPort").value<qint16>());
 	ui->proxyUserEdit->setText(s->get("ProxyUser").toString());
 	ui->proxyPassEdit->setText(s->get("ProxyPass").toString());
+
+	// Download speed
+	ui->downloadLimitSpinBox->setValue(s->get("DownloadRateLimit").toInt());
+	ui->modpackLimitSpinBox->setValue(s->get("ModpackDownloadRateLimit").toInt());
+
+	// Without internet
+	ui->mirrorEdit->setText(s->get("MirrorLocation").toString());
+	ui->offlineCheck->setChecked(s->get("OfflineMode").toBool());
+}
+
+void ProxyPage::on_mirrorBrowseBtn_clicked()
+{
+	QString dir = QFileDialog::getExistingDirectory(this, tr("Mirror folder"),
+													ui->mirrorEdit->text());
+	if (!dir.isEmpty())
+		ui->mirrorEdit->setText(dir);
+}
+
+void ProxyPage::on_exportMirrorBtn_clicked()
+{
+	MirrorExportDialog select(MMC->instances(), this);
+	if (select.exec() != QDialog::Accepted)
+		return;
+
+	QStringList problems;
+	auto artifacts =
+		MirrorExportTask::artifacts(select.selectedInstances(), ENV.metacache(), &problems);
+	MirrorExportTask task(artifacts, select.destination());
+	ProgressDialog dialog(this);
+	dialog.setSkipButton(true, tr("Cancel"));
+	dialog.exec(&task);
+
+	auto result = task.result();
+	problems.append(result.unreadableIndexes);
+	QString message = tr("Copied %1 files (%2 MiB), %3 were up to date already.")
+						  .arg(result.copiedFiles)
+						  .arg(result.copiedBytes / 1048576.0, 0, 'f', 1)
+						  .arg(result.keptFiles);
+	if (!result.missing.isEmpty())
+	{
+		message += "\n\n" + tr("%1 files were never downloaded and are missing from the mirror. "
+								"Update the instances first to get them.")
+								.arg(result.missing.size());
+	}
+	if (!problems.isEmpty())
+	{
+		message += "\n\n" + tr("The files used by these couldn't be worked out:\n%1")
+								.arg(problems.join("\n"));
+	}
+	if (!task.successful())
+	{
+		message += "\n\n" + task.failReason();
+	}
+	CustomMessageBox::selectable(this, tr("Mirror exported"), message,
+								 task.successful() ? QMessageBox::Information
+												   : QMessageBox::Warning)->exec();
 }
@@ -60,6 +60,8 @@ private:
 private
 slots:
 	void proxyChanged(int);
+	void on_mirrorBrowseBtn_clicked();
+	void on_exportMirrorBtn_clicked();
 
 private:
 	Ui::ProxyPage *ui;
@@ -4,14 +4,253 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <thread>
 #include "unpack200.h"
+#include "check_decoding.h"
+
+static bool readFile(const char *path, std::vector<uint8_t> &data)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in)
+		return false;
+	std::ostringstream contents;
+	contents << in.rdbuf();
+	auto str = contents.str();
+	data.assign(str.begin(), str.end());
+	return true;
+}
+
+// only counts the bytes
+class null_sink : public unpack_200_sink
+{
+public:
+	virtual void write(const void *, size_t size)
+	{
+		written += size;
+	}
+	size_t written = 0;
+};
+
+static int benchmark(int argc, char **argv)
+{
+	int iterations = 5;
+	int threads = std::thread::hardware_concurrency();
+	std::vector<const char *> corpus;
+	for (int i = 2; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+		{
+			iterations = atoi(argv[++i]);
+			continue;
+		}
+		if (strcmp(argv[i], "-j") == 0 && i + 1 < argc)
+		{
+			threads = atoi(argv[++i]);
+			continue;
+		}
+		corpus.push_back(argv[i]);
+	}
+	if (corpus.empty() || iterations < 1)
+	{
+		std::cerr << "Nothing to benchmark." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::vector<uint8_t>> inputs(corpus.size());
+	size_t inputBytes = 0;
+	for (size_t i = 0; i < corpus.size(); i++)
+	{
+		if (!readFile(corpus[i], inputs[i]))
+		{
+			std::cerr << "Can't read " << corpus[i] << std::endl;
+			return EXIT_FAILURE;
+		}
+		inputBytes += inputs[i].size();
+	}
+
+	// every mode must produce the same jars
+	std::vector<std::vector<uint8_t>> reference(corpus.size());
+	for (size_t i = 0; i < corpus.size(); i++)
+	{
+		unpack_200_buffer_sink sink;
+		try
+		{
+			unpack_200(inputs[i].data(), inputs[i].size(), sink);
+		}
+		catch (std::runtime_error &e)
+		{
+			std::cerr << corpus[i] << ": " << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+		reference[i] = sink.buffer;
+	}
+
+	typedef std::chrono::steady_clock clock;
+	auto report = [&](const char *mode, clock::duration elapsed, size_t outputBytes)
+	{
+		double ms = std::chrono::duration<double, std::milli>(elapsed).count() / iterations;
+		std::cout << std::left << std::setw(28) << mode << std::right << std::fixed
+				  << std::setprecision(2) << std::setw(10) << ms << " ms/corpus"
+				  << std::setw(10) << (inputBytes / 1048576.0) / (ms / 1000.0) << " MiB/s in"
+				  << std::setw(12) << outputBytes / iterations << " bytes out" << std::endl;
+	};
+
+	std::cout << corpus.size() << " file(s), " << inputBytes << " bytes, " << iterations
+			  << " iteration(s)" << std::endl;
+
+	// through stdio, like the old API
+	{
+		size_t out = 0;
+		auto start = clock::now();
+		for (int n = 0; n < iterations; n++)
+		{
+			for (size_t i = 0; i < corpus.size(); i++)
+			{
+				FILE *input = fopen(corpus[i], "rb");
+				FILE *output = tmpfile();
+				if (!input || !output)
+				{
+					std::cerr << "Can't open files for the stdio run" << std::endl;
+					return EXIT_FAILURE;
+				}
+				unpack_200(input, output);
+				out += reference[i].size();
+			}
+		}
+		report("FILE* -> FILE*", clock::now() - start, out);
+	}
+
+	// in memory, fresh allocations every time
+	{
+		size_t out = 0;
+		auto start = clock::now();
+		for (int n = 0; n < iterations; n++)
+		{
+			for (size_t i = 0; i < corpus.size(); i++)
+			{
+				null_sink sink;
+				unpack_200(inputs[i].data(), inputs[i].size(), sink);
+				out += sink.written;
+			}
+		}
+		report("buffer -> sink", clock::now() - start, out);
+	}
+
+	// in memory, one arena for all of them
+	{
+		size_t out = 0;
+		unpack_200_arena arena;
+		auto start = clock::now();
+		for (int n = 0; n < iterations; n++)
+		{
+			for (size_t i = 0; i < corpus.size(); i++)
+			{
+				unpack_200_buffer_sink sink;
+				unpack_200(inputs[i].data(), inputs[i].size(), sink, &arena);
+				if (sink.buffer != reference[i])
+				{
+					std::cerr << corpus[i] << ": arena output differs!" << std::endl;
+					return EXIT_FAILURE;
+				}
+				out += sink.buffer.size();
+			}
+		}
+		report("buffer -> sink, arena", clock::now() - start, out);
+		std::cout << "arena capacity: " << arena.capacity() << " bytes" << std::endl;
+	}
+
+	// entries compressed on worker threads
+	if (threads > 1)
+	{
+		size_t out = 0;
+		unpack_200_options options;
+		options.threads = threads;
+		auto start = clock::now();
+		for (int n = 0; n < iterations; n++)
+		{
+			for (size_t i = 0; i < corpus.size(); i++)
+			{
+				unpack_200_buffer_sink sink;
+				unpack_200(inputs[i].data(), inputs[i].size(), sink, nullptr, options);
+				if (sink.buffer != reference[i])
+				{
+					std::cerr << corpus[i] << ": parallel deflate output differs!" << std::endl;
+					return EXIT_FAILURE;
+				}
+				out += sink.buffer.size();
+			}
+		}
+		std::string mode = "buffer -> sink, " + std::to_string(threads) + " threads";
+		report(mode.c_str(), clock::now() - start, out);
+	}
+
+	// entries stored, not compressed
+	{
+		size_t out = 0;
+		unpack_200_options options;
+		options.store = true;
+		auto start = clock::now();
+		for (int n = 0; n < iterations; n++)
+		{
+			for (size_t i = 0; i < corpus.size(); i++)
+			{
+				null_sink sink;
+				unpack_200(inputs[i].data(), inputs[i].size(), sink, nullptr, options);
+				out += sink.written;
+			}
+		}
+		report("buffer -> sink, stored", clock::now() - start, out);
+	}
+	return EXIT_SUCCESS;
+}
+
+static int checkDecoding(int argc, char **argv)
+{
+	int rounds = 100000;
+	unsigned int seed = 1;
+	for (int i = 2; i + 1 < argc; i += 2)
+	{
+		if (strcmp(argv[i], "-n") == 0)
+			rounds = atoi(argv[i + 1]);
+		else if (strcmp(argv[i], "-s") == 0)
+			seed = strtoul(argv[i + 1], nullptr, 10);
+	}
+	std::string error;
+	if (!check_decoding(seed, rounds, error))
+	{
+		std::cerr << "Band decoders disagree: " << error << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::cout << rounds << " random band(s) decoded the same both ways." << std::endl;
+	return EXIT_SUCCESS;
+}
 
 int main(int argc, char **argv)
 {
+	if (argc >= 2 && strcmp(argv[1], "--bench") == 0)
+	{
+		return benchmark(argc, argv);
+	}
+	if (argc >= 2 && strcmp(argv[1], "--check-decoding") == 0)
+	{
+		return checkDecoding(argc, argv);
+	}
 	if (argc != 3)
 	{
 		std::cerr << "Simple pack200 unpacker!" << std::endl << "Run like this:" << std::endl
-				  << "  " << argv[0] << " input.jar.lzma output.jar" << std::endl;
+				  << "  " << argv[0] << " input.jar.lzma output.jar" << std::endl
+				  << "Or measure it on a set of .pack files:" << std::endl
+				  << "  " << argv[0] << " --bench [-n iterations] [-j threads] file.pack..." << std::endl
+				  << "Or check the band decoders against each other:" << std::endl
+				  << "  " << argv[0] << " --check-decoding [-n rounds] [-s seed]" << std::endl;
 		return EXIT_FAILURE;
 	}
 
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2002, 2009, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.  Oracle designates this
+ * particular file as subject to the "Classpath" exception as provided
+ * by Oracle in the LICENSE file that accompanied this code.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+
+// Test only: checks the batch band decoder of the library against the one value at a time
+// decoder. Built into anti200, not the library, since it needs the library's internals.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "src/defines.h"
+#include "src/bytes.h"
+#include "src/utils.h"
+#include "src/coding.h"
+#include "src/constants.h"
+
+#include "check_decoding.h"
+
+bool check_decoding(unsigned int seed, int rounds, std::string &error)
+{
+	std::mt19937 rng(seed);
+	std::vector<byte> data;
+	std::vector<int> expected;
+	std::vector<int> actual;
+	std::vector<byte *> positions;
+	char msg[200];
+	error.clear();
+	for (int round = 0; round < rounds && error.empty(); round++)
+	{
+		// one of the canonical codings, or any valid (B,H,S,D)
+		coding *c;
+		if (rng() % 2)
+			c = coding::findByIndex(_meta_canon_min + rng() % (_meta_canon_max - _meta_canon_min + 1));
+		else
+			c = coding::findBySpec(1 + rng() % B_MAX, 1 + rng() % 256, rng() % 3, rng() % 2);
+		if (c == nullptr)
+			continue;
+		if (c->D() != 0 && !(c->isSubrange | c->isFullRange))
+		{
+			// not usable for deltas, the decoder rejects these
+			c->free();
+			continue;
+		}
+		int B = c->B(), H = c->H(), L = c->L();
+
+		// vary the share of one-byte values from none to all of them
+		size_t len = 1 + rng() % 2000;
+		int smallPercent = rng() % 101;
+		data.assign(len + 16, 0); // zero padding past the end, like the input buffer
+		for (size_t i = 0; i < len; i++)
+		{
+			bool small = L > 0 && (int)(rng() % 100) < smallPercent;
+			data[i] = (byte)(small ? rng() % L : rng() % 256);
+		}
+		byte *begin = data.data();
+		byte *limit = begin + data.size();
+		try
+		{
+			value_stream reference;
+			reference.init(begin, begin + len, c);
+			expected.clear();
+			positions.clear();
+			positions.push_back(reference.rp);
+			while (reference.rp < reference.rplimit)
+			{
+				expected.push_back(reference.getInt());
+				positions.push_back(reference.rp);
+			}
+			int N = (int)expected.size();
+
+			// decode in chunks of random size to cross the run boundaries everywhere
+			value_stream batch;
+			batch.init(begin, begin + len, c);
+			actual.assign(N, 0);
+			for (int i = 0; i < N;)
+			{
+				int n = 1 + rng() % 300;
+				if (n > N - i)
+					n = N - i;
+				batch.getInts(&actual[i], n);
+				i += n;
+			}
+			for (int i = 0; i < N && error.empty(); i++)
+			{
+				if (actual[i] != expected[i])
+				{
+					snprintf(msg, sizeof(msg),
+							 "(%d,%d,%d,%d) value %d of %d: got %d, expected %d", B, H,
+							 c->S(), c->D(), i, N, actual[i], expected[i]);
+					error = msg;
+				}
+			}
+			if (error.empty() && (batch.rp != reference.rp || batch.sum != reference.sum))
+			{
+				snprintf(msg, sizeof(msg), "(%d,%d,%d,%d) stream state differs after %d values",
+						 B, H, c->S(), c->D(), N);
+				error = msg;
+			}
+
+			// skipping any number of values must land where decoding them does
+			int skip = rng() % (N + 1);
+			byte *rp = begin;
+			coding::parseMultiple(rp, skip, limit, B, H);
+			if (error.empty() && rp != positions[skip])
+			{
+				snprintf(msg, sizeof(msg), "(%d,%d) skipping %d values: at %d, expected %d", B, H,
+						 skip, (int)(rp - begin), (int)(positions[skip] - begin));
+				error = msg;
+			}
+		}
+		catch (std::runtime_error &e)
+		{
+			snprintf(msg, sizeof(msg), "(%d,%d,%d,%d): %s", B, H, c->S(), c->D(), e.what());
+			error = msg;
+		}
+		c->free();
+	}
+	return error.empty();
+}
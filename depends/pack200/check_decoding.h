@@ -0,0 +1,19 @@
+/*
+ * This is trivial. Do what thou wilt with it. Public domain.
+ */
+
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Check the batch band decoder against the one value at a time decoder
+ *
+ * Decodes random byte streams with random codings both ways and compares the results.
+ *
+ * @param seed Seed for the random data
+ * @param rounds Number of streams to try
+ * @param error Describes the first difference found
+ * @return true when no difference was found
+ */
+bool check_decoding(unsigned int seed, int rounds, std::string &error);
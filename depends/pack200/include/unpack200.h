@@ -25,6 +25,95 @@
 
 #pragma once
 #include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Receives the jar file as it is being written
+ */
+class unpack_200_sink
+{
+public:
+	virtual ~unpack_200_sink() {}
+	/// write the next piece of the jar. Throw std::runtime_error to abort.
+	virtual void write(const void *data, size_t size) = 0;
+};
+
+/**
+ * @brief Sink collecting the jar in memory
+ */
+class unpack_200_buffer_sink : public unpack_200_sink
+{
+public:
+	virtual void write(const void *data, size_t size)
+	{
+		const uint8_t *bytes = (const uint8_t *)data;
+		buffer.insert(buffer.end(), bytes, bytes + size);
+	}
+	std::vector<uint8_t> buffer;
+};
+
+/**
+ * @brief Memory the unpacker can reuse from one archive to the next
+ *
+ * The unpacker makes lots of small allocations that all die together at the end of a
+ * segment. With an arena, they are carved out of a few big blocks that are kept and reused,
+ * instead of going through malloc and free every time.
+ *
+ * An arena may only be used by one unpack_200 call at a time.
+ */
+class unpack_200_arena
+{
+public:
+	explicit unpack_200_arena(size_t block_size = 1 << 20);
+	~unpack_200_arena();
+
+	/// zeroed memory, valid until reset(). temporary memory is only valid until reset_temp()
+	void *alloc(size_t size, bool temporary = false);
+	/// forget all allocations, but keep the memory
+	void reset();
+	/// forget the temporary allocations, but keep the memory
+	void reset_temp();
+	/// bytes reserved from the system
+	size_t capacity() const;
+
+private:
+	struct pool
+	{
+		struct block
+		{
+			uint8_t *data;
+			size_t size;
+		};
+		std::vector<block> blocks;
+		size_t current = 0;
+		size_t used = 0;
+	};
+	void *alloc_from(pool &p, size_t size);
+	void free_pool(pool &p);
+
+	unpack_200_arena(const unpack_200_arena &) = delete;
+	unpack_200_arena &operator=(const unpack_200_arena &) = delete;
+
+	size_t m_block_size;
+	pool m_persistent;
+	pool m_temporary;
+};
+
+/**
+ * @brief How the jar is written
+ */
+struct unpack_200_options
+{
+	/// Threads compressing the jar entries. With more than one, the entries are compressed in
+	/// parallel; the jar is still byte for byte the same.
+	int threads = 1;
+	/// Store the entries without compressing them. Faster, but the jar is bigger.
+	/// Fine for jars that only end up on a local classpath.
+	bool store = false;
+};
 
 /**
  * @brief Unpack a PACK200 file
@@ -35,3 +124,29 @@
  * @throw std::runtime_error for any error encountered
  */
 void unpack_200(FILE * input, FILE * output);
+
+/**
+ * @brief Unpack a PACK200 file already in memory
+ *
+ * @param input The PACK200 data. Not copied, must stay valid until this returns.
+ * @param size Size of the input
+ * @param output Output file for the jar. Closed when done.
+ * @return void
+ * @throw std::runtime_error for any error encountered
+ */
+void unpack_200(const void * input, size_t size, FILE * output);
+
+/**
+ * @brief Unpack a PACK200 file already in memory, passing the jar to a sink
+ *
+ * @param input The PACK200 data. Not copied, must stay valid until this returns.
+ * @param size Size of the input
+ * @param output Receives the jar
+ * @param arena Memory to use for the unpacker's internal allocations. Optional.
+ * @param options How to write the jar
+ * @return void
+ * @throw std::runtime_error for any error encountered
+ */
+void unpack_200(const void *input, size_t size, unpack_200_sink &output,
+				unpack_200_arena *arena = nullptr,
+				const unpack_200_options &options = unpack_200_options());
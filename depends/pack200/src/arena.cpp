@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2001, 2008, Oracle and/or its affiliates. All rights reserved.
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.  Oracle designates this
+ * particular file as subject to the "Classpath" exception as provided
+ * by Oracle in the LICENSE file that accompanied this code.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdexcept>
+
+#include "constants.h"
+#include "defines.h"
+#include "utils.h"
+#include "unpack200.h"
+
+unpack_200_arena::unpack_200_arena(size_t block_size) : m_block_size(block_size)
+{
+}
+
+unpack_200_arena::~unpack_200_arena()
+{
+	free_pool(m_persistent);
+	free_pool(m_temporary);
+}
+
+void unpack_200_arena::free_pool(pool &p)
+{
+	for (auto &b : p.blocks)
+		::free(b.data);
+	p.blocks.clear();
+	p.current = 0;
+	p.used = 0;
+}
+
+void *unpack_200_arena::alloc_from(pool &p, size_t size)
+{
+	// same alignment as the unpacker's own small allocations
+	size += -size & 7;
+	while (p.current < p.blocks.size())
+	{
+		auto &b = p.blocks[p.current];
+		if (b.size - p.used >= size)
+		{
+			uint8_t *res = b.data + p.used;
+			p.used += size;
+			// callers expect calloc-like memory
+			memset(res, 0, size);
+			return res;
+		}
+		// doesn't fit, the rest of this block stays unused until the next reset
+		p.current++;
+		p.used = 0;
+	}
+	pool::block b;
+	b.size = size > m_block_size ? size : m_block_size;
+	b.data = (uint8_t *)must_malloc(b.size);
+	p.blocks.push_back(b);
+	p.current = p.blocks.size() - 1;
+	p.used = size;
+	return b.data;
+}
+
+void *unpack_200_arena::alloc(size_t size, bool temporary)
+{
+	return alloc_from(temporary ? m_temporary : m_persistent, size);
+}
+
+void unpack_200_arena::reset()
+{
+	m_persistent.current = 0;
+	m_persistent.used = 0;
+	reset_temp();
+}
+
+void unpack_200_arena::reset_temp()
+{
+	m_temporary.current = 0;
+	m_temporary.used = 0;
+}
+
+size_t unpack_200_arena::capacity() const
+{
+	size_t total = 0;
+	for (auto &b : m_persistent.blocks)
+		total += b.size;
+	for (auto &b : m_temporary.blocks)
+		total += b.size;
+	return total;
+}
@@ -188,14 +188,21 @@ int band::getIntTotal()
 	{
 		unpack_abort("overflow detected");
 	}
-	for (int k = length - 1; k > 0; k--)
+	int values[BATCH_SIZE];
+	for (int k = length - 1; k > 0;)
 	{
-		int prev_total = total;
-		total += vs[0].getInt();
-		if (total < prev_total)
+		int n = (k < BATCH_SIZE) ? k : BATCH_SIZE;
+		vs[0].getInts(values, n);
+		for (int i = 0; i < n; i++)
 		{
-			unpack_abort("overflow detected");
+			int prev_total = total;
+			total += values[i];
+			if (total < prev_total)
+			{
+				unpack_abort("overflow detected");
+			}
 		}
+		k -= n;
 	}
 	rewind();
 	total_memo = total + 1;
@@ -212,20 +219,34 @@ int band::getIntCount(int tag)
 		{
 			// Lazily calculate an approximate histogram.
 			hist0 = U_NEW(int, (HIST0_MAX - HIST0_MIN) + 1);
-			for (int k = length; k > 0; k--)
+			int values[BATCH_SIZE];
+			for (int k = length; k > 0;)
 			{
-				int x = vs[0].getInt();
-				if (x >= HIST0_MIN && x <= HIST0_MAX)
-					hist0[x - HIST0_MIN] += 1;
+				int n = (k < BATCH_SIZE) ? k : BATCH_SIZE;
+				vs[0].getInts(values, n);
+				for (int i = 0; i < n; i++)
+				{
+					int x = values[i];
+					if (x >= HIST0_MIN && x <= HIST0_MAX)
+						hist0[x - HIST0_MIN] += 1;
+				}
+				k -= n;
 			}
 			rewind();
 		}
 		return hist0[tag - HIST0_MIN];
 	}
 	int total = 0;
-	for (int k = length; k > 0; k--)
+	int values[BATCH_SIZE];
+	for (int k = length; k > 0;)
 	{
-		total += (vs[0].getInt() == tag) ? 1 : 0;
+		int n = (k < BATCH_SIZE) ? k : BATCH_SIZE;
+		vs[0].getInts(values, n);
+		for (int i = 0; i < n; i++)
+		{
+			total += (values[i] == tag) ? 1 : 0;
+		}
+		k -= n;
 	}
 	rewind();
 	return total;
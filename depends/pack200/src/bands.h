@@ -49,6 +49,10 @@ struct band
 		HIST0_MIN = 0,
 		HIST0_MAX = 255
 	}; // catches the usual cases
+	enum
+	{
+		BATCH_SIZE = 256
+	}; // values decoded at a time by getInts() callers
 
 	// properties for attribute layout elements:
 	byte le_kind;   // EK_XXX
@@ -134,6 +138,11 @@ struct band
 		assert(ix == nullptr);
 		return vs[0].getInt();
 	}
+	void getInts(int *out, int n)
+	{
+		assert(ix == nullptr);
+		vs[0].getInts(out, n);
+	}
 	entry *getRefN()
 	{
 		assert(ix != nullptr);
@@ -272,6 +272,48 @@ uint32_t coding::parse_lgH(byte *&rp, int B, int H, int lgH)
 
 static const char ERB[] = "EOF reading band";
 
+// Bands are mostly made of small values that fit in a single byte (any byte below L).
+// Eight bytes are checked at a time for those, without any branches per byte.
+#define BYTES_1 0x0101010101010101ULL
+#define BYTES_HIGH 0x8080808080808080ULL
+
+// Eight bytes in stream order, least significant first.
+static inline uint64_t load_8(const byte *bytes)
+{
+	const unsigned char *ptr = (const unsigned char *)bytes;
+	return (uint64_t)ptr[0] | (uint64_t)ptr[1] << 8 | (uint64_t)ptr[2] << 16 |
+		   (uint64_t)ptr[3] << 24 | (uint64_t)ptr[4] << 32 | (uint64_t)ptr[5] << 40 |
+		   (uint64_t)ptr[6] << 48 | (uint64_t)ptr[7] << 56;
+}
+
+// Number of bytes at ptr, up to 8, that are below L and so each make a whole value.
+// Needs 8 readable bytes.
+static inline int count_small_bytes(const byte *ptr, int L)
+{
+	uint64_t w = load_8(ptr);
+	uint64_t low7 = w & ~BYTES_HIGH;
+	uint64_t big;
+	// Flag the high bit of every byte >= L. Adding to the low 7 bits never carries into the
+	// next byte, so every flag is exact.
+	if (L <= 128)
+		big = ((low7 + BYTES_1 * (uint64_t)(128 - L)) | w) & BYTES_HIGH;
+	else
+		big = (low7 + BYTES_1 * (uint64_t)(256 - L)) & w & BYTES_HIGH;
+	if (big == 0)
+		return 8;
+#if defined(__GNUC__)
+	return __builtin_ctzll(big) >> 3;
+#else
+	int n = 0;
+	while ((big & 0x80) == 0)
+	{
+		big >>= 8;
+		n++;
+	}
+	return n;
+#endif
+}
+
 void coding::parseMultiple(byte *&rp, int N, byte *limit, int B, int H)
 {
 	if (N < 0)
@@ -293,26 +335,26 @@ void coding::parseMultiple(byte *&rp, int N, byte *limit, int B, int H)
 	}
 	// Note:  We assume rp has enough zero-padding.
 	int L = 256 - H;
-	int n = B;
 	while (N > 0)
 	{
-		ptr += 1;
-		if (--n == 0)
+		if (limit - ptr >= 8)
 		{
-			// end of encoding at B bytes, regardless of byte value
+			// skip a run of one-byte values
+			int run = count_small_bytes(ptr, L);
+			if (run > N)
+				run = N;
+			ptr += run;
+			N -= run;
+			if (run == 8 || N == 0)
+				continue;
 		}
-		else
+		// the next value, one byte at a time; it ends at B bytes, or at the first byte < L
+		for (int n = 1; n < B && (*ptr & 0xFF) >= L; n++)
 		{
-			int b = (ptr[-1] & 0xFF);
-			if (b >= L)
-			{
-				// keep going, unless we find a byte < L
-				continue;
-			}
+			ptr++;
 		}
-		// found the last byte
+		ptr++;
 		N -= 1;
-		n = B; // reset length counter
 		// do an error check here
 		if (ptr > limit)
 		{
@@ -617,6 +659,111 @@ int value_stream::getInt()
 	return 0;
 }
 
+// Decode as many values as possible, up to n, without leaving the current coding segment.
+// Returns 0 for the codings that need the scalar path (pop codings).
+int value_stream::getIntRun(int *out, int n)
+{
+	if (rp >= rplimit)
+		return 0;
+	switch (cmk)
+	{
+	case cmk_BHS:
+	case cmk_BHS0:
+	case cmk_BHS1:
+	case cmk_BYTE1:
+	case cmk_CHAR3:
+	case cmk_UNSIGNED5:
+	case cmk_BHSD1:
+	case cmk_BHS1D1full:
+	case cmk_BHS1D1sub:
+	case cmk_DELTA5:
+	case cmk_BCI5:
+	case cmk_BRANCH5:
+		break;
+	default:
+		return 0;
+	}
+	CODING_PRIVATE(c.spec);
+	uint32_t *uvals = (uint32_t *)out;
+	int count = 0;
+
+	// First pass: the raw unsigned values.
+	if (B == 1)
+	{
+		count = (int)(rplimit - rp);
+		if (count > n)
+			count = n;
+		for (int i = 0; i < count; i++)
+			uvals[i] = rp[i] & 0xFF;
+		rp += count;
+	}
+	else
+	{
+		int L = 256 - H;
+		while (count < n && rp < rplimit)
+		{
+			if (L > 0 && rplimit - rp >= 8)
+			{
+				int run = count_small_bytes(rp, L);
+				if (run > n - count)
+					run = n - count;
+				for (int i = 0; i < run; i++)
+					uvals[count + i] = rp[i] & 0xFF;
+				rp += run;
+				count += run;
+				if (run == 8 || count == n)
+					continue;
+			}
+			uvals[count++] = coding::parse(rp, B, H);
+		}
+	}
+
+	// Second pass: sign and delta fix-ups, same as getInt.
+	if (S == 1)
+	{
+		for (int i = 0; i < count; i++)
+			out[i] = DECODE_SIGN_S1(uvals[i]);
+	}
+	else if (S != 0)
+	{
+		for (int i = 0; i < count; i++)
+			out[i] = decode_sign(S, uvals[i]);
+	}
+	if (D != 0)
+	{
+		assert(c.isSubrange | c.isFullRange);
+		if (c.isSubrange)
+		{
+			for (int i = 0; i < count; i++)
+				out[i] = sum = c.sumInUnsignedRange(sum, out[i]);
+		}
+		else
+		{
+			uint32_t usum = (uint32_t)sum;
+			for (int i = 0; i < count; i++)
+				out[i] = (int)(usum += (uint32_t)out[i]);
+			sum = (int)usum;
+		}
+	}
+	return count;
+}
+
+void value_stream::getInts(int *out, int n)
+{
+	while (n > 0)
+	{
+		int count = getIntRun(out, n);
+		if (count == 0)
+		{
+			// pop codings, or the end of a coding segment
+			*out = getInt();
+			count = 1;
+		}
+		out += count;
+		n -= count;
+	}
+}
+
 static int moreCentral(int x, int y)
 { // used to find end of Pop.{F}
 	// Suggested implementation from the Pack200 specification:
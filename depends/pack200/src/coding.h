@@ -195,6 +195,10 @@ struct value_stream
 	// Parse and decode a single value.
 	int getInt();
 
+	// Parse and decode n values, same as calling getInt() n times but faster for long runs.
+	void getInts(int *out, int n);
+	int getIntRun(int *out, int n);
+
 	// Parse and decode a single byte, with no error checks.
 	int getByte()
 	{
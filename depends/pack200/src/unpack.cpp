@@ -292,6 +292,8 @@ void unpacker::free()
 	tmallocs.freeAll();
 	smallbuf.init();
 	tsmallbuf.init();
+	if (arena != nullptr)
+		arena->reset();
 	bcimap.free();
 	class_fixup_type.free();
 	class_fixup_offset.free();
@@ -494,6 +496,11 @@ enum
 // Call malloc.  Try to combine small blocks and free much later.
 void *unpacker::alloc_heap(size_t size, bool smallOK, bool temp)
 {
+	if (arena != nullptr)
+	{
+		// the arena is rewound instead of freeing the blocks one by one
+		return arena->alloc(size, temp);
+	}
 	if (!smallOK || size > SMALL)
 	{
 		void *res = must_malloc((int)size);
@@ -1075,10 +1082,16 @@ void unpacker::read_Utf8_values(entry *cpMap, int len)
 		}
 
 		byte *chp = chars.ptr;
-		for (int j = 0; j < suffix; j++)
+		int charValues[band::BATCH_SIZE];
+		for (int j = 0; j < suffix;)
 		{
-			unsigned short ch = cp_Utf8_chars.getInt();
-			chp = store_Utf8_char(chp, ch);
+			int n = (suffix - j < band::BATCH_SIZE) ? suffix - j : band::BATCH_SIZE;
+			cp_Utf8_chars.getInts(charValues, n);
+			for (int k = 0; k < n; k++)
+			{
+				chp = store_Utf8_char(chp, (unsigned short)charValues[k]);
+			}
+			j += n;
 		}
 		// shrink to fit:
 		if (isMalloc)
@@ -1204,9 +1217,16 @@ void unpacker::read_Utf8_values(entry *cpMap, int len)
 void unpacker::read_single_words(band &cp_band, entry *cpMap, int len)
 {
 	cp_band.readData(len);
-	for (int i = 0; i < len; i++)
+	int values[band::BATCH_SIZE];
+	for (int i = 0; i < len;)
 	{
-		cpMap[i].value.i = cp_band.getInt(); // coding handles signs OK
+		int n = (len - i < band::BATCH_SIZE) ? len - i : band::BATCH_SIZE;
+		cp_band.getInts(values, n);
+		for (int k = 0; k < n; k++)
+		{
+			cpMap[i + k].value.i = values[k]; // coding handles signs OK
+		}
+		i += n;
 	}
 }
 
@@ -3510,6 +3530,8 @@ void unpacker::reset()
 	// restore selected interface state:
 	infileptr = save_u.infileptr;
 	inbytes = save_u.inbytes;
+	inmemory = save_u.inmemory;
+	arena = save_u.arena;
 	jarout = save_u.jarout;
 	gzin = save_u.gzin;
 	verbose = save_u.verbose;
@@ -23,6 +23,8 @@
  * questions.
  */
 
+#include "unpack200.h"
+
 // Global Structures
 struct jar;
 struct gunzip;
@@ -160,6 +162,8 @@ struct unpacker
 	// if running Unix-style, here are the inputs and outputs
 	FILE *infileptr; // buffered
 	bytes inbytes;   // direct
+	bytes inmemory;  // unread rest of an in-memory input
+	unpack_200_arena *arena; // where U_NEW and T_NEW memory comes from, if set
 	gunzip *gzin;	// gunzip filter, if any
 	jar *jarout;	 // output JAR file
 
@@ -380,6 +384,8 @@ struct unpacker
 	{
 		tsmallbuf.init();
 		tmallocs.freeAll();
+		if (arena != nullptr)
+			arena->reset_temp();
 	}
 
 	// Option management methods
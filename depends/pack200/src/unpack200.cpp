@@ -71,6 +71,19 @@ static int64_t read_input_via_stdio(unpacker *u, void *buf, int64_t minlen, int6
 	return numread;
 }
 
+// Callback for fetching data from a buffer in memory.
+static int64_t read_input_via_memory(unpacker *u, void *buf, int64_t minlen, int64_t maxlen)
+{
+	assert(minlen <= maxlen); // don't talk nonsense
+	int64_t numread = maxlen;
+	if (numread > (int64_t)u->inmemory.len)
+		numread = (int64_t)u->inmemory.len;
+	memcpy(buf, u->inmemory.ptr, (size_t)numread);
+	u->inmemory.ptr += numread;
+	u->inmemory.len -= (size_t)numread;
+	return numread;
+}
+
 enum
 {
 	EOF_MAGIC = 0,
@@ -94,20 +107,8 @@ static int read_magic(unpacker *u, char peek[], int peeklen)
 	return magic;
 }
 
-void unpack_200(FILE *input, FILE *output)
+static void unpack_all(unpacker &u)
 {
-	unpacker u;
-	u.init(read_input_via_stdio);
-
-	// initialize jar output
-	// the output takes ownership of the file handle
-	jar jarout;
-	jarout.init(&u);
-	jarout.jarfp = output;
-
-	// the input doesn't
-	u.infileptr = input;
-
 	// read the magic!
 	char peek[4];
 	int magic;
@@ -158,5 +159,66 @@ void unpack_200(FILE *input, FILE *output)
 	}
 	u.finish();
 	u.free(); // tidy up malloc blocks
+}
+
+static void unpack_segments(unpacker &u, FILE *output, unpack_200_sink *sink = nullptr,
+							const unpack_200_options &options = unpack_200_options())
+{
+	// initialize jar output
+	// the output takes ownership of the file handle
+	jar jarout;
+	jarout.init(&u);
+	jarout.jarfp = output;
+	jarout.sink = sink;
+	jarout.deflate_threads = options.threads;
+	jarout.store_only = options.store;
+	try
+	{
+		unpack_all(u);
+	}
+	catch (...)
+	{
+		// stop the compression threads, if any
+		jarout.free();
+		throw;
+	}
+}
+
+void unpack_200(FILE *input, FILE *output)
+{
+	unpacker u;
+	u.init(read_input_via_stdio);
+
+	// the input isn't owned by the output
+	u.infileptr = input;
+	unpack_segments(u, output);
 	fclose(input);
 }
+
+void unpack_200(const void *input, size_t size, FILE *output)
+{
+	unpacker u;
+	u.init(read_input_via_memory);
+	u.inmemory.set((byte *)input, size);
+	unpack_segments(u, output);
+}
+
+void unpack_200(const void *input, size_t size, unpack_200_sink &output, unpack_200_arena *arena,
+				const unpack_200_options &options)
+{
+	unpacker u;
+	u.init(read_input_via_memory);
+	u.inmemory.set((byte *)input, size);
+	u.arena = arena;
+	try
+	{
+		unpack_segments(u, nullptr, &output, options);
+	}
+	catch (...)
+	{
+		// the arena must not keep pointing at anything from this run
+		if (arena)
+			arena->reset();
+		throw;
+	}
+}
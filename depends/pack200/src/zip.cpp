@@ -35,6 +35,15 @@
 #include <stdlib.h>
 #include <assert.h>
 
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 #ifndef _MSC_VER
 #include <strings.h>
 #endif
@@ -66,6 +75,164 @@ inline uint32_t jar::get_crc32(uint32_t c, uchar *ptr, uint32_t len)
 
 #define GET_INT_HI(a) SWAP_BYTES((a >> 16) & 0xFFFF);
 
+// The deflaters of all the jars written at the same time share this many workers. Unpacking
+// several jars in parallel would start a full set of threads for each one otherwise.
+static std::mutex worker_budget_mutex;
+static int worker_budget_used = 0;
+
+// Up to `wanted` workers from the budget, maybe none
+static int reserve_workers(int wanted)
+{
+	static const int limit = std::max(1, (int)std::thread::hardware_concurrency());
+	std::lock_guard<std::mutex> lock(worker_budget_mutex);
+	int got = std::max(0, std::min(wanted, limit - worker_budget_used));
+	worker_budget_used += got;
+	return got;
+}
+
+static void release_workers(int count)
+{
+	std::lock_guard<std::mutex> lock(worker_budget_mutex);
+	worker_budget_used -= count;
+}
+
+// Compresses jar entries on worker threads. The writer takes them back in the order they were
+// queued, so the jar is the same as the one written without threads.
+struct jar_deflater
+{
+	struct job
+	{
+		std::string name;
+		int modtime = 0;
+		bool deflate = false; // the hint going in, whether compressing helped coming out
+		std::vector<uchar> data; // head followed by tail
+		size_t head_len = 0;
+		std::vector<uchar> deflated;
+		uint32_t crc = 0;
+		bool done = false;
+	};
+
+	explicit jar_deflater(int threads)
+	{
+		for (int i = 0; i < threads; i++)
+		{
+			workers.push_back(std::thread(&jar_deflater::run, this));
+		}
+		max_queued = (size_t)threads * 8;
+	}
+
+	~jar_deflater()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+			todo.clear();
+		}
+		work.notify_all();
+		for (auto &worker : workers)
+		{
+			worker.join();
+		}
+		release_workers((int)workers.size());
+		for (auto j : order)
+		{
+			delete j;
+		}
+	}
+
+	void add(job *j)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			order.push_back(j);
+			todo.push_back(j);
+			queued_bytes += j->data.size();
+		}
+		work.notify_one();
+	}
+
+	// Too much is waiting to be written, the writer should wait for it.
+	bool full()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return order.size() > max_queued || queued_bytes > max_queued_bytes;
+	}
+
+	// The oldest entry, when it is done. Waits for it if asked to. The caller owns the result.
+	job *take(bool wait)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		if (order.empty())
+			return nullptr;
+		job *j = order.front();
+		if (!j->done)
+		{
+			if (!wait)
+				return nullptr;
+			finished.wait(lock, [j]() { return j->done; });
+		}
+		order.pop_front();
+		queued_bytes -= j->data.size();
+		return j;
+	}
+
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;)
+		{
+			work.wait(lock, [this]() { return stopping || !todo.empty(); });
+			if (stopping)
+				return;
+			job *j = todo.front();
+			todo.pop_front();
+			lock.unlock();
+			compress(*j);
+			lock.lock();
+			j->done = true;
+			finished.notify_all();
+		}
+	}
+
+	static void compress(job &j)
+	{
+		size_t len = j.data.size();
+		uchar *head = j.data.data();
+		uchar *tail = head + j.head_len;
+		size_t tail_len = len - j.head_len;
+		j.crc = crc32(0, Z_NULL, 0);
+		if (len != 0)
+			j.crc = crc32(j.crc, head, (uint32_t)len);
+		if (!j.deflate)
+			return;
+		try
+		{
+			// same calls as the single threaded writer, for the same bytes
+			j.deflated.resize(len + (len / 2));
+			size_t clen = 0;
+			j.deflate = jar::deflate_bytes(head, j.head_len, tail, tail_len, j.deflated.data(),
+										   j.deflated.size(), clen);
+			j.deflated.resize(j.deflate ? clen : 0);
+		}
+		catch (std::bad_alloc &)
+		{
+			j.deflate = false;
+			j.deflated.clear();
+		}
+	}
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable work;
+	std::condition_variable finished;
+	std::deque<job *> order; // every entry not written yet, in jar order
+	std::deque<job *> todo;  // the ones no worker has picked up
+	size_t queued_bytes = 0;
+	size_t max_queued = 0;
+	size_t max_queued_bytes = 64 << 20;
+	bool stopping = false;
+};
+
 void jar::init(unpacker *u_)
 {
 	BYTES_OF(*this).clear();
@@ -73,16 +240,30 @@ void jar::init(unpacker *u_)
 	u->jarout = this;
 }
 
+void jar::free()
+{
+	central_directory.free();
+	deflated.free();
+	// stops the workers, drops whatever they didn't finish
+	delete deflater;
+	deflater = nullptr;
+}
+
 // Write data to the ZIP output stream.
 void jar::write_data(void *buff, int len)
 {
+	if (sink != nullptr)
+	{
+		sink->write(buff, len);
+		output_file_offset += len;
+		return;
+	}
 	while (len > 0)
 	{
 		int rc = (int)fwrite(buff, 1, len, jarfp);
 		if (rc <= 0)
 		{
-			fprintf(stderr, "Error: write on output file failed err=%d\n", errno);
-			exit(1); // Called only from the native standalone unpacker
+			unpack_abort("write on output file failed");
 		}
 		output_file_offset += rc;
 		buff = ((char *)buff) + rc;
@@ -244,7 +425,7 @@ void jar::write_central_directory()
 // Open a Jar file and initialize.
 void jar::openJarFile(const char *fname)
 {
-	if (!jarfp)
+	if (!jarfp && !sink)
 	{
 		jarfp = fopen(fname, "wb");
 		if (!jarfp)
@@ -255,6 +436,29 @@ void jar::openJarFile(const char *fname)
 	}
 }
 
+// Write the compressed entries that are ready, or all of them
+void jar::write_queued_entries(bool all)
+{
+	if (deflater == nullptr)
+		return;
+	for (;;)
+	{
+		// freed even if writing it fails
+		std::unique_ptr<jar_deflater::job> j(deflater->take(all || deflater->full()));
+		if (!j)
+			break;
+		const char *fname = j->name.c_str();
+		int len = (int)j->data.size();
+		int clen = (int)(j->deflate ? j->deflated.size() : len);
+		add_to_jar_directory(fname, !j->deflate, j->modtime, len, clen, j->crc);
+		write_jar_header(fname, !j->deflate, j->modtime, len, clen, j->crc);
+		if (j->deflate)
+			write_data(j->deflated.data(), clen);
+		else if (len != 0)
+			write_data(j->data.data(), len);
+	}
+}
+
 // Add a ZIP entry and copy the file data
 void jar::addJarEntry(const char *fname, bool deflate_hint, int modtime, bytes &head,
 					  bytes &tail)
@@ -262,14 +466,43 @@ void jar::addJarEntry(const char *fname, bool deflate_hint, int modtime, bytes &
 	int len = (int)(head.len + tail.len);
 	int clen = 0;
 
+	bool deflate = (deflate_hint && len > 0 && !store_only);
+
+	if (deflate_threads > 1 && !store_only && deflater == nullptr)
+	{
+		int workers = reserve_workers(deflate_threads);
+		if (workers == 0)
+		{
+			// other jars are using all the threads, this one is compressed on this one
+			deflate_threads = 1;
+		}
+		else
+		{
+			deflater = new jar_deflater(workers);
+		}
+	}
+	if (deflater != nullptr)
+	{
+		// the data only lives until the next entry, the workers get a copy
+		auto j = new jar_deflater::job();
+		j->name = fname;
+		j->modtime = modtime;
+		j->deflate = deflate;
+		j->head_len = head.len;
+		j->data.reserve(len);
+		j->data.insert(j->data.end(), (uchar *)head.ptr, (uchar *)head.ptr + head.len);
+		j->data.insert(j->data.end(), (uchar *)tail.ptr, (uchar *)tail.ptr + tail.len);
+		deflater->add(j);
+		write_queued_entries(false);
+		return;
+	}
+
 	uint32_t crc = get_crc32(0, Z_NULL, 0);
 	if (head.len != 0)
 		crc = get_crc32(crc, (uchar *)head.ptr, (uint32_t)head.len);
 	if (tail.len != 0)
 		crc = get_crc32(crc, (uchar *)tail.ptr, (uint32_t)tail.len);
 
-	bool deflate = (deflate_hint && len > 0);
-
 	if (deflate)
 	{
 		if (deflate_bytes(head, tail) == false)
@@ -295,6 +528,8 @@ void jar::addJarEntry(const char *fname, bool deflate_hint, int modtime, bytes &
 // Add a ZIP entry for a directory name no data
 void jar::addDirectoryToJarFile(const char *dir_name)
 {
+	// keep the entries in order
+	write_queued_entries(true);
 	bool store = true;
 	add_to_jar_directory((const char *)dir_name, store, default_modtime, 0, 0, 0);
 	write_jar_header((const char *)dir_name, store, default_modtime, 0, 0, 0);
@@ -303,6 +538,7 @@ void jar::addDirectoryToJarFile(const char *dir_name)
 // Write out the central directory and close the jar file.
 void jar::closeJarFile(bool central)
 {
+	write_queued_entries(true);
 	if (jarfp)
 	{
 		fflush(jarfp);
@@ -311,6 +547,10 @@ void jar::closeJarFile(bool central)
 		fflush(jarfp);
 		fclose(jarfp);
 	}
+	else if (sink && central)
+	{
+		write_central_directory();
+	}
 	reset();
 }
 
@@ -359,6 +599,24 @@ uint32_t jar::get_dostime(int modtime)
 bool jar::deflate_bytes(bytes &head, bytes &tail)
 {
 	int len = (int)(head.len + tail.len);
+	deflated.empty();
+	uchar *out = (uchar *)deflated.grow(len + (len / 2));
+	size_t clen = 0;
+	if (!deflate_bytes((uchar *)head.ptr, head.len, (uchar *)tail.ptr, tail.len, out,
+					   deflated.size(), clen))
+	{
+		return false;
+	}
+	deflated.b.len = clen;
+	return true;
+}
+
+// Compress head and tail into out. False when that fails or doesn't make them smaller.
+// Touches nothing else, the worker threads use it too.
+bool jar::deflate_bytes(uchar *head, size_t head_len, uchar *tail, size_t tail_len, uchar *out,
+						size_t out_size, size_t &out_len)
+{
+	int len = (int)(head_len + tail_len);
 
 	z_stream zs;
 	BYTES_OF(zs).clear();
@@ -389,42 +647,41 @@ bool jar::deflate_bytes(bytes &head, bytes &tail)
 		return false;
 	}
 
-	deflated.empty();
-	zs.next_out = (uchar *)deflated.grow(len + (len / 2));
-	zs.avail_out = (int)deflated.size();
-
-	zs.next_in = (uchar *)head.ptr;
-	zs.avail_in = (int)head.len;
+	zs.next_out = out;
+	zs.avail_out = (int)out_size;
 
-	bytes *first = &head;
-	bytes *last = &tail;
-	if (last->len == 0)
+	uchar *first = head;
+	size_t first_len = head_len;
+	uchar *last = tail;
+	size_t last_len = tail_len;
+	if (last_len == 0)
 	{
 		first = nullptr;
-		last = &head;
+		last = head;
+		last_len = head_len;
 	}
-	else if (first->len == 0)
+	else if (first_len == 0)
 	{
 		first = nullptr;
 	}
 
 	if (first != nullptr && error == Z_OK)
 	{
-		zs.next_in = (uchar *)first->ptr;
-		zs.avail_in = (int)first->len;
+		zs.next_in = first;
+		zs.avail_in = (int)first_len;
 		error = deflate(&zs, Z_NO_FLUSH);
 	}
 	if (error == Z_OK)
 	{
-		zs.next_in = (uchar *)last->ptr;
-		zs.avail_in = (int)last->len;
+		zs.next_in = last;
+		zs.avail_in = (int)last_len;
 		error = deflate(&zs, Z_FINISH);
 	}
 	if (error == Z_STREAM_END)
 	{
 		if (len > (int)zs.total_out)
 		{
-			deflated.b.len = zs.total_out;
+			out_len = zs.total_out;
 			deflateEnd(&zs);
 			return true;
 		}
@@ -28,11 +28,15 @@ typedef unsigned int uint32_t;
 typedef unsigned char uchar;
 
 struct unpacker;
+struct jar_deflater;
+class unpack_200_sink;
 
 struct jar
 {
 	// JAR file writer
 	FILE *jarfp;
+	// or, if set, where the jar goes instead of a file
+	unpack_200_sink *sink;
 	int default_modtime;
 
 	// Used by unix2dostime:
@@ -45,6 +49,11 @@ struct jar
 	uint32_t output_file_offset;
 	fillbytes deflated; // temporary buffer
 
+	// Compression settings, set after init():
+	int deflate_threads; // more than 1 compresses the entries on that many worker threads
+	bool store_only;	 // never compress, the jar only goes on a local classpath
+	jar_deflater *deflater; // the worker threads, while there are any
+
 	// pointer to outer unpacker, for error checks etc.
 	unpacker *u;
 
@@ -57,11 +66,7 @@ struct jar
 
 	void init(unpacker *u_);
 
-	void free()
-	{
-		central_directory.free();
-		deflated.free();
-	}
+	void free();
 
 	void reset()
 	{
@@ -80,11 +85,14 @@ struct jar
 	void write_jar_header(const char *fname, bool store, int modtime, int len, int clen,
 						  unsigned int crc);
 	void write_central_directory();
+	void write_queued_entries(bool all);
 	uint32_t dostime(int y, int n, int d, int h, int m, int s);
 	uint32_t get_dostime(int modtime);
 
 	// The definitions of these depend on the NO_ZLIB option:
 	bool deflate_bytes(bytes &head, bytes &tail);
+	static bool deflate_bytes(uchar *head, size_t head_len, uchar *tail, size_t tail_len,
+							  uchar *out, size_t out_size, size_t &out_len);
 	static uint32_t get_crc32(uint32_t c, unsigned char *ptr, uint32_t len);
 };
 
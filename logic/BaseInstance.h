@@ -137,6 +137,9 @@ public:
 	/// returns a valid update task
 	virtual std::shared_ptr<Task> doUpdate() = 0;
 
+	/// make the next update check everything, even if the instance looks unchanged
+	virtual void requestFullUpdate() {}
+
 	/// returns a valid process, ready for launch with the given account.
 	virtual BaseProcess *prepareForLaunch(AuthSessionPtr account) = 0;
 
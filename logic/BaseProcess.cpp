@@ -19,6 +19,7 @@
 #include <QDebug>
 #include <QDir>
 #include <QEventLoop>
+#include <pathutils.h>
 
 MessageLevel::Enum MessageLevel::getLevel(const QString& levelName)
 {
@@ -145,6 +146,32 @@ void BaseProcess::printHeader()
 	emit log(m_header);
 }
 
+void BaseProcess::beginStartupPhase()
+{
+	if (m_timeline && m_startupPhase == -1)
+	{
+		m_startupPhase = m_timeline->begin(tr("Game startup"));
+	}
+}
+
+void BaseProcess::endStartupPhase()
+{
+	if (!m_timeline || m_startupPhase == -1)
+		return;
+	m_timeline->end(m_startupPhase);
+	m_startupPhase = -1;
+
+	QString tracePath = PathCombine(m_instance->instanceRoot(), "launch-trace.json");
+	QString summary = tr("Launch timeline:\n") + m_timeline->summary();
+	if (m_timeline->saveChromeTrace(tracePath))
+	{
+		summary += tr("Saved as Chrome trace: %1\n").arg(tracePath);
+	}
+	emit log(summary + "\n");
+	// each launch gets its own timeline
+	m_timeline.reset();
+}
+
 
 void BaseProcess::logOutput(const QStringList &lines, MessageLevel::Enum defaultLevel,
 								 bool guessLevel, bool censor)
@@ -179,6 +206,11 @@ void BaseProcess::logOutput(QString line, MessageLevel::Enum defaultLevel, bool
 		line = censorPrivateInfo(line);
 
 	emit log(line, level);
+
+	if (m_startupPhase != -1 && startupFinished(line))
+	{
+		endStartupPhase();
+	}
 }
 
 void BaseProcess::on_stdErr()
@@ -243,6 +275,8 @@ void BaseProcess::finish(int code, ExitStatus status)
 		logOutput(m_out_leftover);
 		m_out_leftover.clear();
 	}
+	// the game didn't tell us it started, show what we have
+	endStartupPhase();
 
 	if (!killed)
 	{
@@ -292,6 +326,7 @@ bool BaseProcess::preLaunch()
 	if (!prelaunch_cmd.isEmpty())
 	{
 		prelaunch_cmd = substituteVariables(prelaunch_cmd);
+		TimelineScope phase(m_timeline, tr("Pre-launch command"));
 		// Launch
 		emit log(tr("Running Pre-Launch command: %1").arg(prelaunch_cmd));
 		m_prepostlaunchprocess.start(prelaunch_cmd);
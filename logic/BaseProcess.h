@@ -18,6 +18,7 @@
 #pragma once
 #include <QProcess>
 #include "BaseInstance.h"
+#include "tasks/Timeline.h"
 
 /**
  * @brief the MessageLevel Enum
@@ -62,6 +63,12 @@ public: /* methods */
 
 	void setWorkdir(QString path);
 
+	/// Record the launch phases into the timeline. The summary is logged once the game is up.
+	void setTimeline(TimelinePtr timeline)
+	{
+		m_timeline = timeline;
+	}
+
 	void killProcess();
 
 	/**
@@ -87,6 +94,16 @@ protected: /* methods */
 
 	void printHeader();
 
+	/// start timing the game startup, ended when startupFinished() matches a line of output
+	void beginStartupPhase();
+	/// end the game startup phase, log the timeline summary and save it as a trace
+	void endStartupPhase();
+	/// true if the line of game output means the game is up
+	virtual bool startupFinished(const QString &line)
+	{
+		return false;
+	}
+
 	virtual QMap<QString, QString> getVariables() const = 0;
 	virtual QString censorPrivateInfo(QString in) = 0;
 	virtual MessageLevel::Enum guessLevel(const QString &message, MessageLevel::Enum defaultLevel) = 0;
@@ -139,4 +156,6 @@ protected:
 	QProcess m_prepostlaunchprocess;
 	bool killed = false;
 	QString m_header;
+	TimelinePtr m_timeline;
+	int m_startupPhase = -1;
 };
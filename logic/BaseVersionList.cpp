@@ -30,6 +30,60 @@ BaseVersionPtr BaseVersionList::findVersion(const QString &descriptor)
 	return BaseVersionPtr();
 }
 
+static QStringList versionKeys(const QList<BaseVersionPtr> &versions)
+{
+	QStringList keys;
+	for (auto version : versions)
+	{
+		keys.append(version->descriptor() + '\n' + version->name() + '\n' + version->typeString());
+	}
+	return keys;
+}
+
+void BaseVersionList::publishUpdate(QList<BaseVersionPtr> &current,
+									const QList<BaseVersionPtr> &updated)
+{
+	auto oldKeys = versionKeys(current);
+	auto newKeys = versionKeys(updated);
+	const int added = newKeys.size() - oldKeys.size();
+	if (added < 0 || oldKeys.isEmpty())
+	{
+		beginResetModel();
+		current = updated;
+		endResetModel();
+		return;
+	}
+	int first;
+	if (newKeys.mid(added) == oldKeys)
+	{
+		first = 0;
+	}
+	else if (newKeys.mid(0, oldKeys.size()) == oldKeys)
+	{
+		first = oldKeys.size();
+	}
+	else
+	{
+		beginResetModel();
+		current = updated;
+		endResetModel();
+		return;
+	}
+	if (added)
+	{
+		beginInsertRows(QModelIndex(), first, first + added - 1);
+		current = updated;
+		endInsertRows();
+	}
+	else
+	{
+		current = updated;
+	}
+	// the old rows may have changed details
+	const int kept = first == 0 ? added : 0;
+	emit dataChanged(index(kept, 0), index(kept + oldKeys.size() - 1, columnCount(QModelIndex()) - 1));
+}
+
 BaseVersionPtr BaseVersionList::getLatestStable() const
 {
 	if (count() <= 0)
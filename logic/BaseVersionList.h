@@ -102,6 +102,14 @@ public:
 	 */
 	virtual void sort() = 0;
 
+protected:
+	/*!
+	 * Replaces `current` with `updated` and tells the views only about what changed.
+	 * Versions added at the start or the end of the list are inserted and the other rows are
+	 * refreshed in place, so selections survive a refresh. Anything else resets the model.
+	 */
+	void publishUpdate(QList<BaseVersionPtr> &current, const QList<BaseVersionPtr> &updated);
+
 protected
 slots:
 	/*!
@@ -1,6 +1,10 @@
 #include "Env.h"
 #include "net/HttpMetaCache.h"
 #include "icons/IconList.h"
+#include "java/JavaCheckCache.h"
+#include "forge/ForgeMirrorRanking.h"
+#include "minecraft/LibraryStore.h"
+#include "net/ArtifactMirror.h"
 #include "BaseVersion.h"
 #include "BaseVersionList.h"
 #include <QDir>
@@ -22,6 +26,11 @@ Env::Env()
 void Env::destroy()
 {
 	m_metacache.reset();
+	m_javaCheckCache.reset();
+	m_forgeMirrorRanking.reset();
+	m_libraryStore.reset();
+	m_artifactMirror.reset();
+	m_netJournalPath.clear();
 	m_qnam.reset();
 	m_icons.reset();
 	m_versionLists.clear();
@@ -49,6 +58,29 @@ std::shared_ptr<IconList> Env::icons()
 	Q_ASSERT(m_icons != nullptr);
 	return m_icons;
 }
+
+std::shared_ptr<JavaCheckCache> Env::javaCheckCache()
+{
+	// may be null - java checks simply aren't cached then
+	return m_javaCheckCache;
+}
+
+std::shared_ptr<ForgeMirrorRanking> Env::forgeMirrorRanking()
+{
+	// may be null - mirrors are then tried in random order
+	return m_forgeMirrorRanking;
+}
+
+std::shared_ptr<LibraryStore> Env::libraryStore()
+{
+	// may be null - libraries are then copied into every instance
+	return m_libraryStore;
+}
+
+std::shared_ptr<ArtifactMirror> Env::artifactMirror()
+{
+	return m_artifactMirror;
+}
 /*
 class NullVersion : public BaseVersion
 {
@@ -151,6 +183,48 @@ void Env::initHttpMetaCache(QString rootPath, QString staticDataPath)
 	m_metacache->Load();
 }
 
+void Env::initJavaCheckCache(QString indexPath)
+{
+	m_javaCheckCache.reset(new JavaCheckCache(indexPath));
+	m_javaCheckCache->Load();
+}
+
+void Env::initForgeMirrorRanking(QString indexPath)
+{
+	m_forgeMirrorRanking.reset(new ForgeMirrorRanking(indexPath));
+	m_forgeMirrorRanking->Load();
+}
+
+void Env::initLibraryStore(QString path)
+{
+	m_libraryStore.reset(new LibraryStore(QDir(path).absolutePath()));
+}
+
+QString Env::netJournalPath()
+{
+	return m_netJournalPath;
+}
+
+void Env::initNetJournals(QString path)
+{
+	m_netJournalPath = QDir(path).absolutePath();
+	QDir().mkpath(m_netJournalPath);
+}
+
+void Env::updateMirrorSettings(QString location, bool offline)
+{
+	if (location.isEmpty() && !offline)
+	{
+		m_artifactMirror.reset();
+		return;
+	}
+	m_artifactMirror = std::make_shared<ArtifactMirror>(location, offline);
+	if (offline)
+		qDebug() << "Strict offline mode, everything comes from the cache";
+	else
+		qDebug() << "Downloading everything from the mirror at" << m_artifactMirror->location();
+}
+
 void Env::updateProxySettings(QString proxyTypeStr, QString addr, int port, QString user, QString password)
 {
 	// Set the application proxy settings.
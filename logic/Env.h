@@ -7,6 +7,10 @@
 class IconList;
 class QNetworkAccessManager;
 class HttpMetaCache;
+class JavaCheckCache;
+class ForgeMirrorRanking;
+class LibraryStore;
+class ArtifactMirror;
 class BaseVersionList;
 class BaseVersion;
 
@@ -32,12 +36,39 @@ public:
 
 	std::shared_ptr<IconList> icons();
 
+	std::shared_ptr<JavaCheckCache> javaCheckCache();
+
 	/// init the cache. FIXME: possible future hook point
 	void initHttpMetaCache(QString rootPath, QString staticDataPath);
 
+	/// init the cache of java checker results
+	void initJavaCheckCache(QString indexPath);
+
+	std::shared_ptr<ForgeMirrorRanking> forgeMirrorRanking();
+
+	/// init the persisted Forge mirror rankings
+	void initForgeMirrorRanking(QString indexPath);
+
+	std::shared_ptr<LibraryStore> libraryStore();
+
+	/// init the store of library files shared between instances
+	void initLibraryStore(QString path);
+
+	/// folder of the journals of long downloads, empty if they aren't kept
+	QString netJournalPath();
+
+	/// keep the journals of long downloads in @p path
+	void initNetJournals(QString path);
+
 	/// Updates the application proxy settings from the settings object.
 	void updateProxySettings(QString proxyTypeStr, QString addr, int port, QString user, QString password);
 
+	/// where downloads come from without internet. null when they come from the internet
+	std::shared_ptr<ArtifactMirror> artifactMirror();
+
+	/// Sets up the local mirror (a URL or a directory, may be empty) and strict offline mode.
+	void updateMirrorSettings(QString location, bool offline);
+
 	/// get a version list by name
 	std::shared_ptr<BaseVersionList> getVersionList(QString component);
 
@@ -49,5 +80,10 @@ protected:
 	std::shared_ptr<QNetworkAccessManager> m_qnam;
 	std::shared_ptr<HttpMetaCache> m_metacache;
 	std::shared_ptr<IconList> m_icons;
+	std::shared_ptr<JavaCheckCache> m_javaCheckCache;
+	std::shared_ptr<ForgeMirrorRanking> m_forgeMirrorRanking;
+	std::shared_ptr<LibraryStore> m_libraryStore;
+	std::shared_ptr<ArtifactMirror> m_artifactMirror;
+	QString m_netJournalPath;
 	QMap<QString, std::shared_ptr<BaseVersionList>> m_versionLists;
 };
@@ -49,6 +49,74 @@ QStringList MMCZip::extractDir(QString fileCompressed, QString dir)
 	return JlCompress::extractDir(fileCompressed, dir);
 }
 
+static bool extractCurrentTo(QuaZip &zip, QString target)
+{
+	if (!ensureFilePathExists(target))
+	{
+		return false;
+	}
+	QuaZipFile inFile(&zip);
+	if (!inFile.open(QIODevice::ReadOnly))
+	{
+		return false;
+	}
+	QFile outFile(target);
+	if (!outFile.open(QIODevice::WriteOnly))
+	{
+		return false;
+	}
+	if (!copyData(inFile, outFile) || inFile.getZipError() != UNZ_OK)
+	{
+		return false;
+	}
+	inFile.close();
+	return inFile.getZipError() == UNZ_OK;
+}
+
+bool MMCZip::extractNatives(QString fileCompressed, QString dir, const QStringList &excludes)
+{
+	QuaZip zip(fileCompressed);
+	if (!zip.open(QuaZip::mdUnzip))
+	{
+		return false;
+	}
+	for (bool more = zip.goToFirstFile(); more; more = zip.goToNextFile())
+	{
+		QString name = zip.getCurrentFileName();
+		if (name.endsWith('/'))
+			continue;
+		bool excluded = false;
+		for (auto &exclude : excludes)
+		{
+			if (name.startsWith(exclude))
+			{
+				excluded = true;
+				break;
+			}
+		}
+		if (excluded)
+			continue;
+		if (!extractCurrentTo(zip, PathCombine(dir, name)))
+		{
+			qCritical() << "Failed to extract" << name << "from" << fileCompressed;
+			return false;
+		}
+#ifdef OSX
+		// java 8+ only looks for .dylib, older versions for .jnilib. Provide both.
+		if (name.endsWith(".jnilib"))
+		{
+			name.chop(7);
+			if (!extractCurrentTo(zip, PathCombine(dir, name + ".dylib")))
+			{
+				return false;
+			}
+		}
+#endif
+	}
+	zip.close();
+	return zip.getZipError() == UNZ_OK;
+}
+
 bool compressFile(QuaZip *zip, QString fileName, QString fileDest)
 {
 	if (!zip)
@@ -56,4 +56,12 @@ namespace MMCZip
 	 * \return The list of the full paths of the files extracted, empty on failure.
 	 */
     QStringList extractDir(QString fileCompressed, QString dir = QString());
+
+	/**
+	 * Extract a native library jar, skipping all entries that start with one of the excludes.
+	 *
+	 * On OSX, '.jnilib' files are also extracted as '.dylib' for java 8+.
+	 * \return true if success, false otherwise.
+	 */
+	bool extractNatives(QString fileCompressed, QString dir, const QStringList &excludes);
 }
\ No newline at end of file
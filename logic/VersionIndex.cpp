@@ -0,0 +1,380 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VersionIndex.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+#include <QObject>
+#include <pathutils.h>
+#include <cstring>
+
+namespace
+{
+const char MAGIC[8] = {'M', 'M', 'C', 'V', 'I', 'D', 'X', '\0'};
+const int KIND_SIZE = 16;
+// keeps the tables, and with them the records, 8 byte aligned
+const qint64 HEADER_SIZE = 8 + 4 + 4 + KIND_SIZE + 4 + 4 + 4 + 4 + 8 + 8 + 8;
+const qint64 TABLE_ENTRY_SIZE = 4 + 4 + 8;
+const qint64 PROPERTY_SIZE = 4 + 4;
+const qint64 STRING_ENTRY_SIZE = 4 + 4;
+// tables and strings beyond these are certainly not a version list
+const quint32 MAX_TABLES = 64;
+const quint32 MAX_FIELDS = 256;
+
+quint32 read32(const uchar *p)
+{
+	return qFromLittleEndian<quint32>(p);
+}
+quint64 read64(const uchar *p)
+{
+	return qFromLittleEndian<quint64>(p);
+}
+void append32(QByteArray &out, quint32 value)
+{
+	uchar buf[4];
+	qToLittleEndian(value, buf);
+	out.append((const char *)buf, 4);
+}
+void append64(QByteArray &out, quint64 value)
+{
+	uchar buf[8];
+	qToLittleEndian(value, buf);
+	out.append((const char *)buf, 8);
+}
+/// true if [offset, offset + size) lies within a buffer of `total` bytes
+bool inside(quint64 offset, quint64 size, quint64 total)
+{
+	return offset <= total && size <= total - offset;
+}
+}
+
+VersionIndexPtr VersionIndex::open(const QString &path, const QByteArray &kind, quint32 layout,
+								   QString *error)
+{
+	VersionIndexPtr index(new VersionIndex());
+	QString problem;
+	index->m_file.setFileName(path);
+	if (!index->m_file.open(QIODevice::ReadOnly))
+	{
+		problem = index->m_file.errorString();
+	}
+	else
+	{
+		qint64 size = index->m_file.size();
+		const uchar *mapped = size ? index->m_file.map(0, size) : nullptr;
+		if (!mapped)
+		{
+			// some file systems can't map files, read them instead
+			index->m_data = index->m_file.readAll();
+			index->m_file.close();
+			mapped = (const uchar *)index->m_data.constData();
+			size = index->m_data.size();
+		}
+		if (index->parse(mapped, size, kind, layout, problem))
+		{
+			return index;
+		}
+	}
+	if (error)
+	{
+		*error = problem;
+	}
+	return nullptr;
+}
+
+VersionIndexPtr VersionIndex::fromData(const QByteArray &data, const QByteArray &kind,
+									   quint32 layout, QString *error)
+{
+	VersionIndexPtr index(new VersionIndex());
+	index->m_data = data;
+	QString problem;
+	if (index->parse((const uchar *)index->m_data.constData(), index->m_data.size(), kind,
+					 layout, problem))
+	{
+		return index;
+	}
+	if (error)
+	{
+		*error = problem;
+	}
+	return nullptr;
+}
+
+VersionIndex::~VersionIndex()
+{
+	// unmaps the file, if it was mapped
+	m_file.close();
+}
+
+bool VersionIndex::parse(const uchar *data, qint64 size, const QByteArray &kind,
+						 quint32 layout, QString &error)
+{
+	if (size < HEADER_SIZE || memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+	{
+		error = QObject::tr("Not a version index");
+		return false;
+	}
+	const uchar *p = data + sizeof(MAGIC);
+	quint32 format = read32(p);
+	quint32 fileLayout = read32(p + 4);
+	QByteArray fileKind((const char *)p + 8, KIND_SIZE);
+	fileKind.truncate(qstrnlen(fileKind.constData(), KIND_SIZE));
+	p += 8 + KIND_SIZE;
+	if (format != FORMAT_VERSION || fileLayout != layout || fileKind != kind)
+	{
+		error = QObject::tr("The version index is of a different kind or version");
+		return false;
+	}
+	quint32 tableCount = read32(p);
+	quint32 propertyCount = read32(p + 4);
+	quint32 stringCount = read32(p + 8);
+	// p + 12 is reserved
+	quint64 stringTableOffset = read64(p + 16);
+	quint64 stringDataOffset = read64(p + 24);
+	quint64 stringDataSize = read64(p + 32);
+	const quint64 total = size;
+
+	if (tableCount > MAX_TABLES ||
+		!inside(HEADER_SIZE, tableCount * TABLE_ENTRY_SIZE + propertyCount * PROPERTY_SIZE, total) ||
+		!inside(stringTableOffset, quint64(stringCount) * STRING_ENTRY_SIZE, total) ||
+		!inside(stringDataOffset, stringDataSize, total))
+	{
+		error = QObject::tr("The version index is truncated");
+		return false;
+	}
+
+	// check everything up front, so the accessors don't have to
+	m_stringTable = data + stringTableOffset;
+	m_stringData = data + stringDataOffset;
+	m_stringCount = stringCount;
+	for (quint32 i = 0; i < stringCount; i++)
+	{
+		const uchar *entry = m_stringTable + i * STRING_ENTRY_SIZE;
+		if (!inside(read32(entry), read32(entry + 4), stringDataSize))
+		{
+			error = QObject::tr("The version index has a damaged string pool");
+			return false;
+		}
+	}
+	m_strings.resize(stringCount + 1);
+	m_decoded.fill(false, stringCount + 1);
+
+	p = data + HEADER_SIZE;
+	for (quint32 i = 0; i < tableCount; i++, p += TABLE_ENTRY_SIZE)
+	{
+		Table table;
+		quint32 fields = read32(p);
+		quint32 records = read32(p + 4);
+		quint64 offset = read64(p + 8);
+		if (fields == 0 || fields > MAX_FIELDS || !inside(offset, quint64(fields) * records * 8, total))
+		{
+			error = QObject::tr("The version index has a damaged table");
+			return false;
+		}
+		table.fieldCount = fields;
+		table.recordCount = records;
+		table.records = data + offset;
+		m_tables.append(table);
+	}
+	for (quint32 i = 0; i < propertyCount; i++, p += PROPERTY_SIZE)
+	{
+		m_properties.insert(string(read32(p)), string(read32(p + 4)));
+	}
+	return true;
+}
+
+int VersionIndex::tableCount() const
+{
+	return m_tables.size();
+}
+
+int VersionIndex::fieldCount(int table) const
+{
+	if (table < 0 || table >= m_tables.size())
+		return 0;
+	return m_tables[table].fieldCount;
+}
+
+int VersionIndex::recordCount(int table) const
+{
+	if (table < 0 || table >= m_tables.size())
+		return 0;
+	return m_tables[table].recordCount;
+}
+
+quint64 VersionIndex::value(int table, int record, int field) const
+{
+	if (table < 0 || table >= m_tables.size())
+		return 0;
+	const Table &t = m_tables[table];
+	if (record < 0 || record >= t.recordCount || field < 0 || field >= t.fieldCount)
+		return 0;
+	return read64(t.records + (qint64(record) * t.fieldCount + field) * 8);
+}
+
+QString VersionIndex::string(int table, int record, int field) const
+{
+	return string(value(table, record, field));
+}
+
+QString VersionIndex::string(quint64 id) const
+{
+	// ID 0 is the null string, pool strings start at 1
+	if (id == 0 || id > m_stringCount)
+		return QString();
+	if (!m_decoded[id])
+	{
+		const uchar *entry = m_stringTable + (id - 1) * STRING_ENTRY_SIZE;
+		m_strings[id] =
+			QString::fromUtf8((const char *)m_stringData + read32(entry), read32(entry + 4));
+		m_decoded[id] = true;
+	}
+	return m_strings[id];
+}
+
+QString VersionIndex::property(const QString &key) const
+{
+	return m_properties.value(key);
+}
+
+VersionIndexWriter::VersionIndexWriter(const QByteArray &kind, quint32 layout)
+	: m_kind(kind.left(KIND_SIZE)), m_layout(layout)
+{
+}
+
+int VersionIndexWriter::addTable(int fieldCount)
+{
+	Table table;
+	table.fieldCount = qBound(1, fieldCount, int(MAX_FIELDS));
+	m_tables.append(table);
+	return m_tables.size() - 1;
+}
+
+bool VersionIndexWriter::addRecord(int table, const QVector<quint64> &fields)
+{
+	if (table < 0 || table >= m_tables.size())
+		return false;
+	Table &t = m_tables[table];
+	if (fields.size() > t.fieldCount)
+		return false;
+	t.values += fields;
+	t.values.resize(t.values.size() + t.fieldCount - fields.size());
+	return true;
+}
+
+int VersionIndexWriter::recordCount(int table) const
+{
+	if (table < 0 || table >= m_tables.size())
+		return 0;
+	return m_tables[table].values.size() / m_tables[table].fieldCount;
+}
+
+quint64 VersionIndexWriter::string(const QString &value)
+{
+	if (value.isEmpty())
+		return 0;
+	auto iter = m_ids.find(value);
+	if (iter != m_ids.end())
+		return *iter;
+	m_strings.append(value.toUtf8());
+	quint64 id = m_strings.size();
+	m_ids.insert(value, id);
+	return id;
+}
+
+void VersionIndexWriter::setProperty(const QString &key, const QString &value)
+{
+	m_properties.append(qMakePair(string(key), string(value)));
+}
+
+QByteArray VersionIndexWriter::data() const
+{
+	quint64 offset = HEADER_SIZE + m_tables.size() * TABLE_ENTRY_SIZE +
+					 m_properties.size() * PROPERTY_SIZE;
+	QVector<quint64> tableOffsets;
+	for (auto &table : m_tables)
+	{
+		tableOffsets.append(offset);
+		offset += table.values.size() * 8;
+	}
+	quint64 stringTableOffset = offset;
+	quint64 stringDataOffset = stringTableOffset + m_strings.size() * STRING_ENTRY_SIZE;
+	quint64 stringDataSize = 0;
+	for (auto &str : m_strings)
+	{
+		stringDataSize += str.size();
+	}
+
+	QByteArray out;
+	out.reserve(stringDataOffset + stringDataSize);
+	out.append(MAGIC, sizeof(MAGIC));
+	append32(out, VersionIndex::FORMAT_VERSION);
+	append32(out, m_layout);
+	QByteArray kind = m_kind;
+	kind.append(QByteArray(KIND_SIZE - kind.size(), '\0'));
+	out.append(kind);
+	append32(out, m_tables.size());
+	append32(out, m_properties.size());
+	append32(out, m_strings.size());
+	append32(out, 0);
+	append64(out, stringTableOffset);
+	append64(out, stringDataOffset);
+	append64(out, stringDataSize);
+	for (int i = 0; i < m_tables.size(); i++)
+	{
+		auto &table = m_tables[i];
+		append32(out, table.fieldCount);
+		append32(out, table.values.size() / table.fieldCount);
+		append64(out, tableOffsets[i]);
+	}
+	for (auto &property : m_properties)
+	{
+		append32(out, property.first);
+		append32(out, property.second);
+	}
+	for (auto &table : m_tables)
+	{
+		for (auto value : table.values)
+		{
+			append64(out, value);
+		}
+	}
+	quint32 stringOffset = 0;
+	for (auto &str : m_strings)
+	{
+		append32(out, stringOffset);
+		append32(out, str.size());
+		stringOffset += str.size();
+	}
+	for (auto &str : m_strings)
+	{
+		out.append(str);
+	}
+	return out;
+}
+
+bool VersionIndexWriter::save(const QString &path) const
+{
+	if (!ensureFilePathExists(path))
+		return false;
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	auto bytes = data();
+	if (file.write(bytes) != bytes.size())
+		return false;
+	return file.commit();
+}
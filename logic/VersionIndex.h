@@ -0,0 +1,138 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QFile>
+#include <memory>
+
+class VersionIndex;
+typedef std::shared_ptr<VersionIndex> VersionIndexPtr;
+
+/**
+ * Compact on-disk cache of a version list.
+ *
+ * The file holds one or more tables of fixed size records, a set of string properties and a
+ * pool of interned UTF-8 strings. Every record field is a 64 bit little endian number: either
+ * a plain value or the ID of a string in the pool (ID 0 is the null string, the pool starts
+ * at 1). What the fields mean is up to the version
+ * list that wrote the file - it identifies its layout with a kind and a layout number and
+ * bumps the layout number whenever the fields change, so old files are simply not loaded.
+ *
+ * Files are mapped into memory and read in place. Strings are decoded on first use and shared
+ * by all the records that refer to them.
+ *
+ * Layout (all numbers little endian):
+ *   header     magic "MMCVIDX\0", format, layout, kind[16], table count, property count,
+ *              string count, reserved, string table offset, string data offset, string data size
+ *   tables     per table: field count, record count, record data offset
+ *   properties per property: key string ID, value string ID
+ *   records    per table: record count * field count 64 bit fields
+ *   strings    per string: offset into the string data, size in bytes
+ *   data       the string bytes, not terminated
+ */
+class VersionIndex
+{
+public:
+	enum
+	{
+		FORMAT_VERSION = 1
+	};
+
+	/// open an index file. Returns null when the file is missing, damaged or has a different kind or layout.
+	static VersionIndexPtr open(const QString &path, const QByteArray &kind, quint32 layout,
+								QString *error = nullptr);
+	/// same as open() for an index already in memory
+	static VersionIndexPtr fromData(const QByteArray &data, const QByteArray &kind,
+									quint32 layout, QString *error = nullptr);
+
+	~VersionIndex();
+
+	int tableCount() const;
+	int fieldCount(int table) const;
+	int recordCount(int table) const;
+
+	/// raw value of a field
+	quint64 value(int table, int record, int field) const;
+	/// field holding a string ID, resolved. Invalid IDs give a null string.
+	QString string(int table, int record, int field) const;
+	/// string from the pool by ID. Invalid IDs give a null string.
+	QString string(quint64 id) const;
+
+	/// value of a property, null if there is no such property
+	QString property(const QString &key) const;
+
+private:
+	VersionIndex() = default;
+	bool parse(const uchar *data, qint64 size, const QByteArray &kind, quint32 layout,
+			   QString &error);
+
+private:
+	struct Table
+	{
+		int fieldCount = 0;
+		int recordCount = 0;
+		const uchar *records = nullptr;
+	};
+	QFile m_file;
+	QByteArray m_data;
+	QVector<Table> m_tables;
+	QHash<QString, QString> m_properties;
+	const uchar *m_stringTable = nullptr;
+	const uchar *m_stringData = nullptr;
+	quint32 m_stringCount = 0;
+	mutable QVector<QString> m_strings;
+	mutable QVector<bool> m_decoded;
+};
+
+/**
+ * Builds a VersionIndex file. Strings are interned - adding the same string twice returns the same ID.
+ */
+class VersionIndexWriter
+{
+public:
+	VersionIndexWriter(const QByteArray &kind, quint32 layout);
+
+	/// add an empty table with records of `fieldCount` fields. Returns the table number
+	int addTable(int fieldCount);
+	/// append a record. Missing fields are zero, extra fields are an error.
+	bool addRecord(int table, const QVector<quint64> &fields);
+	int recordCount(int table) const;
+
+	/// intern a string and return its ID
+	quint64 string(const QString &value);
+	void setProperty(const QString &key, const QString &value);
+
+	QByteArray data() const;
+	/// write the file atomically
+	bool save(const QString &path) const;
+
+private:
+	struct Table
+	{
+		int fieldCount = 0;
+		QVector<quint64> values;
+	};
+	QByteArray m_kind;
+	quint32 m_layout;
+	QVector<Table> m_tables;
+	QVector<QPair<quint64, quint64>> m_properties;
+	QHash<QString, quint64> m_ids;
+	QVector<QByteArray> m_strings;
+};
@@ -0,0 +1,98 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "VersionListRefresher.h"
+#include "BaseVersionList.h"
+#include "tasks/Task.h"
+
+#include <QDebug>
+
+VersionListRefresher::VersionListRefresher(QObject *parent) : QObject(parent)
+{
+}
+
+VersionListRefresher::~VersionListRefresher()
+{
+	for (auto task : m_running)
+	{
+		task->disconnect(this);
+		task->deleteLater();
+	}
+}
+
+void VersionListRefresher::addList(std::shared_ptr<BaseVersionList> list)
+{
+	if (list && !m_lists.contains(list))
+	{
+		m_lists.append(list);
+	}
+}
+
+void VersionListRefresher::start()
+{
+	for (auto list : m_lists)
+	{
+		refresh(list.get());
+	}
+}
+
+void VersionListRefresher::refresh(BaseVersionList *list)
+{
+	if (!list || m_running.contains(list))
+	{
+		return;
+	}
+	Task *task = list->getLoadTask();
+	if (!task)
+	{
+		return;
+	}
+	m_running.insert(list, task);
+	connect(task, &Task::succeeded, this, [this, list]()
+	{
+		taskDone(list, true);
+	});
+	connect(task, &Task::failed, this, [this, list](QString reason)
+	{
+		qWarning() << "Refreshing a version list failed:" << reason;
+		taskDone(list, false);
+	});
+	task->start();
+}
+
+void VersionListRefresher::taskDone(BaseVersionList *list, bool success)
+{
+	Task *task = m_running.take(list);
+	if (task)
+	{
+		// other slots of the task may still be running
+		task->deleteLater();
+	}
+	emit listRefreshed(list, success);
+	if (m_running.isEmpty())
+	{
+		emit finished();
+	}
+}
+
+Task *VersionListRefresher::runningTask(BaseVersionList *list) const
+{
+	return m_running.value(list, nullptr);
+}
+
+bool VersionListRefresher::isRunning() const
+{
+	return !m_running.isEmpty();
+}
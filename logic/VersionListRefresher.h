@@ -0,0 +1,66 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <memory>
+
+class BaseVersionList;
+class Task;
+
+/**
+ * Refreshes version lists in the background.
+ *
+ * The lists start out with whatever they have cached locally. The refresh runs their load
+ * tasks, which check the server through the metacache and only parse what changed, and the
+ * lists publish the differences to their views. Dialogs can show a list right away and only
+ * have to wait for a list that has nothing at all yet - see runningTask().
+ */
+class VersionListRefresher : public QObject
+{
+	Q_OBJECT
+public:
+	explicit VersionListRefresher(QObject *parent = 0);
+	virtual ~VersionListRefresher();
+
+	/// refresh this list when start() is called
+	void addList(std::shared_ptr<BaseVersionList> list);
+
+	/// refresh all the added lists. Lists that are already being refreshed are skipped.
+	void start();
+
+	/// refresh a single list, unless it is already being refreshed
+	void refresh(BaseVersionList *list);
+
+	/// the task refreshing `list` right now, or nullptr
+	Task *runningTask(BaseVersionList *list) const;
+
+	bool isRunning() const;
+
+signals:
+	void listRefreshed(BaseVersionList *list, bool success);
+	/// all the running refreshes are done
+	void finished();
+
+private:
+	void taskDone(BaseVersionList *list, bool success);
+
+private:
+	QList<std::shared_ptr<BaseVersionList>> m_lists;
+	QMap<BaseVersionList *, Task *> m_running;
+};
@@ -0,0 +1,142 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Env.h"
+#include "ForgeMirrorProbe.h"
+
+#include <QNetworkAccessManager>
+#include <QDateTime>
+#include <QDebug>
+
+ForgeMirrorProbe::ForgeMirrorProbe(QList<ForgeMirror> mirrors, QString path,
+								   ForgeMirrorRankingPtr ranking,
+								   std::shared_ptr<QNetworkAccessManager> qnam)
+	: QObject(), m_mirrors(mirrors), m_path(path), m_ranking(ranking), m_qnam(qnam)
+{
+	if (!m_qnam)
+		m_qnam = ENV.qnam();
+	m_timeout.setSingleShot(true);
+	connect(&m_timeout, SIGNAL(timeout()), SLOT(timeout()));
+}
+
+ForgeMirrorProbe::~ForgeMirrorProbe()
+{
+	for (auto &probe : m_probes)
+	{
+		if (probe.reply)
+		{
+			probe.reply->disconnect(this);
+			probe.reply->abort();
+			probe.reply->deleteLater();
+		}
+	}
+}
+
+void ForgeMirrorProbe::start()
+{
+	m_clock.start();
+	m_probes.clear();
+	for (auto &mirror : m_mirrors)
+	{
+		Probe probe;
+		probe.mirrorUrl = mirror.mirror_url;
+		m_probes.append(probe);
+	}
+	m_running = m_probes.size();
+	if (!m_running)
+	{
+		emit finished();
+		return;
+	}
+	m_timeout.start(TIMEOUT_MS);
+	for (int i = 0; i < m_probes.size(); i++)
+	{
+		QUrl url(m_probes[i].mirrorUrl + m_path);
+		qDebug() << "Probing mirror" << url.toString();
+		QNetworkRequest request(url);
+		request.setRawHeader("Range", QString("bytes=0-%1").arg(PROBE_BYTES - 1).toLatin1());
+		request.setHeader(QNetworkRequest::UserAgentHeader, "MultiMC/5.0 (Uncached)");
+		auto reply = m_qnam->get(request);
+		m_probes[i].reply = reply;
+		connect(reply, &QNetworkReply::readyRead, this, [this, i]() { readyRead(i); });
+		connect(reply, &QNetworkReply::finished, this, [this, i]() { replyFinished(i); });
+	}
+}
+
+void ForgeMirrorProbe::readyRead(int index)
+{
+	auto &probe = m_probes[index];
+	if (!probe.reply)
+		return;
+	if (probe.latency < 0)
+		probe.latency = m_clock.elapsed();
+	probe.bytes += probe.reply->readAll().size();
+	// mirrors that ignore the range send the whole file, enough is enough
+	if (probe.bytes >= PROBE_BYTES)
+		done(index, true);
+}
+
+void ForgeMirrorProbe::replyFinished(int index)
+{
+	auto &probe = m_probes[index];
+	if (!probe.reply)
+		return;
+	probe.bytes += probe.reply->readAll().size();
+	int status = probe.reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+	bool ok = probe.reply->error() == QNetworkReply::NoError && status < 400;
+	if (ok && probe.latency < 0)
+		probe.latency = m_clock.elapsed();
+	done(index, ok);
+}
+
+void ForgeMirrorProbe::timeout()
+{
+	for (int i = 0; i < m_probes.size(); i++)
+	{
+		// slow, but it did send something
+		done(i, m_probes[i].bytes > 0);
+	}
+}
+
+void ForgeMirrorProbe::done(int index, bool ok)
+{
+	auto &probe = m_probes[index];
+	if (!probe.reply)
+		return;
+	auto reply = probe.reply;
+	probe.reply = nullptr;
+	reply->disconnect(this);
+	reply->abort();
+	reply->deleteLater();
+
+	qint64 now = QDateTime::currentMSecsSinceEpoch();
+	if (ok)
+	{
+		qint64 transfer = m_clock.elapsed() - probe.latency;
+		qDebug() << "Mirror" << probe.mirrorUrl << ": latency" << probe.latency << "ms,"
+				 << probe.bytes << "bytes in" << transfer << "ms";
+		m_ranking->reportSuccess(probe.mirrorUrl, probe.latency, probe.bytes, transfer, now);
+	}
+	else
+	{
+		qWarning() << "Mirror" << probe.mirrorUrl << "failed the probe";
+		m_ranking->reportFailure(probe.mirrorUrl, now);
+	}
+	if (--m_running == 0)
+	{
+		m_timeout.stop();
+		emit finished();
+	}
+}
@@ -0,0 +1,80 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QList>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QNetworkReply>
+#include <memory>
+
+#include "ForgeMirror.h"
+#include "ForgeMirrorRanking.h"
+
+class QNetworkAccessManager;
+
+/**
+ * Measures a set of mirrors at the same time by fetching the start of the same file from each
+ * of them with a ranged request. The results go into the ranking.
+ */
+class ForgeMirrorProbe : public QObject
+{
+	Q_OBJECT
+public:
+	/// bytes asked for from each mirror
+	static const int PROBE_BYTES = 64 * 1024;
+	/// mirrors that haven't answered by then count as failed
+	static const int TIMEOUT_MS = 5000;
+
+	/// path is relative to the mirror base, like the download URLs
+	ForgeMirrorProbe(QList<ForgeMirror> mirrors, QString path, ForgeMirrorRankingPtr ranking,
+					 std::shared_ptr<QNetworkAccessManager> qnam = nullptr);
+	virtual ~ForgeMirrorProbe();
+
+	void start();
+
+signals:
+	/// every mirror either answered or failed
+	void finished();
+
+private
+slots:
+	void timeout();
+
+private:
+	struct Probe
+	{
+		QString mirrorUrl;
+		QNetworkReply *reply = nullptr;
+		qint64 latency = -1;
+		qint64 bytes = 0;
+	};
+	void readyRead(int index);
+	void replyFinished(int index);
+	/// record the result and drop the reply
+	void done(int index, bool ok);
+
+private:
+	QList<ForgeMirror> m_mirrors;
+	QString m_path;
+	ForgeMirrorRankingPtr m_ranking;
+	std::shared_ptr<QNetworkAccessManager> m_qnam;
+	QList<Probe> m_probes;
+	int m_running = 0;
+	QElapsedTimer m_clock;
+	QTimer m_timeout;
+};
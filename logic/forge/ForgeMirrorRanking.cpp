@@ -0,0 +1,200 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ForgeMirrorRanking.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <algorithm>
+
+// how much a new measurement counts against the old ones
+static const double SMOOTHING = 0.3;
+
+ForgeMirrorRanking::ForgeMirrorRanking(QString path) : QObject()
+{
+	m_index_file = path;
+	saveBatchingTimer.setSingleShot(true);
+	saveBatchingTimer.setTimerType(Qt::VeryCoarseTimer);
+	connect(&saveBatchingTimer, SIGNAL(timeout()), SLOT(SaveNow()));
+}
+
+ForgeMirrorRanking::~ForgeMirrorRanking()
+{
+	if (saveBatchingTimer.isActive())
+	{
+		saveBatchingTimer.stop();
+		SaveNow();
+	}
+}
+
+void ForgeMirrorRanking::reportSuccess(const QString &mirrorUrl, qint64 latencyMs, qint64 bytes,
+									   qint64 elapsedMs, qint64 now)
+{
+	auto &stats = m_stats[mirrorUrl];
+	double bytesPerSec = bytes * 1000.0 / qMax<qint64>(elapsedMs, 1);
+	if (stats.latencyMs < 0)
+	{
+		stats.latencyMs = latencyMs;
+		stats.bytesPerSec = bytesPerSec;
+	}
+	else
+	{
+		stats.latencyMs += SMOOTHING * (latencyMs - stats.latencyMs);
+		stats.bytesPerSec += SMOOTHING * (bytesPerSec - stats.bytesPerSec);
+	}
+	stats.failures = 0;
+	stats.lastChecked = now;
+	SaveEventually();
+}
+
+void ForgeMirrorRanking::reportFailure(const QString &mirrorUrl, qint64 now)
+{
+	auto &stats = m_stats[mirrorUrl];
+	stats.failures++;
+	stats.lastChecked = now;
+	SaveEventually();
+}
+
+bool ForgeMirrorRanking::needsProbe(const QString &mirrorUrl, qint64 now) const
+{
+	auto iter = m_stats.find(mirrorUrl);
+	if (iter == m_stats.end())
+		return true;
+	return now - iter->lastChecked > MAX_AGE_MS;
+}
+
+ForgeMirrorRanking::Stats ForgeMirrorRanking::stats(const QString &mirrorUrl) const
+{
+	return m_stats.value(mirrorUrl);
+}
+
+double ForgeMirrorRanking::expectedTimeMs(const QString &mirrorUrl) const
+{
+	auto stats = m_stats.value(mirrorUrl);
+	if (stats.latencyMs < 0 || stats.bytesPerSec <= 0)
+		return -1;
+	return stats.latencyMs + TYPICAL_DOWNLOAD * 1000.0 / stats.bytesPerSec;
+}
+
+QList<ForgeMirror> ForgeMirrorRanking::rank(const QList<ForgeMirror> &mirrors) const
+{
+	// 0 = measured and working, 1 = unknown, 2 = failing
+	auto group = [this](const ForgeMirror &mirror)
+	{
+		auto stats = m_stats.value(mirror.mirror_url);
+		if (stats.failures)
+			return 2;
+		if (expectedTimeMs(mirror.mirror_url) < 0)
+			return 1;
+		return 0;
+	};
+	auto sorted = mirrors;
+	std::stable_sort(sorted.begin(), sorted.end(),
+					 [&](const ForgeMirror &a, const ForgeMirror &b)
+	{
+		int groupA = group(a);
+		int groupB = group(b);
+		if (groupA != groupB)
+			return groupA < groupB;
+		if (groupA == 0)
+			return expectedTimeMs(a.mirror_url) < expectedTimeMs(b.mirror_url);
+		if (groupA == 2)
+			return m_stats.value(a.mirror_url).failures < m_stats.value(b.mirror_url).failures;
+		return false;
+	});
+	return sorted;
+}
+
+void ForgeMirrorRanking::Load()
+{
+	if (m_index_file.isEmpty())
+		return;
+	QFile index(m_index_file);
+	if (!index.open(QIODevice::ReadOnly))
+		return;
+
+	QJsonDocument json = QJsonDocument::fromJson(index.readAll());
+	if (!json.isObject())
+		return;
+	auto root = json.object();
+	// check file version first
+	auto version_val = root.value("version");
+	if (!version_val.isString())
+		return;
+	if (version_val.toString() != "1")
+		return;
+
+	auto mirrors_val = root.value("mirrors");
+	if (!mirrors_val.isArray())
+		return;
+	for (auto element : mirrors_val.toArray())
+	{
+		if (!element.isObject())
+			return;
+		auto obj = element.toObject();
+		QString url = obj.value("url").toString();
+		if (url.isEmpty())
+			continue;
+		Stats stats;
+		stats.latencyMs = obj.value("latency").toDouble(-1);
+		stats.bytesPerSec = obj.value("throughput").toDouble();
+		stats.failures = obj.value("failures").toInt();
+		stats.lastChecked = obj.value("checked").toDouble();
+		m_stats[url] = stats;
+	}
+}
+
+void ForgeMirrorRanking::SaveEventually()
+{
+	if (m_index_file.isEmpty())
+		return;
+	// reset the save timer
+	saveBatchingTimer.stop();
+	saveBatchingTimer.start(30000);
+}
+
+void ForgeMirrorRanking::SaveNow()
+{
+	if (m_index_file.isEmpty())
+		return;
+	QSaveFile tfile(m_index_file);
+	if (!tfile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return;
+	QJsonObject toplevel;
+	toplevel.insert("version", QJsonValue(QString("1")));
+	QJsonArray mirrorsArr;
+	for (auto iter = m_stats.begin(); iter != m_stats.end(); iter++)
+	{
+		QJsonObject mirrorObj;
+		mirrorObj.insert("url", QJsonValue(iter.key()));
+		mirrorObj.insert("latency", QJsonValue(iter->latencyMs));
+		mirrorObj.insert("throughput", QJsonValue(iter->bytesPerSec));
+		mirrorObj.insert("failures", QJsonValue(iter->failures));
+		mirrorObj.insert("checked", QJsonValue(double(iter->lastChecked)));
+		mirrorsArr.append(mirrorObj);
+	}
+	toplevel.insert("mirrors", mirrorsArr);
+	QJsonDocument doc(toplevel);
+	QByteArray jsonData = doc.toJson();
+	qint64 result = tfile.write(jsonData);
+	if (result == -1)
+		return;
+	if (result != jsonData.size())
+		return;
+	tfile.commit();
+}
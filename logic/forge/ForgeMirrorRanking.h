@@ -0,0 +1,94 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QMap>
+#include <QList>
+#include <QTimer>
+#include <memory>
+
+#include "ForgeMirror.h"
+
+/**
+ * Remembers how well each Forge mirror performed, so the good ones can be tried first.
+ *
+ * Mirrors are measured by small probe downloads and by the real downloads. Latency and
+ * throughput are smoothed over time, failures push a mirror down until it works again.
+ * The stats are kept in a JSON file between runs.
+ */
+class ForgeMirrorRanking : public QObject
+{
+	Q_OBJECT
+public:
+	struct Stats
+	{
+		/// time to the first byte, in ms. -1 if never measured
+		double latencyMs = -1;
+		/// bytes per second after the first byte
+		double bytesPerSec = 0;
+		/// failures since the last success
+		int failures = 0;
+		/// when the mirror was last measured, ms since epoch
+		qint64 lastChecked = 0;
+	};
+
+	/// the size used to weigh latency against throughput
+	static const qint64 TYPICAL_DOWNLOAD = 1024 * 1024;
+	/// measurements older than this are probed again
+	static const qint64 MAX_AGE_MS = 24 * 60 * 60 * 1000LL;
+
+	/// path to the file the stats are kept in. Empty keeps them in memory only
+	explicit ForgeMirrorRanking(QString path = QString());
+	virtual ~ForgeMirrorRanking();
+
+	/// a download from the mirror went through
+	void reportSuccess(const QString &mirrorUrl, qint64 latencyMs, qint64 bytes, qint64 elapsedMs,
+					   qint64 now);
+	/// a download from the mirror failed
+	void reportFailure(const QString &mirrorUrl, qint64 now);
+
+	/// true if there is nothing recent known about the mirror
+	bool needsProbe(const QString &mirrorUrl, qint64 now) const;
+
+	/// the stats for a mirror, default ones if it is unknown
+	Stats stats(const QString &mirrorUrl) const;
+
+	/// expected time to fetch a typical download from the mirror, in ms. -1 when unknown
+	double expectedTimeMs(const QString &mirrorUrl) const;
+
+	/**
+	 * Sort mirrors best first: measured working mirrors by expected time, then the unknown ones,
+	 * then the ones that failed last, fewest failures first. Ties keep the given order.
+	 */
+	QList<ForgeMirror> rank(const QList<ForgeMirror> &mirrors) const;
+
+	void Load();
+	// (re)start a timer that calls SaveNow later.
+	void SaveEventually();
+
+public
+slots:
+	void SaveNow();
+
+private:
+	QMap<QString, Stats> m_stats;
+	QString m_index_file;
+	QTimer saveBatchingTimer;
+};
+
+typedef std::shared_ptr<ForgeMirrorRanking> ForgeMirrorRankingPtr;
@@ -1,6 +1,7 @@
 #include "Env.h"
 #include "ForgeMirrors.h"
 #include <QDebug>
+#include <QDateTime>
 #include <algorithm>
 #include <random>
 
@@ -67,8 +68,7 @@ void ForgeMirrors::deferToFixedList()
 					  "http://files.minecraftforge.net/forge_logo.png",
 					  "https://www.creeperhost.net/link.php?id=1",
 					  "http://new.creeperrepo.net/forge/maven/"});
-	injectDownloads();
-	emit succeeded(m_index_within_job);
+	rankMirrors();
 }
 
 void ForgeMirrors::parseMirrorList()
@@ -86,24 +86,69 @@ void ForgeMirrors::parseMirrorList()
 		}
 	}
 	if(!m_mirrors.size())
+	{
 		deferToFixedList();
-	injectDownloads();
-	emit succeeded(m_index_within_job);
+		return;
+	}
+	rankMirrors();
 }
 
-void ForgeMirrors::injectDownloads()
+void ForgeMirrors::rankMirrors()
 {
-	// shuffle the mirrors randomly
+	// shuffle the mirrors randomly, so mirrors nobody measured yet share the load
 	std::random_device rd;
 	std::mt19937 rng(rd());
 	std::shuffle(m_mirrors.begin(), m_mirrors.end(), rng);
 
+	auto ranking = ENV.forgeMirrorRanking();
+	if (!ranking || m_libs.isEmpty())
+	{
+		injectDownloads();
+		return;
+	}
+
+	// measure the mirrors we know nothing recent about, on one of the files we need anyway
+	qint64 now = QDateTime::currentMSecsSinceEpoch();
+	QList<ForgeMirror> unknown;
+	for (auto &mirror : m_mirrors)
+	{
+		if (ranking->needsProbe(mirror.mirror_url, now))
+			unknown.append(mirror);
+	}
+	if (unknown.isEmpty())
+	{
+		injectDownloads();
+		return;
+	}
+	m_probe = std::make_shared<ForgeMirrorProbe>(unknown, m_libs[0]->m_url_path + ".pack.xz",
+												 ranking);
+	connect(m_probe.get(), &ForgeMirrorProbe::finished, this, [this]()
+	{
+		injectDownloads();
+	});
+	m_probe->start();
+}
+
+void ForgeMirrors::injectDownloads()
+{
+	auto ranking = ENV.forgeMirrorRanking();
+	if (ranking)
+	{
+		m_mirrors = ranking->rank(m_mirrors);
+		for (auto &mirror : m_mirrors)
+		{
+			qDebug() << "Mirror" << mirror.name << mirror.mirror_url << "expected time"
+					 << ranking->expectedTimeMs(mirror.mirror_url) << "ms";
+		}
+	}
+
 	// tell parent to download the libs
 	for(auto lib: m_libs)
 	{
 		lib->setMirrors(m_mirrors);
 		m_parent_job->addNetAction(lib);
 	}
+	emit succeeded(m_index_within_job);
 }
 
 void ForgeMirrors::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
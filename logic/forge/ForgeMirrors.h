@@ -19,6 +19,7 @@
 #include "net/HttpMetaCache.h"
 #include "net/NetJob.h"
 #include "forge/ForgeXzDownload.h"
+#include "forge/ForgeMirrorProbe.h"
 #include <QFile>
 #include <QTemporaryFile>
 typedef std::shared_ptr<class ForgeMirrors> ForgeMirrorsPtr;
@@ -30,6 +31,8 @@ public:
 	QList<ForgeXzDownloadPtr> m_libs;
 	NetJobPtr m_parent_job;
 	QList<ForgeMirror> m_mirrors;
+	/// measures the mirrors nothing recent is known about
+	std::shared_ptr<ForgeMirrorProbe> m_probe;
 
 public:
 	explicit ForgeMirrors(QList<ForgeXzDownloadPtr> &libs, NetJobPtr parent_job,
@@ -50,6 +53,7 @@ slots:
 private:
 	void parseMirrorList();
 	void deferToFixedList();
+	void rankMirrors();
 	void injectDownloads();
 
 public
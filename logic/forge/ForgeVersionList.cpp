@@ -18,6 +18,7 @@
 #include "net/NetJob.h"
 #include "net/URLConstants.h"
 #include "Env.h"
+#include "VersionIndex.h"
 
 #include <QtNetwork>
 #include <QtXml>
@@ -25,8 +26,106 @@
 
 #include <QDebug>
 
+namespace
+{
+const char *localVersionIndex = "versions/forge.idx";
+const QByteArray indexKind = "forge";
+// bump when the fields change
+const quint32 indexLayout = 1;
+enum IndexField
+{
+	IndexType,
+	IndexBuild,
+	IndexRecommended,
+	IndexBranch,
+	IndexUniversalUrl,
+	IndexChangelogUrl,
+	IndexInstallerUrl,
+	IndexJobBuildVer,
+	IndexMcVer,
+	IndexMcVerSane,
+	IndexUniversalFilename,
+	IndexInstallerFilename,
+	IndexFieldCount
+};
+}
+
 ForgeVersionList::ForgeVersionList(QObject *parent) : BaseVersionList(parent)
 {
+	loadCachedList();
+}
+
+void ForgeVersionList::loadCachedList()
+{
+	if (!QFile::exists(localVersionIndex))
+	{
+		return;
+	}
+	QString error;
+	auto index = VersionIndex::open(localVersionIndex, indexKind, indexLayout, &error);
+	if (!index || index->tableCount() != 1 || index->fieldCount(0) != IndexFieldCount)
+	{
+		qCritical() << "The forge version cache is unusable:" << error << "Flushing cache.";
+		QFile::remove(localVersionIndex);
+		return;
+	}
+	QList<BaseVersionPtr> versions;
+	for (int i = 0; i < index->recordCount(0); i++)
+	{
+		auto type = index->value(0, i, IndexType);
+		if (type != ForgeVersion::Legacy && type != ForgeVersion::Gradle)
+		{
+			continue;
+		}
+		std::shared_ptr<ForgeVersion> fVersion(new ForgeVersion());
+		fVersion->type = type == ForgeVersion::Legacy ? ForgeVersion::Legacy : ForgeVersion::Gradle;
+		fVersion->m_buildnr = index->value(0, i, IndexBuild);
+		fVersion->is_recommended = index->value(0, i, IndexRecommended) != 0;
+		fVersion->branch = index->string(0, i, IndexBranch);
+		fVersion->universal_url = index->string(0, i, IndexUniversalUrl);
+		fVersion->changelog_url = index->string(0, i, IndexChangelogUrl);
+		fVersion->installer_url = index->string(0, i, IndexInstallerUrl);
+		fVersion->jobbuildver = index->string(0, i, IndexJobBuildVer);
+		fVersion->mcver = index->string(0, i, IndexMcVer);
+		fVersion->mcver_sane = index->string(0, i, IndexMcVerSane);
+		fVersion->universal_filename = index->string(0, i, IndexUniversalFilename);
+		fVersion->installer_filename = index->string(0, i, IndexInstallerFilename);
+		versions.append(fVersion);
+	}
+	// already sorted when it was saved. Still not loaded - the load task refreshes it.
+	beginResetModel();
+	m_vlist = versions;
+	endResetModel();
+	m_source = index->property("source");
+}
+
+void ForgeVersionList::saveCachedList()
+{
+	VersionIndexWriter writer(indexKind, indexLayout);
+	int table = writer.addTable(IndexFieldCount);
+	for (auto version : m_vlist)
+	{
+		auto fVersion = std::dynamic_pointer_cast<ForgeVersion>(version);
+		QVector<quint64> fields(IndexFieldCount);
+		fields[IndexType] = fVersion->type;
+		fields[IndexBuild] = fVersion->m_buildnr;
+		fields[IndexRecommended] = fVersion->is_recommended;
+		fields[IndexBranch] = writer.string(fVersion->branch);
+		fields[IndexUniversalUrl] = writer.string(fVersion->universal_url);
+		fields[IndexChangelogUrl] = writer.string(fVersion->changelog_url);
+		fields[IndexInstallerUrl] = writer.string(fVersion->installer_url);
+		fields[IndexJobBuildVer] = writer.string(fVersion->jobbuildver);
+		fields[IndexMcVer] = writer.string(fVersion->mcver);
+		fields[IndexMcVerSane] = writer.string(fVersion->mcver_sane);
+		fields[IndexUniversalFilename] = writer.string(fVersion->universal_filename);
+		fields[IndexInstallerFilename] = writer.string(fVersion->installer_filename);
+		writer.addRecord(table, fields);
+	}
+	writer.setProperty("source", m_source);
+	if (!writer.save(localVersionIndex))
+	{
+		qCritical() << "Couldn't save the forge version cache.";
+	}
 }
 
 Task *ForgeVersionList::getLoadTask()
@@ -139,10 +238,9 @@ BaseVersionPtr ForgeVersionList::getLatestStable() const
 
 void ForgeVersionList::updateListData(QList<BaseVersionPtr> versions)
 {
-	beginResetModel();
-	m_vlist = versions;
+	publishUpdate(m_vlist, versions);
 	m_loaded = true;
-	endResetModel();
+	saveCachedList();
 	// NOW SORT!!
 	// sort();
 }
@@ -162,23 +260,24 @@ void ForgeListLoadTask::executeTask()
 	setStatus(tr("Fetching Forge version lists..."));
 	auto job = new NetJob("Version index");
 	// we do not care if the version is stale or not.
-	auto forgeListEntry = ENV.metacache()->resolveEntry("minecraftforge", "list.json");
-	auto gradleForgeListEntry = ENV.metacache()->resolveEntry("minecraftforge", "json");
+	listEntry = ENV.metacache()->resolveEntry("minecraftforge", "list.json");
+	gradleListEntry = ENV.metacache()->resolveEntry("minecraftforge", "json");
 
 	// verify by poking the server.
-	forgeListEntry->stale = true;
-	gradleForgeListEntry->stale = true;
+	listEntry->stale = true;
+	gradleListEntry->stale = true;
 
 	job->addNetAction(listDownload = CacheDownload::make(QUrl(URLConstants::FORGE_LEGACY_URL),
-														 forgeListEntry));
+														 listEntry));
 	job->addNetAction(gradleListDownload = CacheDownload::make(
-						  QUrl(URLConstants::FORGE_GRADLE_URL), gradleForgeListEntry));
+						  QUrl(URLConstants::FORGE_GRADLE_URL), gradleListEntry));
 
 	connect(listDownload.get(), SIGNAL(failed(int)), SLOT(listFailed()));
 	connect(gradleListDownload.get(), SIGNAL(failed(int)), SLOT(gradleListFailed()));
 
 	listJob.reset(job);
 	connect(listJob.get(), SIGNAL(succeeded()), SLOT(listDownloaded()));
+	connect(listJob.get(), SIGNAL(failed()), SLOT(listJobFailed()));
 	connect(listJob.get(), SIGNAL(progress(qint64, qint64)), SIGNAL(progress(qint64, qint64)));
 	listJob->start();
 }
@@ -192,6 +291,7 @@ bool ForgeListLoadTask::parseForgeList(QList<BaseVersionPtr> &out)
 		QFile listFile(filename);
 		if (!listFile.open(QIODevice::ReadOnly))
 		{
+			emitFailed(tr("Failed to open the Forge version list."));
 			return false;
 		}
 		data = listFile.readAll();
@@ -303,6 +403,7 @@ bool ForgeListLoadTask::parseForgeGradleList(QList<BaseVersionPtr> &out)
 		QFile listFile(filename);
 		if (!listFile.open(QIODevice::ReadOnly))
 		{
+			emitFailed(tr("Failed to open the Forge version list."));
 			return false;
 		}
 		data = listFile.readAll();
@@ -408,30 +509,36 @@ bool ForgeListLoadTask::parseForgeGradleList(QList<BaseVersionPtr> &out)
 
 void ForgeListLoadTask::listDownloaded()
 {
-	QList<BaseVersionPtr> list;
-	bool ret = true;
-	if (!parseForgeList(list))
-	{
-		ret = false;
-	}
-	if (!parseForgeGradleList(list))
+	// the server had nothing new and the cached list was made from the same files
+	QString source = listEntry->md5sum + gradleListEntry->md5sum;
+	if (m_list->count() && !listEntry->md5sum.isEmpty() && source == m_list->m_source)
 	{
-		ret = false;
+		qDebug() << "Forge version lists didn't change.";
+		m_list->m_loaded = true;
+		emitSucceeded();
+		return;
 	}
 
-	if (!ret)
+	QList<BaseVersionPtr> list;
+	if (!parseForgeList(list) || !parseForgeGradleList(list))
 	{
 		return;
 	}
 	std::sort(list.begin(), list.end(), [](const BaseVersionPtr & l, const BaseVersionPtr & r)
 	{ return (*l > *r); });
 
+	m_list->m_source = source;
 	m_list->updateListData(list);
 
 	emitSucceeded();
 	return;
 }
 
+void ForgeListLoadTask::listJobFailed()
+{
+	emitFailed(tr("Failed to download the Forge version lists."));
+}
+
 void ForgeListLoadTask::listFailed()
 {
 	auto reply = listDownload->m_reply;
@@ -48,9 +48,14 @@ public:
 	virtual int columnCount(const QModelIndex &parent) const;
 
 protected:
+	void loadCachedList();
+	void saveCachedList();
+
 	QList<BaseVersionPtr> m_vlist;
 
 	bool m_loaded = false;
+	/// md5 sums of the downloaded files the list was made from
+	QString m_source;
 
 protected
 slots:
@@ -71,6 +76,7 @@ slots:
 	void listDownloaded();
 	void listFailed();
 	void gradleListFailed();
+	void listJobFailed();
 
 protected:
 	NetJobPtr listJob;
@@ -78,6 +84,8 @@ protected:
 
 	CacheDownloadPtr listDownload;
 	CacheDownloadPtr gradleListDownload;
+	MetaEntryPtr listEntry;
+	MetaEntryPtr gradleListEntry;
 
 private:
 	bool parseForgeList(QList<BaseVersionPtr> &out);
@@ -15,21 +15,35 @@
 
 #include "Env.h"
 #include "ForgeXzDownload.h"
+#include "ForgeMirrorRanking.h"
 #include <pathutils.h>
 
-#include <QCryptographicHash>
 #include <QFileInfo>
 #include <QDateTime>
 #include <QDir>
 #include <QDebug>
+#include <QtConcurrentRun>
+#include <QThreadPool>
+
+/// The pipelines wait for the network most of the time. They get their own threads, so they
+/// don't block the global pool for everything else.
+Q_GLOBAL_STATIC(QThreadPool, pipelinePool)
 
 ForgeXzDownload::ForgeXzDownload(QString relative_path, MetaEntryPtr entry) : NetAction()
 {
 	m_entry = entry;
 	m_target_path = entry->getFullPath();
-	m_pack200_xz_file.setFileTemplate("./dl_temp.XXXXXX");
 	m_status = Job_NotStarted;
 	m_url_path = relative_path;
+	connect(&m_pipelineWatcher, SIGNAL(finished()), SLOT(pipelineFinished()));
+}
+
+ForgeXzDownload::~ForgeXzDownload()
+{
+	// the worker holds its own reference to the pipeline, just let it stop
+	if (m_pipeline)
+		m_pipeline->cancel();
+	stopRace();
 }
 
 void ForgeXzDownload::setMirrors(QList<ForgeMirror> &mirrors)
@@ -39,6 +53,29 @@ void ForgeXzDownload::setMirrors(QList<ForgeMirror> &mirrors)
 	updateUrl();
 }
 
+void ForgeXzDownload::startPipeline()
+{
+	// start unpacking on a worker thread, it waits for the data to come in
+	if (m_pipeline)
+		m_pipeline->cancel();
+	m_pipeline = std::make_shared<ForgeXzPipeline>(m_target_path);
+	auto pipeline = m_pipeline;
+	m_pipelineWatcher.setFuture(QtConcurrent::run(pipelinePool(), [pipeline]()
+	{
+		return pipeline->run();
+	}));
+}
+
+void ForgeXzDownload::connectReply(QNetworkReply *rep)
+{
+	connect(rep, SIGNAL(downloadProgress(qint64, qint64)),
+			SLOT(downloadProgress(qint64, qint64)));
+	connect(rep, SIGNAL(finished()), SLOT(downloadFinished()));
+	connect(rep, SIGNAL(error(QNetworkReply::NetworkError)),
+			SLOT(downloadError(QNetworkReply::NetworkError)));
+	connect(rep, SIGNAL(readyRead()), SLOT(downloadReadyRead()));
+}
+
 void ForgeXzDownload::start()
 {
 	m_status = Job_InProgress;
@@ -48,6 +85,17 @@ void ForgeXzDownload::start()
 		emit succeeded(m_index_within_job);
 		return;
 	}
+	if (offline())
+	{
+		// whatever is in the cache has to do
+		bool cached = QFileInfo(m_target_path).isFile();
+		m_status = cached ? Job_Finished : Job_Failed;
+		if (cached)
+			emit succeeded(m_index_within_job);
+		else
+			emit failed(m_index_within_job);
+		return;
+	}
 	// can we actually create the real, final file?
 	if (!ensureFilePathExists(m_target_path))
 	{
@@ -62,6 +110,8 @@ void ForgeXzDownload::start()
 		return;
 	}
 
+	startPipeline();
+
 	qDebug() << "Downloading " << m_url.toString();
 	QNetworkRequest request(m_url);
 	request.setRawHeader(QString("If-None-Match").toLatin1(), m_entry->etag.toLatin1());
@@ -70,13 +120,118 @@ void ForgeXzDownload::start()
 	auto worker = ENV.qnam();
 	QNetworkReply *rep = worker->get(request);
 
+	m_timer.start();
+	m_latency = -1;
+	m_received = 0;
 	m_reply.reset(rep);
-	connect(rep, SIGNAL(downloadProgress(qint64, qint64)),
-			SLOT(downloadProgress(qint64, qint64)));
-	connect(rep, SIGNAL(finished()), SLOT(downloadFinished()));
-	connect(rep, SIGNAL(error(QNetworkReply::NetworkError)),
-			SLOT(downloadError(QNetworkReply::NetworkError)));
-	connect(rep, SIGNAL(readyRead()), SLOT(downloadReadyRead()));
+	connectReply(rep);
+}
+
+void ForgeXzDownload::startRace()
+{
+	m_race_index = (m_mirror_index + 1) % m_mirrors.size();
+	QUrl url(m_mirrors[m_race_index].mirror_url + m_url_path + ".pack.xz");
+	qDebug() << "Racing" << m_url.toString() << "against" << url.toString();
+	QNetworkRequest request(url);
+	request.setHeader(QNetworkRequest::UserAgentHeader, "MultiMC/5.0 (Cached)");
+	QNetworkReply *rep = ENV.qnam()->get(request);
+	m_race_reply.reset(rep);
+	m_race_buffer.clear();
+	m_race_latency = -1;
+	m_race_start = m_received;
+	m_race_timer.start();
+	connect(rep, &QNetworkReply::readyRead, this, [this]() { raceReadyRead(); });
+	connect(rep, &QNetworkReply::finished, this, [this]() { raceFinished(); });
+}
+
+void ForgeXzDownload::raceReadyRead()
+{
+	if (m_race_latency < 0)
+		m_race_latency = m_race_timer.elapsed();
+	m_race_buffer.append(m_race_reply->readAll());
+	if (m_race_buffer.size() >= RACE_DECISION_BYTES)
+	{
+		switchToRace();
+	}
+}
+
+void ForgeXzDownload::raceFinished()
+{
+	int status = m_race_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+	if (m_race_reply->error() != QNetworkReply::NoError || status >= 400)
+	{
+		qWarning() << "Race against" << m_mirrors[m_race_index].mirror_url << "failed";
+		reportFailure(m_race_index);
+		stopRace();
+		return;
+	}
+	// all of it came in before the first mirror had sent much
+	m_race_buffer.append(m_race_reply->readAll());
+	switchToRace();
+}
+
+void ForgeXzDownload::switchToRace(bool firstFailed)
+{
+	qDebug() << "Mirror" << m_mirrors[m_race_index].mirror_url << "won the race over"
+			 << m_mirrors[m_mirror_index].mirror_url;
+	// the loser still gets its speed recorded, that's how it loses its place
+	if (!firstFailed && m_latency >= 0)
+		reportSuccess(m_mirror_index, m_latency, m_received - m_race_start,
+					  m_race_timer.elapsed());
+
+	disconnect(m_reply.get(), 0, this, 0);
+	m_reply->abort();
+
+	QNetworkReply *rep = m_race_reply.get();
+	m_reply = m_race_reply;
+	m_race_reply.reset();
+	disconnect(rep, 0, this, 0);
+	m_mirror_index = m_race_index;
+	m_race_index = -1;
+	updateUrl();
+
+	// start over with the data from the winner
+	m_timer = m_race_timer;
+	m_latency = m_race_latency;
+	m_received = m_race_buffer.size();
+	startPipeline();
+	m_pipeline->feed(m_race_buffer);
+	m_race_buffer.clear();
+
+	connectReply(rep);
+	if (rep->isFinished())
+	{
+		downloadFinished();
+	}
+}
+
+void ForgeXzDownload::stopRace()
+{
+	if (!m_race_reply)
+		return;
+	disconnect(m_race_reply.get(), 0, this, 0);
+	m_race_reply->abort();
+	m_race_reply.reset();
+	m_race_buffer.clear();
+	m_race_index = -1;
+}
+
+void ForgeXzDownload::reportSuccess(int mirror, qint64 latency, qint64 bytes, qint64 elapsed)
+{
+	auto ranking = ENV.forgeMirrorRanking();
+	if (!ranking || mirror < 0 || mirror >= m_mirrors.size())
+		return;
+	ranking->reportSuccess(m_mirrors[mirror].mirror_url, latency, bytes,
+						   qMax<qint64>(elapsed - latency, 1),
+						   QDateTime::currentMSecsSinceEpoch());
+}
+
+void ForgeXzDownload::reportFailure(int mirror)
+{
+	auto ranking = ENV.forgeMirrorRanking();
+	if (!ranking || mirror < 0 || mirror >= m_mirrors.size())
+		return;
+	ranking->reportFailure(m_mirrors[mirror].mirror_url, QDateTime::currentMSecsSinceEpoch());
 }
 
 void ForgeXzDownload::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
@@ -95,6 +250,8 @@ void ForgeXzDownload::downloadError(QNetworkReply::NetworkError error)
 
 void ForgeXzDownload::failAndTryNextMirror()
 {
+	stopRace();
+	reportFailure(m_mirror_index);
 	m_status = Job_Failed;
 	int next = m_mirror_index + 1;
 	if(m_mirrors.size() == next)
@@ -119,48 +276,26 @@ void ForgeXzDownload::updateUrl()
 
 void ForgeXzDownload::downloadFinished()
 {
-	//TEST: defer to other possible mirrors (autofail the first one)
-	/*
-	qDebug() <<"dl " << index_within_job << " mirror " << m_mirror_index;
-	if( m_mirror_index == 0)
-	{
-		qDebug() <<"dl " << index_within_job << " AUTOFAIL";
-		m_status = Job_Failed;
-		m_pack200_xz_file.close();
-		m_pack200_xz_file.remove();
-		m_reply.reset();
-		failAndTryNextMirror();
-		return;
-	}
-	*/
-
 	// if the download succeeded
 	if (m_status != Job_Failed)
 	{
-		// nothing went wrong...
-		m_status = Job_Finished;
-		if (m_pack200_xz_file.isOpen())
-		{
-			// we actually downloaded something! process and isntall it
-			decompressAndInstall();
-			return;
-		}
-		else
-		{
-			// something bad happened -- on the local machine!
-			m_status = Job_Failed;
-			m_pack200_xz_file.remove();
-			m_reply.reset();
-			emit failed(m_index_within_job);
-			return;
-		}
+		// the rest happens on the worker, see pipelineFinished()
+		m_pipeline->finish();
+		return;
 	}
 	// else the download failed
 	else
 	{
-		m_status = Job_Failed;
-		m_pack200_xz_file.close();
-		m_pack200_xz_file.remove();
+		if (m_race_reply)
+		{
+			// the other mirror is still going, continue with that one
+			reportFailure(m_mirror_index);
+			m_status = Job_InProgress;
+			switchToRace(true);
+			return;
+		}
+		m_pipeline->cancel();
+		m_pipeline.reset();
 		m_reply.reset();
 		failAndTryNextMirror();
 		return;
@@ -169,215 +304,58 @@ void ForgeXzDownload::downloadFinished()
 
 void ForgeXzDownload::downloadReadyRead()
 {
-
-	if (!m_pack200_xz_file.isOpen())
+	auto data = m_reply->readAll();
+	if (m_latency < 0)
 	{
-		if (!m_pack200_xz_file.open())
+		m_latency = m_timer.elapsed();
+		// big download and a choice of mirrors, see if the next one is faster
+		qint64 size = m_reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+		if (size >= RACE_MIN_SIZE && m_mirrors.size() > 1 && !m_race_reply)
 		{
-			/*
-			* Can't open the file... the job failed
-			*/
-			m_reply->abort();
-			emit failed(m_index_within_job);
-			return;
+			startRace();
 		}
 	}
-	m_pack200_xz_file.write(m_reply->readAll());
-}
-
-#include "xz.h"
-#include "unpack200.h"
-#include <stdexcept>
-
-const size_t buffer_size = 8196;
-
-void ForgeXzDownload::decompressAndInstall()
-{
-	// rewind the downloaded temp file
-	m_pack200_xz_file.seek(0);
-	// de-xz'd file
-	QTemporaryFile pack200_file("./dl_temp.XXXXXX");
-	pack200_file.open();
-
-	bool xz_success = false;
-	// first, de-xz
+	m_received += data.size();
+	m_pipeline->feed(data);
+	if (m_race_reply && m_received - m_race_start >= RACE_DECISION_BYTES)
 	{
-		uint8_t in[buffer_size];
-		uint8_t out[buffer_size];
-		struct xz_buf b;
-		struct xz_dec *s;
-		enum xz_ret ret;
-		xz_crc32_init();
-		xz_crc64_init();
-		s = xz_dec_init(XZ_DYNALLOC, 1 << 26);
-		if (s == nullptr)
-		{
-			xz_dec_end(s);
-			failAndTryNextMirror();
-			return;
-		}
-		b.in = in;
-		b.in_pos = 0;
-		b.in_size = 0;
-		b.out = out;
-		b.out_pos = 0;
-		b.out_size = buffer_size;
-		while (!xz_success)
-		{
-			if (b.in_pos == b.in_size)
-			{
-				b.in_size = m_pack200_xz_file.read((char *)in, sizeof(in));
-				b.in_pos = 0;
-			}
-
-			ret = xz_dec_run(s, &b);
-
-			if (b.out_pos == sizeof(out))
-			{
-				if (pack200_file.write((char *)out, b.out_pos) != b.out_pos)
-				{
-					// msg = "Write error\n";
-					xz_dec_end(s);
-					failAndTryNextMirror();
-					return;
-				}
-
-				b.out_pos = 0;
-			}
-
-			if (ret == XZ_OK)
-				continue;
-
-			if (ret == XZ_UNSUPPORTED_CHECK)
-			{
-				// unsupported check. this is OK, but we should log this
-				continue;
-			}
-
-			if (pack200_file.write((char *)out, b.out_pos) != b.out_pos)
-			{
-				// write error
-				pack200_file.close();
-				xz_dec_end(s);
-				return;
-			}
-
-			switch (ret)
-			{
-			case XZ_STREAM_END:
-				xz_dec_end(s);
-				xz_success = true;
-				break;
-
-			case XZ_MEM_ERROR:
-				qCritical() << "Memory allocation failed\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_MEMLIMIT_ERROR:
-				qCritical() << "Memory usage limit reached\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_FORMAT_ERROR:
-				qCritical() << "Not a .xz file\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_OPTIONS_ERROR:
-				qCritical() << "Unsupported options in the .xz headers\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			case XZ_DATA_ERROR:
-			case XZ_BUF_ERROR:
-				qCritical() << "File is corrupt\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-
-			default:
-				qCritical() << "Bug!\n";
-				xz_dec_end(s);
-				failAndTryNextMirror();
-				return;
-			}
-		}
+		qDebug() << "Mirror" << m_mirrors[m_mirror_index].mirror_url << "won the race";
+		if (m_race_latency >= 0)
+			reportSuccess(m_race_index, m_race_latency, m_race_buffer.size(),
+						  m_race_timer.elapsed());
+		stopRace();
 	}
-	m_pack200_xz_file.remove();
+}
 
-	// revert pack200
-	pack200_file.seek(0);
-	int handle_in = pack200_file.handle();
-	// FIXME: dispose of file handles, pointers and the like. Ideally wrap in objects.
-	if(handle_in == -1)
-	{
-		qCritical() << "Error reopening " << pack200_file.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	FILE * file_in = fdopen(handle_in,"r");
-	if(!file_in)
-	{
-		qCritical() << "Error reopening " << pack200_file.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	QFile qfile_out(m_target_path);
-	if(!qfile_out.open(QIODevice::WriteOnly))
-	{
-		qCritical() << "Error opening " << qfile_out.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	int handle_out = qfile_out.handle();
-	if(handle_out == -1)
-	{
-		qCritical() << "Error opening " << qfile_out.fileName();
-		failAndTryNextMirror();
-		return;
-	}
-	FILE * file_out = fdopen(handle_out,"w");
-	if(!file_out)
+void ForgeXzDownload::pipelineFinished()
+{
+	auto result = m_pipelineWatcher.result();
+	// the download failed and was already handled
+	if (m_status == Job_Failed || !m_pipeline)
 	{
-		qCritical() << "Error opening " << qfile_out.fileName();
-		failAndTryNextMirror();
 		return;
 	}
-	try
-	{
-		unpack_200(file_in, file_out);
-	}
-	catch (std::runtime_error &err)
+	m_pipeline.reset();
+	// the pipeline can finish before the reply does, we don't care about the reply anymore
+	disconnect(m_reply.get(), 0, this, 0);
+	if (!result.ok)
 	{
+		qCritical() << "Failed to unpack" << m_url.toString() << ":" << result.error;
 		m_status = Job_Failed;
-		qCritical() << "Error unpacking " << pack200_file.fileName() << " : " << err.what();
-		QFile f(m_target_path);
-		if (f.exists())
-			f.remove();
-		failAndTryNextMirror();
-		return;
-	}
-	pack200_file.remove();
-
-	QFile jar_file(m_target_path);
-
-	if (!jar_file.open(QIODevice::ReadOnly))
-	{
-		jar_file.remove();
+		m_reply->abort();
+		m_reply.reset();
 		failAndTryNextMirror();
 		return;
 	}
-	m_entry->md5sum = QCryptographicHash::hash(jar_file.readAll(), QCryptographicHash::Md5)
-						  .toHex()
-						  .constData();
-	jar_file.close();
+	stopRace();
+	reportSuccess(m_mirror_index, m_latency, m_received, m_timer.elapsed());
+	qDebug() << "Unpacked" << m_target_path << ":" << result.xzBytes << "bytes xz," << result.packBytes
+			 << "bytes pack200, xz" << result.xzMs << "ms (overlapping the download), unpack"
+			 << result.unpackMs << "ms";
 
+	m_status = Job_Finished;
 	QFileInfo output_file_info(m_target_path);
+	m_entry->md5sum = result.md5.constData();
 	m_entry->etag = m_reply->rawHeader("ETag").constData();
 	m_entry->local_changed_timestamp =
 		output_file_info.lastModified().toUTC().toMSecsSinceEpoch();
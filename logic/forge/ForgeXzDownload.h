@@ -18,8 +18,10 @@
 #include "net/NetAction.h"
 #include "net/HttpMetaCache.h"
 #include <QFile>
-#include <QTemporaryFile>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
 #include "ForgeMirror.h"
+#include "ForgeXzPipeline.h"
 
 typedef std::shared_ptr<class ForgeXzDownload> ForgeXzDownloadPtr;
 
@@ -30,8 +32,9 @@ public:
 	MetaEntryPtr m_entry;
 	/// if saving to file, use the one specified in this string
 	QString m_target_path;
-	/// this is the output file, if any
-	QTemporaryFile m_pack200_xz_file;
+	/// turns the downloaded bytes into the jar on a worker thread
+	ForgeXzPipelinePtr m_pipeline;
+	QFutureWatcher<ForgeXzPipeline::Result> m_pipelineWatcher;
 	/// mirror index (NOT OPTICS, I SWEAR)
 	int m_mirror_index = 0;
 	/// list of mirrors to use. Mirror has the url base
@@ -39,13 +42,32 @@ public:
 	/// path relative to the mirror base
 	QString m_url_path;
 
+	/// downloads at least this big are raced against the next mirror
+	static const qint64 RACE_MIN_SIZE = 2 * 1024 * 1024;
+	/// the first mirror to deliver this much since the race started wins it
+	static const qint64 RACE_DECISION_BYTES = 256 * 1024;
+
+	/// time since the request was sent and until the first byte came
+	QElapsedTimer m_timer;
+	qint64 m_latency = -1;
+	qint64 m_received = 0;
+	/// the second mirror, while racing
+	QObjectPtr<QNetworkReply> m_race_reply;
+	int m_race_index = -1;
+	/// what the second mirror sent so far, it's only used if it wins
+	QByteArray m_race_buffer;
+	qint64 m_race_latency = -1;
+	/// bytes from the first mirror when the race started
+	qint64 m_race_start = 0;
+	QElapsedTimer m_race_timer;
+
 public:
 	explicit ForgeXzDownload(QString relative_path, MetaEntryPtr entry);
 	static ForgeXzDownloadPtr make(QString relative_path, MetaEntryPtr entry)
 	{
 		return ForgeXzDownloadPtr(new ForgeXzDownload(relative_path, entry));
 	}
-	virtual ~ForgeXzDownload(){};
+	virtual ~ForgeXzDownload();
 	void setMirrors(QList<ForgeMirror> & mirrors);
 
 protected
@@ -54,13 +76,24 @@ slots:
 	virtual void downloadError(QNetworkReply::NetworkError error);
 	virtual void downloadFinished();
 	virtual void downloadReadyRead();
+	void pipelineFinished();
 
 public
 slots:
 	virtual void start();
 
 private:
-	void decompressAndInstall();
 	void failAndTryNextMirror();
 	void updateUrl();
+	void startPipeline();
+	void connectReply(QNetworkReply *reply);
+	void startRace();
+	void raceReadyRead();
+	void raceFinished();
+	/// the second mirror won, or the first one failed. Continue with the second one
+	void switchToRace(bool firstFailed = false);
+	/// drop the second mirror
+	void stopRace();
+	void reportSuccess(int mirror, qint64 latency, qint64 bytes, qint64 elapsed);
+	void reportFailure(int mirror);
 };
@@ -0,0 +1,277 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ForgeXzPipeline.h"
+
+#include <QFile>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QThread>
+#include <QThreadStorage>
+#include <stdexcept>
+#include <memory>
+#include <mutex>
+
+#include "xz.h"
+#include "unpack200.h"
+
+ForgeXzPipeline::ForgeXzPipeline(QString targetPath) : m_targetPath(targetPath)
+{
+}
+
+void ForgeXzPipeline::feed(const QByteArray &data)
+{
+	if (data.isEmpty())
+		return;
+	QMutexLocker locker(&m_mutex);
+	m_chunks.enqueue(data);
+	m_wake.wakeAll();
+}
+
+void ForgeXzPipeline::finish()
+{
+	QMutexLocker locker(&m_mutex);
+	m_finished = true;
+	m_wake.wakeAll();
+}
+
+void ForgeXzPipeline::cancel()
+{
+	QMutexLocker locker(&m_mutex);
+	m_cancelled = true;
+	m_wake.wakeAll();
+}
+
+bool ForgeXzPipeline::nextChunk(QByteArray &chunk)
+{
+	QMutexLocker locker(&m_mutex);
+	while (m_chunks.isEmpty() && !m_finished && !m_cancelled)
+	{
+		m_wake.wait(&m_mutex);
+	}
+	if (m_cancelled || m_chunks.isEmpty())
+		return false;
+	chunk = m_chunks.dequeue();
+	return true;
+}
+
+static const char *xzError(enum xz_ret ret)
+{
+	switch (ret)
+	{
+	case XZ_MEM_ERROR:
+		return "Memory allocation failed";
+	case XZ_MEMLIMIT_ERROR:
+		return "Memory usage limit reached";
+	case XZ_FORMAT_ERROR:
+		return "Not a .xz file";
+	case XZ_OPTIONS_ERROR:
+		return "Unsupported options in the .xz headers";
+	case XZ_DATA_ERROR:
+	case XZ_BUF_ERROR:
+		return "File is corrupt";
+	default:
+		return "Bug!";
+	}
+}
+
+ForgeXzPipeline::Result ForgeXzPipeline::run()
+{
+	// nothing may escape into the thread pool
+	try
+	{
+		return decompressAndUnpack();
+	}
+	catch (std::exception &err)
+	{
+		Result result;
+		result.error = QString::fromLocal8Bit(err.what());
+		return result;
+	}
+	catch (...)
+	{
+		Result result;
+		result.error = "Unknown error";
+		return result;
+	}
+}
+
+ForgeXzPipeline::Result ForgeXzPipeline::decompressAndUnpack()
+{
+	Result result;
+	QElapsedTimer timer;
+
+	// the CRC tables are global, fill them only once
+	static std::once_flag crcInit;
+	std::call_once(crcInit, []()
+	{
+		xz_crc32_init();
+		xz_crc64_init();
+	});
+	std::unique_ptr<struct xz_dec, void (*)(struct xz_dec *)> decoder(
+		xz_dec_init(XZ_DYNALLOC, 1 << 26), xz_dec_end);
+	struct xz_dec *s = decoder.get();
+	if (s == nullptr)
+	{
+		result.error = "Memory allocation failed";
+		return result;
+	}
+
+	const size_t buffer_size = 1 << 16;
+	uint8_t out[buffer_size];
+	QByteArray pack;
+	QByteArray chunk;
+	struct xz_buf b;
+	b.out = out;
+	b.out_pos = 0;
+	b.out_size = buffer_size;
+
+	bool xz_success = false;
+	while (!xz_success)
+	{
+		timer.start();
+		bool more = nextChunk(chunk);
+		result.waitMs += timer.elapsed();
+		if (!more)
+			break;
+		timer.start();
+		result.xzBytes += chunk.size();
+		b.in = (const uint8_t *)chunk.constData();
+		b.in_pos = 0;
+		b.in_size = chunk.size();
+		// decompress until this chunk is used up
+		for (;;)
+		{
+			enum xz_ret ret = xz_dec_run(s, &b);
+			bool full = b.out_pos == b.out_size;
+			if (full || ret == XZ_STREAM_END)
+			{
+				pack.append((const char *)out, b.out_pos);
+				b.out_pos = 0;
+			}
+			if (ret == XZ_STREAM_END)
+			{
+				xz_success = true;
+				break;
+			}
+			if (ret != XZ_OK && ret != XZ_UNSUPPORTED_CHECK)
+			{
+				result.error = xzError(ret);
+				return result;
+			}
+			// a full output buffer means the decoder may still hold more
+			if (b.in_pos == b.in_size && !full)
+				break;
+		}
+		result.xzMs += timer.elapsed();
+	}
+	decoder.reset();
+	{
+		QMutexLocker locker(&m_mutex);
+		if (m_cancelled)
+		{
+			result.error = "Cancelled";
+			return result;
+		}
+	}
+	if (!xz_success)
+	{
+		result.error = "The download ended before the end of the xz stream";
+		return result;
+	}
+	// don't need the compressed data anymore
+	{
+		QMutexLocker locker(&m_mutex);
+		m_chunks.clear();
+	}
+	chunk.clear();
+	result.packBytes = pack.size();
+
+	timer.start();
+	result.ok = unpack(pack, result);
+	result.unpackMs = timer.elapsed();
+	return result;
+}
+
+namespace
+{
+/// writes the jar to a file and hashes it on the way
+class HashingFileSink : public unpack_200_sink
+{
+public:
+	HashingFileSink(QFile &file) : m_file(file), m_md5(QCryptographicHash::Md5)
+	{
+	}
+	virtual void write(const void *data, size_t size) override
+	{
+		if (m_file.write((const char *)data, size) != (qint64)size)
+		{
+			throw std::runtime_error(m_file.errorString().toStdString());
+		}
+		m_md5.addData((const char *)data, size);
+	}
+	QByteArray md5() const
+	{
+		return m_md5.result().toHex();
+	}
+
+private:
+	QFile &m_file;
+	QCryptographicHash m_md5;
+};
+}
+
+bool ForgeXzPipeline::unpack(const QByteArray &pack, Result &result)
+{
+	// every worker thread keeps its own unpacker memory, so unpacking many libraries in a row
+	// doesn't go through the heap every time
+	static QThreadStorage<unpack_200_arena *> arenas;
+	if (!arenas.hasLocalData())
+	{
+		arenas.setLocalData(new unpack_200_arena());
+	}
+
+	QFile jar_file(m_targetPath);
+	if (!jar_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		result.error = QObject::tr("Error opening %1").arg(m_targetPath);
+		return false;
+	}
+	HashingFileSink sink(jar_file);
+	// the universal jar has thousands of classes, compress them on all cores
+	unpack_200_options options;
+	options.threads = QThread::idealThreadCount();
+	try
+	{
+		unpack_200(pack.constData(), pack.size(), sink, arenas.localData(), options);
+	}
+	catch (std::exception &err)
+	{
+		result.error = QObject::tr("Error unpacking %1: %2").arg(m_targetPath, err.what());
+		jar_file.close();
+		jar_file.remove();
+		return false;
+	}
+	catch (...)
+	{
+		result.error = QObject::tr("Error unpacking %1").arg(m_targetPath);
+		jar_file.close();
+		jar_file.remove();
+		return false;
+	}
+	result.md5 = sink.md5();
+	return true;
+}
@@ -0,0 +1,78 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <memory>
+
+typedef std::shared_ptr<class ForgeXzPipeline> ForgeXzPipelinePtr;
+
+/**
+ * Turns a .pack.xz stream into a jar while it is being downloaded.
+ *
+ * The network side feeds the received bytes in, run() decompresses them on a worker thread
+ * as they arrive (the xz container checks its own CRC as it goes) and keeps the pack200 data
+ * in memory. Once the stream is complete, the pack200 data is unpacked into the target jar,
+ * which is hashed while it is written. Nothing else touches the disk.
+ */
+class ForgeXzPipeline
+{
+public:
+	struct Result
+	{
+		bool ok = false;
+		QString error;
+		/// md5 of the resulting jar, hex encoded
+		QByteArray md5;
+		qint64 xzBytes = 0;
+		qint64 packBytes = 0;
+		/// time spent waiting for the network, decompressing and unpacking, in ms
+		qint64 waitMs = 0;
+		qint64 xzMs = 0;
+		qint64 unpackMs = 0;
+	};
+
+	explicit ForgeXzPipeline(QString targetPath);
+
+	/// add downloaded bytes. Any thread.
+	void feed(const QByteArray &data);
+	/// no more bytes will come. Any thread.
+	void finish();
+	/// stop as soon as possible, the result will be a failure. Any thread.
+	void cancel();
+
+	/// do the work. Blocks until the stream is complete or cancelled, call on a worker thread.
+	/// Never throws.
+	Result run();
+
+private:
+	/// wait for the next chunk. false when there is nothing more to read
+	bool nextChunk(QByteArray &chunk);
+	Result decompressAndUnpack();
+	bool unpack(const QByteArray &pack, Result &result);
+
+private:
+	QString m_targetPath;
+	QMutex m_mutex;
+	QWaitCondition m_wake;
+	QQueue<QByteArray> m_chunks;
+	bool m_finished = false;
+	bool m_cancelled = false;
+};
@@ -0,0 +1,175 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "JavaCheckCache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QDebug>
+
+JavaCheckCache::JavaCheckCache(QString path) : QObject()
+{
+	m_index_file = path;
+	saveBatchingTimer.setSingleShot(true);
+	saveBatchingTimer.setTimerType(Qt::VeryCoarseTimer);
+	connect(&saveBatchingTimer, SIGNAL(timeout()), SLOT(SaveNow()));
+}
+
+JavaCheckCache::~JavaCheckCache()
+{
+	saveBatchingTimer.stop();
+	SaveNow();
+}
+
+QString JavaCheckCache::resolveBinary(const QString &path)
+{
+	QString real = path;
+	// bare names like 'java' are looked up in PATH, same as QProcess would
+	if (!path.contains('/') && !path.contains('\\'))
+	{
+		real = QStandardPaths::findExecutable(path);
+		if (real.isEmpty())
+			return QString();
+	}
+	QFileInfo finfo(real);
+	auto canonical = finfo.canonicalFilePath();
+	if (canonical.isEmpty())
+		return QString();
+	return canonical;
+}
+
+bool JavaCheckCache::lookup(const QString &path, JavaCheckResult &result)
+{
+	auto binary = resolveBinary(path);
+	if (binary.isEmpty())
+		return false;
+	auto iter = m_entries.find(binary);
+	if (iter == m_entries.end())
+		return false;
+
+	QFileInfo finfo(binary);
+	qint64 mtime = finfo.lastModified().toUTC().toMSecsSinceEpoch();
+	if (finfo.size() != iter->size || mtime != iter->mtime)
+	{
+		qDebug() << "Java binary" << binary << "changed since it was last checked.";
+		m_entries.erase(iter);
+		SaveEventually();
+		return false;
+	}
+	result = iter->result;
+	// the cached result may have been produced for a different path pointing to the same binary
+	result.path = path;
+	return true;
+}
+
+void JavaCheckCache::store(const JavaCheckResult &result)
+{
+	auto binary = resolveBinary(result.path);
+	if (binary.isEmpty())
+		return;
+	QFileInfo finfo(binary);
+	Entry entry;
+	entry.size = finfo.size();
+	entry.mtime = finfo.lastModified().toUTC().toMSecsSinceEpoch();
+	entry.result = result;
+	m_entries[binary] = entry;
+	SaveEventually();
+}
+
+void JavaCheckCache::Load()
+{
+	QFile index(m_index_file);
+	if (!index.open(QIODevice::ReadOnly))
+		return;
+
+	QJsonDocument json = QJsonDocument::fromJson(index.readAll());
+	if (!json.isObject())
+		return;
+	auto root = json.object();
+	// check file version first
+	auto version_val = root.value("version");
+	if (!version_val.isString())
+		return;
+	if (version_val.toString() != "1")
+		return;
+
+	auto entries_val = root.value("entries");
+	if (!entries_val.isArray())
+		return;
+	for (auto element : entries_val.toArray())
+	{
+		if (!element.isObject())
+			return;
+		auto obj = element.toObject();
+		QString binary = obj.value("binary").toString();
+		if (binary.isEmpty())
+			continue;
+		Entry entry;
+		entry.size = obj.value("size").toDouble();
+		entry.mtime = obj.value("mtime").toDouble();
+		entry.result.path = binary;
+		entry.result.valid = obj.value("valid").toBool();
+		entry.result.is_64bit = obj.value("is_64bit").toBool();
+		entry.result.mojangPlatform = obj.value("mojangPlatform").toString();
+		entry.result.realPlatform = obj.value("realPlatform").toString();
+		entry.result.javaVersion = obj.value("javaVersion").toString();
+		m_entries[binary] = entry;
+	}
+}
+
+void JavaCheckCache::SaveEventually()
+{
+	// reset the save timer
+	saveBatchingTimer.stop();
+	saveBatchingTimer.start(30000);
+}
+
+void JavaCheckCache::SaveNow()
+{
+	QSaveFile tfile(m_index_file);
+	if (!tfile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return;
+	QJsonObject toplevel;
+	toplevel.insert("version", QJsonValue(QString("1")));
+	QJsonArray entriesArr;
+	for (auto iter = m_entries.begin(); iter != m_entries.end(); iter++)
+	{
+		QJsonObject entryObj;
+		entryObj.insert("binary", QJsonValue(iter.key()));
+		entryObj.insert("size", QJsonValue(double(iter->size)));
+		entryObj.insert("mtime", QJsonValue(double(iter->mtime)));
+		entryObj.insert("valid", QJsonValue(iter->result.valid));
+		entryObj.insert("is_64bit", QJsonValue(iter->result.is_64bit));
+		entryObj.insert("mojangPlatform", QJsonValue(iter->result.mojangPlatform));
+		entryObj.insert("realPlatform", QJsonValue(iter->result.realPlatform));
+		entryObj.insert("javaVersion", QJsonValue(iter->result.javaVersion));
+		entriesArr.append(entryObj);
+	}
+	toplevel.insert("entries", entriesArr);
+	QJsonDocument doc(toplevel);
+	QByteArray jsonData = doc.toJson();
+	qint64 result = tfile.write(jsonData);
+	if (result == -1)
+		return;
+	if (result != jsonData.size())
+		return;
+	tfile.commit();
+}
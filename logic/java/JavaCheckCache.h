@@ -0,0 +1,69 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QMap>
+#include <QTimer>
+#include <memory>
+
+#include "JavaChecker.h"
+
+/**
+ * Persistent cache of java checker results.
+ *
+ * Entries are keyed by the resolved binary path and invalidated when the size or
+ * modification time of the binary changes, so only new or updated JVMs are probed again.
+ */
+class JavaCheckCache : public QObject
+{
+	Q_OBJECT
+public:
+	// supply path to the cache index file
+	JavaCheckCache(QString path);
+	~JavaCheckCache();
+
+	/// look up a result for the java binary at `path`. Returns false if there is no valid entry.
+	bool lookup(const QString &path, JavaCheckResult &result);
+
+	/// remember the result of a finished check
+	void store(const JavaCheckResult &result);
+
+	// (re)start a timer that calls SaveNow later.
+	void SaveEventually();
+	void Load();
+
+public
+slots:
+	void SaveNow();
+
+private:
+	struct Entry
+	{
+		qint64 size = 0;
+		qint64 mtime = 0;
+		JavaCheckResult result;
+	};
+	/// resolve `java`-style names through PATH and canonicalize the rest
+	static QString resolveBinary(const QString &path);
+
+	QMap<QString, Entry> m_entries;
+	QString m_index_file;
+	QTimer saveBatchingTimer;
+};
+
+typedef std::shared_ptr<JavaCheckCache> JavaCheckCachePtr;
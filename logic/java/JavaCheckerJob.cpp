@@ -14,11 +14,33 @@
  */
 
 #include "JavaCheckerJob.h"
+#include "JavaCheckCache.h"
+#include "Env.h"
 #include "pathutils.h"
 
+#include <QThread>
 #include <QDebug>
 
+/// how many java processes may run at the same time
+static int maxConcurrentChecks()
+{
+	return qBound(1, QThread::idealThreadCount(), 4);
+}
+
 void JavaCheckerJob::partFinished(JavaCheckResult result)
+{
+	m_doing--;
+	auto cache = ENV.javaCheckCache();
+	// only remember working javas. Failures may be transient (timeouts, etc.)
+	if (cache && result.valid)
+	{
+		cache->store(result);
+	}
+	recordResult(result);
+	startMoreChecks();
+}
+
+void JavaCheckerJob::recordResult(const JavaCheckResult &result)
 {
 	num_finished++;
 	qDebug() << m_job_name.toLocal8Bit() << "progress:" << num_finished << "/"
@@ -26,21 +48,42 @@ void JavaCheckerJob::partFinished(JavaCheckResult result)
 	emit progress(num_finished, javacheckers.size());
 
 	javaresults.replace(result.id, result);
-
-	if (num_finished == javacheckers.size())
-	{
-		emit finished(javaresults);
-	}
 }
 
 void JavaCheckerJob::start()
 {
 	qDebug() << m_job_name.toLocal8Bit() << " started.";
 	m_running = true;
-	for (auto iter : javacheckers)
+	for (int i = 0; i < javacheckers.size(); i++)
 	{
 		javaresults.append(JavaCheckResult());
-		connect(iter.get(), SIGNAL(checkFinished(JavaCheckResult)), SLOT(partFinished(JavaCheckResult)));
-		iter->performCheck();
+		m_todo.enqueue(i);
+	}
+	// deliver the results asynchronously, even if they all come from the cache
+	QMetaObject::invokeMethod(this, "startMoreChecks", Qt::QueuedConnection);
+}
+
+void JavaCheckerJob::startMoreChecks()
+{
+	auto cache = ENV.javaCheckCache();
+	while (m_todo.size() && m_doing < maxConcurrentChecks())
+	{
+		auto checker = javacheckers[m_todo.dequeue()];
+		JavaCheckResult cached;
+		if (cache && cache->lookup(checker->path, cached))
+		{
+			qDebug() << "Using cached java check result for" << checker->path;
+			cached.id = checker->id;
+			recordResult(cached);
+			continue;
+		}
+		m_doing++;
+		connect(checker.get(), SIGNAL(checkFinished(JavaCheckResult)),
+				SLOT(partFinished(JavaCheckResult)), Qt::UniqueConnection);
+		checker->performCheck();
+	}
+	if (!m_todo.size() && !m_doing && num_finished == javacheckers.size())
+	{
+		emit finished(javaresults);
 	}
 }
@@ -17,6 +17,7 @@
 
 #include <QtNetwork>
 #include <QLabel>
+#include <QQueue>
 #include "JavaChecker.h"
 #include "tasks/ProgressProvider.h"
 
@@ -33,13 +34,13 @@ public:
 	{
 		javacheckers.append(base);
 		total_progress++;
-		// if this is already running, the action needs to be started right away!
+		// if this is already running, the action needs to be queued right away!
 		if (isRunning())
 		{
 			emit progress(current_progress, total_progress);
-			connect(base.get(), SIGNAL(checkFinished(JavaCheckResult)), SLOT(partFinished(JavaCheckResult)));
-
-			base->performCheck();
+			javaresults.append(JavaCheckResult());
+			m_todo.enqueue(javacheckers.size() - 1);
+			startMoreChecks();
 		}
 		return true;
 	}
@@ -76,8 +77,11 @@ slots:
 private
 slots:
 	void partFinished(JavaCheckResult result);
+	void startMoreChecks();
 
 private:
+	void recordResult(const JavaCheckResult &result);
+
 	QString m_job_name;
 	QList<JavaCheckerPtr> javacheckers;
 	QList<JavaCheckResult> javaresults;
@@ -85,4 +89,8 @@ private:
 	qint64 total_progress = 0;
 	int num_finished = 0;
 	bool m_running = false;
+	/// indexes of checkers that still need to run
+	QQueue<int> m_todo;
+	/// number of java processes currently running
+	int m_doing = 0;
 };
@@ -16,7 +16,10 @@
 #include <QStringList>
 #include <QString>
 #include <QDir>
-#include <QStringList>
+#include <QSet>
+#include <QFileInfo>
+#include <QProcessEnvironment>
+#include <QStandardPaths>
 
 #include <settings/Setting.h>
 #include <pathutils.h>
@@ -197,12 +200,61 @@ QList<QString> JavaUtils::FindJavaPaths()
 #elif LINUX
 QList<QString> JavaUtils::FindJavaPaths()
 {
-	qDebug() << "Linux Java detection incomplete - defaulting to \"java\"";
-
 	QList<QString> javas;
+	// canonical paths of what we already have, so symlinked javas are only checked once
+	QSet<QString> seen;
+	auto addJava = [&](const QString &path)
+	{
+		QFileInfo finfo(path);
+		if (!finfo.isFile() || !finfo.isExecutable())
+			return;
+		auto canonical = finfo.canonicalFilePath();
+		if (seen.contains(canonical))
+			return;
+		seen.insert(canonical);
+		javas.append(path);
+	};
+	// every JVM is a folder with bin/java (JDKs also have jre/bin/java)
+	auto scanJavaHome = [&](const QString &home)
+	{
+		addJava(PathCombine(home, "bin", "java"));
+		addJava(PathCombine(home, "jre/bin", "java"));
+	};
+	auto scanJavaDir = [&](const QString &dirPath)
+	{
+		QDir dir(dirPath);
+		for (auto entry : dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+		{
+			scanJavaHome(entry.absoluteFilePath());
+		}
+	};
+
 	javas.append(this->GetDefaultJava()->path);
-    javas.append("/opt/java/bin/java");
-    javas.append("/usr/bin/java");
+	auto defaultJava = QStandardPaths::findExecutable("java");
+	if (!defaultJava.isEmpty())
+	{
+		seen.insert(QFileInfo(defaultJava).canonicalFilePath());
+	}
+
+	auto env = QProcessEnvironment::systemEnvironment();
+	if (env.contains("JAVA_HOME"))
+	{
+		scanJavaHome(env.value("JAVA_HOME"));
+	}
+	for (auto path : env.value("PATH").split(':', QString::SkipEmptyParts))
+	{
+		addJava(PathCombine(path, "java"));
+	}
+	scanJavaDir("/usr/lib/jvm");
+	scanJavaDir("/usr/lib32/jvm");
+	scanJavaDir("/usr/lib64/jvm");
+	scanJavaHome("/opt/java");
+	scanJavaDir("/opt/jdk");
+	scanJavaDir("/opt/jvm");
+	// sdkman and similar per-user managers
+	scanJavaDir(PathCombine(QDir::homePath(), ".sdkman/candidates/java"));
+	scanJavaDir(PathCombine(QDir::homePath(), ".jdks"));
+	addJava("/usr/bin/java");
 
 	return javas;
 }
@@ -17,6 +17,7 @@
 #include "Env.h"
 #include "net/URLConstants.h"
 #include "MMCError.h"
+#include "VersionIndex.h"
 
 #include <QtXml>
 
@@ -30,8 +31,46 @@
 
 #include <QtNetwork>
 
+namespace
+{
+const char *localVersionIndex = "versions/liteloader.idx";
+const QByteArray indexKind = "liteloader";
+// bump when the fields change
+const quint32 indexLayout = 1;
+enum Tables
+{
+	VersionTable,
+	LibraryTable
+};
+enum VersionField
+{
+	VersionVersion,
+	VersionFile,
+	VersionMcVersion,
+	VersionMd5,
+	VersionTimestamp,
+	VersionLatest,
+	VersionTweakClass,
+	VersionDefaultUrl,
+	VersionDescription,
+	VersionAuthors,
+	VersionFirstLibrary,
+	VersionLibraryCount,
+	VersionFieldCount
+};
+enum LibraryField
+{
+	LibraryName,
+	LibraryBaseUrl,
+	LibraryAbsoluteUrl,
+	LibraryHint,
+	LibraryFieldCount
+};
+}
+
 LiteLoaderVersionList::LiteLoaderVersionList(QObject *parent) : BaseVersionList(parent)
 {
+	loadCachedList();
 }
 
 Task *LiteLoaderVersionList::getLoadTask()
@@ -83,11 +122,114 @@ BaseVersionPtr LiteLoaderVersionList::getLatestStable() const
 
 void LiteLoaderVersionList::updateListData(QList<BaseVersionPtr> versions)
 {
+	std::sort(versions.begin(), versions.end(), cmpVersions);
+	publishUpdate(m_vlist, versions);
+	m_loaded = true;
+	saveCachedList();
+}
+
+void LiteLoaderVersionList::loadCachedList()
+{
+	if (!QFile::exists(localVersionIndex))
+	{
+		return;
+	}
+	QString error;
+	auto index = VersionIndex::open(localVersionIndex, indexKind, indexLayout, &error);
+	if (!index || index->tableCount() != 2 ||
+		index->fieldCount(VersionTable) != VersionFieldCount ||
+		index->fieldCount(LibraryTable) != LibraryFieldCount)
+	{
+		qCritical() << "The liteloader version cache is unusable:" << error << "Flushing cache.";
+		QFile::remove(localVersionIndex);
+		return;
+	}
+	const int libraryCount = index->recordCount(LibraryTable);
+	QList<BaseVersionPtr> versions;
+	for (int i = 0; i < index->recordCount(VersionTable); i++)
+	{
+		LiteLoaderVersionPtr version(new LiteLoaderVersion());
+		version->version = index->string(VersionTable, i, VersionVersion);
+		version->file = index->string(VersionTable, i, VersionFile);
+		version->mcVersion = index->string(VersionTable, i, VersionMcVersion);
+		version->md5 = index->string(VersionTable, i, VersionMd5);
+		version->timestamp = index->value(VersionTable, i, VersionTimestamp);
+		version->isLatest = index->value(VersionTable, i, VersionLatest) != 0;
+		version->tweakClass = index->string(VersionTable, i, VersionTweakClass);
+		version->defaultUrl = index->string(VersionTable, i, VersionDefaultUrl);
+		version->description = index->string(VersionTable, i, VersionDescription);
+		version->authors = index->string(VersionTable, i, VersionAuthors);
+		quint64 first = index->value(VersionTable, i, VersionFirstLibrary);
+		quint64 count = index->value(VersionTable, i, VersionLibraryCount);
+		if (first > quint64(libraryCount) || count > quint64(libraryCount) - first)
+		{
+			qCritical() << "The liteloader version cache is damaged. Flushing cache.";
+			QFile::remove(localVersionIndex);
+			return;
+		}
+		for (int lib = first; lib < int(first + count); lib++)
+		{
+			RawLibraryPtr library(new RawLibrary());
+			library->setRawName(GradleSpecifier(index->string(LibraryTable, lib, LibraryName)));
+			library->setBaseUrl(index->string(LibraryTable, lib, LibraryBaseUrl));
+			library->setAbsoluteUrl(index->string(LibraryTable, lib, LibraryAbsoluteUrl));
+			library->setHint(index->string(LibraryTable, lib, LibraryHint));
+			version->libraries.append(library);
+		}
+		versions.append(version);
+	}
+	// still not loaded - the load task refreshes it.
 	beginResetModel();
 	m_vlist = versions;
-	m_loaded = true;
 	std::sort(m_vlist.begin(), m_vlist.end(), cmpVersions);
 	endResetModel();
+	m_source = index->property("source");
+}
+
+void LiteLoaderVersionList::saveCachedList()
+{
+	VersionIndexWriter writer(indexKind, indexLayout);
+	writer.addTable(VersionFieldCount);
+	writer.addTable(LibraryFieldCount);
+	for (auto item : m_vlist)
+	{
+		auto version = std::dynamic_pointer_cast<LiteLoaderVersion>(item);
+		QVector<quint64> fields(VersionFieldCount);
+		fields[VersionVersion] = writer.string(version->version);
+		fields[VersionFile] = writer.string(version->file);
+		fields[VersionMcVersion] = writer.string(version->mcVersion);
+		fields[VersionMd5] = writer.string(version->md5);
+		fields[VersionTimestamp] = version->timestamp;
+		fields[VersionLatest] = version->isLatest;
+		fields[VersionTweakClass] = writer.string(version->tweakClass);
+		fields[VersionDefaultUrl] = writer.string(version->defaultUrl);
+		fields[VersionDescription] = writer.string(version->description);
+		fields[VersionAuthors] = writer.string(version->authors);
+		fields[VersionFirstLibrary] = writer.recordCount(LibraryTable);
+		fields[VersionLibraryCount] = version->libraries.size();
+		for (auto library : version->libraries)
+		{
+			// the index only knows plain libraries. LiteLoader has never used anything else.
+			if (library->applyRules || library->applyExcludes || library->isNative())
+			{
+				qWarning() << "Not caching the liteloader version list, it has complex libraries.";
+				QFile::remove(localVersionIndex);
+				return;
+			}
+			QVector<quint64> libFields(LibraryFieldCount);
+			libFields[LibraryName] = writer.string(library->rawName());
+			libFields[LibraryBaseUrl] = writer.string(library->m_base_url);
+			libFields[LibraryAbsoluteUrl] = writer.string(library->absoluteUrl());
+			libFields[LibraryHint] = writer.string(library->hint());
+			writer.addRecord(LibraryTable, libFields);
+		}
+		writer.addRecord(VersionTable, fields);
+	}
+	writer.setProperty("source", m_source);
+	if (!writer.save(localVersionIndex))
+	{
+		qCritical() << "Couldn't save the liteloader version cache.";
+	}
 }
 
 LLListLoadTask::LLListLoadTask(LiteLoaderVersionList *vlist)
@@ -104,7 +246,7 @@ void LLListLoadTask::executeTask()
 	setStatus(tr("Loading LiteLoader version list..."));
 	auto job = new NetJob("Version index");
 	// we do not care if the version is stale or not.
-	auto liteloaderEntry = ENV.metacache()->resolveEntry("liteloader", "versions.json");
+	liteloaderEntry = ENV.metacache()->resolveEntry("liteloader", "versions.json");
 
 	// verify by poking the server.
 	liteloaderEntry->stale = true;
@@ -128,6 +270,16 @@ void LLListLoadTask::listFailed()
 
 void LLListLoadTask::listDownloaded()
 {
+	// the server had nothing new and the cached list was made from the same file
+	if (m_list->count() && !liteloaderEntry->md5sum.isEmpty() &&
+		liteloaderEntry->md5sum == m_list->m_source)
+	{
+		qDebug() << "LiteLoader version list didn't change.";
+		m_list->m_loaded = true;
+		emitSucceeded();
+		return;
+	}
+
 	QByteArray data;
 	{
 		auto dlJob = listDownload;
@@ -233,6 +385,7 @@ void LLListLoadTask::listDownloaded()
 		}
 		tempList.append(perMcVersionList);
 	}
+	m_list->m_source = liteloaderEntry->md5sum;
 	m_list->updateListData(tempList);
 
 	emitSucceeded();
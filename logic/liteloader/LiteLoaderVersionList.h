@@ -82,9 +82,14 @@ public:
 	virtual BaseVersionPtr getLatestStable() const;
 
 protected:
+	void loadCachedList();
+	void saveCachedList();
+
 	QList<BaseVersionPtr> m_vlist;
 
 	bool m_loaded = false;
+	/// md5 sum of the downloaded file the list was made from
+	QString m_source;
 
 protected
 slots:
@@ -109,6 +114,7 @@ slots:
 protected:
 	NetJobPtr listJob;
 	CacheDownloadPtr listDownload;
+	MetaEntryPtr liteloaderEntry;
 	LiteLoaderVersionList *m_list;
 };
 
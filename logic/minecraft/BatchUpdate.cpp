@@ -0,0 +1,232 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BatchUpdate.h"
+#include "Env.h"
+#include "MMCError.h"
+#include "minecraft/MinecraftVersion.h"
+#include "minecraft/MinecraftVersionList.h"
+#include "minecraft/OneSixInstance.h"
+#include "minecraft/OneSixUpdate.h"
+
+#include <QSet>
+#include <QDebug>
+
+namespace
+{
+/// instance updates running at the same time - mostly waiting on the network or building jars
+const int maxParallelUpdates = 4;
+}
+
+BatchUpdate::BatchUpdate(QList<InstancePtr> instances, QObject *parent)
+	: Task(parent), m_instances(instances)
+{
+}
+
+void BatchUpdate::executeTask()
+{
+	// every Minecraft version the instances use only needs its files updated once
+	QSet<QString> versions;
+	for (auto instance : m_instances)
+	{
+		auto onesix = std::dynamic_pointer_cast<OneSixInstance>(instance);
+		if (!onesix || onesix->providesVersionFile())
+			continue;
+		QString versionId = onesix->intendedVersionId();
+		if (versions.contains(versionId))
+			continue;
+		versions.insert(versionId);
+		auto version = std::dynamic_pointer_cast<MinecraftVersion>(
+			ENV.getVersion("net.minecraft", versionId));
+		if (!version || !version->needsUpdate())
+			continue;
+		auto list = std::dynamic_pointer_cast<MinecraftVersionList>(
+			ENV.getVersionList("net.minecraft"));
+		auto task = list->createUpdateTask(versionId);
+		if (task)
+			m_versionUpdates.enqueue(task);
+	}
+	setStatus(tr("Getting the version files from Mojang..."));
+	nextVersionUpdate();
+}
+
+void BatchUpdate::nextVersionUpdate()
+{
+	if (m_versionUpdate)
+	{
+		m_versionUpdate->disconnect(this);
+	}
+	if (m_versionUpdates.isEmpty())
+	{
+		sharedFilesStart();
+		return;
+	}
+	m_versionUpdate = m_versionUpdates.dequeue();
+	m_versionUpdate->setTimeline(m_timeline);
+	// a version that fails here fails again in the update of its instances, which reports it
+	connect(m_versionUpdate.get(), SIGNAL(succeeded()), SLOT(nextVersionUpdate()),
+			Qt::QueuedConnection);
+	connect(m_versionUpdate.get(), SIGNAL(failed(QString)), SLOT(nextVersionUpdate()),
+			Qt::QueuedConnection);
+	m_versionUpdate->start();
+}
+
+void BatchUpdate::sharedFilesStart()
+{
+	m_sharedFilesJob.reset(new NetJob(tr("Files shared by the instances")));
+	m_sharedFilesJob->setPriority(Priority_Launch);
+	QSet<QString> targets;
+	for (auto instance : m_instances)
+	{
+		auto onesix = std::dynamic_pointer_cast<OneSixInstance>(instance);
+		if (!onesix)
+			continue;
+		try
+		{
+			onesix->reloadProfile();
+		}
+		catch (...)
+		{
+			// the update of the instance will tell what's wrong with it
+			continue;
+		}
+		for (auto download : OneSixUpdate::sharedDownloads(onesix.get()))
+		{
+			if (targets.contains(download->getTargetFilepath()))
+				continue;
+			targets.insert(download->getTargetFilepath());
+			m_sharedFilesJob->addNetAction(download);
+		}
+	}
+	if (!m_sharedFilesJob->size())
+	{
+		sharedFilesFinished();
+		return;
+	}
+	qDebug() << "Downloading" << m_sharedFilesJob->size() << "files for" << m_instances.size()
+			 << "instances";
+	setStatus(tr("Getting the files shared by the instances..."));
+	m_sharedFilesJob->setTimeline(m_timeline);
+	// what failed here is tried again by the instances that need it
+	connect(m_sharedFilesJob.get(), SIGNAL(succeeded()), SLOT(sharedFilesFinished()));
+	connect(m_sharedFilesJob.get(), SIGNAL(failed()), SLOT(sharedFilesFinished()));
+	connect(m_sharedFilesJob.get(), SIGNAL(progress(qint64, qint64)),
+			SIGNAL(progress(qint64, qint64)));
+	m_sharedFilesJob->start();
+}
+
+void BatchUpdate::sharedFilesFinished()
+{
+	if (m_sharedFilesJob)
+	{
+		m_sharedFilesJob->disconnect(this);
+	}
+	for (auto instance : m_instances)
+	{
+		m_todo.enqueue(instance);
+	}
+	reportProgress();
+	startMoreInstances();
+}
+
+void BatchUpdate::startMoreInstances()
+{
+	while (m_running.size() < maxParallelUpdates && !m_todo.isEmpty())
+	{
+		InstancePtr instance = m_todo.dequeue();
+		QString id = instance->id();
+		auto update = instance->doUpdate();
+		if (!update)
+		{
+			// nothing to do. Not instanceDone(), that would get here again and finish twice
+			recordDone(instance, true, QString());
+			continue;
+		}
+		m_running.insert(id, update);
+		m_runningProgress.insert(id, 0);
+		update->setTimeline(m_timeline);
+		connect(update.get(), &Task::status, this, [this, id](QString status)
+		{
+			emit instanceStatus(id, status);
+		});
+		connect(update.get(), &Task::progress, this, [this, id](qint64 current, qint64 total)
+		{
+			emit instanceProgress(id, current, total);
+			m_runningProgress[id] = total > 0 ? qBound<qint64>(0, current * 1000 / total, 1000) : 0;
+			reportProgress();
+		});
+		connect(update.get(), &Task::succeeded, this, [this, instance]()
+		{
+			instanceDone(instance, true, QString());
+		}, Qt::QueuedConnection);
+		connect(update.get(), &Task::failed, this, [this, instance](QString reason)
+		{
+			instanceDone(instance, false, reason);
+		}, Qt::QueuedConnection);
+		update->start();
+	}
+	setStatus(tr("Updating instances (%1 of %2 done)...").arg(m_done).arg(m_instances.size()));
+	if (m_running.isEmpty() && m_todo.isEmpty())
+	{
+		if (m_failures.isEmpty())
+		{
+			emitSucceeded();
+			return;
+		}
+		QStringList reasons;
+		for (auto instance : m_instances)
+		{
+			if (m_failures.contains(instance->id()))
+				reasons.append(instance->name() + ": " + m_failures[instance->id()]);
+		}
+		emitFailed(tr("%n instance(s) failed to update:\n\n%1", "", m_failures.size())
+					   .arg(reasons.join("\n\n")));
+	}
+}
+
+void BatchUpdate::instanceDone(InstancePtr instance, bool success, QString reason)
+{
+	recordDone(instance, success, reason);
+	startMoreInstances();
+}
+
+void BatchUpdate::recordDone(InstancePtr instance, bool success, QString reason)
+{
+	QString id = instance->id();
+	auto update = m_running.take(id);
+	if (update)
+	{
+		update->disconnect(this);
+	}
+	m_runningProgress.remove(id);
+	m_done++;
+	if (!success)
+	{
+		qWarning() << "Updating" << instance->name() << "failed:" << reason;
+		m_failures.insert(id, reason);
+	}
+	emit instanceFinished(id, success);
+	reportProgress();
+}
+
+void BatchUpdate::reportProgress()
+{
+	qint64 current = m_done * 1000;
+	for (auto permille : m_runningProgress)
+	{
+		current += permille;
+	}
+	emit progress(current, qMax(1, m_instances.size()) * 1000);
+}
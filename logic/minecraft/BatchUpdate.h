@@ -0,0 +1,85 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QList>
+#include <QMap>
+#include <QQueue>
+#include <memory>
+
+#include "BaseInstance.h"
+#include "net/NetJob.h"
+#include "tasks/Task.h"
+
+/**
+ * Updates many instances in one go - all of them before an event, for example.
+ *
+ * Instead of every instance going over mostly the same files on its own, the version files are
+ * updated once per Minecraft version, then the jars, libraries and asset indexes the instances
+ * need are downloaded together in one job, each file once. After that the updates of the
+ * instances themselves run side by side. They find the shared files in the cache and only do
+ * what is particular to each instance: modded jars, FML libraries and assets.
+ *
+ * One instance failing doesn't stop the others. The batch fails at the end if any of them did.
+ */
+class BatchUpdate : public Task
+{
+	Q_OBJECT
+public:
+	explicit BatchUpdate(QList<InstancePtr> instances, QObject *parent = 0);
+	virtual ~BatchUpdate() {};
+
+	/// why the instances that failed to update failed, by instance ID
+	QMap<QString, QString> failures() const
+	{
+		return m_failures;
+	}
+
+signals:
+	void instanceStatus(QString id, QString status);
+	void instanceProgress(QString id, qint64 current, qint64 total);
+	void instanceFinished(QString id, bool success);
+
+protected:
+	virtual void executeTask();
+
+private
+slots:
+	void nextVersionUpdate();
+	void sharedFilesStart();
+	void sharedFilesFinished();
+	void startMoreInstances();
+
+private:
+	/// an instance update finished, start the next ones
+	void instanceDone(InstancePtr instance, bool success, QString reason);
+	/// keep track of an instance update that finished
+	void recordDone(InstancePtr instance, bool success, QString reason);
+	void reportProgress();
+
+private:
+	QList<InstancePtr> m_instances;
+	QQueue<std::shared_ptr<Task>> m_versionUpdates;
+	std::shared_ptr<Task> m_versionUpdate;
+	NetJobPtr m_sharedFilesJob;
+
+	QQueue<InstancePtr> m_todo;
+	QMap<QString, std::shared_ptr<Task>> m_running;
+	/// progress of the running instance updates, in permille
+	QMap<QString, qint64> m_runningProgress;
+	int m_done = 0;
+	QMap<QString, QString> m_failures;
+};
@@ -0,0 +1,231 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CacheCleanupTask.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QtConcurrentRun>
+#include <algorithm>
+
+#include "InstanceList.h"
+#include "net/HttpMetaCache.h"
+#include "minecraft/LibraryStore.h"
+
+namespace
+{
+/// the bases that hold game files. Everything else is small or not only ours to decide about.
+const QStringList cleanedBases = {"libraries", "versions", "asset_objects", "fmllibs"};
+
+const qint64 msPerDay = 24 * 60 * 60 * 1000;
+
+struct Candidate
+{
+	QString base;
+	QString path;
+	QString fullPath;
+	qint64 size;
+	qint64 lastUse;
+};
+}
+
+CacheCleanupTask::CacheCleanupTask(std::shared_ptr<HttpMetaCache> cache,
+								   const QList<InstanceFiles::File> &liveFiles, Budget budget,
+								   bool dryRun, QObject *parent)
+	: Task(parent), m_cache(cache), m_liveFiles(liveFiles), m_budget(budget), m_dryRun(dryRun),
+	  m_aborted(false)
+{
+	connect(&m_watcher, SIGNAL(finished()), SLOT(workFinished()));
+}
+
+QList<InstanceFiles::File> CacheCleanupTask::liveFiles(std::shared_ptr<InstanceList> instances,
+													   std::shared_ptr<HttpMetaCache> cache,
+													   QStringList *problems)
+{
+	QList<InstancePtr> list;
+	for (int i = 0; i < instances->count(); i++)
+	{
+		list.append(instances->at(i));
+	}
+	InstanceFiles::loadProfiles(list);
+	return InstanceFiles::gather(list, cache, problems);
+}
+
+CacheCleanupTask::Result CacheCleanupTask::result() const
+{
+	return m_result;
+}
+
+void CacheCleanupTask::abort()
+{
+	m_aborted = true;
+}
+
+void CacheCleanupTask::executeTask()
+{
+	setStatus(m_dryRun ? tr("Looking for unused files in the cache...")
+					   : tr("Removing unused files from the cache..."));
+	for (auto &base : cleanedBases)
+	{
+		m_roots.insert(base, m_cache->getBasePath(base));
+		m_lastAccess.insert(base, m_cache->lastAccessTimes(base));
+	}
+	m_watcher.setFuture(QtConcurrent::run(this, &CacheCleanupTask::run));
+}
+
+CacheCleanupTask::Result CacheCleanupTask::run()
+{
+	// only reads what was gathered on the main thread, the index is updated back there
+	Result result;
+	QSet<QString> live;
+	for (auto &file : m_liveFiles)
+	{
+		live.insert(file.source);
+		if (file.objectsRoot.isEmpty() || !QFileInfo(file.source).isFile())
+			continue;
+		// the asset indexes are read here, they are big
+		QList<InstanceFiles::File> objects;
+		if (!InstanceFiles::assetObjects(file, &objects))
+		{
+			result.unreadableIndexes.append(file.source);
+			continue;
+		}
+		for (auto &object : objects)
+		{
+			live.insert(object.source);
+		}
+	}
+	QList<Candidate> candidates;
+	int step = 0;
+	for (auto &base : cleanedBases)
+	{
+		QString root = m_roots[base];
+		if (root.isEmpty())
+			continue;
+		auto &lastAccess = m_lastAccess[base];
+		QDir rootDir(root);
+		QDirIterator iter(root, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+		while (iter.hasNext())
+		{
+			if (m_aborted)
+			{
+				result.aborted = true;
+				return result;
+			}
+			QString fullPath = QDir::cleanPath(iter.next());
+			QFileInfo info = iter.fileInfo();
+			// the version files next to the jars belong to the version list
+			if (base == "versions" && info.suffix() == "json")
+				continue;
+			if (live.contains(fullPath))
+			{
+				result.keptFiles++;
+				result.keptBytes += info.size();
+				continue;
+			}
+			QString path = rootDir.relativeFilePath(fullPath);
+			qint64 lastUse = qMax(lastAccess.value(path, 0),
+								  info.lastModified().toMSecsSinceEpoch());
+			candidates.append({base, path, fullPath, info.size(), lastUse});
+		}
+		emit progress(++step, cleanedBases.size() + 1);
+	}
+
+	// least recently used first
+	std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b)
+	{
+		return a.lastUse < b.lastUse;
+	});
+	qint64 total = result.keptBytes;
+	for (auto &candidate : candidates)
+	{
+		total += candidate.size;
+	}
+	qint64 cutoff = QDateTime::currentMSecsSinceEpoch() - qint64(m_budget.maxAgeDays) * msPerDay;
+	QSet<QString> touchedDirs;
+	for (auto &candidate : candidates)
+	{
+		if (m_aborted)
+		{
+			result.aborted = true;
+			break;
+		}
+		bool tooOld = m_budget.maxAgeDays >= 0 && candidate.lastUse <= cutoff;
+		bool tooBig = m_budget.maxBytes >= 0 && total > m_budget.maxBytes;
+		if (!tooOld && !tooBig)
+		{
+			result.keptFiles++;
+			result.keptBytes += candidate.size;
+			continue;
+		}
+		// counted before the link goes away
+		bool lastLink = LibraryStore::linkCount(candidate.fullPath) <= 1;
+		if (!m_dryRun && !QFile::remove(candidate.fullPath))
+		{
+			result.errors.append(tr("Couldn't remove %1").arg(candidate.fullPath));
+			result.keptFiles++;
+			result.keptBytes += candidate.size;
+			continue;
+		}
+		total -= candidate.size;
+		result.removed.append({candidate.base, candidate.path, candidate.size});
+		result.removedBytes += candidate.size;
+		if (lastLink)
+			result.freedBytes += candidate.size;
+		touchedDirs.insert(QFileInfo(candidate.fullPath).absolutePath());
+	}
+
+	// folders of libraries and versions nothing is left of
+	if (!m_dryRun)
+	{
+		for (auto dir : touchedDirs)
+		{
+			QDir current(dir);
+			while (!m_roots.values().contains(current.absolutePath()) &&
+				   current.rmdir(current.absolutePath()))
+			{
+				current.cdUp();
+			}
+		}
+	}
+	emit progress(cleanedBases.size() + 1, cleanedBases.size() + 1);
+	return result;
+}
+
+void CacheCleanupTask::workFinished()
+{
+	m_result = m_watcher.result();
+	if (!m_dryRun)
+	{
+		// also after an abort - the files that are gone are gone
+		for (auto &removed : m_result.removed)
+		{
+			m_cache->removeEntry(removed.base, removed.path);
+		}
+	}
+	if (m_result.aborted)
+	{
+		emitFailed(tr("Cancelled."));
+		return;
+	}
+	if (!m_result.errors.isEmpty())
+	{
+		emitFailed(m_result.errors.join("\n"));
+		return;
+	}
+	emitSucceeded();
+}
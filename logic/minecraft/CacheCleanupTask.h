@@ -0,0 +1,110 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QFutureWatcher>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+
+#include "tasks/Task.h"
+#include "minecraft/InstanceFiles.h"
+
+class HttpMetaCache;
+class InstanceList;
+
+/**
+ * Removes game files from the download cache that no instance uses any more - libraries,
+ * jars, asset objects and FML libraries of versions nobody plays, left behind by updates.
+ *
+ * Files an instance uses are never removed. Of the others, the ones that weren't used for a
+ * while go first, then the least recently used ones until the cache fits its size budget.
+ * A dry run only reports what would be removed.
+ */
+class CacheCleanupTask : public Task
+{
+	Q_OBJECT
+public:
+	struct Budget
+	{
+		/// unused files not used in this many days are removed, -1 to keep them
+		int maxAgeDays = 30;
+		/// unused files are removed until the cache is no bigger than this, -1 for no limit
+		qint64 maxBytes = -1;
+	};
+	struct RemovedFile
+	{
+		QString base;
+		QString path;
+		qint64 size;
+	};
+	struct Result
+	{
+		/// the files that were removed - or would be, in a dry run
+		QList<RemovedFile> removed;
+		qint64 removedBytes = 0;
+		/// disk space that gave back. Files with other hard links to them, like libraries in
+		/// the library store, free nothing.
+		qint64 freedBytes = 0;
+		int keptFiles = 0;
+		qint64 keptBytes = 0;
+		/// asset indexes that couldn't be read - the objects they list might be removed
+		QStringList unreadableIndexes;
+		QStringList errors;
+		bool aborted = false;
+	};
+
+	CacheCleanupTask(std::shared_ptr<HttpMetaCache> cache,
+					 const QList<InstanceFiles::File> &liveFiles, Budget budget, bool dryRun,
+					 QObject *parent = 0);
+
+	/// The cached files the instances use, loading their profiles where needed. Instances whose
+	/// files can't be worked out are added to @p problems - don't remove anything then, what
+	/// they use is unknown. The asset objects are only looked up when the task runs.
+	static QList<InstanceFiles::File> liveFiles(std::shared_ptr<InstanceList> instances,
+												std::shared_ptr<HttpMetaCache> cache,
+												QStringList *problems);
+
+	Result result() const;
+
+public
+slots:
+	virtual void abort() override;
+
+protected:
+	virtual void executeTask() override;
+
+private slots:
+	void workFinished();
+
+private:
+	Result run();
+
+private:
+	std::shared_ptr<HttpMetaCache> m_cache;
+	QList<InstanceFiles::File> m_liveFiles;
+	Budget m_budget;
+	bool m_dryRun;
+	/// base name -> root folder, read on the main thread
+	QMap<QString, QString> m_roots;
+	/// base name -> resource path -> last access, read on the main thread
+	QMap<QString, QMap<QString, qint64>> m_lastAccess;
+	std::atomic<bool> m_aborted;
+	QFutureWatcher<Result> m_watcher;
+	Result m_result;
+};
@@ -0,0 +1,144 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "InstanceFiles.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <pathutils.h>
+
+#include "net/HttpMetaCache.h"
+#include "net/URLConstants.h"
+#include "minecraft/AssetsUtils.h"
+#include "minecraft/LegacyInstance.h"
+#include "minecraft/MinecraftProfile.h"
+#include "minecraft/OneSixInstance.h"
+#include "minecraft/OneSixUpdate.h"
+#include "minecraft/VersionFilterData.h"
+
+void InstanceFiles::loadProfiles(const QList<InstancePtr> &instances)
+{
+	for (auto instance : instances)
+	{
+		auto onesix = std::dynamic_pointer_cast<OneSixInstance>(instance);
+		if (!onesix || onesix->profileComplete())
+			continue;
+		try
+		{
+			onesix->reloadProfile();
+		}
+		catch (...)
+		{
+			// gather() reports it
+		}
+	}
+}
+
+QList<InstanceFiles::File> InstanceFiles::gather(const QList<InstancePtr> &instances,
+												 std::shared_ptr<HttpMetaCache> cache,
+												 QStringList *problems)
+{
+	QList<File> files;
+	QSet<QString> seen;
+	auto add = [&](QString base, QString path, QUrl url, bool binaryJson)
+	{
+		QString source = QDir::cleanPath(PathCombine(cache->getBasePath(base), path));
+		if (seen.contains(source))
+			return;
+		seen.insert(source);
+		files.append({source, url, binaryJson, QString()});
+	};
+	QString versionsUrl = "http://" + URLConstants::AWS_DOWNLOAD_VERSIONS;
+	QString objectsRoot = cache->getBasePath("asset_objects");
+
+	for (auto instance : instances)
+	{
+		QString versionId = instance->intendedVersionId();
+		for (auto &lib : g_VersionFilterData.fmlLibsMapping.value(versionId))
+		{
+			QString base = lib.ours ? URLConstants::FMLLIBS_OUR_BASE_URL
+									: URLConstants::FMLLIBS_FORGE_BASE_URL;
+			add("fmllibs", lib.filename, QUrl(base + lib.filename), false);
+		}
+		if (std::dynamic_pointer_cast<LegacyInstance>(instance))
+		{
+			QString jarPath = versionId + "/" + versionId + ".jar";
+			add("versions", jarPath, QUrl(versionsUrl + jarPath), false);
+			continue;
+		}
+		auto onesix = std::dynamic_pointer_cast<OneSixInstance>(instance);
+		if (!onesix)
+			continue;
+		if (!onesix->profileComplete())
+		{
+			problems->append(instance->name());
+			continue;
+		}
+		auto version = onesix->getMinecraftProfile();
+		QString jarPath = version->id + "/" + version->id + ".jar";
+		add("versions", jarPath, QUrl(versionsUrl + jarPath), false);
+
+		// what the version list got from Mojang when the version was installed - built in
+		// versions don't have one
+		QString versionFile = versionId + "/" + versionId + ".dat";
+		if (QFile::exists(PathCombine(cache->getBasePath("versions"), versionFile)))
+		{
+			add("versions", versionFile,
+				QUrl(versionsUrl + versionId + "/" + versionId + ".json"), true);
+		}
+
+		auto libs = version->getActiveNativeLibs();
+		libs.append(version->getActiveNormalLibs());
+		for (auto lib : libs)
+		{
+			bool local = lib->hint() == "local";
+			// packed Forge libraries are listed as plain jars, a mirror is asked for those
+			for (auto file : OneSixUpdate::libraryFiles(lib))
+			{
+				add("libraries", file.first, local ? QUrl() : QUrl(file.second), false);
+			}
+		}
+		if (!version->assets.isEmpty())
+		{
+			QString indexPath = version->assets + ".json";
+			QString source =
+				QDir::cleanPath(PathCombine(cache->getBasePath("asset_indexes"), indexPath));
+			if (!seen.contains(source))
+			{
+				seen.insert(source);
+				QUrl url("http://" + URLConstants::AWS_DOWNLOAD_INDEXES + indexPath);
+				files.append({source, url, false, objectsRoot});
+			}
+		}
+	}
+	return files;
+}
+
+bool InstanceFiles::assetObjects(const File &index, QList<File> *objects)
+{
+	AssetsIndex parsed;
+	if (!AssetsUtils::loadAssetsIndexJson(index.source, &parsed))
+		return false;
+	for (auto &object : parsed.objects)
+	{
+		QString objectPath = object.hash.left(2) + "/" + object.hash;
+		objects->append({QDir::cleanPath(PathCombine(index.objectsRoot, objectPath)),
+						 QUrl("http://" + URLConstants::RESOURCE_BASE + objectPath), false,
+						 QString()});
+	}
+	return true;
+}
@@ -0,0 +1,61 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <memory>
+
+class HttpMetaCache;
+class BaseInstance;
+typedef std::shared_ptr<BaseInstance> InstancePtr;
+
+/**
+ * The files instances get from the internet into the download cache: game jars, version files,
+ * libraries, FML libraries and asset indexes. Worked out from the profiles of the instances,
+ * see loadProfiles(). The asset objects are listed in the indexes and have to be read from
+ * them - see assetObjects().
+ */
+namespace InstanceFiles
+{
+struct File
+{
+	/// the file in the cache
+	QString source;
+	/// where it came from, empty for files that don't come from the internet
+	QUrl url;
+	/// a version file MultiMC keeps in binary form
+	bool binaryJson;
+	/// for asset indexes, where the objects they list are in the cache
+	QString objectsRoot;
+};
+
+/// Loads the profiles of the OneSix instances among @p instances that haven't loaded theirs in
+/// full yet - most haven't, until they are updated, launched or edited. Call before gather().
+void loadProfiles(const QList<InstancePtr> &instances);
+
+/// The files @p instances use. Instances without a complete profile are added to @p problems,
+/// what they use isn't known.
+QList<File> gather(const QList<InstancePtr> &instances, std::shared_ptr<HttpMetaCache> cache,
+				   QStringList *problems);
+
+/// The objects the asset index @p index lists, as files in its objectsRoot. Reads the index,
+/// so keep it off the main thread. False if the index can't be read.
+bool assetObjects(const File &index, QList<File> *objects);
+}
@@ -0,0 +1,143 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "minecraft/LaunchFingerprint.h"
+#include "minecraft/OneSixInstance.h"
+#include "minecraft/MinecraftProfile.h"
+#include "minecraft/OneSixLibrary.h"
+#include "minecraft/VersionFilterData.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <pathutils.h>
+
+static QString fingerprintPath(OneSixInstance *instance)
+{
+	return PathCombine(instance->instanceRoot(), "launch.fingerprint");
+}
+
+static void addString(QCryptographicHash &hash, const QString &value)
+{
+	hash.addData(value.toUtf8());
+	hash.addData("\0", 1);
+}
+
+/// a missing file and an existing file always hash differently
+static void addFile(QCryptographicHash &hash, const QString &path)
+{
+	QFileInfo info(path);
+	addString(hash, info.absoluteFilePath());
+	if (!info.isFile())
+	{
+		addString(hash, "missing");
+		return;
+	}
+	addString(hash, QString::number(info.size()));
+	addString(hash, QString::number(info.lastModified().toMSecsSinceEpoch()));
+}
+
+QString LaunchFingerprint::compute(OneSixInstance *instance)
+{
+	auto version = instance->getMinecraftProfile();
+	if (!version)
+		return QString();
+
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	addString(hash, instance->intendedVersionId());
+	addString(hash, version->id);
+
+	// the patches that make up the profile
+	for (int i = 0;; i++)
+	{
+		auto patch = version->versionPatch(i);
+		if (!patch)
+			break;
+		addString(hash, patch->getPatchID());
+		addString(hash, patch->getPatchVersion());
+		auto filename = patch->getPatchFilename();
+		if (!filename.isEmpty())
+			addFile(hash, filename);
+	}
+
+	// the libraries, in both architectures if there are two
+	auto libraries = instance->librariesPath();
+	auto libs = version->getActiveNativeLibs();
+	libs.append(version->getActiveNormalLibs());
+	for (auto lib : libs)
+	{
+		addString(hash, lib->downloadUrl());
+		QString storage = lib->storagePath();
+		if (storage.contains("${arch}"))
+		{
+			addFile(hash, libraries.absoluteFilePath(QString(storage).replace("${arch}", "32")));
+			addFile(hash, libraries.absoluteFilePath(QString(storage).replace("${arch}", "64")));
+		}
+		else
+		{
+			addFile(hash, libraries.absoluteFilePath(storage));
+		}
+	}
+
+	// the game jar and jar mods
+	addFile(hash, instance->versionsPath().absoluteFilePath(version->id + "/" + version->id + ".jar"));
+	auto jarMods = instance->getJarMods();
+	for (auto &mod : jarMods)
+	{
+		addFile(hash, mod.filename().absoluteFilePath());
+	}
+	if (!jarMods.isEmpty())
+	{
+		addFile(hash, PathCombine(instance->instanceRoot(), "temp.jar"));
+	}
+
+	// FML libraries copied into the instance
+	if (version->traits.contains("legacyFML") && version->versionPatch("net.minecraftforge"))
+	{
+		auto &mapping = g_VersionFilterData.fmlLibsMapping;
+		for (auto &lib : mapping.value(instance->intendedVersionId()))
+		{
+			addFile(hash, PathCombine(instance->libDir(), lib.filename));
+		}
+	}
+
+	// the asset index. the assets themselves are only checked by a full update
+	addString(hash, version->assets);
+	addFile(hash, "assets/indexes/" + version->assets + ".json");
+
+	return hash.result().toHex();
+}
+
+QString LaunchFingerprint::stored(OneSixInstance *instance)
+{
+	QFile file(fingerprintPath(instance));
+	if (!file.open(QIODevice::ReadOnly))
+		return QString();
+	return QString::fromLatin1(file.readAll()).trimmed();
+}
+
+bool LaunchFingerprint::store(OneSixInstance *instance, const QString &fingerprint)
+{
+	QFile file(fingerprintPath(instance));
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	return file.write(fingerprint.toLatin1()) == fingerprint.size();
+}
+
+void LaunchFingerprint::clear(OneSixInstance *instance)
+{
+	QFile::remove(fingerprintPath(instance));
+}
@@ -0,0 +1,43 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+
+class OneSixInstance;
+
+/**
+ * Fingerprint of everything the instance update puts in place: the profile patches, the
+ * libraries, the jar mods and the asset index - by name and by size and timestamp of the
+ * files on disk.
+ *
+ * It is stored after a successful update. As long as it doesn't change, the next update
+ * has nothing to do.
+ */
+namespace LaunchFingerprint
+{
+/// compute the fingerprint for the instance's loaded profile. Only stats files, reads nothing.
+QString compute(OneSixInstance *instance);
+
+/// the fingerprint stored by the last successful update, or an empty string
+QString stored(OneSixInstance *instance);
+
+/// remember the fingerprint of a successful update
+bool store(OneSixInstance *instance, const QString &fingerprint);
+
+/// forget the stored fingerprint, so the next update checks everything
+void clear(OneSixInstance *instance);
+}
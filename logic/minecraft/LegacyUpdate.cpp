@@ -29,6 +29,7 @@
 #include "minecraft/MinecraftVersionList.h"
 #include "minecraft/ModList.h"
 #include "minecraft/LegacyInstance.h"
+#include "minecraft/LibraryStore.h"
 
 LegacyUpdate::LegacyUpdate(BaseInstance *inst, QObject *parent) : Task(parent), m_inst(inst)
 {
@@ -107,6 +108,7 @@ void LegacyUpdate::fmllibsStart()
 	// download missing libs to our place
 	setStatus(tr("Dowloading FML libraries..."));
 	auto dljob = new NetJob("FML libraries");
+	dljob->setPriority(Priority_Launch);
 	auto metacache = ENV.metacache();
 	for (auto &lib : fmlLibsToProcess)
 	{
@@ -131,6 +133,7 @@ void LegacyUpdate::fmllibsFinished()
 		setStatus(tr("Copying FML libraries into the instance..."));
 		LegacyInstance *inst = (LegacyInstance *)m_inst;
 		auto metacache = ENV.metacache();
+		auto store = ENV.libraryStore();
 		int index = 0;
 		for (auto &lib : fmlLibsToProcess)
 		{
@@ -142,8 +145,14 @@ void LegacyUpdate::fmllibsFinished()
 				emitFailed(tr("Failed creating FML library folder inside the instance."));
 				return;
 			}
-			if (!QFile::copy(entry->getFullPath(), PathCombine(inst->libDir(), lib.filename)))
+			// linked to the one stored copy where possible, copied otherwise
+			QString error;
+			bool placed = store ? store->place(entry->getFullPath(), path, &error)
+								: QFile::copy(entry->getFullPath(), path);
+			if (!placed)
 			{
+				if (!error.isEmpty())
+					qWarning() << error;
 				emitFailed(tr("Failed copying Forge/FML library: %1.").arg(lib.filename));
 				return;
 			}
@@ -372,6 +381,7 @@ void LegacyUpdate::jarStart()
 	QString urlstr = "http://" + URLConstants::AWS_DOWNLOAD_VERSIONS + localPath;
 
 	auto dljob = new NetJob("Minecraft.jar for version " + version_id);
+	dljob->setPriority(Priority_Launch);
 
 	auto metacache = ENV.metacache();
 	auto entry = metacache->resolveEntry("versions", localPath);
@@ -0,0 +1,117 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LibraryDedupeTask.h"
+
+#include <QFile>
+#include <QSet>
+#include <QtConcurrentRun>
+#include <pathutils.h>
+
+#include "InstanceList.h"
+#include "minecraft/LegacyInstance.h"
+#include "minecraft/OneSixInstance.h"
+#include "minecraft/VersionFilterData.h"
+
+LibraryDedupeTask::LibraryDedupeTask(LibraryStorePtr store, const QStringList &files,
+									 QObject *parent)
+	: Task(parent), m_store(store), m_files(files)
+{
+	connect(&m_watcher, SIGNAL(finished()), SLOT(workFinished()));
+}
+
+QStringList LibraryDedupeTask::fmlLibraries(std::shared_ptr<InstanceList> instances)
+{
+	QSet<QString> names;
+	for (auto &libs : g_VersionFilterData.fmlLibsMapping)
+	{
+		for (auto &lib : libs)
+		{
+			names.insert(lib.filename);
+		}
+	}
+	QStringList files;
+	for (int i = 0; i < instances->count(); i++)
+	{
+		auto instance = instances->at(i);
+		QString libDir;
+		if (auto legacy = std::dynamic_pointer_cast<LegacyInstance>(instance))
+			libDir = legacy->libDir();
+		else if (auto onesix = std::dynamic_pointer_cast<OneSixInstance>(instance))
+			libDir = onesix->libDir();
+		else
+			continue;
+		for (auto &name : names)
+		{
+			QString path = PathCombine(libDir, name);
+			if (QFile::exists(path))
+				files.append(path);
+		}
+	}
+	return files;
+}
+
+LibraryDedupeTask::Result LibraryDedupeTask::result() const
+{
+	return m_result;
+}
+
+void LibraryDedupeTask::executeTask()
+{
+	setStatus(tr("Deduplicating libraries..."));
+	m_watcher.setFuture(QtConcurrent::run(this, &LibraryDedupeTask::run));
+}
+
+LibraryDedupeTask::Result LibraryDedupeTask::run()
+{
+	// only touches the store and the result, everything else stays on the main thread
+	Result result;
+	int steps = m_files.size() + 1;
+	// damaged files go first - along with the instance files that share them, the next
+	// update downloads those again
+	result.verification = m_store->verify(m_files);
+	result.reclaimed += result.verification.freed;
+	emit progress(1, steps);
+	for (int i = 0; i < m_files.size(); i++)
+	{
+		if (!QFile::exists(m_files[i]))
+			continue;
+		result.files++;
+		QString error;
+		qint64 freed = m_store->dedupe(m_files[i], &error);
+		if (freed < 0)
+		{
+			result.errors.append(error);
+		}
+		else if (freed > 0)
+		{
+			result.linked++;
+			result.reclaimed += freed;
+		}
+		emit progress(i + 2, steps);
+	}
+	return result;
+}
+
+void LibraryDedupeTask::workFinished()
+{
+	m_result = m_watcher.result();
+	if (!m_result.errors.isEmpty())
+	{
+		emitFailed(m_result.errors.join("\n"));
+		return;
+	}
+	emitSucceeded();
+}
@@ -0,0 +1,68 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QFutureWatcher>
+#include <QStringList>
+#include <memory>
+
+#include "tasks/Task.h"
+#include "LibraryStore.h"
+
+class InstanceList;
+
+/**
+ * Moves library files that already exist in instances into the library store, replacing
+ * every copy of the same file with a link to the stored one. Checks the store first, so
+ * damaged files are not spread any further.
+ */
+class LibraryDedupeTask : public Task
+{
+	Q_OBJECT
+public:
+	struct Result
+	{
+		int files = 0;
+		/// files that were replaced by a link
+		int linked = 0;
+		/// bytes saved by linking and by cleaning up the store
+		qint64 reclaimed = 0;
+		LibraryStore::Verification verification;
+		QStringList errors;
+	};
+
+	LibraryDedupeTask(LibraryStorePtr store, const QStringList &files, QObject *parent = 0);
+
+	/// the FML libraries present in any of the instances
+	static QStringList fmlLibraries(std::shared_ptr<InstanceList> instances);
+
+	Result result() const;
+
+protected:
+	virtual void executeTask() override;
+
+private slots:
+	void workFinished();
+
+private:
+	Result run();
+
+private:
+	LibraryStorePtr m_store;
+	QStringList m_files;
+	QFutureWatcher<Result> m_watcher;
+	Result m_result;
+};
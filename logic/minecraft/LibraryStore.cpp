@@ -0,0 +1,328 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LibraryStore.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDirIterator>
+#include <QCryptographicHash>
+#include <QObject>
+#include <QDebug>
+#include <pathutils.h>
+
+#ifdef Q_OS_WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+namespace
+{
+struct FileIdentity
+{
+	bool valid = false;
+	quint64 device = 0;
+	quint64 index = 0;
+	int links = 0;
+};
+
+FileIdentity identify(const QString &path)
+{
+	FileIdentity id;
+#ifdef Q_OS_WIN32
+	HANDLE handle = CreateFileW((LPCWSTR)QDir::toNativeSeparators(path).utf16(), 0,
+								FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+								OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE)
+		return id;
+	BY_HANDLE_FILE_INFORMATION info;
+	if (GetFileInformationByHandle(handle, &info))
+	{
+		id.valid = true;
+		id.device = info.dwVolumeSerialNumber;
+		id.index = (quint64(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+		id.links = info.nNumberOfLinks;
+	}
+	CloseHandle(handle);
+#else
+	struct stat info;
+	if (::stat(QFile::encodeName(path).constData(), &info) == 0)
+	{
+		id.valid = true;
+		id.device = info.st_dev;
+		id.index = info.st_ino;
+		id.links = info.st_nlink;
+	}
+#endif
+	return id;
+}
+
+bool hardLink(const QString &from, const QString &to)
+{
+#ifdef Q_OS_WIN32
+	return CreateHardLinkW((LPCWSTR)QDir::toNativeSeparators(to).utf16(),
+						   (LPCWSTR)QDir::toNativeSeparators(from).utf16(), nullptr);
+#else
+	return ::link(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0;
+#endif
+}
+
+/// copy-on-write copy, for file systems like btrfs and XFS
+bool cloneFile(const QString &from, const QString &to)
+{
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+	int in = ::open(QFile::encodeName(from).constData(), O_RDONLY | O_CLOEXEC);
+	if (in < 0)
+		return false;
+	int out = ::open(QFile::encodeName(to).constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+					 0644);
+	if (out < 0)
+	{
+		::close(in);
+		return false;
+	}
+	bool ok = ::ioctl(out, FICLONE, in) == 0;
+	::close(in);
+	::close(out);
+	if (!ok)
+		QFile::remove(to);
+	return ok;
+#else
+	Q_UNUSED(from);
+	Q_UNUSED(to);
+	return false;
+#endif
+}
+}
+
+LibraryStore::LibraryStore(const QString &root) : m_root(root)
+{
+}
+
+QString LibraryStore::root() const
+{
+	return m_root;
+}
+
+QString LibraryStore::storedPath(const QString &sha1) const
+{
+	// a level of folders keeps the directories small
+	return PathCombine(m_root, sha1.left(2), sha1);
+}
+
+bool LibraryStore::place(const QString &source, const QString &target, QString *error,
+						 Method *method)
+{
+	QString sha1 = fileSha1(source);
+	if (sha1.isEmpty())
+	{
+		if (error)
+			*error = QObject::tr("Couldn't read %1").arg(source);
+		return false;
+	}
+	// copy, don't link - the source belongs to someone else
+	if (!store(source, sha1, false, error))
+		return false;
+	QString stored = storedPath(sha1);
+	Method used = Linked;
+	if (!sameFile(stored, target))
+	{
+		if (!ensureFilePathExists(target))
+		{
+			if (error)
+				*error = QObject::tr("Couldn't create the folder for %1").arg(target);
+			return false;
+		}
+		if (!put(stored, target, used, error))
+			return false;
+	}
+	// a stored file nothing links to only takes up space
+	if (used != Linked && linkCount(stored) == 1)
+	{
+		QFile::remove(stored);
+	}
+	if (method)
+		*method = used;
+	return true;
+}
+
+qint64 LibraryStore::dedupe(const QString &path, QString *error, QString *hash)
+{
+	QFileInfo info(path);
+	if (!info.isFile() || info.isSymLink())
+		return 0;
+	QString sha1 = fileSha1(path);
+	if (sha1.isEmpty())
+	{
+		if (error)
+			*error = QObject::tr("Couldn't read %1").arg(path);
+		return -1;
+	}
+	if (hash)
+		*hash = sha1;
+	// the first copy of a file can simply become the stored one
+	if (!store(path, sha1, true, error))
+		return -1;
+	QString stored = storedPath(sha1);
+	if (sameFile(stored, path))
+		return 0;
+	Method method;
+	if (!put(stored, path, method, error))
+		return -1;
+	return method == Copied ? 0 : info.size();
+}
+
+LibraryStore::Verification LibraryStore::verify(const QStringList &placed)
+{
+	Verification result;
+	QDirIterator iter(m_root, QDir::Files, QDirIterator::Subdirectories);
+	while (iter.hasNext())
+	{
+		QString path = iter.next();
+		QFileInfo info(path);
+		qint64 size = info.size();
+		// leftovers of an interrupted store()
+		if (info.fileName().endsWith(".part"))
+		{
+			if (QFile::remove(path))
+				result.freed += size;
+			continue;
+		}
+		result.checked++;
+		if (fileSha1(path) != info.fileName())
+		{
+			qWarning() << "Stored library" << path << "is damaged, removing it";
+			result.damaged.append(info.fileName());
+			for (auto &file : placed)
+			{
+				if (sameFile(path, file) && QFile::remove(file))
+					result.removed.append(file);
+			}
+			QFile::remove(path);
+			continue;
+		}
+		if (linkCount(path) == 1)
+		{
+			if (QFile::remove(path))
+			{
+				result.unused++;
+				result.freed += size;
+			}
+		}
+	}
+	return result;
+}
+
+QString LibraryStore::fileSha1(const QString &path)
+{
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return QString();
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	while (!file.atEnd())
+	{
+		QByteArray chunk = file.read(1 << 16);
+		if (chunk.isEmpty() && file.error() != QFile::NoError)
+			return QString();
+		hash.addData(chunk);
+	}
+	return QString::fromLatin1(hash.result().toHex());
+}
+
+bool LibraryStore::sameFile(const QString &first, const QString &second)
+{
+	auto a = identify(first);
+	auto b = identify(second);
+	return a.valid && b.valid && a.device == b.device && a.index == b.index;
+}
+
+int LibraryStore::linkCount(const QString &path)
+{
+	return identify(path).links;
+}
+
+bool LibraryStore::store(const QString &source, const QString &sha1, bool linkSource,
+						 QString *error)
+{
+	QString stored = storedPath(sha1);
+	if (QFile::exists(stored))
+		return true;
+	if (!ensureFilePathExists(stored))
+	{
+		if (error)
+			*error = QObject::tr("Couldn't create the library store in %1").arg(m_root);
+		return false;
+	}
+	// never leave a half written file under a hash name
+	QString temp = stored + ".part";
+	QFile::remove(temp);
+	bool ok = (linkSource && hardLink(source, temp)) || cloneFile(source, temp) ||
+			  QFile::copy(source, temp);
+	if (!ok || !QFile::rename(temp, stored))
+	{
+		QFile::remove(temp);
+		// somebody else may have stored it in the meantime
+		if (QFile::exists(stored))
+			return true;
+		if (error)
+			*error = QObject::tr("Couldn't store %1 in the library store").arg(source);
+		return false;
+	}
+	return true;
+}
+
+bool LibraryStore::put(const QString &stored, const QString &target, Method &method,
+					   QString *error)
+{
+	// build the new file next to the target so the target is never half written
+	QString temp = target + ".part";
+	QFile::remove(temp);
+	if (hardLink(stored, temp))
+		method = Linked;
+	else if (cloneFile(stored, temp))
+		method = Cloned;
+	else if (QFile::copy(stored, temp))
+		method = Copied;
+	else
+	{
+		if (error)
+			*error = QObject::tr("Couldn't copy %1 to %2").arg(stored, target);
+		return false;
+	}
+	if (QFile::exists(target) && !QFile::remove(target))
+	{
+		QFile::remove(temp);
+		if (error)
+			*error = QObject::tr("Couldn't replace %1").arg(target);
+		return false;
+	}
+	if (!QFile::rename(temp, target))
+	{
+		QFile::remove(temp);
+		if (error)
+			*error = QObject::tr("Couldn't move %1 into place").arg(target);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,94 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <memory>
+
+class LibraryStore;
+typedef std::shared_ptr<LibraryStore> LibraryStorePtr;
+
+/**
+ * Content addressed store of the library files that are copied into instances.
+ *
+ * Every distinct file is kept once, named by its SHA-1, and instances get a hard link to it -
+ * or a copy-on-write clone where the file system can do that but not hard links. When neither
+ * works, for example because the instance folder is on another drive, the file is copied.
+ *
+ * Hard linked files share their contents, so this is only meant for files nobody writes to,
+ * like the FML libraries of legacy Forge.
+ */
+class LibraryStore
+{
+public:
+	enum Method
+	{
+		Linked,
+		Cloned,
+		Copied
+	};
+
+	struct Verification
+	{
+		int checked = 0;
+		/// stored files that didn't match their hash and were removed
+		QStringList damaged;
+		/// files linked to a damaged stored file, removed with it
+		QStringList removed;
+		/// stored files no instance used anymore, removed
+		int unused = 0;
+		qint64 freed = 0;
+	};
+
+	explicit LibraryStore(const QString &root);
+
+	QString root() const;
+
+	/// where the file with the given hex SHA-1 is kept
+	QString storedPath(const QString &sha1) const;
+
+	/// Put the contents of `source` at `target`, sharing them with every other place the same
+	/// contents are at.
+	bool place(const QString &source, const QString &target, QString *error = nullptr,
+			   Method *method = nullptr);
+
+	/// Replace the file at `path` with the stored copy of its contents. Returns how many
+	/// bytes that saved, 0 if it was already stored or couldn't be linked, -1 on errors.
+	/// The SHA-1 of the file goes to `hash`.
+	qint64 dedupe(const QString &path, QString *error = nullptr, QString *hash = nullptr);
+
+	/// Check every stored file against its name, removing the damaged ones and the ones no
+	/// instance links to anymore. Those of the `placed` files that are links to a damaged file
+	/// share its contents, so they are removed too.
+	Verification verify(const QStringList &placed = QStringList());
+
+	/// hex SHA-1 of a file, empty if it can't be read
+	static QString fileSha1(const QString &path);
+	/// true if both paths are the same file on disk, for example two hard links to it
+	static bool sameFile(const QString &first, const QString &second);
+	/// number of hard links to a file, 0 if it doesn't exist
+	static int linkCount(const QString &path);
+
+private:
+	/// make sure the contents of `source` with the given hash are stored
+	bool store(const QString &source, const QString &sha1, bool linkSource, QString *error);
+	/// replace `target` with a link, clone or copy of `stored`
+	bool put(const QString &stored, const QString &target, Method &method, QString *error);
+
+private:
+	QString m_root;
+};
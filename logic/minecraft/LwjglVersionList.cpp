@@ -82,12 +82,15 @@ void LWJGLVersionList::loadList()
 	Q_ASSERT_X(!m_loading, "loadList", "list is already loading (m_loading is true)");
 
 	setLoading(true);
-	auto worker = ENV.qnam();
-	QNetworkRequest req(QUrl(RSS_URL));
-	req.setRawHeader("Accept", "application/rss+xml, text/xml, */*");
-	req.setRawHeader("User-Agent", "MultiMC/5.0 (Uncached)");
-	reply = worker->get(req);
-	connect(reply, SIGNAL(finished()), SLOT(netRequestComplete()));
+	auto entry = ENV.metacache()->resolveEntry("general", "lwjgl.rss");
+	// verify by poking the server.
+	entry->stale = true;
+	auto job = new NetJob("LWJGL version list");
+	job->addNetAction(m_listDownload = CacheDownload::make(QUrl(RSS_URL), entry));
+	m_listJob.reset(job);
+	connect(job, SIGNAL(succeeded()), SLOT(netRequestComplete()));
+	connect(job, SIGNAL(failed()), SLOT(netRequestFailed()));
+	job->start();
 }
 
 inline QDomElement getDomElementByTagName(QDomElement parent, QString tagname)
@@ -99,9 +102,23 @@ inline QDomElement getDomElementByTagName(QDomElement parent, QString tagname)
 		return QDomElement();
 }
 
+void LWJGLVersionList::netRequestFailed()
+{
+	failed("Failed to load LWJGL list. Network error.");
+	setLoading(false);
+}
+
 void LWJGLVersionList::netRequestComplete()
 {
-	if (reply->error() == QNetworkReply::NoError)
+	// the list we have came from the same feed
+	if (!m_listDownload->wasModified() && count())
+	{
+		finished();
+		setLoading(false);
+		return;
+	}
+	QFile listFile(m_listDownload->getTargetFilepath());
+	if (listFile.open(QIODevice::ReadOnly))
 	{
 		QRegExp lwjglRegex("lwjgl-(([0-9]\\.?)+)\\.zip");
 		Q_ASSERT_X(lwjglRegex.isValid(), "load LWJGL list", "LWJGL regex is invalid");
@@ -110,7 +127,7 @@ void LWJGLVersionList::netRequestComplete()
 
 		QString xmlErrorMsg;
 		int errorLine;
-		auto rawData = reply->readAll();
+		auto rawData = listFile.readAll();
 		if (!doc.setContent(rawData, false, &xmlErrorMsg, &errorLine))
 		{
 			failed("Failed to load LWJGL list. XML error: " + xmlErrorMsg + " at line " +
@@ -164,11 +181,10 @@ void LWJGLVersionList::netRequestComplete()
 	}
 	else
 	{
-		failed("Failed to load LWJGL list. Network error: " + reply->errorString());
+		failed("Failed to load LWJGL list. Can't open the downloaded feed.");
 	}
 
 	setLoading(false);
-	reply->deleteLater();
 }
 
 void LWJGLVersionList::failed(QString msg)
@@ -23,6 +23,7 @@
 
 #include "BaseVersion.h"
 #include "BaseVersionList.h"
+#include "net/NetJob.h"
 
 class LWJGLVersion;
 typedef std::shared_ptr<LWJGLVersion> PtrLWJGLVersion;
@@ -135,8 +136,8 @@ signals:
 private:
 	QList<PtrLWJGLVersion> m_vlist;
 
-	QNetworkReply *m_netReply;
-	QNetworkReply *reply;
+	NetJobPtr m_listJob;
+	CacheDownloadPtr m_listDownload;
 
 	bool m_loading;
 	bool m_errored;
@@ -151,4 +152,5 @@ private:
 private
 slots:
 	virtual void netRequestComplete();
+	void netRequestFailed();
 };
@@ -25,6 +25,13 @@ MinecraftInstance::MinecraftInstance(SettingsObjectPtr globalSettings, SettingsO
 	m_settings->registerOverride(globalSettings->getSetting("MinMemAlloc"));
 	m_settings->registerOverride(globalSettings->getSetting("MaxMemAlloc"));
 	m_settings->registerOverride(globalSettings->getSetting("PermGen"));
+
+	// Performance profile
+	m_settings->registerSetting("OverrideAutoTune", false);
+	m_settings->registerOverride(globalSettings->getSetting("AutoTuneJava"));
+	m_settings->registerOverride(globalSettings->getSetting("AutoTuneHeap"));
+	m_settings->registerOverride(globalSettings->getSetting("AutoTuneGC"));
+	m_settings->registerOverride(globalSettings->getSetting("AutoTuneJIT"));
 }
 
 QString MinecraftInstance::minecraftRoot() const
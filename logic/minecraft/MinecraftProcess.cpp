@@ -34,6 +34,7 @@
 // constructor
 MinecraftProcess::MinecraftProcess(MinecraftInstancePtr inst) : BaseProcess(inst)
 {
+	m_profile = PerformanceProfile::forInstance(inst, inst->extraArguments());
 }
 
 MinecraftProcess* MinecraftProcess::create(MinecraftInstancePtr inst)
@@ -139,13 +140,18 @@ QStringList MinecraftProcess::javaArguments() const
 					"minecraft.exe.heapdump");
 #endif
 
-	args << QString("-Xms%1m").arg(m_instance->settings().get("MinMemAlloc").toInt());
-	args << QString("-Xmx%1m").arg(m_instance->settings().get("MaxMemAlloc").toInt());
+	// the performance profile replaces the fixed memory settings if it picked a heap size
+	if (!m_profile.maxHeap())
+	{
+		args << QString("-Xms%1m").arg(m_instance->settings().get("MinMemAlloc").toInt());
+		args << QString("-Xmx%1m").arg(m_instance->settings().get("MaxMemAlloc").toInt());
+	}
 	auto permgen = m_instance->settings().get("PermGen").toInt();
 	if (permgen != 64)
 	{
 		args << QString("-XX:PermSize=%1m").arg(permgen);
 	}
+	args.append(m_profile.arguments());
 	args << "-Duser.language=en";
 	if (!m_nativeFolder.isEmpty())
 		args << QString("-Djava.library.path=%1").arg(m_nativeFolder);
@@ -171,6 +177,19 @@ void MinecraftProcess::arm()
 
 	QString JavaPath = m_instance->settings().get("JavaPath").toString();
 	emit log("Java path is:\n" + JavaPath + "\n\n");
+	if (m_profile.enabled())
+	{
+		QString profileLog = tr("Performance profile:\n");
+		for (auto &choice : m_profile.choices())
+		{
+			if (choice.args.isEmpty())
+				profileLog += QString("%1: skipped (%2)\n").arg(choice.name, choice.reason);
+			else
+				profileLog += QString("%1: %2 (%3)\n")
+								  .arg(choice.name, choice.args.join(' '), choice.reason);
+		}
+		emit log(profileLog + "\n");
+	}
 	QString allArgs = args.join(", ");
 	emit log("Java Arguments:\n[" + censorPrivateInfo(allArgs) + "]\n\n");
 
@@ -183,6 +202,7 @@ void MinecraftProcess::arm()
 	}
 
 	// instantiate the launcher part
+	TimelineScope phase(m_timeline, tr("Starting java"));
 	start(JavaPath, args);
 	if (!waitForStarted())
 	{
@@ -201,11 +221,18 @@ void MinecraftProcess::arm()
 
 void MinecraftProcess::launch()
 {
+	beginStartupPhase();
 	QString launchString("launch\n");
 	QByteArray bytes = launchString.toUtf8();
 	writeData(bytes.constData(), bytes.length());
 }
 
+bool MinecraftProcess::startupFinished(const QString &line)
+{
+	// printed by Minecraft right before it opens its window
+	return line.contains("LWJGL Version:");
+}
+
 void MinecraftProcess::abort()
 {
 	QString launchString("abort\n");
@@ -19,6 +19,7 @@
 
 #include <QString>
 #include "minecraft/MinecraftInstance.h"
+#include "minecraft/PerformanceProfile.h"
 #include "BaseProcess.h"
 
 /**
@@ -68,10 +69,13 @@ protected:
 	AuthSessionPtr m_session;
 	QString launchScript;
 	QString m_nativeFolder;
+	/// automatically chosen JVM flags, if enabled
+	PerformanceProfile m_profile;
 
 	virtual QMap<QString, QString> getVariables() const override;
 
 	QStringList javaArguments() const;
 	virtual QString censorPrivateInfo(QString in) override;
 	virtual MessageLevel::Enum guessLevel(const QString &message, MessageLevel::Enum defaultLevel) override;
+	virtual bool startupFinished(const QString &line) override;
 };
@@ -17,6 +17,7 @@
 #include <QDir>
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QSet>
 #include <pathutils.h>
 
 #include "minecraft/MinecraftProfile.h"
@@ -74,6 +75,9 @@ void MinecraftProfile::clear()
 	tweakers.clear();
 	jarMods.clear();
 	traits.clear();
+	m_librariesResolved = false;
+	m_activeNormalLibs.clear();
+	m_activeNativeLibs.clear();
 }
 
 void MinecraftProfile::clearPatches()
@@ -205,38 +209,49 @@ bool MinecraftProfile::revertToVanilla()
 	return false;
 }
 
-QList<std::shared_ptr<OneSixLibrary> > MinecraftProfile::getActiveNormalLibs()
+void MinecraftProfile::resolveLibraries()
 {
-	QList<std::shared_ptr<OneSixLibrary> > output;
+	m_activeNormalLibs.clear();
+	m_activeNativeLibs.clear();
+	QSet<QString> names;
 	for (auto lib : libraries)
 	{
-		if (lib->isActive() && !lib->isNative())
+		if (!lib->isActive())
 		{
-			for (auto other : output)
-			{
-				if (other->rawName() == lib->rawName())
-				{
-					qWarning() << "Multiple libraries with name" << lib->rawName() << "in library list!";
-					continue;
-				}
-			}
-			output.append(lib);
+			continue;
+		}
+		if (lib->isNative())
+		{
+			m_activeNativeLibs.append(lib);
+			continue;
+		}
+		QString name = lib->rawName();
+		if (names.contains(name))
+		{
+			qWarning() << "Multiple libraries with name" << name << "in library list!";
 		}
+		names.insert(name);
+		m_activeNormalLibs.append(lib);
 	}
-	return output;
+	m_librariesResolved = true;
+}
+
+QList<std::shared_ptr<OneSixLibrary> > MinecraftProfile::getActiveNormalLibs()
+{
+	if (!m_librariesResolved)
+	{
+		resolveLibraries();
+	}
+	return m_activeNormalLibs;
 }
 
 QList<std::shared_ptr<OneSixLibrary> > MinecraftProfile::getActiveNativeLibs()
 {
-	QList<std::shared_ptr<OneSixLibrary> > output;
-	for (auto lib : libraries)
+	if (!m_librariesResolved)
 	{
-		if (lib->isActive() && lib->isNative())
-		{
-			output.append(lib);
-		}
+		resolveLibraries();
 	}
-	return output;
+	return m_activeNativeLibs;
 }
 
 std::shared_ptr<MinecraftProfile> MinecraftProfile::fromJson(const QJsonObject &obj)
@@ -415,6 +430,8 @@ void MinecraftProfile::finalize()
 	};
 	finalizeArguments(vanillaMinecraftArguments, vanillaProcessArguments);
 	finalizeArguments(minecraftArguments, processArguments);
+	// the rules only depend on the OS, which doesn't change while we run
+	resolveLibraries();
 }
 
 void MinecraftProfile::installJarMods(QStringList selectedFiles)
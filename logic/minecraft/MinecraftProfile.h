@@ -88,10 +88,10 @@ public:
 	void finalize();
 
 public:
-	/// get all java libraries that belong to the classpath
+	/// get all java libraries that belong to the classpath. Resolved once per finalize().
 	QList<std::shared_ptr<OneSixLibrary>> getActiveNormalLibs();
 
-	/// get all native libraries that need to be available to the process
+	/// get all native libraries that need to be available to the process. Resolved once per finalize().
 	QList<std::shared_ptr<OneSixLibrary>> getActiveNativeLibs();
 
 	/// get file ID of the patch file at #
@@ -195,7 +195,16 @@ public: /* data */
 	}
 	*/
 	// QList<Rule> rules;
+private:
+	/// evaluate the library rules for this OS and remember the result
+	void resolveLibraries();
+
 private:
 	QList<ProfilePatchPtr> VersionPatches;
 	ProfileStrategy *m_strategy = nullptr;
+
+	/// the active libraries, split into java and native ones. Valid until the profile is cleared.
+	bool m_librariesResolved = false;
+	QList<OneSixLibraryPtr> m_activeNormalLibs;
+	QList<OneSixLibraryPtr> m_activeNativeLibs;
 };
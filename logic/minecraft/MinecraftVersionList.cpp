@@ -27,11 +27,10 @@
 #include "ParseUtils.h"
 #include "ProfileUtils.h"
 #include "VersionFilterData.h"
+#include "VersionIndex.h"
 
 #include <pathutils.h>
 
-static const char * localVersionCache = "versions/versions.dat";
-
 class MCVListLoadTask : public Task
 {
 	Q_OBJECT
@@ -45,9 +44,11 @@ public:
 protected
 slots:
 	void list_downloaded();
+	void list_failed();
 
 protected:
-	QNetworkReply *vlistReply;
+	NetJobPtr listJob;
+	CacheDownloadPtr listDownload;
 	MinecraftVersionList *m_list;
 	MinecraftVersion *m_currentStable;
 };
@@ -118,23 +119,104 @@ void MinecraftVersionList::sortInternal()
 	qSort(m_vlist.begin(), m_vlist.end(), cmpVersions);
 }
 
+namespace
+{
+const char *localVersionIndex = "versions/versions.idx";
+// the versions.dat file used to be a Qt binary JSON document. Converted once, then removed.
+const char *legacyVersionCache = "versions/versions.dat";
+
+const QByteArray indexKind = "minecraft";
+// bump when the fields change
+const quint32 indexLayout = 1;
+enum IndexField
+{
+	IndexId,
+	IndexType,
+	IndexReleaseTime,
+	IndexReleaseMs,
+	IndexReleaseOffset,
+	IndexUpdateTime,
+	IndexUpdateMs,
+	IndexUpdateOffset,
+	IndexFieldCount
+};
+
+QDateTime indexTime(const VersionIndexPtr &index, int row, int msField, int offsetField)
+{
+	return QDateTime::fromMSecsSinceEpoch(qint64(index->value(0, row, msField)),
+										  Qt::OffsetFromUTC,
+										  int(qint64(index->value(0, row, offsetField))));
+}
+}
+
 void MinecraftVersionList::loadCachedList()
 {
-	QFile localIndex(localVersionCache);
-	if (!localIndex.exists())
+	if (!QFile::exists(localVersionIndex))
 	{
+		if (QFile::exists(legacyVersionCache))
+		{
+			loadLegacyCachedList();
+		}
+		return;
+	}
+	QString error;
+	auto index = VersionIndex::open(localVersionIndex, indexKind, indexLayout, &error);
+	if (!index || index->tableCount() != 1 || index->fieldCount(0) != IndexFieldCount)
+	{
+		// the cache has gone bad or is from a different version of MultiMC... flush it.
+		qCritical() << "The minecraft version cache is unusable:" << error << "Flushing cache.";
+		QFile::remove(localVersionIndex);
 		return;
 	}
+	qDebug() << "Loading local version list.";
+	m_latestReleaseID = index->property("latestRelease");
+	m_latestSnapshotID = index->property("latestSnapshot");
+
+	QList<BaseVersionPtr> tempList;
+	for (int i = 0; i < index->recordCount(0); i++)
+	{
+		QString versionID = index->string(0, i, IndexId);
+		QString versionType = index->string(0, i, IndexType);
+		if (versionID.isEmpty() || versionType.isEmpty())
+		{
+			qCritical() << "The minecraft version cache contains a version without ID or type.";
+			continue;
+		}
+		if (g_VersionFilterData.legacyBlacklist.contains(versionID))
+		{
+			continue;
+		}
+		std::shared_ptr<MinecraftVersion> mcVersion(new MinecraftVersion());
+		mcVersion->m_name = mcVersion->m_descriptor = versionID;
+		mcVersion->m_releaseTimeString = index->string(0, i, IndexReleaseTime);
+		mcVersion->m_releaseTime = indexTime(index, i, IndexReleaseMs, IndexReleaseOffset);
+		mcVersion->m_updateTimeString = index->string(0, i, IndexUpdateTime);
+		mcVersion->m_updateTime = indexTime(index, i, IndexUpdateMs, IndexUpdateOffset);
+		if (mcVersion->m_releaseTime < g_VersionFilterData.legacyCutoffDate)
+		{
+			continue;
+		}
+		mcVersion->m_versionSource = Local;
+		mcVersion->download_url = "http://" + URLConstants::AWS_DOWNLOAD_VERSIONS + versionID + "/";
+		mcVersion->m_type = versionType;
+		tempList.append(mcVersion);
+	}
+	updateListData(tempList);
+	m_hasLocalIndex = true;
+}
+
+void MinecraftVersionList::loadLegacyCachedList()
+{
+	QFile localIndex(legacyVersionCache);
 	if (!localIndex.open(QIODevice::ReadOnly))
 	{
-		// FIXME: this is actually a very bad thing! How do we deal with this?
-		qCritical() << "The minecraft version cache can't be read.";
+		qCritical() << "The old minecraft version cache can't be read.";
 		return;
 	}
 	auto data = localIndex.readAll();
+	localIndex.close();
 	try
 	{
-		localIndex.close();
 		QJsonDocument jsonDoc = QJsonDocument::fromBinaryData(data);
 		if (jsonDoc.isNull())
 		{
@@ -144,12 +226,16 @@ void MinecraftVersionList::loadCachedList()
 	}
 	catch (MMCError &e)
 	{
-		// the cache has gone bad for some reason... flush it.
-		qCritical() << "The minecraft version cache is corrupted. Flushing cache.";
+		qCritical() << "The old minecraft version cache is corrupted. Flushing cache.";
 		localIndex.remove();
 		return;
 	}
 	m_hasLocalIndex = true;
+	qDebug() << "Converting the old minecraft version cache.";
+	if (saveCachedList())
+	{
+		localIndex.remove();
+	}
 }
 
 void MinecraftVersionList::loadBuiltinList()
@@ -352,7 +438,7 @@ BaseVersionPtr MinecraftVersionList::getLatestStable() const
 
 void MinecraftVersionList::updateListData(QList<BaseVersionPtr> versions)
 {
-	beginResetModel();
+	auto updated = m_vlist;
 	for (auto version : versions)
 	{
 		auto descr = version->descriptor();
@@ -360,7 +446,7 @@ void MinecraftVersionList::updateListData(QList<BaseVersionPtr> versions)
 		if (!m_lookup.contains(descr))
 		{
 			m_lookup[version->descriptor()] = version;
-			m_vlist.append(version);
+			updated.append(version);
 			continue;
 		}
 		auto orig = std::dynamic_pointer_cast<MinecraftVersion>(m_lookup[descr]);
@@ -375,8 +461,8 @@ void MinecraftVersionList::updateListData(QList<BaseVersionPtr> versions)
 		// alright, it's an update. put it inside the original, for further processing.
 		orig->upstreamUpdate = added;
 	}
-	sortInternal();
-	endResetModel();
+	qSort(updated.begin(), updated.end(), cmpVersions);
+	publishUpdate(m_vlist, updated);
 }
 
 inline QDomElement getDomElementByTagName(QDomElement parent, QString tagname)
@@ -392,29 +478,47 @@ MCVListLoadTask::MCVListLoadTask(MinecraftVersionList *vlist)
 {
 	m_list = vlist;
 	m_currentStable = NULL;
-	vlistReply = nullptr;
 }
 
 void MCVListLoadTask::executeTask()
 {
 	setStatus(tr("Loading instance version list..."));
-	auto worker = ENV.qnam();
-	vlistReply = worker->get(QNetworkRequest(
-		QUrl("http://" + URLConstants::AWS_DOWNLOAD_VERSIONS + "versions.json")));
-	connect(vlistReply, SIGNAL(finished()), this, SLOT(list_downloaded()));
+	auto entry = ENV.metacache()->resolveEntry("versions", "versions.json");
+	// verify by poking the server.
+	entry->stale = true;
+	auto job = new NetJob("Minecraft version list");
+	job->addNetAction(listDownload = CacheDownload::make(
+						  QUrl("http://" + URLConstants::AWS_DOWNLOAD_VERSIONS + "versions.json"),
+						  entry));
+	listJob.reset(job);
+	connect(listJob.get(), SIGNAL(succeeded()), SLOT(list_downloaded()));
+	connect(listJob.get(), SIGNAL(failed()), SLOT(list_failed()));
+	connect(listJob.get(), SIGNAL(progress(qint64, qint64)), SIGNAL(progress(qint64, qint64)));
+	listJob->start();
+}
+
+void MCVListLoadTask::list_failed()
+{
+	emitFailed(tr("Failed to load Minecraft main version list"));
 }
 
 void MCVListLoadTask::list_downloaded()
 {
-	if (vlistReply->error() != QNetworkReply::NoError)
+	// the list we already have came from the same file
+	if (m_list->m_loaded && !listDownload->wasModified())
 	{
-		vlistReply->deleteLater();
-		emitFailed("Failed to load Minecraft main version list" + vlistReply->errorString());
+		emitSucceeded();
 		return;
 	}
 
-	auto data = vlistReply->readAll();
-	vlistReply->deleteLater();
+	QFile listFile(listDownload->getTargetFilepath());
+	if (!listFile.open(QIODevice::ReadOnly))
+	{
+		emitFailed(tr("Failed to open the Minecraft main version list"));
+		return;
+	}
+	auto data = listFile.readAll();
+	listFile.close();
 	try
 	{
 		QJsonParseError jsonError;
@@ -526,59 +630,41 @@ std::shared_ptr<Task> MinecraftVersionList::createUpdateTask(QString version)
 	return std::shared_ptr<Task>(new MCVListVersionUpdateTask(this, version));
 }
 
-void MinecraftVersionList::saveCachedList()
+bool MinecraftVersionList::saveCachedList()
 {
-	// FIXME: throw.
-	if (!ensureFilePathExists(localVersionCache))
-		return;
-	QSaveFile tfile(localVersionCache);
-	if (!tfile.open(QIODevice::WriteOnly | QIODevice::Truncate))
-		return;
-	QJsonObject toplevel;
-	QJsonArray entriesArr;
+	VersionIndexWriter writer(indexKind, indexLayout);
+	int table = writer.addTable(IndexFieldCount);
 	for (auto version : m_vlist)
 	{
 		auto mcversion = std::dynamic_pointer_cast<MinecraftVersion>(version);
 		// do not save the remote versions.
 		if (mcversion->m_versionSource != Local)
 			continue;
-		QJsonObject entryObj;
-
-		entryObj.insert("id", mcversion->descriptor());
-		entryObj.insert("time", mcversion->m_updateTimeString);
-		entryObj.insert("releaseTime", mcversion->m_releaseTimeString);
-		entryObj.insert("type", mcversion->m_type);
-		entriesArr.append(entryObj);
+		QVector<quint64> fields(IndexFieldCount);
+		fields[IndexId] = writer.string(mcversion->descriptor());
+		fields[IndexType] = writer.string(mcversion->m_type);
+		fields[IndexReleaseTime] = writer.string(mcversion->m_releaseTimeString);
+		fields[IndexReleaseMs] = mcversion->m_releaseTime.toMSecsSinceEpoch();
+		fields[IndexReleaseOffset] = qint64(mcversion->m_releaseTime.offsetFromUtc());
+		fields[IndexUpdateTime] = writer.string(mcversion->m_updateTimeString);
+		fields[IndexUpdateMs] = mcversion->m_updateTime.toMSecsSinceEpoch();
+		fields[IndexUpdateOffset] = qint64(mcversion->m_updateTime.offsetFromUtc());
+		writer.addRecord(table, fields);
 	}
-	toplevel.insert("versions", entriesArr);
-
+	if (!m_latestReleaseID.isNull())
 	{
-		bool someLatest = false;
-		QJsonObject latestObj;
-		if(!m_latestReleaseID.isNull())
-		{
-			latestObj.insert("release", m_latestReleaseID);
-			someLatest = true;
-		}
-		if(!m_latestSnapshotID.isNull())
-		{
-			latestObj.insert("snapshot", m_latestSnapshotID);
-			someLatest = true;
-		}
-		if(someLatest)
-		{
-			toplevel.insert("latest", latestObj);
-		}
+		writer.setProperty("latestRelease", m_latestReleaseID);
 	}
-
-	QJsonDocument doc(toplevel);
-	QByteArray jsonData = doc.toBinaryData();
-	qint64 result = tfile.write(jsonData);
-	if (result == -1)
-		return;
-	if (result != jsonData.size())
-		return;
-	tfile.commit();
+	if (!m_latestSnapshotID.isNull())
+	{
+		writer.setProperty("latestSnapshot", m_latestSnapshotID);
+	}
+	if (!writer.save(localVersionIndex))
+	{
+		qCritical() << "Couldn't save the minecraft version cache.";
+		return false;
+	}
+	return true;
 }
 
 void MinecraftVersionList::finalizeUpdate(QString version)
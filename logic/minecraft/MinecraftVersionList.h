@@ -35,7 +35,8 @@ private:
 	void loadBuiltinList();
 	void loadMojangList(QJsonDocument jsonDoc, VersionSource source);
 	void loadCachedList();
-	void saveCachedList();
+	void loadLegacyCachedList();
+	bool saveCachedList();
 	void finalizeUpdate(QString version);
 public:
 	friend class MCVListLoadTask;
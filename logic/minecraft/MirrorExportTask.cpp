@@ -0,0 +1,183 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MirrorExportTask.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QSet>
+#include <QtConcurrentRun>
+#include <pathutils.h>
+
+#include "net/ArtifactMirror.h"
+#include "net/HttpMetaCache.h"
+#include "net/URLConstants.h"
+
+MirrorExportTask::MirrorExportTask(const QList<Artifact> &artifacts, const QString &destination,
+								   QObject *parent)
+	: Task(parent), m_artifacts(artifacts), m_destination(destination), m_aborted(false)
+{
+	connect(&m_watcher, SIGNAL(finished()), SLOT(workFinished()));
+}
+
+QList<MirrorExportTask::Artifact>
+MirrorExportTask::artifacts(const QList<InstancePtr> &instances,
+							std::shared_ptr<HttpMetaCache> cache, QStringList *problems)
+{
+	QList<Artifact> artifacts;
+	auto add = [&](QString base, QString path, QUrl url)
+	{
+		artifacts.append({QDir::cleanPath(PathCombine(cache->getBasePath(base), path)), url,
+						  false, QString()});
+	};
+	// the version lists, so versions can still be picked
+	add("versions", "versions.json",
+		QUrl("http://" + URLConstants::AWS_DOWNLOAD_VERSIONS + "versions.json"));
+	add("minecraftforge", "list.json", QUrl(URLConstants::FORGE_LEGACY_URL));
+	add("minecraftforge", "json", QUrl(URLConstants::FORGE_GRADLE_URL));
+	add("liteloader", "versions.json", QUrl(URLConstants::LITELOADER_URL));
+
+	InstanceFiles::loadProfiles(instances);
+	for (auto &file : InstanceFiles::gather(instances, cache, problems))
+	{
+		// local libraries don't come from anywhere a mirror could stand in for
+		if (!file.url.isEmpty())
+			artifacts.append(file);
+	}
+	return artifacts;
+}
+
+MirrorExportTask::Result MirrorExportTask::result() const
+{
+	return m_result;
+}
+
+void MirrorExportTask::abort()
+{
+	m_aborted = true;
+}
+
+void MirrorExportTask::executeTask()
+{
+	setStatus(tr("Copying files to the mirror..."));
+	m_watcher.setFuture(QtConcurrent::run(this, &MirrorExportTask::run));
+}
+
+MirrorExportTask::Result MirrorExportTask::run()
+{
+	Result result;
+	QDir destination(m_destination);
+	// the asset indexes are read here, they are big. Versions share most of their objects.
+	QList<Artifact> artifacts = m_artifacts;
+	QSet<QString> objects;
+	for (auto &artifact : m_artifacts)
+	{
+		if (artifact.objectsRoot.isEmpty() || !QFileInfo(artifact.source).isFile())
+			continue;
+		QList<Artifact> listed;
+		if (!InstanceFiles::assetObjects(artifact, &listed))
+		{
+			result.unreadableIndexes.append(artifact.source);
+			continue;
+		}
+		for (auto &object : listed)
+		{
+			if (objects.contains(object.source))
+				continue;
+			objects.insert(object.source);
+			artifacts.append(object);
+		}
+	}
+	int step = 0;
+	for (auto &artifact : artifacts)
+	{
+		if (m_aborted)
+		{
+			result.aborted = true;
+			return result;
+		}
+		emit progress(step++, artifacts.size());
+		if (!QFileInfo(artifact.source).isFile())
+		{
+			result.missing.append(artifact.source);
+			continue;
+		}
+		QString target = destination.absoluteFilePath(ArtifactMirror::treePath(artifact.url));
+		if (!exportFile(artifact, target, result))
+		{
+			result.errors.append(tr("Couldn't copy %1 to %2").arg(artifact.source, target));
+		}
+	}
+	emit progress(artifacts.size(), artifacts.size());
+	return result;
+}
+
+bool MirrorExportTask::exportFile(const Artifact &artifact, const QString &target,
+								  Result &result)
+{
+	QFileInfo source(artifact.source);
+	QFileInfo existing(target);
+	if (existing.isFile() && existing.lastModified() >= source.lastModified() &&
+		(artifact.binaryJson || existing.size() == source.size()))
+	{
+		result.keptFiles++;
+		return true;
+	}
+	if (!ensureFilePathExists(target))
+		return false;
+
+	if (artifact.binaryJson)
+	{
+		QFile file(artifact.source);
+		if (!file.open(QIODevice::ReadOnly))
+			return false;
+		QJsonDocument doc = QJsonDocument::fromBinaryData(file.readAll());
+		if (doc.isNull())
+			return false;
+		QByteArray data = doc.toJson();
+		QSaveFile out(target);
+		if (!out.open(QIODevice::WriteOnly) || out.write(data) != data.size() || !out.commit())
+			return false;
+		result.copiedFiles++;
+		result.copiedBytes += data.size();
+		return true;
+	}
+
+	if (existing.exists() && !QFile::remove(target))
+		return false;
+	if (!QFile::copy(artifact.source, target))
+		return false;
+	result.copiedFiles++;
+	result.copiedBytes += source.size();
+	return true;
+}
+
+void MirrorExportTask::workFinished()
+{
+	m_result = m_watcher.result();
+	if (m_result.aborted)
+	{
+		emitFailed(tr("Cancelled."));
+		return;
+	}
+	if (!m_result.errors.isEmpty())
+	{
+		emitFailed(m_result.errors.join("\n"));
+		return;
+	}
+	emitSucceeded();
+}
@@ -0,0 +1,89 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QFutureWatcher>
+#include <QStringList>
+#include <QUrl>
+#include <atomic>
+#include <memory>
+
+#include "tasks/Task.h"
+#include "minecraft/InstanceFiles.h"
+
+class HttpMetaCache;
+
+/**
+ * Builds a mirror tree (see ArtifactMirror) from the download cache, with everything the chosen
+ * instances need from the internet: the version lists, the game jars, libraries, assets and
+ * FML libraries. Put it on a web server or a shared folder and point MultiMC at it on
+ * machines without internet.
+ *
+ * Files that are in the mirror already and haven't changed since aren't copied again.
+ */
+class MirrorExportTask : public Task
+{
+	Q_OBJECT
+public:
+	/// version files in binary form go in as JSON, asset indexes bring the objects they list
+	typedef InstanceFiles::File Artifact;
+	struct Result
+	{
+		int copiedFiles = 0;
+		qint64 copiedBytes = 0;
+		/// up to date in the mirror already
+		int keptFiles = 0;
+		/// what wasn't in the cache - instances that were never updated, for example
+		QStringList missing;
+		/// asset indexes that couldn't be read, the objects they list weren't copied
+		QStringList unreadableIndexes;
+		QStringList errors;
+		bool aborted = false;
+	};
+
+	MirrorExportTask(const QList<Artifact> &artifacts, const QString &destination,
+					 QObject *parent = 0);
+
+	/// What the instances need from the internet, and where it is in the cache. Loads the
+	/// profiles of the instances that haven't loaded theirs yet. Instances whose files can't be
+	/// worked out are added to @p problems. The asset objects are only looked up when the task
+	/// runs.
+	static QList<Artifact> artifacts(const QList<InstancePtr> &instances,
+									 std::shared_ptr<HttpMetaCache> cache, QStringList *problems);
+
+	Result result() const;
+
+public
+slots:
+	virtual void abort() override;
+
+protected:
+	virtual void executeTask() override;
+
+private slots:
+	void workFinished();
+
+private:
+	Result run();
+	bool exportFile(const Artifact &artifact, const QString &target, Result &result);
+
+private:
+	QList<Artifact> m_artifacts;
+	QString m_destination;
+	std::atomic<bool> m_aborted;
+	QFutureWatcher<Result> m_watcher;
+	Result m_result;
+};
@@ -0,0 +1,136 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "minecraft/NativesCache.h"
+#include "MMCZip.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QCoreApplication>
+#include <QDebug>
+#include <pathutils.h>
+
+/// touched every time a folder is used, the garbage collector looks at its timestamp
+static const char *lastUsedMarker = ".lastused";
+
+NativesCache::NativesCache(QString root) : m_root(root)
+{
+}
+
+static bool touch(QString path)
+{
+	QFile marker(path);
+	if (!marker.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	marker.write(QByteArray::number(QDateTime::currentMSecsSinceEpoch()));
+	return true;
+}
+
+QString NativesCache::prepare(QString libraryRoot, const QList<OneSixLibraryPtr> &natives,
+							  QString arch)
+{
+	// hash everything that affects the result
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	QList<QPair<QString, QStringList>> jars;
+	for (auto native : natives)
+	{
+		QString storage = native->storagePath();
+		storage.replace("${arch}", arch);
+		QString jarPath = PathCombine(libraryRoot, storage);
+		QFile jar(jarPath);
+		if (!jar.open(QIODevice::ReadOnly))
+		{
+			qCritical() << "Native library" << jarPath << "is missing.";
+			return QString();
+		}
+		hash.addData(storage.toUtf8());
+		hash.addData(QCryptographicHash::hash(jar.readAll(), QCryptographicHash::Md5));
+		QStringList excludes = native->extract_excludes;
+		excludes.sort();
+		hash.addData(excludes.join('\n').toUtf8());
+		hash.addData("\0", 1);
+		jars.append(qMakePair(jarPath, native->extract_excludes));
+	}
+	QString key = hash.result().toHex();
+	QDir root(m_root);
+	QString target = root.absoluteFilePath(key);
+
+	if (!QFileInfo(PathCombine(target, lastUsedMarker)).exists())
+	{
+		// extract into a private folder and move it into place, so concurrent launches never
+		// see a half-extracted folder
+		QString temp =
+			root.absoluteFilePath(key + ".tmp" + QString::number(QCoreApplication::applicationPid()));
+		QDir(temp).removeRecursively();
+		if (!ensureFolderPathExists(temp))
+		{
+			qCritical() << "Couldn't create folder" << temp;
+			return QString();
+		}
+		for (auto &jar : jars)
+		{
+			qDebug() << "Extracting natives from" << jar.first;
+			if (!MMCZip::extractNatives(jar.first, temp, jar.second))
+			{
+				QDir(temp).removeRecursively();
+				return QString();
+			}
+		}
+		touch(PathCombine(temp, lastUsedMarker));
+		// a folder without the marker is a leftover of an interrupted garbage collection
+		if (QFileInfo(target).exists())
+		{
+			QDir(target).removeRecursively();
+		}
+		if (!root.rename(temp, target))
+		{
+			// somebody else was faster, use theirs.
+			QDir(temp).removeRecursively();
+			if (!QFileInfo(PathCombine(target, lastUsedMarker)).exists())
+			{
+				qCritical() << "Couldn't move natives into" << target;
+				return QString();
+			}
+		}
+	}
+	touch(PathCombine(target, lastUsedMarker));
+	return target;
+}
+
+void NativesCache::collectGarbage(int maxAgeDays, QString keep)
+{
+	QDir root(m_root);
+	auto cutoff = QDateTime::currentDateTime().addDays(-maxAgeDays);
+	for (auto entry : root.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot))
+	{
+		if (entry.absoluteFilePath() == QFileInfo(keep).absoluteFilePath())
+			continue;
+		// leftovers of interrupted extractions have no marker and only get a day
+		QFileInfo marker(PathCombine(entry.absoluteFilePath(), lastUsedMarker));
+		QDateTime lastUsed = marker.exists() ? marker.lastModified() : entry.lastModified();
+		auto entryCutoff = marker.exists() ? cutoff : QDateTime::currentDateTime().addDays(-1);
+		if (lastUsed >= entryCutoff)
+			continue;
+		qDebug() << "Removing unused natives" << entry.absoluteFilePath();
+		// drop the marker first, so a partially removed folder is never used again.
+		// files still loaded by a running game can't be removed on some systems, the rest
+		// of the folder will be picked up next time.
+		QFile::remove(marker.absoluteFilePath());
+		QDir(entry.absoluteFilePath()).removeRecursively();
+	}
+}
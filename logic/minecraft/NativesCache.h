@@ -0,0 +1,50 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QList>
+#include "minecraft/OneSixLibrary.h"
+
+/**
+ * Shared store of extracted native libraries.
+ *
+ * A set of native jars (with their extract excludes) is extracted once into a folder named
+ * after the hash of the jar contents and excludes. Every instance using the same set
+ * launches with that folder, instead of extracting the natives again on every launch.
+ *
+ * Folders that weren't used for a while are removed.
+ */
+class NativesCache
+{
+public:
+	explicit NativesCache(QString root);
+
+	/**
+	 * Make sure the natives are extracted and return the folder they are in.
+	 *
+	 * \param libraryRoot folder the library storage paths are relative to
+	 * \param arch '32' or '64', replaces ${arch} in library paths
+	 * \return the folder or an empty string on failure
+	 */
+	QString prepare(QString libraryRoot, const QList<OneSixLibraryPtr> &natives, QString arch);
+
+	/// remove folders not used in the last `maxAgeDays` days, except for `keep`
+	void collectGarbage(int maxAgeDays, QString keep = QString());
+
+private:
+	QString m_root;
+};
@@ -25,6 +25,9 @@
 #include "minecraft/VersionBuildError.h"
 #include "minecraft/MinecraftProcess.h"
 #include "minecraft/OneSixProfileStrategy.h"
+#include "minecraft/NativesCache.h"
+#include "minecraft/LaunchFingerprint.h"
+#include "java/JavaCheckCache.h"
 #include "MMCZip.h"
 
 #include "minecraft/AssetsUtils.h"
@@ -62,6 +65,11 @@ std::shared_ptr<Task> OneSixInstance::doUpdate()
 	return std::shared_ptr<Task>(new OneSixUpdate(this));
 }
 
+void OneSixInstance::requestFullUpdate()
+{
+	LaunchFingerprint::clear(this);
+}
+
 QString replaceTokensIn(QString text, QMap<QString, QString> with)
 {
 	QString result;
@@ -124,6 +132,35 @@ QStringList OneSixInstance::processMinecraftArgs(AuthSessionPtr session)
 	return parts;
 }
 
+QString OneSixInstance::prepareNatives(const QList<OneSixLibraryPtr> &natives)
+{
+	bool needsArch = false;
+	for (auto native : natives)
+	{
+		if (native->storagePath().contains("${arch}"))
+			needsArch = true;
+	}
+	// the arch is only known if the java was checked before
+	QString arch = "64";
+	if (needsArch)
+	{
+		JavaCheckResult java;
+		auto cache = ENV.javaCheckCache();
+		if (!cache || !cache->lookup(settings().get("JavaPath").toString(), java) || !java.valid)
+		{
+			return QString();
+		}
+		arch = java.mojangPlatform;
+	}
+	NativesCache cache(QDir("natives").absolutePath());
+	auto folder = cache.prepare(librariesPath().absolutePath(), natives, arch);
+	if (!folder.isEmpty())
+	{
+		cache.collectGarbage(30, folder);
+	}
+	return folder;
+}
+
 BaseProcess *OneSixInstance::prepareForLaunch(AuthSessionPtr session)
 {
 	QString launchScript;
@@ -188,13 +225,23 @@ BaseProcess *OneSixInstance::prepareForLaunch(AuthSessionPtr session)
 
 	// native libraries (mostly LWJGL)
 	{
-		QDir natives_dir(PathCombine(instanceRoot(), "natives/"));
-		for (auto native : m_version->getActiveNativeLibs())
+		auto natives = m_version->getActiveNativeLibs();
+		QString cachedNatives = prepareNatives(natives);
+		if (!cachedNatives.isEmpty())
+		{
+			launchScript += "natives " + cachedNatives + "\n";
+		}
+		else
 		{
-			QFileInfo finfo(PathCombine("libraries", native->storagePath()));
-			launchScript += "ext " + finfo.absoluteFilePath() + "\n";
+			// let the launcher extract them into the instance
+			QDir natives_dir(PathCombine(instanceRoot(), "natives/"));
+			for (auto native : natives)
+			{
+				QFileInfo finfo(PathCombine("libraries", native->storagePath()));
+				launchScript += "ext " + finfo.absoluteFilePath() + "\n";
+			}
+			launchScript += "natives " + natives_dir.absolutePath() + "\n";
 		}
-		launchScript += "natives " + natives_dir.absolutePath() + "\n";
 	}
 
 	// traits. including legacyLaunch and others ;)
@@ -305,14 +352,17 @@ void OneSixInstance::reloadProfile()
 	try
 	{
 		m_version->reload();
+		m_profileComplete = true;
 		unsetFlag(VersionBrokenFlag);
 		emit versionReloaded();
 	}
 	catch (VersionIncomplete &error)
 	{
+		m_profileComplete = false;
 	}
 	catch (MMCError &error)
 	{
+		m_profileComplete = false;
 		m_version->clear();
 		setFlag(VersionBrokenFlag);
 		// TODO: rethrow to show some error message(s)?
@@ -323,6 +373,7 @@ void OneSixInstance::reloadProfile()
 
 void OneSixInstance::clearProfile()
 {
+	m_profileComplete = false;
 	m_version->clear();
 	emit versionReloaded();
 }
@@ -332,6 +383,11 @@ std::shared_ptr<MinecraftProfile> OneSixInstance::getMinecraftProfile() const
 	return m_version;
 }
 
+bool OneSixInstance::profileComplete() const
+{
+	return m_profileComplete;
+}
+
 QString OneSixInstance::getStatusbarDescription()
 {
 	QStringList traits;
@@ -49,6 +49,7 @@ public:
 	virtual QString instanceConfigFolder() const override;
 
 	virtual std::shared_ptr<Task> doUpdate() override;
+	virtual void requestFullUpdate() override;
 	virtual BaseProcess *prepareForLaunch(AuthSessionPtr account) override;
 
 	virtual void cleanupAfterRun() override;
@@ -74,6 +75,10 @@ public:
 	/// get the current full version info
 	std::shared_ptr<MinecraftProfile> getMinecraftProfile() const;
 
+	/// false if the profile wasn't loaded in full - a part of it may be missing until the
+	/// version lists are loaded or the instance is updated
+	bool profileComplete() const;
+
 	virtual QString getStatusbarDescription() override;
 
 	virtual QDir jarmodsPath() const;
@@ -92,9 +97,12 @@ signals:
 
 private:
 	QStringList processMinecraftArgs(AuthSessionPtr account);
+	/// extract the natives into the shared natives cache. Returns the folder or an empty string.
+	QString prepareNatives(const QList<OneSixLibraryPtr> &natives);
 
 protected:
 	std::shared_ptr<MinecraftProfile> m_version;
+	bool m_profileComplete = false;
 	mutable std::shared_ptr<ModList> m_loader_mod_list;
 	mutable std::shared_ptr<ModList> m_core_mod_list;
 	mutable std::shared_ptr<ModList> m_resource_pack_list;
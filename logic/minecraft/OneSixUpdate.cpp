@@ -22,6 +22,7 @@
 #include <QFileInfo>
 #include <QTextStream>
 #include <QDataStream>
+#include <QtConcurrentRun>
 #include <pathutils.h>
 #include <JlCompress.h>
 
@@ -30,6 +31,8 @@
 #include "minecraft/MinecraftProfile.h"
 #include "minecraft/OneSixLibrary.h"
 #include "minecraft/OneSixInstance.h"
+#include "minecraft/LaunchFingerprint.h"
+#include "minecraft/LibraryStore.h"
 #include "forge/ForgeMirrors.h"
 #include "net/URLConstants.h"
 #include "minecraft/AssetsUtils.h"
@@ -37,6 +40,7 @@
 
 OneSixUpdate::OneSixUpdate(OneSixInstance *inst, QObject *parent) : Task(parent), m_inst(inst)
 {
+	connect(&m_jarModsWatcher, SIGNAL(finished()), SLOT(jarModsFinished()));
 }
 
 void OneSixUpdate::executeTask()
@@ -61,6 +65,12 @@ void OneSixUpdate::executeTask()
 	if (m_inst->providesVersionFile() || !targetVersion->needsUpdate())
 	{
 		qDebug() << "Instance either provides a version file or doesn't need an update.";
+		if (isReadyToLaunch())
+		{
+			qDebug() << m_inst->name() << "is unchanged since the last update, skipping it.";
+			emitSucceeded();
+			return;
+		}
 		jarlibStart();
 		return;
 	}
@@ -71,6 +81,7 @@ void OneSixUpdate::executeTask()
 		jarlibStart();
 		return;
 	}
+	versionUpdateTask->setTimeline(m_timeline);
 	connect(versionUpdateTask.get(), SIGNAL(succeeded()), SLOT(jarlibStart()));
 	connect(versionUpdateTask.get(), SIGNAL(failed(QString)), SLOT(versionUpdateFailed(QString)));
 	connect(versionUpdateTask.get(), SIGNAL(progress(qint64, qint64)),
@@ -79,11 +90,88 @@ void OneSixUpdate::executeTask()
 	versionUpdateTask->start();
 }
 
+bool OneSixUpdate::isReadyToLaunch()
+{
+	auto stored = LaunchFingerprint::stored(m_inst);
+	if (stored.isEmpty())
+	{
+		return false;
+	}
+	try
+	{
+		m_inst->reloadProfile();
+	}
+	catch (...)
+	{
+		return false;
+	}
+	return LaunchFingerprint::compute(m_inst) == stored;
+}
+
 void OneSixUpdate::versionUpdateFailed(QString reason)
 {
 	emitFailed(reason);
 }
 
+QList<QPair<QString, QString>> OneSixUpdate::libraryFiles(std::shared_ptr<OneSixLibrary> lib)
+{
+	QString raw_storage = lib->storagePath();
+	QString raw_dl = lib->downloadUrl();
+	QList<QPair<QString, QString>> files;
+	if (raw_storage.contains("${arch}"))
+	{
+		for (auto arch : {"32", "64"})
+		{
+			QString cooked_storage = raw_storage;
+			QString cooked_dl = raw_dl;
+			files.append(qMakePair(cooked_storage.replace("${arch}", arch),
+								   cooked_dl.replace("${arch}", arch)));
+		}
+	}
+	else
+	{
+		files.append(qMakePair(raw_storage, raw_dl));
+	}
+	return files;
+}
+
+QList<CacheDownloadPtr> OneSixUpdate::sharedDownloads(OneSixInstance *inst)
+{
+	QList<CacheDownloadPtr> downloads;
+	auto metacache = ENV.metacache();
+	auto add = [&](QString base, QString path, QUrl url)
+	{
+		auto entry = metacache->resolveEntry(base, path);
+		if (entry->stale)
+			downloads.append(CacheDownload::make(url, entry));
+	};
+	std::shared_ptr<MinecraftProfile> version = inst->getMinecraftProfile();
+
+	QString jarPath = version->id + "/" + version->id + ".jar";
+	add("versions", jarPath, QUrl("http://" + URLConstants::AWS_DOWNLOAD_VERSIONS + jarPath));
+
+	auto libs = version->getActiveNativeLibs();
+	libs.append(version->getActiveNormalLibs());
+	for (auto lib : libs)
+	{
+		// local libraries aren't downloaded, packed Forge ones come from the Forge mirrors
+		if (lib->hint() == "local" || (lib->hint() == "forge-pack-xz" && !ENV.artifactMirror()))
+			continue;
+		for (auto file : libraryFiles(lib))
+		{
+			add("libraries", file.first, QUrl(file.second));
+		}
+	}
+
+	if (!version->assets.isEmpty())
+	{
+		QString indexPath = version->assets + ".json";
+		add("asset_indexes", indexPath,
+			QUrl("http://" + URLConstants::AWS_DOWNLOAD_INDEXES + indexPath));
+	}
+	return downloads;
+}
+
 void OneSixUpdate::assetIndexStart()
 {
 	setStatus(tr("Updating assets index..."));
@@ -93,11 +181,13 @@ void OneSixUpdate::assetIndexStart()
 	QUrl indexUrl = "http://" + URLConstants::AWS_DOWNLOAD_INDEXES + assetName + ".json";
 	QString localPath = assetName + ".json";
 	auto job = new NetJob(tr("Asset index for %1").arg(inst->name()));
+	job->setPriority(Priority_Launch);
 
 	auto metacache = ENV.metacache();
 	auto entry = metacache->resolveEntry("asset_indexes", localPath);
 	job->addNetAction(CacheDownload::make(indexUrl, entry));
 	jarlibDownloadJob.reset(job);
+	jarlibDownloadJob->setTimeline(m_timeline);
 
 	connect(jarlibDownloadJob.get(), SIGNAL(succeeded()), SLOT(assetIndexFinished()));
 	connect(jarlibDownloadJob.get(), SIGNAL(failed()), SLOT(assetIndexFailed()));
@@ -116,43 +206,55 @@ void OneSixUpdate::assetIndexFinished()
 	QString assetName = version->assets;
 
 	QString asset_fname = "assets/indexes/" + assetName + ".json";
+	auto metacache = ENV.metacache();
+	auto indexEntry = metacache->resolveEntry("asset_indexes", assetName + ".json");
 	if (!AssetsUtils::loadAssetsIndexJson(asset_fname, &index))
 	{
-		auto metacache = ENV.metacache();
-		auto entry = metacache->resolveEntry("asset_indexes", assetName + ".json");
-		metacache->evictEntry(entry);
+		metacache->evictEntry(indexEntry);
 		emitFailed(tr("Failed to read the assets index!"));
+		return;
 	}
 
-	QList<Md5EtagDownloadPtr> dls;
-	for (auto object : index.objects.values())
+	// an interrupted download of the same index goes on without looking at every object again
+	QString journalId = "assets-" + inst->id();
+	QString journalContext = assetName + ":" + indexEntry->md5sum;
+	NetJobPtr job = NetJob::resume(journalId, journalContext);
+	if (!job)
 	{
-		QString objectName = object.hash.left(2) + "/" + object.hash;
-		QFileInfo objectFile("assets/objects/" + objectName);
-		if ((!objectFile.isFile()) || (objectFile.size() != object.size))
+		QList<Md5EtagDownloadPtr> dls;
+		for (auto object : index.objects.values())
 		{
-			auto objectDL = MD5EtagDownload::make(
-				QUrl("http://" + URLConstants::RESOURCE_BASE + objectName),
-				objectFile.filePath());
-			objectDL->m_total_progress = object.size;
-			dls.append(objectDL);
+			QString objectName = object.hash.left(2) + "/" + object.hash;
+			QFileInfo objectFile("assets/objects/" + objectName);
+			if ((!objectFile.isFile()) || (objectFile.size() != object.size))
+			{
+				auto objectDL = MD5EtagDownload::make(
+					QUrl("http://" + URLConstants::RESOURCE_BASE + objectName),
+					objectFile.filePath());
+				objectDL->m_total_progress = object.size;
+				dls.append(objectDL);
+			}
 		}
-	}
-	if (dls.size())
-	{
-		setStatus(tr("Getting the assets files from Mojang..."));
-		auto job = new NetJob(tr("Assets for %1").arg(inst->name()));
+		if (!dls.size())
+		{
+			NetJob::discardJournal(journalId);
+			assetsFinished();
+			return;
+		}
+		job.reset(new NetJob(tr("Assets for %1").arg(inst->name())));
 		for (auto dl : dls)
 			job->addNetAction(dl);
-		jarlibDownloadJob.reset(job);
-		connect(jarlibDownloadJob.get(), SIGNAL(succeeded()), SLOT(assetsFinished()));
-		connect(jarlibDownloadJob.get(), SIGNAL(failed()), SLOT(assetsFailed()));
-		connect(jarlibDownloadJob.get(), SIGNAL(progress(qint64, qint64)),
-				SIGNAL(progress(qint64, qint64)));
-		jarlibDownloadJob->start();
-		return;
+		job->setJournal(journalId, journalContext);
 	}
-	assetsFinished();
+	setStatus(tr("Getting the assets files from Mojang..."));
+	job->setPriority(Priority_Launch);
+	jarlibDownloadJob = job;
+	jarlibDownloadJob->setTimeline(m_timeline);
+	connect(jarlibDownloadJob.get(), SIGNAL(succeeded()), SLOT(assetsFinished()));
+	connect(jarlibDownloadJob.get(), SIGNAL(failed()), SLOT(assetsFailed()));
+	connect(jarlibDownloadJob.get(), SIGNAL(progress(qint64, qint64)),
+			SIGNAL(progress(qint64, qint64)));
+	jarlibDownloadJob->start();
 }
 
 void OneSixUpdate::assetIndexFailed()
@@ -162,6 +264,8 @@ void OneSixUpdate::assetIndexFailed()
 
 void OneSixUpdate::assetsFinished()
 {
+	// everything is in place now, the next update can be skipped if nothing changes
+	LaunchFingerprint::store(m_inst, LaunchFingerprint::compute(m_inst));
 	emitSucceeded();
 }
 
@@ -199,6 +303,7 @@ void OneSixUpdate::jarlibStart()
 		QString urlstr = "http://" + URLConstants::AWS_DOWNLOAD_VERSIONS + localPath;
 
 		auto job = new NetJob(tr("Libraries for instance %1").arg(inst->name()));
+		job->setPriority(Priority_Launch);
 
 		auto metacache = ENV.metacache();
 		auto entry = metacache->resolveEntry("versions", localPath);
@@ -224,36 +329,22 @@ void OneSixUpdate::jarlibStart()
 			continue;
 		}
 
-		QString raw_storage = lib->storagePath();
-		QString raw_dl = lib->downloadUrl();
-
-		auto f = [&](QString storage, QString dl)
+		for (auto file : libraryFiles(lib))
 		{
+			QString storage = file.first;
 			auto entry = metacache->resolveEntry("libraries", storage);
 			if (entry->stale)
 			{
-				if (lib->hint() == "forge-pack-xz")
+				// a local mirror has the plain jars, the Forge mirrors aren't asked then
+				if (lib->hint() == "forge-pack-xz" && !ENV.artifactMirror())
 				{
 					ForgeLibs.append(ForgeXzDownload::make(storage, entry));
 				}
 				else
 				{
-					jarlibDownloadJob->addNetAction(CacheDownload::make(dl, entry));
+					jarlibDownloadJob->addNetAction(CacheDownload::make(file.second, entry));
 				}
 			}
-		};
-		if (raw_storage.contains("${arch}"))
-		{
-			QString cooked_storage = raw_storage;
-			QString cooked_dl = raw_dl;
-			f(cooked_storage.replace("${arch}", "32"), cooked_dl.replace("${arch}", "32"));
-			cooked_storage = raw_storage;
-			cooked_dl = raw_dl;
-			f(cooked_storage.replace("${arch}", "64"), cooked_dl.replace("${arch}", "64"));
-		}
-		else
-		{
-			f(raw_storage, raw_dl);
 		}
 	}
 	if (!brokenLocalLibs.empty())
@@ -279,6 +370,7 @@ void OneSixUpdate::jarlibStart()
 			ForgeMirrors::make(ForgeLibs, jarlibDownloadJob, forgeMirrorList));
 	}
 
+	jarlibDownloadJob->setTimeline(m_timeline);
 	connect(jarlibDownloadJob.get(), SIGNAL(succeeded()), SLOT(jarlibFinished()));
 	connect(jarlibDownloadJob.get(), SIGNAL(failed()), SLOT(jarlibFailed()));
 	connect(jarlibDownloadJob.get(), SIGNAL(progress(qint64, qint64)),
@@ -315,18 +407,39 @@ void OneSixUpdate::jarlibFinished()
 	auto jarMods = inst->getJarMods();
 	if(jarMods.size())
 	{
-		auto sourceJarPath = m_inst->versionsPath().absoluteFilePath(version->id + "/" + version->id + ".jar");
-		QString localPath = version_id + "/" + version_id + ".jar";
-		auto metacache = ENV.metacache();
-		auto entry = metacache->resolveEntry("versions", localPath);
-		QString fullJarPath = entry->getFullPath();
-		if(!MMCZip::createModdedJar(sourceJarPath, finalJarPath, jarMods))
+		setStatus(tr("Creating the custom Minecraft jar file..."));
+		if (m_timeline)
 		{
-			emitFailed(tr("Failed to create the custom Minecraft jar file."));
-			return;
+			m_jarModsPhase = m_timeline->begin(tr("Jar mods"));
 		}
+		auto sourceJarPath = m_inst->versionsPath().absoluteFilePath(version->id + "/" + version->id + ".jar");
+		// in the background - a batch update builds the jars of several instances at once
+		m_jarModsWatcher.setFuture(
+			QtConcurrent::run(MMCZip::createModdedJar, sourceJarPath, finalJarPath, jarMods));
+		return;
 	}
-	if (version->traits.contains("legacyFML"))
+	fmllibsOrAssetsStart();
+}
+
+void OneSixUpdate::jarModsFinished()
+{
+	auto finalJarPath = QDir(m_inst->instanceRoot()).absoluteFilePath("temp.jar");
+	if (m_timeline)
+	{
+		m_timeline->end(m_jarModsPhase, QFileInfo(finalJarPath).size(), 1);
+	}
+	if (!m_jarModsWatcher.result())
+	{
+		emitFailed(tr("Failed to create the custom Minecraft jar file."));
+		return;
+	}
+	fmllibsOrAssetsStart();
+}
+
+void OneSixUpdate::fmllibsOrAssetsStart()
+{
+	OneSixInstance *inst = (OneSixInstance *)m_inst;
+	if (inst->getMinecraftProfile()->traits.contains("legacyFML"))
 	{
 		fmllibsStart();
 	}
@@ -390,6 +503,7 @@ void OneSixUpdate::fmllibsStart()
 	// download missing libs to our place
 	setStatus(tr("Dowloading FML libraries..."));
 	auto dljob = new NetJob("FML libraries");
+	dljob->setPriority(Priority_Launch);
 	auto metacache = ENV.metacache();
 	for (auto &lib : fmlLibsToProcess)
 	{
@@ -399,6 +513,7 @@ void OneSixUpdate::fmllibsStart()
 		dljob->addNetAction(CacheDownload::make(QUrl(urlString), entry));
 	}
 
+	dljob->setTimeline(m_timeline);
 	connect(dljob, SIGNAL(succeeded()), SLOT(fmllibsFinished()));
 	connect(dljob, SIGNAL(failed()), SLOT(fmllibsFailed()));
 	connect(dljob, SIGNAL(progress(qint64, qint64)), SIGNAL(progress(qint64, qint64)));
@@ -412,8 +527,10 @@ void OneSixUpdate::fmllibsFinished()
 	if (!fmlLibsToProcess.isEmpty())
 	{
 		setStatus(tr("Copying FML libraries into the instance..."));
+		TimelineScope phase(m_timeline, tr("Copying FML libraries"));
 		OneSixInstance *inst = (OneSixInstance *)m_inst;
 		auto metacache = ENV.metacache();
+		auto store = ENV.libraryStore();
 		int index = 0;
 		for (auto &lib : fmlLibsToProcess)
 		{
@@ -425,11 +542,18 @@ void OneSixUpdate::fmllibsFinished()
 				emitFailed(tr("Failed creating FML library folder inside the instance."));
 				return;
 			}
-			if (!QFile::copy(entry->getFullPath(), PathCombine(inst->libDir(), lib.filename)))
+			// linked to the one stored copy where possible, copied otherwise
+			QString error;
+			bool placed = store ? store->place(entry->getFullPath(), path, &error)
+								: QFile::copy(entry->getFullPath(), path);
+			if (!placed)
 			{
+				if (!error.isEmpty())
+					qWarning() << error;
 				emitFailed(tr("Failed copying Forge/FML library: %1.").arg(lib.filename));
 				return;
 			}
+			phase.addFile(QFileInfo(entry->getFullPath()).size());
 			index++;
 		}
 		progress(index, fmlLibsToProcess.size());
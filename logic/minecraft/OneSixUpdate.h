@@ -18,6 +18,8 @@
 #include <QObject>
 #include <QList>
 #include <QUrl>
+#include <QPair>
+#include <QFutureWatcher>
 
 #include "net/NetJob.h"
 #include "tasks/Task.h"
@@ -26,6 +28,7 @@
 
 class MinecraftVersion;
 class OneSixInstance;
+class OneSixLibrary;
 
 class OneSixUpdate : public Task
 {
@@ -34,6 +37,14 @@ public:
 	explicit OneSixUpdate(OneSixInstance *inst, QObject *parent = 0);
 	virtual void executeTask();
 
+	/// The downloads of the files from Mojang the instance needs that aren't in the cache yet:
+	/// its jar, its plain libraries and its asset index. Other instances may need the same ones.
+	/// The profile of the instance has to be loaded.
+	static QList<CacheDownloadPtr> sharedDownloads(OneSixInstance *inst);
+
+	/// cache paths and URLs of a library - some come in a 32 and a 64 bit flavour
+	static QList<QPair<QString, QString>> libraryFiles(std::shared_ptr<OneSixLibrary> lib);
+
 private
 slots:
 	void versionUpdateFailed(QString reason);
@@ -42,6 +53,8 @@ slots:
 	void jarlibFinished();
 	void jarlibFailed();
 
+	void jarModsFinished();
+
 	void fmllibsStart();
 	void fmllibsFinished();
 	void fmllibsFailed();
@@ -53,6 +66,13 @@ slots:
 	void assetsFinished();
 	void assetsFailed();
 
+private:
+	/// true if nothing changed since the last successful update
+	bool isReadyToLaunch();
+
+	/// what comes after the jar: FML libraries for old Forge, then the assets
+	void fmllibsOrAssetsStart();
+
 private:
 	NetJobPtr jarlibDownloadJob;
 	NetJobPtr legacyDownloadJob;
@@ -65,4 +85,6 @@ private:
 	OneSixInstance *m_inst = nullptr;
 	QString jarHashOnEntry;
 	QList<FMLlib> fmlLibsToProcess;
+	QFutureWatcher<bool> m_jarModsWatcher;
+	int m_jarModsPhase = -1;
 };
@@ -0,0 +1,306 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "minecraft/PerformanceProfile.h"
+#include "java/JavaCheckCache.h"
+#include "Env.h"
+
+#include <QFile>
+#include <QDir>
+#include <QDirIterator>
+#include <QThread>
+#include <QRegularExpression>
+#include <pathutils.h>
+
+HardwareInfo HardwareInfo::probe()
+{
+	HardwareInfo info;
+	info.cores = qMax(1, QThread::idealThreadCount());
+
+#ifdef LINUX
+	QFile meminfo("/proc/meminfo");
+	if (meminfo.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		// MemTotal:        16307352 kB
+		for (auto line : QString::fromLatin1(meminfo.readAll()).split('\n'))
+		{
+			if (!line.startsWith("MemTotal:"))
+				continue;
+			auto parts = line.split(' ', QString::SkipEmptyParts);
+			if (parts.size() >= 2)
+				info.physicalMemory = parts[1].toLongLong() / 1024;
+			break;
+		}
+	}
+	QDir nodes("/sys/devices/system/node");
+	auto nodeList = nodes.entryList({"node*"}, QDir::Dirs | QDir::NoDotAndDotDot);
+	if (nodeList.size() > 1)
+		info.numaNodes = nodeList.size();
+#endif
+	return info;
+}
+
+int PerformanceProfile::javaMajorVersion(const QString &version)
+{
+	QRegularExpression re("^(\\d+)(?:\\.(\\d+))?");
+	auto match = re.match(version);
+	if (!match.hasMatch())
+		return 0;
+	int first = match.captured(1).toInt();
+	// old style: 1.x
+	if (first == 1 && !match.captured(2).isEmpty())
+		return match.captured(2).toInt();
+	return first;
+}
+
+static bool userHasArg(const QStringList &userArgs, const QRegularExpression &re)
+{
+	for (auto arg : userArgs)
+	{
+		if (re.match(arg).hasMatch())
+			return true;
+	}
+	return false;
+}
+
+void PerformanceProfile::decideHeap(const HardwareInfo &hw, const JavaCheckResult &java,
+									int modCount, const Options &options)
+{
+	Choice choice;
+	choice.name = "heap";
+	if (!options.heap)
+	{
+		choice.reason = QObject::tr("disabled for this instance");
+		m_choices.append(choice);
+		return;
+	}
+	if (options.memoryOverridden)
+	{
+		choice.reason = QObject::tr("the instance sets its own memory limits");
+		m_choices.append(choice);
+		return;
+	}
+	if (userHasArg(options.userArgs, QRegularExpression("^-Xm[sx]")))
+	{
+		choice.reason = QObject::tr("heap size set in the java arguments");
+		m_choices.append(choice);
+		return;
+	}
+	if (hw.physicalMemory <= 0)
+	{
+		choice.reason = QObject::tr("physical memory size is unknown");
+		m_choices.append(choice);
+		return;
+	}
+
+	// vanilla is happy with 1 GiB, every mod adds a bit on top
+	int wanted = 1024 + modCount * 16;
+	QStringList why;
+	why << QObject::tr("%n mod(s)", "", modCount);
+
+	// never take more than half of the machine
+	int cap = hw.physicalMemory / 2;
+	if (wanted > cap)
+	{
+		wanted = cap;
+		why << QObject::tr("capped to half of %1 MiB physical memory").arg(hw.physicalMemory);
+	}
+	// 32bit JVMs can't reserve much more than this
+	if (java.valid && !java.is_64bit && wanted > 1024)
+	{
+		wanted = 1024;
+		why << QObject::tr("32-bit java");
+	}
+	// round to 128 MiB and keep a sane minimum
+	wanted = qMax(512, (wanted / 128) * 128);
+	m_maxHeap = wanted;
+
+	// start at half the maximum so the heap doesn't have to grow through many full GCs
+	choice.args << QString("-Xms%1m").arg(qMax(256, wanted / 2));
+	choice.args << QString("-Xmx%1m").arg(wanted);
+	choice.reason = why.join(", ");
+	m_choices.append(choice);
+}
+
+void PerformanceProfile::decideGC(const HardwareInfo &hw, const JavaCheckResult &java,
+								  const Options &options)
+{
+	Choice choice;
+	choice.name = "gc";
+	if (!options.gc)
+	{
+		choice.reason = QObject::tr("disabled for this instance");
+		m_choices.append(choice);
+		return;
+	}
+	if (userHasArg(options.userArgs, QRegularExpression("^-XX:[+-]Use.*GC$")))
+	{
+		choice.reason = QObject::tr("garbage collector set in the java arguments");
+		m_choices.append(choice);
+		return;
+	}
+
+	int major = javaMajorVersion(java.javaVersion);
+	if (!major)
+	{
+		// the flags a java takes depend on its version, so leave it to its defaults
+		choice.reason = QObject::tr("unknown java version");
+		m_choices.append(choice);
+		return;
+	}
+	int gcThreads = qBound(1, hw.cores, 8);
+	if (hw.cores < 2)
+	{
+		choice.args << "-XX:+UseSerialGC";
+		choice.reason = QObject::tr("single CPU - concurrent collectors would only add overhead");
+	}
+	else if (major >= 9)
+	{
+		// ParNew is gone in java 10 and CMS in java 14, G1 is the default anyway
+		choice.args << "-XX:+UseG1GC" << "-XX:MaxGCPauseMillis=50";
+		choice.reason = QObject::tr("java %1 - G1 keeps pauses short").arg(major);
+	}
+	else if (major == 8 && m_maxHeap >= 2048)
+	{
+		choice.args << "-XX:+UseG1GC" << "-XX:MaxGCPauseMillis=50";
+		choice.reason = QObject::tr("java %1 with a %2 MiB heap - G1 keeps pauses short")
+							.arg(major)
+							.arg(m_maxHeap);
+	}
+	else if (major >= 7)
+	{
+		choice.args << "-XX:+UseConcMarkSweepGC" << "-XX:+UseParNewGC";
+		choice.args << QString("-XX:ParallelGCThreads=%1").arg(gcThreads);
+		choice.reason = QObject::tr("java %1 with %2 CPUs - concurrent collector")
+							.arg(major)
+							.arg(hw.cores);
+	}
+	else
+	{
+		choice.reason = QObject::tr("java %1 is too old to tune").arg(major);
+		m_choices.append(choice);
+		return;
+	}
+	if (hw.numaNodes > 1)
+	{
+		choice.args << "-XX:+UseNUMA";
+		choice.reason += QObject::tr(", %1 NUMA nodes").arg(hw.numaNodes);
+	}
+	m_choices.append(choice);
+}
+
+void PerformanceProfile::decideJIT(const HardwareInfo &hw, const JavaCheckResult &java,
+								   int modCount, const Options &options)
+{
+	Choice choice;
+	choice.name = "jit";
+	if (!options.jit)
+	{
+		choice.reason = QObject::tr("disabled for this instance");
+		m_choices.append(choice);
+		return;
+	}
+	if (userHasArg(options.userArgs, QRegularExpression("^-XX:.*(Tiered|CodeCache)")))
+	{
+		choice.reason = QObject::tr("JIT options set in the java arguments");
+		m_choices.append(choice);
+		return;
+	}
+
+	QStringList why;
+	int major = javaMajorVersion(java.javaVersion);
+	// tiered compilation is only on by default since java 8
+	if (major == 7)
+	{
+		choice.args << "-XX:+TieredCompilation";
+		why << QObject::tr("java 7 - enable tiered compilation");
+	}
+	if (hw.cores < 2)
+	{
+		choice.args << "-XX:TieredStopAtLevel=1";
+		why << QObject::tr("single CPU - keep the compiler out of the game's way");
+	}
+	// big modpacks run out of the default 48 MiB code cache and stop compiling
+	if (modCount >= 50)
+	{
+		choice.args << "-XX:ReservedCodeCacheSize=256m";
+		why << QObject::tr("%1 mods - larger code cache").arg(modCount);
+	}
+	choice.reason = why.isEmpty() ? QObject::tr("defaults are fine") : why.join(", ");
+	m_choices.append(choice);
+}
+
+PerformanceProfile PerformanceProfile::compute(const HardwareInfo &hw,
+											   const JavaCheckResult &java, int modCount,
+											   const Options &options)
+{
+	PerformanceProfile profile;
+	profile.m_enabled = true;
+	profile.decideHeap(hw, java, modCount, options);
+	profile.decideGC(hw, java, options);
+	profile.decideJIT(hw, java, modCount, options);
+	return profile;
+}
+
+static int countMods(const QString &minecraftRoot)
+{
+	int count = 0;
+	for (auto folder : {"mods", "coremods"})
+	{
+		QDirIterator iter(PathCombine(minecraftRoot, folder), {"*.jar", "*.zip", "*.litemod"},
+						  QDir::Files, QDirIterator::Subdirectories);
+		while (iter.hasNext())
+		{
+			iter.next();
+			count++;
+		}
+	}
+	return count;
+}
+
+PerformanceProfile PerformanceProfile::forInstance(MinecraftInstancePtr instance,
+												   const QStringList &userArgs)
+{
+	auto &settings = instance->settings();
+	if (!settings.get("AutoTuneJava").toBool())
+	{
+		return PerformanceProfile();
+	}
+	Options options;
+	options.heap = settings.get("AutoTuneHeap").toBool();
+	options.gc = settings.get("AutoTuneGC").toBool();
+	options.jit = settings.get("AutoTuneJIT").toBool();
+	options.memoryOverridden = settings.get("OverrideMemory").toBool();
+	options.userArgs = userArgs;
+
+	// we only know the java version if it was checked before
+	JavaCheckResult java;
+	auto cache = ENV.javaCheckCache();
+	if (cache)
+	{
+		cache->lookup(settings.get("JavaPath").toString(), java);
+	}
+	return compute(HardwareInfo::probe(), java, countMods(instance->minecraftRoot()), options);
+}
+
+QStringList PerformanceProfile::arguments() const
+{
+	QStringList args;
+	for (auto &choice : m_choices)
+	{
+		args.append(choice.args);
+	}
+	return args;
+}
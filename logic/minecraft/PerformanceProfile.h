@@ -0,0 +1,104 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+
+#include "minecraft/MinecraftInstance.h"
+#include "java/JavaChecker.h"
+
+/// What we could find out about the machine we are running on
+struct HardwareInfo
+{
+	/// number of logical CPUs
+	int cores = 1;
+	/// physical memory in MiB, 0 if unknown
+	qint64 physicalMemory = 0;
+	/// number of NUMA nodes
+	int numaNodes = 1;
+
+	/// read the hardware info from /proc and sysfs (where available)
+	static HardwareInfo probe();
+};
+
+/**
+ * Generates JVM heap, GC and JIT flags from the hardware, the java version and the size
+ * of the instance's mod set.
+ *
+ * Every choice carries a human readable reason, so it can be shown in the launch log.
+ */
+class PerformanceProfile
+{
+public:
+	struct Choice
+	{
+		/// 'heap', 'gc' or 'jit'
+		QString name;
+		/// the arguments to pass to java. Empty if the choice was skipped.
+		QStringList args;
+		/// why this was decided
+		QString reason;
+	};
+
+	struct Options
+	{
+		bool heap = true;
+		bool gc = true;
+		bool jit = true;
+		/// the user set the memory limits explicitly for the instance
+		bool memoryOverridden = false;
+		/// arguments the user passes to java. Anything in here wins.
+		QStringList userArgs;
+	};
+
+	/// compute the profile. Pure - does not touch the system.
+	static PerformanceProfile compute(const HardwareInfo &hw, const JavaCheckResult &java,
+									  int modCount, const Options &options);
+
+	/// compute the profile for an instance, if enabled in its settings
+	static PerformanceProfile forInstance(MinecraftInstancePtr instance, const QStringList &userArgs);
+
+	/// parse major java version from strings like '1.8.0_45' or '11.0.2'. 0 if unknown.
+	static int javaMajorVersion(const QString &version);
+
+	bool enabled() const
+	{
+		return m_enabled;
+	}
+	QStringList arguments() const;
+	const QList<Choice> &choices() const
+	{
+		return m_choices;
+	}
+	/// heap size picked by the profile in MiB, 0 if the heap was not tuned
+	int maxHeap() const
+	{
+		return m_maxHeap;
+	}
+
+private:
+	void decideHeap(const HardwareInfo &hw, const JavaCheckResult &java, int modCount,
+					const Options &options);
+	void decideGC(const HardwareInfo &hw, const JavaCheckResult &java, const Options &options);
+	void decideJIT(const HardwareInfo &hw, const JavaCheckResult &java, int modCount,
+				   const Options &options);
+
+	bool m_enabled = false;
+	int m_maxHeap = 0;
+	QList<Choice> m_choices;
+};
@@ -7,6 +7,10 @@
 #include <QJsonArray>
 #include <QRegularExpression>
 #include <QSaveFile>
+#include <QCache>
+#include <QMutex>
+#include <QCryptographicHash>
+#include <QDateTime>
 
 namespace ProfileUtils
 {
@@ -98,7 +102,37 @@ bool readOverrideOrders(QString path, PatchOrder &order)
 	return true;
 }
 
-VersionFilePtr parseJsonFile(const QFileInfo &fileInfo, const bool requireOrder)
+namespace
+{
+/// what a file looked like when it was last hashed
+struct Fingerprint
+{
+	qint64 size;
+	QDateTime modified;
+	QByteArray hash;
+};
+
+/**
+ * Parsed version files, shared by every profile in the process.
+ *
+ * Files are identified by their content hash, so instances using the same Forge or LiteLoader
+ * patch share one parse. The hash of a path is remembered together with its size and
+ * modification time and only recomputed when either changes.
+ */
+struct VersionFileCache
+{
+	QMutex mutex;
+	QCache<QString, Fingerprint> fingerprints{1024};
+	QCache<QByteArray, VersionFile> files{128};
+};
+
+VersionFileCache &versionFileCache()
+{
+	static VersionFileCache cache;
+	return cache;
+}
+
+QByteArray readVersionFile(const QFileInfo &fileInfo)
 {
 	QFile file(fileInfo.absoluteFilePath());
 	if (!file.open(QFile::ReadOnly))
@@ -106,8 +140,75 @@ VersionFilePtr parseJsonFile(const QFileInfo &fileInfo, const bool requireOrder)
 		throw JSONValidationError(QObject::tr("Unable to open the version file %1: %2.")
 									  .arg(fileInfo.fileName(), file.errorString()));
 	}
+	return file.readAll();
+}
+
+/// A copy that shares nothing with @p file. Callers change the libraries of their patches too.
+VersionFile *deepCopy(const VersionFile &file)
+{
+	auto copy = new VersionFile(file);
+	for (auto libs : {&copy->overwriteLibs, &copy->addLibs})
+	{
+		for (auto &lib : *libs)
+		{
+			lib = std::make_shared<RawLibrary>(*lib);
+		}
+	}
+	for (auto &jarMod : copy->jarMods)
+	{
+		jarMod = std::make_shared<Jarmod>(*jarMod);
+	}
+	return copy;
+}
+}
+
+VersionFilePtr parseJsonFile(const QFileInfo &fileInfo, const bool requireOrder)
+{
+	auto &cache = versionFileCache();
+	// don't trust a QFileInfo the caller may have had for a while
+	QFileInfo info(fileInfo.absoluteFilePath());
+	QString path = info.canonicalFilePath();
+	if (path.isEmpty())
+	{
+		path = info.absoluteFilePath();
+	}
+
+	QByteArray data;
+	QByteArray hash;
+	{
+		QMutexLocker locker(&cache.mutex);
+		auto known = cache.fingerprints.object(path);
+		if (known && known->size == info.size() && known->modified == info.lastModified())
+		{
+			hash = known->hash;
+		}
+	}
+	if (hash.isEmpty())
+	{
+		data = readVersionFile(info);
+		hash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+		QMutexLocker locker(&cache.mutex);
+		cache.fingerprints.insert(path, new Fingerprint{info.size(), info.lastModified(), hash});
+	}
+	// the order is only read when asked for, so that is part of the key too
+	QByteArray key = hash + (requireOrder ? "+order" : "");
+	{
+		QMutexLocker locker(&cache.mutex);
+		if (auto cached = cache.files.object(key))
+		{
+			// callers adjust the patches they get, so they each get their own copy
+			VersionFilePtr copy(deepCopy(*cached));
+			copy->filename = info.absoluteFilePath();
+			return copy;
+		}
+	}
+
+	if (data.isEmpty())
+	{
+		data = readVersionFile(info);
+	}
 	QJsonParseError error;
-	QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+	QJsonDocument doc = QJsonDocument::fromJson(data, &error);
 	if (error.error != QJsonParseError::NoError)
 	{
 		throw JSONValidationError(
@@ -115,7 +216,10 @@ VersionFilePtr parseJsonFile(const QFileInfo &fileInfo, const bool requireOrder)
 				.arg(fileInfo.fileName(), error.errorString())
 				.arg(error.offset));
 	}
-	return VersionFile::fromJson(doc, file.fileName(), requireOrder);
+	auto file = VersionFile::fromJson(doc, info.absoluteFilePath(), requireOrder);
+	QMutexLocker locker(&cache.mutex);
+	cache.files.insert(key, deepCopy(*file));
+	return file;
 }
 
 VersionFilePtr parseBinaryJsonFile(const QFileInfo &fileInfo)
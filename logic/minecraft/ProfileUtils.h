@@ -13,7 +13,8 @@ bool readOverrideOrders(QString path, PatchOrder &order);
 bool writeOverrideOrders(QString path, const PatchOrder &order);
 
 
-/// Parse a version file in JSON format
+/// Parse a version file in JSON format. Files with unchanged contents are only parsed once per
+/// process - every call returns a fresh copy of the cached patch the caller is free to modify.
 VersionFilePtr parseJsonFile(const QFileInfo &fileInfo, const bool requireOrder);
 
 /// Parse a version file in binary JSON format
@@ -249,6 +249,21 @@ bool VersionFile::hasJarMods()
 	return !jarMods.isEmpty();
 }
 
+bool VersionFile::matchesMinecraftVersion(const QString &id)
+{
+	// most patches name one exact version, a substring search does the same as the pattern
+	if (!mcVersion.contains('*') && !mcVersion.contains('?') && !mcVersion.contains('['))
+	{
+		return id.contains(mcVersion, Qt::CaseInsensitive);
+	}
+	if (m_mcVersionPatternSource != mcVersion)
+	{
+		m_mcVersionPattern = QRegExp(mcVersion, Qt::CaseInsensitive, QRegExp::Wildcard);
+		m_mcVersionPatternSource = mcVersion;
+	}
+	return m_mcVersionPattern.indexIn(id) != -1;
+}
+
 void VersionFile::applyTo(MinecraftProfile *version)
 {
 	if (minimumLauncherVersion != -1)
@@ -262,8 +277,7 @@ void VersionFile::applyTo(MinecraftProfile *version)
 
 	if (!version->id.isNull() && !mcVersion.isNull())
 	{
-		if (QRegExp(mcVersion, Qt::CaseInsensitive, QRegExp::Wildcard).indexIn(version->id) ==
-			-1)
+		if (!matchesMinecraftVersion(version->id))
 		{
 			throw MinecraftVersionMismatch(fileId, mcVersion, version->id);
 		}
@@ -3,6 +3,7 @@
 #include <QString>
 #include <QStringList>
 #include <QDateTime>
+#include <QRegExp>
 #include <memory>
 #include "minecraft/OpSys.h"
 #include "minecraft/OneSixRule.h"
@@ -107,6 +108,15 @@ public: /* data */
 	QSet<QString> traits;
 
 	QList<JarmodPtr> jarMods;
+
+private: /* methods */
+	/// does `id` match the mcVersion wildcard?
+	bool matchesMinecraftVersion(const QString &id);
+
+private: /* data */
+	/// mcVersion compiled into a pattern, the first time it is needed
+	QString m_mcVersionPatternSource;
+	QRegExp m_mcVersionPattern;
 };
 
 
@@ -0,0 +1,58 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ArtifactMirror.h"
+
+#include <QDir>
+
+ArtifactMirror::ArtifactMirror(const QString &location, bool offline) : m_offline(offline)
+{
+	if (location.isEmpty())
+		return;
+	QUrl url(location);
+	if (url.scheme() == "http" || url.scheme() == "https" || url.scheme() == "file")
+		m_location = url;
+	else
+		m_location = QUrl::fromLocalFile(QDir(location).absolutePath());
+	// so relative paths go inside of it
+	QString path = m_location.path();
+	if (!path.endsWith('/'))
+		m_location.setPath(path + '/');
+}
+
+QUrl ArtifactMirror::map(const QUrl &url) const
+{
+	if (!m_location.isValid())
+		return url;
+	if (url.scheme() != "http" && url.scheme() != "https")
+		return url;
+	// redirects within the mirror
+	if (url.toString().startsWith(m_location.toString()))
+		return url;
+	QUrl mapped = m_location;
+	mapped.setPath(m_location.path() + treePath(url));
+	if (!m_location.isLocalFile())
+		mapped.setQuery(url.query());
+	return mapped;
+}
+
+QString ArtifactMirror::treePath(const QUrl &url)
+{
+	QString path = QDir::cleanPath(url.host() + "/" + url.path());
+	// nothing above the root of the mirror
+	while (path.startsWith("../"))
+		path.remove(0, 3);
+	return path;
+}
@@ -0,0 +1,59 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QUrl>
+
+/**
+ * A local copy of the files MultiMC downloads, for places without internet.
+ *
+ * The mirror is an HTTP server or a directory laid out like the original URLs, with the host as
+ * the first folder: http://libraries.minecraft.net/com/foo/foo.jar is looked for at
+ * <mirror>/libraries.minecraft.net/com/foo/foo.jar. MirrorExportTask builds such a tree from
+ * the download cache.
+ *
+ * In strict offline mode nothing is requested at all, not even to check whether a cached file
+ * is still current. Downloads use what is in the cache and fail if it isn't there.
+ */
+class ArtifactMirror
+{
+public:
+	/// @p location is an http(s) URL or a directory, may be empty in offline mode
+	ArtifactMirror(const QString &location, bool offline);
+
+	bool offline() const
+	{
+		return m_offline;
+	}
+
+	/// the root of the mirror, invalid if there is none
+	QUrl location() const
+	{
+		return m_location;
+	}
+
+	/// The URL to get @p url from. URLs that are already in the mirror, and ones that aren't
+	/// http(s), stay as they are.
+	QUrl map(const QUrl &url) const;
+
+	/// where the file from @p url goes in a mirror tree, relative to its root
+	static QString treePath(const QUrl &url);
+
+private:
+	QUrl m_location;
+	bool m_offline;
+};
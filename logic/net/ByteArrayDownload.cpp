@@ -25,8 +25,18 @@ ByteArrayDownload::ByteArrayDownload(QUrl url) : NetAction()
 
 void ByteArrayDownload::start()
 {
-	qDebug() << "Downloading " << m_url.toString();
-	QNetworkRequest request(m_url);
+	if (offline())
+	{
+		// nothing to fall back on, these aren't cached
+		qCritical() << "Offline, not downloading" << m_url.toString();
+		m_status = Job_Failed;
+		m_errorString = "MultiMC is in offline mode";
+		emit failed(m_index_within_job);
+		return;
+	}
+	QUrl url = requestUrl();
+	qDebug() << "Downloading " << url.toString();
+	QNetworkRequest request(url);
 	request.setHeader(QNetworkRequest::UserAgentHeader, "MultiMC/5.0 (Uncached)");
 	auto worker = ENV.qnam();
 	QNetworkReply *rep = worker->get(request);
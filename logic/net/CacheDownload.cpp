@@ -21,29 +21,54 @@
 #include <QDateTime>
 #include <QDebug>
 #include "Env.h"
+#include "InFlightDownloads.h"
+#include "NetScheduler.h"
 
 CacheDownload::CacheDownload(QUrl url, MetaEntryPtr entry)
-	: NetAction(), md5sum(QCryptographicHash::Md5)
+	: NetAction(), m_target_path(entry->getFullPath()), m_output_file(m_target_path)
 {
 	m_url = url;
 	m_entry = entry;
-	m_target_path = entry->getFullPath();
 	m_status = Job_NotStarted;
 }
 
+QJsonObject CacheDownload::journalEntry() const
+{
+	QJsonObject entry;
+	entry.insert("type", QString("cache"));
+	entry.insert("url", m_url.toString());
+	entry.insert("base", m_entry->base);
+	entry.insert("path", m_entry->path);
+	return entry;
+}
+
 void CacheDownload::start()
 {
 	m_status = Job_InProgress;
+	wroteAnyData = false;
 	if (!m_entry->stale)
 	{
 		m_status = Job_Finished;
 		emit succeeded(m_index_within_job);
 		return;
 	}
-	// create a new save file
-	m_output_file.reset(new QSaveFile(m_target_path));
-
-	// if there already is a file and md5 checking is in effect and it can be opened
+	if (offline())
+	{
+		// whatever is in the cache has to do
+		if (QFileInfo(m_target_path).isFile())
+		{
+			qDebug() << "Offline, using the cached" << m_target_path;
+			m_status = Job_Finished;
+			emit succeeded(m_index_within_job);
+		}
+		else
+		{
+			qCritical() << "Offline, and" << m_url.toString() << "isn't in the cache";
+			m_status = Job_Failed;
+			emit failed(m_index_within_job);
+		}
+		return;
+	}
 	if (!ensureFilePathExists(m_target_path))
 	{
 		qCritical() << "Could not create folder for " + m_target_path;
@@ -51,19 +76,20 @@ void CacheDownload::start()
 		emit failed(m_index_within_job);
 		return;
 	}
-	if (!m_output_file->open(QIODevice::WriteOnly))
+	// another job is getting the same file right now - wait for it instead of racing it
+	auto leader = InFlightDownloads::claim(m_target_path, this);
+	if (leader)
 	{
-		qCritical() << "Could not open " + m_target_path + " for writing";
-		m_status = Job_Failed;
-		emit failed(m_index_within_job);
+		follow(static_cast<CacheDownload *>(leader));
 		return;
 	}
-	qDebug() << "Downloading " << m_url.toString();
-	QNetworkRequest request(m_url);
+	QUrl url = requestUrl();
+	qDebug() << "Downloading " << url.toString();
+	QNetworkRequest request(url);
 
-	// check file consistency first.
+	// check file consistency first - unless we are already getting a newer one.
 	QFile current(m_target_path);
-	if(current.exists() && current.size() != 0)
+	if (!m_output_file.prepareRequest(request) && current.exists() && current.size() != 0)
 	{
 		if (m_entry->remote_changed_timestamp.size())
 			request.setRawHeader(QString("If-Modified-Since").toLatin1(),
@@ -76,6 +102,7 @@ void CacheDownload::start()
 
 	auto worker = ENV.qnam();
 	QNetworkReply *rep = worker->get(request);
+	rep->setReadBufferSize(NetScheduler::readBufferSize);
 
 	m_reply.reset(rep);
 	connect(rep, SIGNAL(downloadProgress(qint64, qint64)),
@@ -88,9 +115,10 @@ void CacheDownload::start()
 
 void CacheDownload::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
 {
-	m_total_progress = bytesTotal;
-	m_progress = bytesReceived;
-	emit progress(m_index_within_job, bytesReceived, bytesTotal);
+	qint64 resumedFrom = m_output_file.resumedFrom();
+	m_total_progress = bytesTotal < 0 ? bytesTotal : resumedFrom + bytesTotal;
+	m_progress = resumedFrom + bytesReceived;
+	emit progress(m_index_within_job, m_progress, m_total_progress);
 }
 
 void CacheDownload::downloadError(QNetworkReply::NetworkError error)
@@ -122,30 +150,58 @@ void CacheDownload::downloadFinished()
 		return;
 	}
 
+	// what the download limits held back is all here now
+	if (m_status != Job_Failed && m_reply->bytesAvailable() > 0)
+	{
+		downloadReadyRead();
+	}
+
 	// if the download succeeded
 	if (m_status == Job_Failed)
 	{
-		m_output_file->cancelWriting();
+		// keep what we got, the next attempt continues from there
+		if (wroteAnyData)
+		{
+			m_output_file.write(m_reply->readAll());
+			m_output_file.suspend();
+		}
 		m_reply.reset();
+		InFlightDownloads::release(m_target_path, this);
 		emit failed(m_index_within_job);
 		return;
 	}
 
+	// an empty file doesn't trigger readyRead
+	if (!wroteAnyData && PartialFile::carriesContent(m_reply.get()))
+	{
+		if (!m_output_file.begin(m_reply.get()))
+		{
+			m_output_file.discard();
+			m_reply.reset();
+			m_status = Job_Failed;
+			InFlightDownloads::release(m_target_path, this);
+			emit failed(m_index_within_job);
+			return;
+		}
+		wroteAnyData = true;
+	}
+
 	// if we wrote any data to the save file, we try to commit the data to the real file.
 	if (wroteAnyData)
 	{
+		QByteArray md5 = m_output_file.md5().toHex();
 		// nothing went wrong...
-		if (m_output_file->commit())
+		if (m_output_file.commit())
 		{
 			m_status = Job_Finished;
-			m_entry->md5sum = md5sum.result().toHex().constData();
+			m_entry->md5sum = md5.constData();
 		}
 		else
 		{
 			qCritical() << "Failed to commit changes to " << m_target_path;
-			m_output_file->cancelWriting();
 			m_reply.reset();
 			m_status = Job_Failed;
+			InFlightDownloads::release(m_target_path, this);
 			emit failed(m_index_within_job);
 			return;
 		}
@@ -155,12 +211,13 @@ void CacheDownload::downloadFinished()
 		m_status = Job_Finished;
 	}
 
-	// then get rid of the save file
-	m_output_file.reset();
-
 	QFileInfo output_file_info(m_target_path);
 
-	m_entry->etag = m_reply->rawHeader("ETag").constData();
+	// a 304 doesn't have to repeat the ETag, keep the one we have
+	if (m_reply->hasRawHeader("ETag"))
+	{
+		m_entry->etag = m_reply->rawHeader("ETag").constData();
+	}
 	if (m_reply->hasRawHeader("Last-Modified"))
 	{
 		m_entry->remote_changed_timestamp = m_reply->rawHeader("Last-Modified").constData();
@@ -171,20 +228,83 @@ void CacheDownload::downloadFinished()
 	ENV.metacache()->updateEntry(m_entry);
 
 	m_reply.reset();
+	InFlightDownloads::release(m_target_path, this);
 	emit succeeded(m_index_within_job);
 	return;
 }
 
 void CacheDownload::downloadReadyRead()
 {
-	QByteArray ba = m_reply->readAll();
-	md5sum.addData(ba);
-	if (m_output_file->write(ba) != ba.size())
+	QByteArray ba = readLimited();
+	// redirects and error pages don't go into the file
+	if (!PartialFile::carriesContent(m_reply.get()))
+		return;
+	if (!wroteAnyData)
+	{
+		if (!m_output_file.begin(m_reply.get()))
+		{
+			// the next attempt starts over
+			m_output_file.discard();
+			m_status = Job_Failed;
+			m_reply->abort();
+			return;
+		}
+		wroteAnyData = true;
+	}
+	if (!m_output_file.write(ba))
 	{
 		qCritical() << "Failed writing into " + m_target_path;
 		m_status = Job_Failed;
 		m_reply->abort();
-		emit failed(m_index_within_job);
 	}
-	wroteAnyData = true;
+}
+
+void CacheDownload::follow(CacheDownload *leader)
+{
+	qDebug() << "Waiting for another download of" << m_target_path;
+	m_leader = leader;
+	// a background leader would otherwise wait for the very download waiting on it
+	leader->raisePriority(m_priority);
+	connect(leader, SIGNAL(progress(int, qint64, qint64)),
+			SLOT(leaderProgress(int, qint64, qint64)));
+	connect(leader, SIGNAL(succeeded(int)), SLOT(leaderSucceeded()));
+	connect(leader, SIGNAL(failed(int)), SLOT(leaderFailed()));
+	// the job of the other download may be thrown away before it is done
+	connect(leader, SIGNAL(destroyed()), SLOT(leaderFailed()));
+	leaderProgress(leader->m_index_within_job, leader->m_progress, leader->m_total_progress);
+}
+
+void CacheDownload::stopFollowing()
+{
+	if (m_leader)
+	{
+		m_leader->disconnect(this);
+	}
+	m_leader.clear();
+}
+
+void CacheDownload::leaderProgress(int, qint64 current, qint64 total)
+{
+	m_progress = current;
+	m_total_progress = total;
+	emit progress(m_index_within_job, m_progress, m_total_progress);
+}
+
+void CacheDownload::leaderSucceeded()
+{
+	CacheDownload *leader = m_leader;
+	stopFollowing();
+	// same file, same cache entry - the other download already updated the cache
+	*m_entry = *leader->m_entry;
+	wroteAnyData = leader->wroteAnyData;
+	m_status = Job_Finished;
+	emit succeeded(m_index_within_job);
+}
+
+void CacheDownload::leaderFailed()
+{
+	stopFollowing();
+	// the retry either follows the retry of the other download or gets the file itself
+	m_status = Job_Failed;
+	emit failed(m_index_within_job);
 }
@@ -17,8 +17,9 @@
 
 #include "NetAction.h"
 #include "HttpMetaCache.h"
-#include <QCryptographicHash>
-#include <QSaveFile>
+#include "PartialFile.h"
+
+#include <QPointer>
 
 typedef std::shared_ptr<class CacheDownload> CacheDownloadPtr;
 class CacheDownload : public NetAction
@@ -28,13 +29,18 @@ private:
 	MetaEntryPtr m_entry;
 	/// if saving to file, use the one specified in this string
 	QString m_target_path;
-	/// this is the output file, if any
-	std::shared_ptr<QSaveFile> m_output_file;
-	/// the hash-as-you-download
-	QCryptographicHash md5sum;
+	/// the data downloaded so far, kept when the download fails so it can be resumed
+	PartialFile m_output_file;
 
 	bool wroteAnyData = false;
 
+	/// another download that is getting the same file right now, for another job
+	QPointer<CacheDownload> m_leader;
+
+private:
+	void follow(CacheDownload *leader);
+	void stopFollowing();
+
 public:
 	explicit CacheDownload(QUrl url, MetaEntryPtr entry);
 	static CacheDownloadPtr make(QUrl url, MetaEntryPtr entry)
@@ -42,10 +48,16 @@ public:
 		return CacheDownloadPtr(new CacheDownload(url, entry));
 	}
 	virtual ~CacheDownload(){};
+	virtual QJsonObject journalEntry() const override;
 	QString getTargetFilepath()
 	{
 		return m_target_path;
 	}
+	/// true if the file was downloaded again, false if the cached copy was still good
+	bool wasModified() const
+	{
+		return wroteAnyData;
+	}
 protected
 slots:
 	virtual void downloadProgress(qint64 bytesReceived, qint64 bytesTotal);
@@ -53,6 +65,12 @@ slots:
 	virtual void downloadFinished();
 	virtual void downloadReadyRead();
 
+private
+slots:
+	void leaderProgress(int index, qint64 current, qint64 total);
+	void leaderSucceeded();
+	void leaderFailed();
+
 public
 slots:
 	virtual void start();
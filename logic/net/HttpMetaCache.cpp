@@ -30,6 +30,12 @@
 #include <QJsonArray>
 #include <QJsonObject>
 
+namespace
+{
+// using an entry only marks it as used again after this long, so resolving doesn't keep saving
+const qint64 accessGranularity = 60 * 60 * 1000;
+}
+
 QString MetaEntry::getFullPath()
 {
 	// FIXME: make local?
@@ -115,6 +121,12 @@ MetaEntryPtr HttpMetaCache::resolveEntry(QString base, QString resource_path,
 	}
 
 	// entry passed all the checks we cared about.
+	qint64 now = QDateTime::currentMSecsSinceEpoch();
+	if (now - entry->last_access > accessGranularity)
+	{
+		entry->last_access = now;
+		SaveEventually();
+	}
 	return entry;
 }
 
@@ -131,6 +143,7 @@ bool HttpMetaCache::updateEntry(MetaEntryPtr stale_entry)
 		qCritical() << "Cannot add stale entry: " << stale_entry->getFullPath().toLocal8Bit();
 		return false;
 	}
+	stale_entry->last_access = QDateTime::currentMSecsSinceEpoch();
 	m_entries[stale_entry->base].entry_list[stale_entry->path] = stale_entry;
 	SaveEventually();
 	return true;
@@ -147,6 +160,32 @@ bool HttpMetaCache::evictEntry(MetaEntryPtr entry)
 	return false;
 }
 
+bool HttpMetaCache::removeEntry(QString base, QString resource_path)
+{
+	if (!m_entries.contains(base))
+		return false;
+	auto entry = m_entries[base].entry_list.take(resource_path);
+	if (!entry)
+		return false;
+	// anyone still holding on to it has to download it again
+	entry->stale = true;
+	SaveEventually();
+	return true;
+}
+
+QMap<QString, qint64> HttpMetaCache::lastAccessTimes(QString base)
+{
+	QMap<QString, qint64> times;
+	if (!m_entries.contains(base))
+		return times;
+	for (auto entry : m_entries[base].entry_list)
+	{
+		if (!entry->stale)
+			times.insert(entry->path, entry->last_access);
+	}
+	return times;
+}
+
 MetaEntryPtr HttpMetaCache::staleEntry(QString base, QString resource_path)
 {
 	auto foo = new MetaEntry;
@@ -215,6 +254,8 @@ void HttpMetaCache::Load()
 		foo->local_changed_timestamp = element_obj.value("last_changed_timestamp").toDouble();
 		foo->remote_changed_timestamp =
 			element_obj.value("remote_changed_timestamp").toString();
+		// indexes from before access times were kept count as last used when last changed
+		foo->last_access = element_obj.value("last_access").toDouble(foo->local_changed_timestamp);
 		// presumed innocent until closer examination
 		foo->stale = false;
 		entrymap.entry_list[path] = MetaEntryPtr(foo);
@@ -255,6 +296,7 @@ void HttpMetaCache::SaveNow()
 			if (!entry->remote_changed_timestamp.isEmpty())
 				entryObj.insert("remote_changed_timestamp",
 								QJsonValue(entry->remote_changed_timestamp));
+			entryObj.insert("last_access", QJsonValue(double(entry->last_access)));
 			entriesArr.append(entryObj);
 		}
 	}
@@ -29,6 +29,7 @@ struct MetaEntry
 	QString etag;
 	qint64 local_changed_timestamp = 0;
 	QString remote_changed_timestamp; // QString for now, RFC 2822 encoded time
+	qint64 last_access = 0; // ms since epoch, roughly - for cleaning up the cache
 	bool stale = true;
 	QString getFullPath();
 };
@@ -57,6 +58,12 @@ public:
 	// evict selected entry from cache
 	bool evictEntry(MetaEntryPtr entry);
 
+	// forget the entry of a file that was deleted
+	bool removeEntry(QString base, QString resource_path);
+
+	// when the entries of a base were last used, by resource path
+	QMap<QString, qint64> lastAccessTimes(QString base);
+
 	void addBase(QString base, QString base_root);
 
 	// (re)start a timer that calls SaveNow later.
@@ -0,0 +1,61 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "InFlightDownloads.h"
+#include "NetAction.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QPointer>
+
+namespace
+{
+QHash<QString, QPointer<NetAction>> &inFlight()
+{
+	static QHash<QString, QPointer<NetAction>> downloads;
+	return downloads;
+}
+
+QString key(const QString &path)
+{
+	return QDir::cleanPath(QFileInfo(path).absoluteFilePath());
+}
+}
+
+NetAction *InFlightDownloads::claim(const QString &path, NetAction *action)
+{
+	auto &current = inFlight()[key(path)];
+	// a download that was destroyed before it finished leaves a null pointer behind
+	if (!current || current == action)
+	{
+		current = action;
+		return nullptr;
+	}
+	if (current->metaObject() != action->metaObject())
+	{
+		return nullptr;
+	}
+	return current;
+}
+
+void InFlightDownloads::release(const QString &path, NetAction *action)
+{
+	auto it = inFlight().find(key(path));
+	if (it != inFlight().end() && (it.value() == action || !it.value()))
+	{
+		inFlight().erase(it);
+	}
+}
@@ -0,0 +1,38 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+
+class NetAction;
+
+/**
+ * The downloads to files that are running right now, in all the NetJobs.
+ *
+ * Two jobs may want the same file at the same time - two instances updating at once, or a
+ * version list and an instance both wanting the same library. Only the first download to a
+ * file gets it, the others wait for it and get its result instead of writing over it.
+ */
+class InFlightDownloads
+{
+public:
+	/// Registers @p action as the download to @p path. If another download of the same kind
+	/// already has the file, returns that one instead - @p action should follow it then.
+	static NetAction *claim(const QString &path, NetAction *action);
+
+	/// Call when a download that claimed @p path is done with it, before it says so.
+	static void release(const QString &path, NetAction *action);
+};
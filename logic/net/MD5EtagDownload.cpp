@@ -15,30 +15,46 @@
 
 #include "Env.h"
 #include "MD5EtagDownload.h"
+#include "InFlightDownloads.h"
+#include "NetScheduler.h"
 #include <pathutils.h>
 #include <QCryptographicHash>
 #include <QDebug>
 
-MD5EtagDownload::MD5EtagDownload(QUrl url, QString target_path) : NetAction()
+MD5EtagDownload::MD5EtagDownload(QUrl url, QString target_path)
+	: NetAction(), m_target_path(target_path), m_output_file(target_path)
 {
 	m_url = url;
-	m_target_path = target_path;
 	m_status = Job_NotStarted;
 }
 
+QJsonObject MD5EtagDownload::journalEntry() const
+{
+	QJsonObject entry;
+	entry.insert("type", QString("md5"));
+	entry.insert("url", m_url.toString());
+	entry.insert("target", m_target_path);
+	if (!m_expected_md5.isEmpty())
+		entry.insert("md5", m_expected_md5);
+	// so the progress adds up before it starts
+	entry.insert("size", double(m_total_progress));
+	return entry;
+}
+
 void MD5EtagDownload::start()
 {
+	m_status = Job_InProgress;
+	m_wroteAnyData = false;
 	QString filename = m_target_path;
-	m_output_file.setFileName(filename);
+	QFile existing(filename);
 	// if there already is a file and md5 checking is in effect and it can be opened
-	if (m_output_file.exists() && m_output_file.open(QIODevice::ReadOnly))
+	if (existing.exists() && existing.open(QIODevice::ReadOnly))
 	{
 		// get the md5 of the local file.
-		m_local_md5 =
-			QCryptographicHash::hash(m_output_file.readAll(), QCryptographicHash::Md5)
-				.toHex()
-				.constData();
-		m_output_file.close();
+		QCryptographicHash hash(QCryptographicHash::Md5);
+		hash.addData(&existing);
+		m_local_md5 = hash.result().toHex().constData();
+		existing.close();
 		// if we are expecting some md5sum, compare it with the local one
 		if (!m_expected_md5.isEmpty())
 		{
@@ -46,6 +62,7 @@ void MD5EtagDownload::start()
 			if(m_local_md5 == m_expected_md5)
 			{
 				qDebug() << "Skipping " << m_url.toString() << ": md5 match.";
+				m_status = Job_Finished;
 				emit succeeded(m_index_within_job);
 				return;
 			}
@@ -55,17 +72,44 @@ void MD5EtagDownload::start()
 			// no expected md5. we use the local md5sum as an ETag
 		}
 	}
+	if (offline())
+	{
+		// whatever is there has to do, if nothing says it's wrong
+		if (existing.exists() && m_expected_md5.isEmpty())
+		{
+			qDebug() << "Offline, using the existing" << m_target_path;
+			m_status = Job_Finished;
+			emit succeeded(m_index_within_job);
+		}
+		else
+		{
+			qCritical() << "Offline, and there's no good copy of" << m_url.toString();
+			m_status = Job_Failed;
+			emit failed(m_index_within_job);
+		}
+		return;
+	}
 	if (!ensureFilePathExists(filename))
 	{
+		m_status = Job_Failed;
 		emit failed(m_index_within_job);
 		return;
 	}
+	// another job is getting the same file right now - wait for it instead of racing it
+	auto leader = InFlightDownloads::claim(m_target_path, this);
+	if (leader)
+	{
+		follow(static_cast<MD5EtagDownload *>(leader));
+		return;
+	}
 
-	QNetworkRequest request(m_url);
+	QUrl url = requestUrl();
+	QNetworkRequest request(url);
 
-	qDebug() << "Downloading " << m_url.toString() << " local MD5: " << m_local_md5;
+	qDebug() << "Downloading " << url.toString() << " local MD5: " << m_local_md5;
 
-	if(!m_local_md5.isEmpty())
+	// the local file is no use if we are resuming a newer one
+	if(!m_output_file.prepareRequest(request) && !m_local_md5.isEmpty())
 	{
 		request.setRawHeader(QString("If-None-Match").toLatin1(), m_local_md5.toLatin1());
 	}
@@ -74,17 +118,9 @@ void MD5EtagDownload::start()
 
 	request.setHeader(QNetworkRequest::UserAgentHeader, "MultiMC/5.0 (Uncached)");
 
-	// Go ahead and try to open the file.
-	// If we don't do this, empty files won't be created, which breaks the updater.
-	// Plus, this way, we don't end up starting a download for a file we can't open.
-	if (!m_output_file.open(QIODevice::WriteOnly))
-	{
-		emit failed(m_index_within_job);
-		return;
-	}
-
 	auto worker = ENV.qnam();
 	QNetworkReply *rep = worker->get(request);
+	rep->setReadBufferSize(NetScheduler::readBufferSize);
 
 	m_reply.reset(rep);
 	connect(rep, SIGNAL(downloadProgress(qint64, qint64)),
@@ -97,9 +133,10 @@ void MD5EtagDownload::start()
 
 void MD5EtagDownload::downloadProgress(qint64 bytesReceived, qint64 bytesTotal)
 {
-	m_total_progress = bytesTotal;
-	m_progress = bytesReceived;
-	emit progress(m_index_within_job, bytesReceived, bytesTotal);
+	qint64 resumedFrom = m_output_file.resumedFrom();
+	m_total_progress = bytesTotal < 0 ? bytesTotal : resumedFrom + bytesTotal;
+	m_progress = resumedFrom + bytesReceived;
+	emit progress(m_index_within_job, m_progress, m_total_progress);
 }
 
 void MD5EtagDownload::downloadError(QNetworkReply::NetworkError error)
@@ -111,45 +148,159 @@ void MD5EtagDownload::downloadError(QNetworkReply::NetworkError error)
 
 void MD5EtagDownload::downloadFinished()
 {
-	// if the download succeeded
-	if (m_status != Job_Failed)
+	// what the download limits held back is all here now
+	if (m_status != Job_Failed && m_reply->bytesAvailable() > 0)
 	{
-		// nothing went wrong...
-		m_status = Job_Finished;
-		m_output_file.close();
-
-		// FIXME: compare with the real written data md5sum
-		// this is just an ETag
-		qDebug() << "Finished " << m_url.toString() << " got " << m_reply->rawHeader("ETag").constData();
-
-		m_reply.reset();
-		emit succeeded(m_index_within_job);
-		return;
+		downloadReadyRead();
 	}
-	// else the download failed
-	else
+
+	// the download failed - keep what we got, the next attempt continues from there
+	if (m_status == Job_Failed)
 	{
-		m_output_file.close();
-		m_output_file.remove();
+		if (m_wroteAnyData)
+		{
+			m_output_file.write(m_reply->readAll());
+			m_output_file.suspend();
+		}
 		m_reply.reset();
+		InFlightDownloads::release(m_target_path, this);
 		emit failed(m_index_within_job);
 		return;
 	}
+
+	// an empty file doesn't trigger readyRead, but it still has to be created
+	if (!m_wroteAnyData && PartialFile::carriesContent(m_reply.get()))
+	{
+		if (!m_output_file.begin(m_reply.get()))
+		{
+			m_output_file.discard();
+			m_status = Job_Failed;
+			m_reply.reset();
+			InFlightDownloads::release(m_target_path, this);
+			emit failed(m_index_within_job);
+			return;
+		}
+		m_wroteAnyData = true;
+	}
+
+	// otherwise the local file is still good
+	if (m_wroteAnyData)
+	{
+		QString md5 = m_output_file.md5().toHex();
+		if (!m_expected_md5.isEmpty() && md5 != m_expected_md5)
+		{
+			qCritical() << "Downloaded" << m_url.toString() << "has MD5" << md5 << "instead of"
+						<< m_expected_md5;
+			m_output_file.discard();
+			m_status = Job_Failed;
+			m_reply.reset();
+			InFlightDownloads::release(m_target_path, this);
+			emit failed(m_index_within_job);
+			return;
+		}
+		if (!m_output_file.commit())
+		{
+			m_status = Job_Failed;
+			m_reply.reset();
+			InFlightDownloads::release(m_target_path, this);
+			emit failed(m_index_within_job);
+			return;
+		}
+	}
+
+	// nothing went wrong...
+	m_status = Job_Finished;
+	qDebug() << "Finished " << m_url.toString() << " got " << m_reply->rawHeader("ETag").constData();
+	m_reply.reset();
+	InFlightDownloads::release(m_target_path, this);
+	emit succeeded(m_index_within_job);
 }
 
 void MD5EtagDownload::downloadReadyRead()
 {
-	if (!m_output_file.isOpen())
+	QByteArray data = readLimited();
+	// redirects and error pages don't go into the file
+	if (!PartialFile::carriesContent(m_reply.get()))
+		return;
+	if (!m_wroteAnyData)
 	{
-		if (!m_output_file.open(QIODevice::WriteOnly))
+		if (!m_output_file.begin(m_reply.get()))
 		{
 			/*
-			* Can't open the file... the job failed
+			* Can't continue the file... the job failed, the next attempt starts over
 			*/
+			m_output_file.discard();
+			m_status = Job_Failed;
 			m_reply->abort();
+			return;
+		}
+		m_wroteAnyData = true;
+	}
+	if (!m_output_file.write(data))
+	{
+		m_status = Job_Failed;
+		m_reply->abort();
+	}
+}
+
+void MD5EtagDownload::follow(MD5EtagDownload *leader)
+{
+	qDebug() << "Waiting for another download of" << m_target_path;
+	m_leader = leader;
+	// a background leader would otherwise wait for the very download waiting on it
+	leader->raisePriority(m_priority);
+	connect(leader, SIGNAL(progress(int, qint64, qint64)),
+			SLOT(leaderProgress(int, qint64, qint64)));
+	connect(leader, SIGNAL(succeeded(int)), SLOT(leaderSucceeded()));
+	connect(leader, SIGNAL(failed(int)), SLOT(leaderFailed()));
+	// the job of the other download may be thrown away before it is done
+	connect(leader, SIGNAL(destroyed()), SLOT(leaderFailed()));
+	leaderProgress(leader->m_index_within_job, leader->m_progress, leader->m_total_progress);
+}
+
+void MD5EtagDownload::stopFollowing()
+{
+	if (m_leader)
+	{
+		m_leader->disconnect(this);
+	}
+	m_leader.clear();
+}
+
+void MD5EtagDownload::leaderProgress(int, qint64 current, qint64 total)
+{
+	m_progress = current;
+	m_total_progress = total;
+	emit progress(m_index_within_job, m_progress, m_total_progress);
+}
+
+void MD5EtagDownload::leaderSucceeded()
+{
+	QString leaderMd5 = m_leader->m_expected_md5;
+	stopFollowing();
+	// the other download only checked the file against what it expected
+	if (!m_expected_md5.isEmpty() && m_expected_md5 != leaderMd5)
+	{
+		QFile result(m_target_path);
+		QCryptographicHash hash(QCryptographicHash::Md5);
+		if (!result.open(QIODevice::ReadOnly) || !hash.addData(&result) ||
+			hash.result().toHex() != m_expected_md5)
+		{
+			qCritical() << "Downloaded" << m_url.toString() << "doesn't have the MD5"
+						<< m_expected_md5;
+			m_status = Job_Failed;
 			emit failed(m_index_within_job);
 			return;
 		}
 	}
-	m_output_file.write(m_reply->readAll());
+	m_status = Job_Finished;
+	emit succeeded(m_index_within_job);
+}
+
+void MD5EtagDownload::leaderFailed()
+{
+	stopFollowing();
+	// the retry either follows the retry of the other download or gets the file itself
+	m_status = Job_Failed;
+	emit failed(m_index_within_job);
 }
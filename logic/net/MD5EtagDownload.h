@@ -16,7 +16,9 @@
 #pragma once
 
 #include "NetAction.h"
-#include <QFile>
+#include "PartialFile.h"
+
+#include <QPointer>
 
 typedef std::shared_ptr<class MD5EtagDownload> Md5EtagDownloadPtr;
 class MD5EtagDownload : public NetAction
@@ -29,8 +31,16 @@ public:
 	QString m_local_md5;
 	/// if saving to file, use the one specified in this string
 	QString m_target_path;
-	/// this is the output file, if any
-	QFile m_output_file;
+	/// the data downloaded so far, kept when the download fails so it can be resumed
+	PartialFile m_output_file;
+	/// true once the reply started writing to m_output_file
+	bool m_wroteAnyData = false;
+	/// another download that is getting the same file right now, for another job
+	QPointer<MD5EtagDownload> m_leader;
+
+private:
+	void follow(MD5EtagDownload *leader);
+	void stopFollowing();
 
 public:
 	explicit MD5EtagDownload(QUrl url, QString target_path);
@@ -39,6 +49,7 @@ public:
 		return Md5EtagDownloadPtr(new MD5EtagDownload(url, target_path));
 	}
 	virtual ~MD5EtagDownload(){};
+	virtual QJsonObject journalEntry() const override;
 protected
 slots:
 	virtual void downloadProgress(qint64 bytesReceived, qint64 bytesTotal);
@@ -46,6 +57,12 @@ slots:
 	virtual void downloadFinished();
 	virtual void downloadReadyRead();
 
+private
+slots:
+	void leaderProgress(int index, qint64 current, qint64 total);
+	void leaderSucceeded();
+	void leaderFailed();
+
 public
 slots:
 	virtual void start();
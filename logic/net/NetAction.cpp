@@ -0,0 +1,62 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NetAction.h"
+#include "NetScheduler.h"
+#include "ArtifactMirror.h"
+#include "Env.h"
+
+#include <QTimer>
+
+QUrl NetAction::requestUrl() const
+{
+	auto mirror = ENV.artifactMirror();
+	if (!mirror)
+		return m_url;
+	return mirror->map(m_url);
+}
+
+bool NetAction::offline()
+{
+	auto mirror = ENV.artifactMirror();
+	return mirror && mirror->offline();
+}
+
+QByteArray NetAction::readLimited()
+{
+	// once the reply is finished, all it has is in memory already
+	if (m_reply->isFinished())
+		return m_reply->readAll();
+	auto &scheduler = NetScheduler::instance();
+	qint64 allowed = scheduler.take(m_priority, m_limiter.get(), m_reply->bytesAvailable());
+	QByteArray data = m_reply->read(allowed);
+	if (m_reply->bytesAvailable() > 0 && !m_readScheduled)
+	{
+		// the rest waits. Once its buffer is full, the reply stops taking more from the network.
+		m_readScheduled = true;
+		QTimer::singleShot(scheduler.waitTime(m_priority, m_limiter.get()), this,
+						   SLOT(readMore()));
+	}
+	return data;
+}
+
+void NetAction::readMore()
+{
+	m_readScheduled = false;
+	if (m_reply && m_reply->bytesAvailable() > 0)
+	{
+		downloadReadyRead();
+	}
+}
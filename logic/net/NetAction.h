@@ -17,6 +17,7 @@
 
 #include <QObject>
 #include <QUrl>
+#include <QJsonObject>
 #include <memory>
 #include <QNetworkReply>
 #include <QObjectPtr.h>
@@ -29,6 +30,19 @@ enum JobStatus
 	Job_Failed
 };
 
+enum NetPriority
+{
+	/// someone is waiting for it in a dialog
+	Priority_Interactive,
+	/// an instance can't launch without it
+	Priority_Launch,
+	/// nobody is waiting for it - news, translations and such
+	Priority_Background,
+	Priority_Count
+};
+
+class RateLimiter;
+
 typedef std::shared_ptr<class NetAction> NetActionPtr;
 class NetAction : public QObject, public std::enable_shared_from_this<NetAction>
 {
@@ -56,6 +70,19 @@ public:
 	{
 		return shared_from_this();
 	}
+	/// What it takes to make this part again after a restart, see NetJournal. Empty if it
+	/// can't be made again.
+	virtual QJsonObject journalEntry() const
+	{
+		return QJsonObject();
+	}
+	/// Makes this part as urgent as @p priority if it isn't already. Used when a more urgent
+	/// download waits for this one, so a background part doesn't hold it back.
+	void raisePriority(NetPriority priority)
+	{
+		if (priority < m_priority)
+			m_priority = priority;
+	}
 
 public:
 	/// the network reply
@@ -79,6 +106,26 @@ public:
 	/// number of failures up to this point
 	int m_failures = 0;
 
+	/// when to start it and whether to hold it back for others, see NetScheduler
+	NetPriority m_priority = Priority_Interactive;
+
+	/// the download limit of the job it is in, if it has one
+	std::shared_ptr<RateLimiter> m_limiter;
+
+protected:
+	/// what to request to get m_url - the copy in the local mirror, if there is one
+	QUrl requestUrl() const;
+
+	/// true in strict offline mode, where nothing may be requested at all
+	static bool offline();
+
+	/// Reads as much from the reply as the download limits allow. If that isn't all of it,
+	/// downloadReadyRead() is called again later for the rest.
+	QByteArray readLimited();
+
+private:
+	bool m_readScheduled = false;
+
 signals:
 	void started(int index);
 	void progress(int index, qint64 current, qint64 total);
@@ -92,6 +139,10 @@ slots:
 	virtual void downloadFinished() = 0;
 	virtual void downloadReadyRead() = 0;
 
+private
+slots:
+	void readMore();
+
 public
 slots:
 	virtual void start() = 0;
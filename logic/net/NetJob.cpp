@@ -18,6 +18,7 @@
 #include "MD5EtagDownload.h"
 #include "ByteArrayDownload.h"
 #include "CacheDownload.h"
+#include "Env.h"
 
 #include <QDebug>
 
@@ -29,7 +30,10 @@ void NetJob::partSucceeded(int index)
 
 	m_doing.remove(index);
 	m_done.insert(index);
+	if (m_journal)
+		m_journal->partDone(index);
 	downloads[index].get()->disconnect(this);
+	NetScheduler::instance().partFinished(m_priority);
 	startMoreParts();
 }
 
@@ -40,6 +44,8 @@ void NetJob::partFailed(int index)
 	if (slot.failures == 3)
 	{
 		m_failed.insert(index);
+		if (m_journal)
+			m_journal->partFailed(index);
 	}
 	else
 	{
@@ -47,6 +53,7 @@ void NetJob::partFailed(int index)
 		m_todo.enqueue(index);
 	}
 	downloads[index].get()->disconnect(this);
+	NetScheduler::instance().partFinished(m_priority);
 	startMoreParts();
 }
 
@@ -68,28 +75,49 @@ void NetJob::start()
 {
 	qDebug() << m_job_name.toLocal8Bit() << " started.";
 	m_running = true;
+	if (m_timeline)
+	{
+		m_timelinePhase = m_timeline->begin(m_job_name);
+	}
 	for (int i = 0; i < downloads.size(); i++)
 	{
 		m_todo.enqueue(i);
 	}
+	startJournal();
 	// hack that delays early failures so they can be caught easier
 	QMetaObject::invokeMethod(this, "startMoreParts", Qt::QueuedConnection);
 }
 
 void NetJob::startMoreParts()
 {
+	// woken up by the scheduler after it was done
+	if (!m_running)
+		return;
 	// check for final conditions if there's nothing in the queue
 	if(!m_todo.size())
 	{
 		if(!m_doing.size())
 		{
+			disconnect(&NetScheduler::instance(), 0, this, 0);
+			m_running = false;
+			if (m_timeline)
+			{
+				m_timeline->end(m_timelinePhase, current_progress, m_done.size());
+			}
 			if(!m_failed.size())
 			{
+				if (m_journal)
+					m_journal->remove();
+				m_journal.reset();
 				qDebug() << m_job_name.toLocal8Bit() << "succeeded.";
 				emit succeeded();
 			}
 			else
 			{
+				// kept, the next try only needs the parts that failed
+				if (m_journal)
+					m_journal->end();
+				m_journal.reset();
 				qCritical() << m_job_name.toLocal8Bit() << "failed.";
 				emit failed();
 			}
@@ -97,10 +125,18 @@ void NetJob::startMoreParts()
 		return;
 	}
 	// otherwise try to start more parts
+	auto &scheduler = NetScheduler::instance();
 	while (m_doing.size() < 6)
 	{
 		if(!m_todo.size())
 			return;
+		if (!scheduler.mayStart(m_priority))
+		{
+			// held back for more important downloads, try again when one of those is done
+			connect(&scheduler, SIGNAL(partsMayStart()), this, SLOT(startMoreParts()),
+					Qt::UniqueConnection);
+			return;
+		}
 		int doThis = m_todo.dequeue();
 		m_doing.insert(doThis);
 		auto part = downloads[doThis];
@@ -109,10 +145,155 @@ void NetJob::startMoreParts()
 		connect(part.get(), SIGNAL(failed(int)), SLOT(partFailed(int)));
 		connect(part.get(), SIGNAL(progress(int, qint64, qint64)),
 				SLOT(partProgress(int, qint64, qint64)));
+		scheduler.partStarted(m_priority);
 		part->start();
 	}
 }
 
+void NetJob::setPriority(NetPriority priority)
+{
+	m_priority = priority;
+	for (auto download : downloads)
+	{
+		download->m_priority = priority;
+	}
+}
+
+void NetJob::setRateLimit(qint64 bytesPerSecond)
+{
+	if (bytesPerSecond > 0)
+		m_limiter = std::make_shared<RateLimiter>(bytesPerSecond);
+	else
+		m_limiter.reset();
+	for (auto download : downloads)
+	{
+		download->m_limiter = m_limiter;
+	}
+}
+
+void NetJob::setJournal(QString id, QString context)
+{
+	m_journalId = id;
+	m_journalContext = context;
+}
+
+void NetJob::startJournal()
+{
+	m_journal.reset();
+	QString dir = ENV.netJournalPath();
+	if (m_journalId.isEmpty() || dir.isEmpty())
+		return;
+	auto journal = std::make_shared<NetJournal>(NetJournal::pathFor(dir, m_journalId));
+	// short jobs aren't worth it, unless they go on with one that was
+	bool worthIt = downloads.size() >= journalMinParts || journal->exists();
+	QList<QJsonObject> parts;
+	for (auto download : downloads)
+	{
+		auto part = download->journalEntry();
+		if (part.isEmpty())
+		{
+			worthIt = false;
+			break;
+		}
+		parts.append(part);
+	}
+	// an old journal is replaced by this job either way
+	if (!worthIt || !journal->begin(m_job_name, m_journalContext))
+	{
+		journal->remove();
+		return;
+	}
+	for (auto &part : parts)
+	{
+		journal->addPart(part);
+	}
+	m_journal = journal;
+}
+
+void NetJob::journalPartAdded(NetActionPtr part)
+{
+	if (!m_journal)
+		return;
+	auto entry = part->journalEntry();
+	if (entry.isEmpty())
+	{
+		// it couldn't be resumed in full any more
+		m_journal->remove();
+		m_journal.reset();
+		return;
+	}
+	m_journal->addPart(entry);
+}
+
+NetActionPtr NetJob::partFromJournal(const QJsonObject &part)
+{
+	QString type = part.value("type").toString();
+	QUrl url(part.value("url").toString());
+	if (type == "cache")
+	{
+		auto entry = ENV.metacache()->resolveEntry(part.value("base").toString(),
+												   part.value("path").toString());
+		return CacheDownload::make(url, entry);
+	}
+	if (type == "md5")
+	{
+		auto download = MD5EtagDownload::make(url, part.value("target").toString());
+		download->m_expected_md5 = part.value("md5").toString();
+		download->m_total_progress = qMax<qint64>(1, part.value("size").toDouble());
+		return download;
+	}
+	return NetActionPtr();
+}
+
+NetJobPtr NetJob::resume(QString id, QString context)
+{
+	QString dir = ENV.netJournalPath();
+	if (dir.isEmpty())
+		return NetJobPtr();
+	NetJournal journal(NetJournal::pathFor(dir, id));
+	if (!journal.load())
+		return NetJobPtr();
+	if (!context.isNull() && journal.context() != context)
+	{
+		qDebug() << "The download journal" << id << "is for something else, dropping it";
+		journal.remove();
+		return NetJobPtr();
+	}
+	NetJobPtr job(new NetJob(journal.name()));
+	for (auto &part : journal.pendingParts())
+	{
+		auto action = partFromJournal(part);
+		if (!action)
+		{
+			journal.remove();
+			return NetJobPtr();
+		}
+		job->addNetAction(action);
+	}
+	if (!job->size())
+	{
+		journal.remove();
+		return NetJobPtr();
+	}
+	qDebug() << "Resuming" << journal.name() << "with" << job->size() << "parts left";
+	job->setJournal(id, journal.context());
+	return job;
+}
+
+QStringList NetJob::interruptedJournals()
+{
+	QString dir = ENV.netJournalPath();
+	if (dir.isEmpty())
+		return QStringList();
+	return NetJournal::interrupted(dir);
+}
+
+void NetJob::discardJournal(QString id)
+{
+	QString dir = ENV.netJournalPath();
+	if (!dir.isEmpty())
+		NetJournal(NetJournal::pathFor(dir, id)).remove();
+}
 
 QStringList NetJob::getFailedFiles()
 {
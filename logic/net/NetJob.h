@@ -21,8 +21,11 @@
 #include "MD5EtagDownload.h"
 #include "CacheDownload.h"
 #include "HttpMetaCache.h"
+#include "RateLimiter.h"
 #include "tasks/ProgressProvider.h"
 #include "QObjectPtr.h"
+#include "NetScheduler.h"
+#include "NetJournal.h"
 
 class NetJob;
 typedef QObjectPtr<NetJob> NetJobPtr;
@@ -37,6 +40,8 @@ public:
 	{
 		NetActionPtr base = std::static_pointer_cast<NetAction>(action);
 		base->m_index_within_job = downloads.size();
+		base->m_priority = m_priority;
+		base->m_limiter = m_limiter;
 		downloads.append(action);
 		part_info pi;
 		{
@@ -54,11 +59,37 @@ public:
 			connect(base.get(), SIGNAL(failed(int)), SLOT(partFailed(int)));
 			connect(base.get(), SIGNAL(progress(int, qint64, qint64)),
 					SLOT(partProgress(int, qint64, qint64)));
+			journalPartAdded(base);
+			m_doing.insert(base->m_index_within_job);
+			NetScheduler::instance().partStarted(m_priority);
 			base->start();
 		}
 		return true;
 	}
 
+	/// what the parts are for - background jobs make way for everything else
+	void setPriority(NetPriority priority);
+
+	/// limit the download speed of this job, in bytes per second. 0 for no limit.
+	void setRateLimit(qint64 bytesPerSecond);
+
+	/// Keeps a journal of the job under @p id while it runs, so it can go on after a restart.
+	/// Only done for long jobs whose parts can all be made again. @p context says what the
+	/// job was for, to tell whether an old journal still applies.
+	void setJournal(QString id, QString context = QString());
+
+	/// Whatever the job with the journal @p id had left to do when it was stopped, or null if
+	/// there's nothing. If @p context is given, a journal for anything else is thrown away.
+	static NetJobPtr resume(QString id, QString context = QString());
+
+	/// ids of the journals of jobs that were stopped by closing MultiMC, or by a crash
+	static QStringList interruptedJournals();
+
+	static void discardJournal(QString id);
+
+	/// jobs with fewer parts aren't worth a journal
+	static const int journalMinParts = 20;
+
 	NetActionPtr operator[](int index)
 	{
 		return downloads[index];
@@ -97,6 +128,11 @@ public slots:
 	// FIXME: implement
 	virtual void abort() {};
 
+private:
+	void startJournal();
+	void journalPartAdded(NetActionPtr part);
+	static NetActionPtr partFromJournal(const QJsonObject &part);
+
 private slots:
 	void partProgress(int index, qint64 bytesReceived, qint64 bytesTotal);
 	void partSucceeded(int index);
@@ -120,4 +156,10 @@ private:
 	qint64 current_progress = 0;
 	qint64 total_progress = 0;
 	bool m_running = false;
+	int m_timelinePhase = -1;
+	NetPriority m_priority = Priority_Interactive;
+	std::shared_ptr<RateLimiter> m_limiter;
+	QString m_journalId;
+	QString m_journalContext;
+	std::shared_ptr<NetJournal> m_journal;
 };
@@ -0,0 +1,163 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NetJournal.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QDebug>
+#include <pathutils.h>
+
+NetJournal::NetJournal(const QString &path) : m_file(path)
+{
+}
+
+QStringList NetJournal::interrupted(const QString &dir)
+{
+	QStringList ids;
+	for (auto entry : QDir(dir).entryInfoList({"*.journal"}, QDir::Files, QDir::Name))
+	{
+		NetJournal journal(entry.absoluteFilePath());
+		if (journal.load() && !journal.ended() && !journal.pendingParts().isEmpty())
+			ids.append(entry.completeBaseName());
+	}
+	return ids;
+}
+
+QString NetJournal::pathFor(const QString &dir, const QString &id)
+{
+	return PathCombine(dir, id + ".journal");
+}
+
+bool NetJournal::exists() const
+{
+	return m_file.exists();
+}
+
+bool NetJournal::load()
+{
+	m_name.clear();
+	m_context.clear();
+	m_parts.clear();
+	m_done.clear();
+	m_ended = false;
+	if (!m_file.open(QIODevice::ReadOnly))
+		return false;
+	bool first = true;
+	while (!m_file.atEnd())
+	{
+		QByteArray data = m_file.readLine().trimmed();
+		if (data.isEmpty())
+			continue;
+		// the last line may have been cut off by a crash, everything before it still counts
+		QJsonObject line = QJsonDocument::fromJson(data).object();
+		if (line.isEmpty())
+			break;
+		if (first)
+		{
+			m_name = line.value("job").toString();
+			m_context = line.value("context").toString();
+			first = false;
+		}
+		else if (line.contains("part"))
+			m_parts.append(line.value("part").toObject());
+		else if (line.contains("done"))
+			m_done.insert(line.value("done").toInt());
+		else if (line.contains("end"))
+			m_ended = true;
+	}
+	m_file.close();
+	return !first;
+}
+
+QList<QJsonObject> NetJournal::pendingParts() const
+{
+	QList<QJsonObject> pending;
+	for (int i = 0; i < m_parts.size(); i++)
+	{
+		if (!m_done.contains(i))
+			pending.append(m_parts[i]);
+	}
+	return pending;
+}
+
+bool NetJournal::begin(const QString &name, const QString &context)
+{
+	m_file.close();
+	if (!ensureFilePathExists(m_file.fileName()) ||
+		!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "Could not write the download journal" << m_file.fileName();
+		return false;
+	}
+	m_name = name;
+	m_context = context;
+	m_parts.clear();
+	m_done.clear();
+	m_ended = false;
+	QJsonObject header;
+	header.insert("job", name);
+	header.insert("context", context);
+	append(header);
+	return true;
+}
+
+void NetJournal::addPart(const QJsonObject &part)
+{
+	m_parts.append(part);
+	QJsonObject line;
+	line.insert("part", part);
+	append(line);
+}
+
+void NetJournal::partDone(int index)
+{
+	m_done.insert(index);
+	QJsonObject line;
+	line.insert("done", index);
+	append(line);
+}
+
+void NetJournal::partFailed(int index)
+{
+	QJsonObject line;
+	line.insert("failed", index);
+	append(line);
+}
+
+void NetJournal::end()
+{
+	m_ended = true;
+	QJsonObject line;
+	line.insert("end", true);
+	append(line);
+	m_file.close();
+}
+
+void NetJournal::remove()
+{
+	m_file.close();
+	m_file.remove();
+}
+
+void NetJournal::append(const QJsonObject &line)
+{
+	if (!m_file.isOpen())
+		return;
+	m_file.write(QJsonDocument(line).toJson(QJsonDocument::Compact) + '\n');
+	// a line at a time, so a crash loses at most the part that was just done
+	m_file.flush();
+}
@@ -0,0 +1,84 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+/**
+ * What a long NetJob has to do and what it has done, kept on disk so the job can go on after
+ * MultiMC was closed or crashed in the middle of it.
+ *
+ * A journal is a file of JSON lines, only ever appended to while the job runs: the job's name
+ * and context first, then a line for each part, each part that is done and each one that
+ * failed for good, and a last line when the job failed. A job that succeeds removes its
+ * journal. Together with the partial files the parts leave behind (see PartialFile), the job
+ * can continue where it stopped without checking all of its files again.
+ */
+class NetJournal
+{
+public:
+	explicit NetJournal(const QString &path);
+
+	/// ids of the journals in @p dir whose jobs never got to finish
+	static QStringList interrupted(const QString &dir);
+
+	/// file of the journal with @p id in @p dir
+	static QString pathFor(const QString &dir, const QString &id);
+
+	bool exists() const;
+
+	/// reads the journal, false if there isn't a usable one
+	bool load();
+	QString name() const
+	{
+		return m_name;
+	}
+	QString context() const
+	{
+		return m_context;
+	}
+	/// descriptions of the parts that aren't done, the ones that failed included
+	QList<QJsonObject> pendingParts() const;
+	/// false if the job was still running when it was last written to
+	bool ended() const
+	{
+		return m_ended;
+	}
+
+	/// Starts a new journal, replacing an old one.
+	bool begin(const QString &name, const QString &context);
+	void addPart(const QJsonObject &part);
+	void partDone(int index);
+	void partFailed(int index);
+	/// the job failed, it can be tried again later but isn't interrupted
+	void end();
+	void remove();
+
+private:
+	void append(const QJsonObject &line);
+
+private:
+	QFile m_file;
+	QString m_name;
+	QString m_context;
+	QList<QJsonObject> m_parts;
+	QSet<int> m_done;
+	bool m_ended = false;
+};
@@ -0,0 +1,83 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NetScheduler.h"
+
+namespace
+{
+/// background parts running at the same time when nothing else is
+const int maxBackgroundParts = 2;
+/// how often paused background downloads check whether they may go on
+const int backgroundPollInterval = 250;
+}
+
+NetScheduler &NetScheduler::instance()
+{
+	static NetScheduler scheduler;
+	return scheduler;
+}
+
+void NetScheduler::setRateLimit(qint64 bytesPerSecond)
+{
+	m_limiter.setRate(bytesPerSecond);
+}
+
+bool NetScheduler::foregroundRunning() const
+{
+	return m_running[Priority_Interactive] || m_running[Priority_Launch];
+}
+
+bool NetScheduler::mayStart(NetPriority priority) const
+{
+	if (priority != Priority_Background)
+		return true;
+	return !foregroundRunning() && m_running[Priority_Background] < maxBackgroundParts;
+}
+
+void NetScheduler::partStarted(NetPriority priority)
+{
+	m_running[priority]++;
+}
+
+void NetScheduler::partFinished(NetPriority priority)
+{
+	m_running[priority] = qMax(0, m_running[priority] - 1);
+	// queued, so a job that goes on with its next part takes the slot before background parts
+	QMetaObject::invokeMethod(this, "partsMayStart", Qt::QueuedConnection);
+}
+
+qint64 NetScheduler::take(NetPriority priority, RateLimiter *jobLimiter, qint64 wanted)
+{
+	if (priority == Priority_Background && foregroundRunning())
+		return 0;
+	qint64 allowed = qMin(wanted, m_limiter.available());
+	if (jobLimiter)
+		allowed = qMin(allowed, jobLimiter->available());
+	allowed = qMax<qint64>(0, allowed);
+	m_limiter.consume(allowed);
+	if (jobLimiter)
+		jobLimiter->consume(allowed);
+	return allowed;
+}
+
+int NetScheduler::waitTime(NetPriority priority, RateLimiter *jobLimiter)
+{
+	if (priority == Priority_Background && foregroundRunning())
+		return backgroundPollInterval;
+	int wait = m_limiter.waitTime();
+	if (jobLimiter)
+		wait = qMax(wait, jobLimiter->waitTime());
+	return qMax(wait, 10);
+}
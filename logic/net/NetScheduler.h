@@ -0,0 +1,67 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QObject>
+
+#include "NetAction.h"
+#include "RateLimiter.h"
+
+/**
+ * Decides when the parts of NetJobs may start and how fast they may download, by priority.
+ *
+ * Interactive and launch-blocking parts always start right away. Background parts only start
+ * when nothing else is downloading, a few at a time, and the ones already running stop reading
+ * while anything else downloads - news or translations never slow down a launch.
+ *
+ * On top of that, all downloads together may be limited to a number of bytes per second.
+ */
+class NetScheduler : public QObject
+{
+	Q_OBJECT
+public:
+	static NetScheduler &instance();
+
+	/// what a reply buffers before it stops reading from the network, so limits reach the network
+	static const qint64 readBufferSize = 256 * 1024;
+
+	/// limit for all downloads together, in bytes per second. 0 for no limit.
+	void setRateLimit(qint64 bytesPerSecond);
+
+	/// true if a part with this priority may start right now
+	bool mayStart(NetPriority priority) const;
+	void partStarted(NetPriority priority);
+	void partFinished(NetPriority priority);
+
+	/// How many of the @p wanted bytes a download may read right now, given its priority and
+	/// the limit of its job (if any). What it gets is taken out of the limits.
+	qint64 take(NetPriority priority, RateLimiter *jobLimiter, qint64 wanted);
+
+	/// milliseconds until a download that got nothing from take() should ask again
+	int waitTime(NetPriority priority, RateLimiter *jobLimiter);
+
+signals:
+	/// parts that were held back may be able to start now
+	void partsMayStart();
+
+private:
+	NetScheduler() {};
+	bool foregroundRunning() const;
+
+private:
+	int m_running[Priority_Count] = {};
+	RateLimiter m_limiter;
+};
@@ -0,0 +1,240 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PartialFile.h"
+
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegExp>
+#include <QDebug>
+
+namespace
+{
+/// save the state after this much new data, in case MultiMC doesn't get to do it
+const qint64 saveInterval = 1024 * 1024;
+}
+
+PartialFile::PartialFile(const QString &target)
+	: m_target(target), m_file(target + ".part"), m_hash(QCryptographicHash::Md5)
+{
+}
+
+QString PartialFile::partPath() const
+{
+	return m_file.fileName();
+}
+
+bool PartialFile::prepareRequest(QNetworkRequest &request)
+{
+	loadState();
+	m_resumedFrom = 0;
+	if (m_size == 0)
+		return false;
+	if (m_validator.isEmpty())
+	{
+		// nothing to tell whether the rest still belongs to it
+		discard();
+		return false;
+	}
+	qDebug() << "Resuming" << m_target << "from byte" << m_size;
+	request.setRawHeader("Range", "bytes=" + QByteArray::number(m_size) + "-");
+	request.setRawHeader("If-Range", m_validator);
+	return true;
+}
+
+bool PartialFile::carriesContent(QNetworkReply *reply)
+{
+	QVariant status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+	// not HTTP, for example a local file
+	if (!status.isValid())
+		return true;
+	int code = status.toInt();
+	return code == 200 || code == 206;
+}
+
+bool PartialFile::begin(QNetworkReply *reply)
+{
+	loadState();
+	qint64 offset = 0;
+	if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 206)
+	{
+		QRegExp range("bytes (\\d+)-\\d+/(\\d+|\\*)");
+		if (!range.exactMatch(QString::fromLatin1(reply->rawHeader("Content-Range"))) ||
+			range.cap(1).toLongLong() != m_size)
+		{
+			qWarning() << "Got the wrong part of" << m_target << "- starting over.";
+			return false;
+		}
+		offset = m_size;
+	}
+
+	// weak ETags can't be used with If-Range
+	QByteArray etag = reply->rawHeader("ETag");
+	if (!etag.isEmpty() && !etag.startsWith("W/"))
+		m_validator = etag;
+	else
+		m_validator = reply->rawHeader("Last-Modified");
+
+	if (!m_file.isOpen() && !m_file.open(QIODevice::ReadWrite))
+	{
+		qCritical() << "Could not open" << m_file.fileName() << "for writing";
+		return false;
+	}
+	// anything after the good data was written after the state was last saved
+	if (!m_file.resize(offset) || !m_file.seek(offset))
+	{
+		qCritical() << "Could not write to" << m_file.fileName();
+		return false;
+	}
+	m_size = offset;
+	m_resumedFrom = offset;
+	if (offset == 0)
+	{
+		m_hash.reset();
+		m_hashValid = true;
+	}
+	else if (!m_hashValid && !rehash())
+	{
+		return false;
+	}
+	saveState();
+	return true;
+}
+
+bool PartialFile::write(const QByteArray &data)
+{
+	if (m_file.write(data) != data.size())
+		return false;
+	m_hash.addData(data);
+	m_size += data.size();
+	if (m_size - m_savedSize >= saveInterval)
+		saveState();
+	return true;
+}
+
+QByteArray PartialFile::md5()
+{
+	if (!m_hashValid)
+		rehash();
+	return m_hash.result();
+}
+
+void PartialFile::suspend()
+{
+	if (m_validator.isEmpty())
+	{
+		discard();
+		return;
+	}
+	saveState();
+	m_file.close();
+}
+
+bool PartialFile::commit()
+{
+	m_file.close();
+	QFile::remove(partPath() + ".json");
+	if (QFile::exists(m_target) && !QFile::remove(m_target))
+	{
+		qCritical() << "Could not replace" << m_target;
+		discard();
+		return false;
+	}
+	if (!m_file.rename(m_target))
+	{
+		qCritical() << "Could not move" << m_file.fileName() << "to" << m_target;
+		discard();
+		return false;
+	}
+	// ready for the next download to the same place
+	m_file.setFileName(m_target + ".part");
+	m_size = 0;
+	m_savedSize = 0;
+	m_validator.clear();
+	return true;
+}
+
+void PartialFile::discard()
+{
+	m_file.close();
+	m_file.remove();
+	QFile::remove(partPath() + ".json");
+	m_hash.reset();
+	m_hashValid = false;
+	m_validator.clear();
+	m_size = 0;
+	m_savedSize = 0;
+	m_resumedFrom = 0;
+	m_stateLoaded = true;
+}
+
+void PartialFile::loadState()
+{
+	if (m_stateLoaded)
+		return;
+	m_stateLoaded = true;
+
+	QFile stateFile(partPath() + ".json");
+	if (!stateFile.open(QIODevice::ReadOnly))
+		return;
+	QJsonObject state = QJsonDocument::fromJson(stateFile.readAll()).object();
+	qint64 size = state.value("size").toVariant().toLongLong();
+	QByteArray validator = state.value("validator").toString().toLatin1();
+	// the data may have gotten further than the state, but not the other way around
+	if (size <= 0 || validator.isEmpty() || QFileInfo(partPath()).size() < size)
+	{
+		discard();
+		return;
+	}
+	m_size = size;
+	m_savedSize = size;
+	m_validator = validator;
+	m_hashValid = false;
+}
+
+void PartialFile::saveState()
+{
+	m_file.flush();
+	QJsonObject state;
+	state.insert("size", QString::number(m_size));
+	state.insert("validator", QString::fromLatin1(m_validator));
+	QFile stateFile(partPath() + ".json");
+	if (stateFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		stateFile.write(QJsonDocument(state).toJson(QJsonDocument::Compact));
+		m_savedSize = m_size;
+	}
+}
+
+bool PartialFile::rehash()
+{
+	// after a restart, the hash of the data so far has to be worked out again
+	QFile existing(partPath());
+	if (!existing.open(QIODevice::ReadOnly))
+		return false;
+	m_hash.reset();
+	qint64 remaining = m_size;
+	while (remaining > 0)
+	{
+		QByteArray chunk = existing.read(qMin<qint64>(remaining, 1 << 16));
+		if (chunk.isEmpty())
+			return false;
+		m_hash.addData(chunk);
+		remaining -= chunk.size();
+	}
+	m_hashValid = true;
+	return true;
+}
@@ -0,0 +1,88 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+/**
+ * The data of a download in progress, kept on disk so a failed download can be resumed
+ * instead of starting over - by the next retry, or by the next run of MultiMC.
+ *
+ * The data goes to `<target>.part`. Next to it, `<target>.part.json` records how much of it
+ * is good and the validator (a strong ETag or Last-Modified) the server sent with it, so the
+ * rest can be requested with Range and If-Range. If the file changed on the server in the
+ * meantime, the server sends all of it again and the partial data is dropped.
+ */
+class PartialFile
+{
+public:
+	explicit PartialFile(const QString &target);
+
+	QString partPath() const;
+
+	/// Sets up the request to continue from the partial data, if there is any that can be
+	/// continued. Returns true if it did.
+	bool prepareRequest(QNetworkRequest &request);
+
+	/// True if the reply is the file (or the rest of it), and not a redirect or an error page.
+	static bool carriesContent(QNetworkReply *reply);
+
+	/// Call once the headers of a reply that carries content are in. Keeps the partial data if
+	/// the reply continues it, starts over otherwise. False if the reply continues something
+	/// else or the file can't be written - discard() and try again then.
+	bool begin(QNetworkReply *reply);
+
+	bool write(const QByteArray &data);
+
+	/// Where the current reply started - its progress is on top of this.
+	qint64 resumedFrom() const
+	{
+		return m_resumedFrom;
+	}
+
+	/// MD5 of all the data, over all the attempts it took.
+	QByteArray md5();
+
+	/// Remembers how far the download got, so it can be resumed later.
+	void suspend();
+
+	/// Moves the complete data to the target path.
+	bool commit();
+
+	/// Throws away all the data.
+	void discard();
+
+private:
+	void loadState();
+	void saveState();
+	bool rehash();
+
+private:
+	QString m_target;
+	QFile m_file;
+	QCryptographicHash m_hash;
+	/// true if m_hash covers all m_size bytes
+	bool m_hashValid = false;
+	QByteArray m_validator;
+	/// bytes of good data in the part file
+	qint64 m_size = 0;
+	qint64 m_savedSize = 0;
+	qint64 m_resumedFrom = 0;
+	bool m_stateLoaded = false;
+};
@@ -0,0 +1,65 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RateLimiter.h"
+
+#include <limits>
+
+RateLimiter::RateLimiter(qint64 bytesPerSecond)
+{
+	setRate(bytesPerSecond);
+}
+
+void RateLimiter::setRate(qint64 bytesPerSecond)
+{
+	m_rate = qMax<qint64>(0, bytesPerSecond);
+	// start with a full bucket
+	m_tokens = m_rate;
+	m_clock.start();
+}
+
+void RateLimiter::refill()
+{
+	qint64 elapsed = m_clock.restart();
+	m_tokens = qMin<double>(m_rate, m_tokens + double(m_rate) * elapsed / 1000.0);
+}
+
+qint64 RateLimiter::available()
+{
+	if (!m_rate)
+		return std::numeric_limits<qint64>::max();
+	refill();
+	return qint64(m_tokens);
+}
+
+void RateLimiter::consume(qint64 bytes)
+{
+	if (!m_rate)
+		return;
+	refill();
+	m_tokens -= bytes;
+}
+
+int RateLimiter::waitTime()
+{
+	if (!m_rate)
+		return 0;
+	refill();
+	// enough for a useful read, not a trickle of single bytes
+	double wanted = qMin<double>(m_rate, 16 * 1024) - m_tokens;
+	if (wanted <= 0)
+		return 0;
+	return int(wanted * 1000.0 / m_rate) + 1;
+}
@@ -0,0 +1,52 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QElapsedTimer>
+
+/**
+ * A token bucket: lets through a number of bytes per second on average, in bursts of up to
+ * one second worth of data.
+ */
+class RateLimiter
+{
+public:
+	explicit RateLimiter(qint64 bytesPerSecond = 0);
+
+	/// 0 for no limit
+	void setRate(qint64 bytesPerSecond);
+	qint64 rate() const
+	{
+		return m_rate;
+	}
+
+	/// how many bytes may go through right now
+	qint64 available();
+
+	/// takes bytes that went through out of the bucket
+	void consume(qint64 bytes);
+
+	/// milliseconds until something may go through again
+	int waitTime();
+
+private:
+	void refill();
+
+private:
+	qint64 m_rate = 0;
+	double m_tokens = 0;
+	QElapsedTimer m_clock;
+};
@@ -37,6 +37,7 @@ void NewsChecker::reloadNews()
 	qDebug() << "Reloading news.";
 
 	NetJob* job = new NetJob("News RSS Feed");
+	job->setPriority(Priority_Background);
 	job->addNetAction(ByteArrayDownload::make(m_feedUrl));
 	QObject::connect(job, &NetJob::succeeded, this, &NewsChecker::rssDownloadFinished);
 	QObject::connect(job, &NetJob::failed, this, &NewsChecker::rssDownloadFailed);
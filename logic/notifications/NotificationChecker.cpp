@@ -53,6 +53,7 @@ void NotificationChecker::checkForNotifications()
 		return;
 	}
 	m_checkJob.reset(new NetJob("Checking for notifications"));
+	m_checkJob->setPriority(Priority_Background);
 	auto entry = ENV.metacache()->resolveEntry("root", "notifications.json");
 	entry->stale = true;
 	m_checkJob->addNetAction(m_download = CacheDownload::make(m_notificationsUrl, entry));
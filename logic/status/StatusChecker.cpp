@@ -43,6 +43,7 @@ void StatusChecker::reloadStatus()
 	// qDebug() << "Reloading status.";
 
 	NetJob* job = new NetJob("Status JSON");
+	job->setPriority(Priority_Background);
 	job->addNetAction(ByteArrayDownload::make(URLConstants::MOJANG_STATUS_URL));
 	QObject::connect(job, &NetJob::succeeded, this, &StatusChecker::statusDownloadFinished);
 	QObject::connect(job, &NetJob::failed, this, &StatusChecker::statusDownloadFailed);
@@ -16,6 +16,7 @@
 #pragma once
 
 #include <QObject>
+#include "Timeline.h"
 
 class ProgressProvider : public QObject
 {
@@ -34,8 +35,22 @@ signals:
 public:
 	virtual ~ProgressProvider() {}
 	virtual bool isRunning() const = 0;
+
+	/// record the phases of this (and anything it starts) into the timeline
+	void setTimeline(TimelinePtr timeline)
+	{
+		m_timeline = timeline;
+	}
+	TimelinePtr timeline() const
+	{
+		return m_timeline;
+	}
+
 public
 slots:
 	virtual void start() = 0;
 	virtual void abort() = 0;
+
+protected:
+	TimelinePtr m_timeline;
 };
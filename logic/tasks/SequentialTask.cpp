@@ -29,6 +29,10 @@ void SequentialTask::startNext()
 		return;
 	}
 	std::shared_ptr<ProgressProvider> next = m_queue[m_currentIndex];
+	if (m_timeline && !next->timeline())
+	{
+		next->setTimeline(m_timeline);
+	}
 	connect(next.get(), SIGNAL(failed(QString)), this, SLOT(subTaskFailed(QString)));
 	connect(next.get(), SIGNAL(status(QString)), this, SLOT(subTaskStatus(QString)));
 	connect(next.get(), SIGNAL(progress(qint64, qint64)), this, SLOT(subTaskProgress(qint64, qint64)));
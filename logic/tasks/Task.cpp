@@ -30,9 +30,18 @@ void Task::setProgress(int new_progress)
 	emit progress(new_progress, 100);
 }
 
+QString Task::timelineName() const
+{
+	return metaObject()->className();
+}
+
 void Task::start()
 {
 	m_running = true;
+	if (m_timeline)
+	{
+		m_timelinePhase = m_timeline->begin(timelineName());
+	}
 	emit started();
 	executeTask();
 }
@@ -42,6 +51,10 @@ void Task::emitFailed(QString reason)
 	m_running = false;
 	m_succeeded = false;
 	m_failReason = reason;
+	if (m_timeline)
+	{
+		m_timeline->end(m_timelinePhase);
+	}
 	qCritical() << "Task failed: " << reason;
 	emit failed(reason);
 }
@@ -51,6 +64,10 @@ void Task::emitSucceeded()
 	if (!m_running) { return; } // Don't succeed twice.
 	m_running = false;
 	m_succeeded = true;
+	if (m_timeline)
+	{
+		m_timeline->end(m_timelinePhase);
+	}
 	qDebug() << "Task succeeded";
 	emit succeeded();
 }
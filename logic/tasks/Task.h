@@ -48,6 +48,9 @@ slots:
 protected:
 	virtual void executeTask() = 0;
 
+	/// name of this task's phase in the timeline
+	virtual QString timelineName() const;
+
 protected slots:
 	virtual void emitSucceeded();
 	virtual void emitFailed(QString reason);
@@ -61,5 +64,6 @@ protected:
 	bool m_running = false;
 	bool m_succeeded = false;
 	QString m_failReason = "";
+	int m_timelinePhase = -1;
 };
 
@@ -0,0 +1,154 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Timeline.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QCoreApplication>
+#include <QObject>
+
+Timeline::Timeline()
+{
+	m_clock.start();
+}
+
+qint64 Timeline::now() const
+{
+	return m_clock.nsecsElapsed() / 1000;
+}
+
+int Timeline::begin(const QString &name)
+{
+	QMutexLocker locker(&m_mutex);
+	Phase phase;
+	phase.name = name;
+	phase.start = now();
+	phase.depth = m_open++;
+	m_phases.append(phase);
+	return m_phases.size() - 1;
+}
+
+void Timeline::end(int phase, qint64 bytes, int files)
+{
+	QMutexLocker locker(&m_mutex);
+	if (phase < 0 || phase >= m_phases.size())
+		return;
+	auto &entry = m_phases[phase];
+	if (entry.end != -1)
+		return;
+	entry.end = now();
+	entry.bytes = bytes;
+	entry.files = files;
+	m_open--;
+}
+
+QList<Timeline::Phase> Timeline::phases() const
+{
+	QMutexLocker locker(&m_mutex);
+	return m_phases;
+}
+
+static QString formatBytes(qint64 bytes)
+{
+	if (bytes < 1024)
+		return QObject::tr("%1 B").arg(bytes);
+	if (bytes < 1024 * 1024)
+		return QObject::tr("%1 KiB").arg(bytes / 1024.0, 0, 'f', 1);
+	return QObject::tr("%1 MiB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+QString Timeline::summary() const
+{
+	auto all = phases();
+	QString out;
+	qint64 first = -1;
+	qint64 last = 0;
+	for (auto &phase : all)
+	{
+		QString line = QString(phase.depth * 2, ' ') + phase.name + ": ";
+		if (phase.end == -1)
+		{
+			line += QObject::tr("unfinished");
+		}
+		else
+		{
+			line += QObject::tr("%1 ms").arg((phase.end - phase.start) / 1000);
+			last = qMax(last, phase.end);
+		}
+		if (first == -1)
+			first = phase.start;
+		QStringList details;
+		if (phase.files)
+			details << QObject::tr("%n file(s)", "", phase.files);
+		if (phase.bytes)
+			details << formatBytes(phase.bytes);
+		if (!details.isEmpty())
+			line += " (" + details.join(", ") + ")";
+		out += line + "\n";
+	}
+	if (first != -1 && last > first)
+	{
+		out += QObject::tr("Total: %1 ms").arg((last - first) / 1000) + "\n";
+	}
+	return out;
+}
+
+QByteArray Timeline::toChromeTrace() const
+{
+	auto all = phases();
+	qint64 pid = QCoreApplication::applicationPid();
+	QJsonArray events;
+	for (auto &phase : all)
+	{
+		QJsonObject event;
+		event.insert("name", phase.name);
+		event.insert("cat", QString("launch"));
+		event.insert("pid", double(pid));
+		// overlapping phases that don't nest would confuse the viewer, keep each depth on its own row
+		event.insert("tid", phase.depth);
+		event.insert("ts", double(phase.start));
+		if (phase.end == -1)
+		{
+			// chrome shows unmatched begin events as running until the end of the trace
+			event.insert("ph", QString("B"));
+		}
+		else
+		{
+			event.insert("ph", QString("X"));
+			event.insert("dur", double(phase.end - phase.start));
+		}
+		QJsonObject args;
+		args.insert("bytes", double(phase.bytes));
+		args.insert("files", phase.files);
+		event.insert("args", args);
+		events.append(event);
+	}
+	QJsonObject root;
+	root.insert("traceEvents", events);
+	root.insert("displayTimeUnit", QString("ms"));
+	return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool Timeline::saveChromeTrace(const QString &path) const
+{
+	QFile file(path);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	auto data = toChromeTrace();
+	return file.write(data) == data.size();
+}
@@ -0,0 +1,105 @@
+/* Copyright 2013-2015 MultiMC Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <memory>
+
+class Timeline;
+typedef std::shared_ptr<Timeline> TimelinePtr;
+
+/**
+ * Records named phases of a multi-step operation (like launching an instance) with their
+ * wall time, bytes transferred and number of files touched.
+ *
+ * Phases may overlap and nest. The result can be printed as a short summary or saved as
+ * a Chrome trace (chrome://tracing, about:tracing) for closer inspection.
+ */
+class Timeline
+{
+public:
+	struct Phase
+	{
+		QString name;
+		/// start and end in microseconds since the timeline was created. end is -1 while open.
+		qint64 start = 0;
+		qint64 end = -1;
+		qint64 bytes = 0;
+		int files = 0;
+		/// number of phases that were open when this one started
+		int depth = 0;
+	};
+
+	Timeline();
+
+	/// start a phase. Returns the handle to pass to end()
+	int begin(const QString &name);
+
+	/// end a phase started by begin(). Ending a phase twice or an invalid handle does nothing.
+	void end(int phase, qint64 bytes = 0, int files = 0);
+
+	/// copy of all the phases recorded so far
+	QList<Phase> phases() const;
+
+	/// human readable summary, one phase per line
+	QString summary() const;
+
+	/// the timeline in the Chrome trace event format
+	QByteArray toChromeTrace() const;
+
+	/// save toChromeTrace() into a file
+	bool saveChromeTrace(const QString &path) const;
+
+private:
+	qint64 now() const;
+
+private:
+	QElapsedTimer m_clock;
+	QList<Phase> m_phases;
+	int m_open = 0;
+	mutable QMutex m_mutex;
+};
+
+/// Times the enclosing block as a phase. Does nothing without a timeline.
+class TimelineScope
+{
+public:
+	TimelineScope(TimelinePtr timeline, const QString &name) : m_timeline(timeline)
+	{
+		if (m_timeline)
+			m_phase = m_timeline->begin(name);
+	}
+	~TimelineScope()
+	{
+		if (m_timeline)
+			m_timeline->end(m_phase, m_bytes, m_files);
+	}
+	void addFile(qint64 bytes)
+	{
+		m_bytes += bytes;
+		m_files++;
+	}
+
+private:
+	TimelinePtr m_timeline;
+	int m_phase = -1;
+	qint64 m_bytes = 0;
+	int m_files = 0;
+};
@@ -23,6 +23,7 @@
 #include <QFile>
 #include <QTemporaryDir>
 #include <QCryptographicHash>
+#include <QtConcurrentRun>
 
 namespace GoUpdate
 {
@@ -31,8 +32,7 @@ DownloadTask::DownloadTask(Status status, QObject *parent)
 	: Task(parent)
 {
 	m_status = status;
-
-	m_updateFilesDir.setAutoRemove(false);
+	connect(&m_hashWatcher, SIGNAL(finished()), SLOT(installedFilesHashed()));
 }
 
 void DownloadTask::setUseLocalUpdater(bool useLocal)
@@ -40,13 +40,45 @@ void DownloadTask::setUseLocalUpdater(bool useLocal)
 	m_keepLocalUpdater = useLocal;
 }
 
-void DownloadTask::executeTask()
+void DownloadTask::prepare()
 {
+	if (m_preparation != NotPrepared)
+		return;
 	loadVersionInfo();
 }
 
+void DownloadTask::executeTask()
+{
+	m_startRequested = true;
+	switch (m_preparation)
+	{
+	case NotPrepared:
+		loadVersionInfo();
+		break;
+	case Preparing:
+		// continues when the preparation is done
+		setStatus(tr("Checking installed files..."));
+		break;
+	case Prepared:
+		startDownload();
+		break;
+	}
+}
+
+void DownloadTask::preparationFailed(QString reason)
+{
+	m_preparation = NotPrepared;
+	if (m_startRequested)
+	{
+		emitFailed(reason);
+		return;
+	}
+	qWarning() << "Preparing the update failed:" << reason << "- trying again when it starts.";
+}
+
 void DownloadTask::loadVersionInfo()
 {
+	m_preparation = Preparing;
 	setStatus(tr("Loading version information..."));
 
 	m_currentVersionFileListDownload.reset();
@@ -87,14 +119,13 @@ void DownloadTask::vinfoDownloadFailed()
 
 	// TODO: Give a more detailed error message.
 	qCritical() << "Failed to download version info files.";
-	emitFailed(tr("Failed to download version info files."));
+	preparationFailed(tr("Failed to download version info files."));
 }
 
 void DownloadTask::processDownloadedVersionInfo()
 {
-	VersionFileList m_currentVersionFileList;
-	VersionFileList m_newVersionFileList;
-	OperationList operationList;
+	m_currentVersionFileList.clear();
+	m_newVersionFileList.clear();
 
 	setStatus(tr("Reading file list for new version..."));
 	qDebug() << "Reading file list for new version...";
@@ -102,7 +133,7 @@ void DownloadTask::processDownloadedVersionInfo()
 	if (!parseVersionInfo(m_newVersionFileListDownload->m_data, m_newVersionFileList, error))
 	{
 		qCritical() << error;
-		emitFailed(error);
+		preparationFailed(error);
 		return;
 	}
 
@@ -124,43 +155,102 @@ void DownloadTask::processDownloadedVersionInfo()
 	m_newVersionFileListDownload.reset();
 	m_vinfoNetJob.reset();
 
+	// reading every installed file takes a while, keep it off the GUI thread
+	setStatus(tr("Checking installed files..."));
+	m_hashWatcher.setFuture(
+		QtConcurrent::run(hashInstalledFiles, m_newVersionFileList, m_status.rootPath));
+}
+
+void DownloadTask::installedFilesHashed()
+{
+	m_operationList.clear();
+
 	setStatus(tr("Processing file lists - figuring out how to install the update..."));
 
 	// make a new netjob for the actual update files
 	NetJobPtr netJob (new NetJob("Update Files"));
 
 	// fill netJob and operationList
-	if (!processFileLists(m_currentVersionFileList, m_newVersionFileList, m_status.rootPath, m_updateFilesDir.path(), netJob, operationList, m_keepLocalUpdater))
+	if (!processFileLists(m_currentVersionFileList, m_newVersionFileList, m_status.rootPath,
+						  m_updateFilesDir.path(), netJob, m_operationList, m_keepLocalUpdater,
+						  m_hashWatcher.result(), m_useDeltas))
 	{
-		emitFailed(tr("Failed to process update lists..."));
+		preparationFailed(tr("Failed to process update lists..."));
 		return;
 	}
 
 	// write the instruction file for the file swapper
-	if(!writeInstallScript(operationList, PathCombine(m_updateFilesDir.path(), "file_list.xml")))
+	if(!writeInstallScript(m_operationList, PathCombine(m_updateFilesDir.path(), "file_list.xml")))
 	{
-		emitFailed(tr("Failed to write update script file."));
+		preparationFailed(tr("Failed to write update script file."));
 		return;
 	}
 
+	m_filesNetJob = netJob;
+	m_preparation = Prepared;
+	if (m_startRequested)
+	{
+		startDownload();
+	}
+}
+
+void DownloadTask::startDownload()
+{
+	// the updater picks the files up from here after MultiMC exits
+	m_updateFilesDir.setAutoRemove(false);
+
 	// Now start the download.
-	QObject::connect(netJob.get(), &NetJob::succeeded, this, &DownloadTask::fileDownloadFinished);
-	QObject::connect(netJob.get(), &NetJob::progress, this, &DownloadTask::fileDownloadProgressChanged);
-	QObject::connect(netJob.get(), &NetJob::failed, this, &DownloadTask::fileDownloadFailed);
+	QObject::connect(m_filesNetJob.get(), &NetJob::succeeded, this, &DownloadTask::fileDownloadFinished);
+	QObject::connect(m_filesNetJob.get(), &NetJob::progress, this, &DownloadTask::fileDownloadProgressChanged);
+	QObject::connect(m_filesNetJob.get(), &NetJob::failed, this, &DownloadTask::fileDownloadFailed);
 
-	setStatus(tr("Downloading %1 update files.").arg(QString::number(netJob->size())));
+	setStatus(tr("Downloading %1 update files.").arg(QString::number(m_filesNetJob->size())));
 	qDebug() << "Begin downloading update files to" << m_updateFilesDir.path();
-	m_filesNetJob = netJob;
 	m_filesNetJob->start();
 }
 
+bool DownloadTask::fallBackToFullDownloads()
+{
+	if (!m_useDeltas)
+		return false;
+	bool hasPatches = false;
+	for (auto &op : m_operationList)
+	{
+		if (op.type == Operation::OP_PATCH)
+			hasPatches = true;
+	}
+	if (!hasPatches)
+		return false;
+
+	qWarning() << "Delta patches can't be used, downloading whole files instead.";
+	m_useDeltas = false;
+	// not from within the slots of the failed job, it goes away
+	QMetaObject::invokeMethod(this, "installedFilesHashed", Qt::QueuedConnection);
+	return true;
+}
+
 void DownloadTask::fileDownloadFinished()
 {
+	// the updater checks patches too, but then it can only give up
+	for (auto &op : m_operationList)
+	{
+		if (op.type != Operation::OP_PATCH)
+			continue;
+		if (!checkDeltaPatch(op, m_hashWatcher.result()))
+		{
+			if (fallBackToFullDownloads())
+				return;
+			emitFailed(tr("Failed to download update files."));
+			return;
+		}
+	}
 	emitSucceeded();
 }
 
 void DownloadTask::fileDownloadFailed()
 {
+	if (fallBackToFullDownloads())
+		return;
 	// TODO: Give more info about the failure.
 	qCritical() << "Failed to download update files.";
 	emitFailed(tr("Failed to download update files."));
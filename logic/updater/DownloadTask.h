@@ -19,6 +19,8 @@
 #include "net/NetJob.h"
 #include "GoUpdate.h"
 
+#include <QFutureWatcher>
+
 namespace GoUpdate
 {
 /*!
@@ -38,6 +40,13 @@ public:
 	/// set updater download behavior
 	void setUseLocalUpdater(bool useLocal);
 
+	/*!
+	 * Downloads the file lists and works out what needs to be updated, without downloading
+	 * anything else. Call it as soon as an update is known to exist - start() then picks up
+	 * from wherever this got to.
+	 */
+	void prepare();
+
 protected:
 	//! Entry point for tasks.
 	virtual void executeTask() override;
@@ -61,7 +70,29 @@ protected:
 
 	Status m_status;
 
-	bool m_keepLocalUpdater;
+	bool m_keepLocalUpdater = false;
+
+	//! How far prepare() got.
+	enum
+	{
+		NotPrepared,
+		Preparing,
+		Prepared
+	} m_preparation = NotPrepared;
+
+	//! True once the task was started, as opposed to just prepared.
+	bool m_startRequested = false;
+
+	VersionFileList m_currentVersionFileList;
+	VersionFileList m_newVersionFileList;
+
+	OperationList m_operationList;
+
+	//! Cleared when a delta patch can't be used, to download whole files instead.
+	bool m_useDeltas = true;
+
+	//! Hashes the installed files on a worker thread.
+	QFutureWatcher<FileStateMap> m_hashWatcher;
 
 	/*!
 	 * Temporary directory to store update files in.
@@ -77,9 +108,22 @@ protected slots:
 	void processDownloadedVersionInfo();
 	void vinfoDownloadFailed();
 
+	/*!
+	 * Called when the installed files are hashed. Builds the operation list and the download
+	 * job, and starts it if the task was started already.
+	 */
+	void installedFilesHashed();
+
 	void fileDownloadFinished();
 	void fileDownloadFailed();
 	void fileDownloadProgressChanged(qint64 current, qint64 total);
+
+private:
+	void startDownload();
+	/// start over with full downloads if any files were to be patched, returns false otherwise
+	bool fallBackToFullDownloads();
+	/// fail the task if it was started, otherwise prepare again when it is
+	void preparationFailed(QString reason);
 };
 
 }
\ No newline at end of file
@@ -3,6 +3,11 @@
 #include <QDebug>
 #include <QDomDocument>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutex>
+#include <QCryptographicHash>
+#include <QtConcurrentMap>
 #include <Env.h>
 
 namespace GoUpdate
@@ -52,6 +57,13 @@ bool parseVersionInfo(const QByteArray &data, VersionFileList &list, QString &er
 			{
 				file.sources.append(FileSource("http", sourceObj.value("Url").toString()));
 			}
+			else if (type == "delta")
+			{
+				FileSource source("delta", sourceObj.value("Url").toString());
+				source.baseMd5 = sourceObj.value("BaseMD5").toString();
+				source.md5 = sourceObj.value("MD5").toString();
+				file.sources.append(source);
+			}
 			else
 			{
 				qWarning() << "Unknown source type" << type << "ignored.";
@@ -66,6 +78,113 @@ bool parseVersionInfo(const QByteArray &data, VersionFileList &list, QString &er
 	return true;
 }
 
+namespace
+{
+struct HashCacheEntry
+{
+	qint64 size;
+	QDateTime modified;
+	QString md5;
+};
+
+/// MD5s of installed files, kept between update checks
+struct HashCache
+{
+	QMutex mutex;
+	QHash<QString, HashCacheEntry> entries;
+};
+
+HashCache &hashCache()
+{
+	static HashCache cache;
+	return cache;
+}
+
+struct HashJob
+{
+	QString rootPath;
+	QString path;
+	FileState state;
+};
+
+void hashInstalledFile(HashJob &job)
+{
+	QString realPath = PathCombine(job.rootPath, job.path);
+	QFileInfo info(realPath);
+	if (!info.exists())
+	{
+		return;
+	}
+	job.state.exists = true;
+	if (!info.isReadable())
+	{
+		qCritical() << "File " << realPath << " is not readable.";
+		job.state.usable = false;
+	}
+	if (!info.isWritable())
+	{
+		qCritical() << "File " << realPath << " is not writable.";
+		job.state.usable = false;
+	}
+	if (!job.state.usable)
+	{
+		return;
+	}
+
+	auto &cache = hashCache();
+	{
+		QMutexLocker locker(&cache.mutex);
+		auto iter = cache.entries.find(realPath);
+		if (iter != cache.entries.end() && iter->size == info.size() &&
+			iter->modified == info.lastModified())
+		{
+			job.state.md5 = iter->md5;
+			return;
+		}
+	}
+
+	QFile file(realPath);
+	if (!file.open(QFile::ReadOnly))
+	{
+		qCritical() << "File " << realPath << " cannot be opened for reading.";
+		job.state.usable = false;
+		return;
+	}
+	// the big files are tens of megabytes, don't read them in one go
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	QByteArray buffer;
+	while (!(buffer = file.read(1 << 16)).isEmpty())
+	{
+		hash.addData(buffer);
+	}
+	if (file.error() != QFile::NoError)
+	{
+		qCritical() << "File " << realPath << " cannot be read:" << file.errorString();
+		job.state.usable = false;
+		return;
+	}
+	job.state.md5 = hash.result().toHex();
+	QMutexLocker locker(&cache.mutex);
+	cache.entries.insert(realPath, HashCacheEntry{info.size(), info.lastModified(), job.state.md5});
+}
+}
+
+FileStateMap hashInstalledFiles(const VersionFileList &files, const QString &rootPath)
+{
+	QVector<HashJob> jobs;
+	for (auto &entry : files)
+	{
+		jobs.append(HashJob{rootPath, entry.path, FileState()});
+	}
+	QtConcurrent::blockingMap(jobs, hashInstalledFile);
+	FileStateMap states;
+	for (auto &job : jobs)
+	{
+		states.insert(job.path, job.state);
+	}
+	return states;
+}
+
 bool processFileLists
 (
 	const VersionFileList &currentVersion,
@@ -76,6 +195,23 @@ bool processFileLists
 	OperationList &ops,
 	bool useLocalUpdater
 )
+{
+	return processFileLists(currentVersion, newVersion, rootPath, tempPath, job, ops,
+							useLocalUpdater, hashInstalledFiles(newVersion, rootPath));
+}
+
+bool processFileLists
+(
+	const VersionFileList &currentVersion,
+	const VersionFileList &newVersion,
+	const QString &rootPath,
+	const QString &tempPath,
+	NetJobPtr job,
+	OperationList &ops,
+	bool useLocalUpdater,
+	const FileStateMap &installed,
+	bool useDeltas
+)
 {
 	// First, if we've loaded the current version's file list, we need to iterate through it and
 	// delete anything in the current one version's list that isn't in the new version's list.
@@ -112,57 +248,25 @@ bool processFileLists
 	// Next, check each file in MultiMC's folder and see if we need to update them.
 	for (VersionFileEntry entry : newVersion)
 	{
-		// TODO: Let's not MD5sum a ton of files on the GUI thread. We should probably find a
-		// way to do this in the background.
-		QString fileMD5;
 		QString realEntryPath = PathCombine(rootPath, entry.path);
-		QFile entryFile(realEntryPath);
-		QFileInfo entryInfo(realEntryPath);
+		FileState state = installed.value(entry.path);
 
 		bool needs_upgrade = false;
-		if (!entryFile.exists())
+		if (!state.exists)
 		{
 			needs_upgrade = true;
 		}
-		else
+		else if (!state.usable)
 		{
-			bool pass = true;
-			if (!entryInfo.isReadable())
-			{
-				qCritical() << "File " << realEntryPath << " is not readable.";
-				pass = false;
-			}
-			if (!entryInfo.isWritable())
-			{
-				qCritical() << "File " << realEntryPath << " is not writable.";
-				pass = false;
-			}
-			if (!entryFile.open(QFile::ReadOnly))
-			{
-				qCritical() << "File " << realEntryPath << " cannot be opened for reading.";
-				pass = false;
-			}
-			if (!pass)
-			{
-				ops.clear();
-				return false;
-			}
+			ops.clear();
+			return false;
 		}
-
-		if(!needs_upgrade)
+		else if (state.md5 != entry.md5)
 		{
-			QCryptographicHash hash(QCryptographicHash::Md5);
-			auto foo = entryFile.readAll();
-
-			hash.addData(foo);
-			fileMD5 = hash.result().toHex();
-			if ((fileMD5 != entry.md5))
-			{
-				qDebug() << "MD5Sum does not match!";
-				qDebug() << "Expected:'" << entry.md5 << "'";
-				qDebug() << "Got:     '" << fileMD5 << "'";
-				needs_upgrade = true;
-			}
+			qDebug() << "MD5Sum does not match!";
+			qDebug() << "Expected:'" << entry.md5 << "'";
+			qDebug() << "Got:     '" << state.md5 << "'";
+			needs_upgrade = true;
 		}
 
 		// skip file. it doesn't need an upgrade.
@@ -178,6 +282,31 @@ bool processFileLists
 		// if it's the updater we want to treat it separately
 		bool isUpdater = entry.path.endsWith("updater") || entry.path.endsWith("updater.exe");
 
+		// A patch against the installed file is a lot smaller than the whole file. The updater
+		// applies it, so it can't patch itself.
+		if (useDeltas && !isUpdater && state.exists)
+		{
+			bool patched = false;
+			for (FileSource source : entry.sources)
+			{
+				if (source.type != "delta" || source.baseMd5 != state.md5)
+					continue;
+
+				qDebug() << "Will patch" << entry.path << "with" << source.url;
+
+				QString patchPath =
+					PathCombine(tempPath, QString(entry.path).replace("/", "_") + ".patch");
+				auto download = MD5EtagDownload::make(source.url, patchPath);
+				download->m_expected_md5 = source.md5;
+				job->addNetAction(download);
+				ops.append(Operation::PatchOp(patchPath, entry.path, entry.mode, entry.md5));
+				patched = true;
+				break;
+			}
+			if (patched)
+				continue;
+		}
+
 		// Go through the sources list and find one to use.
 		// TODO: Make a NetAction that takes a source list and tries each of them until one
 		// works. For now, we'll just use the first http one.
@@ -223,6 +352,37 @@ bool processFileLists
 	return true;
 }
 
+bool checkDeltaPatch(const Operation &op, const FileStateMap &installed)
+{
+	// the format is described in the updater's DeltaPatch.h
+	QFile patch(op.file);
+	if (!patch.open(QFile::ReadOnly))
+	{
+		qCritical() << "Delta patch" << op.file << "cannot be opened for reading.";
+		return false;
+	}
+	QByteArray header = patch.read(8 + 1 + 16 + 16);
+	if (header.size() != 8 + 1 + 16 + 16 || !header.startsWith("MMCDELTA") || header[8] != 1)
+	{
+		qCritical() << "Delta patch" << op.file << "is not a patch this updater can apply.";
+		return false;
+	}
+	QString baseMd5 = header.mid(9, 16).toHex();
+	QString targetMd5 = header.mid(25, 16).toHex();
+	if (targetMd5 != op.md5)
+	{
+		qCritical() << "Delta patch" << op.file << "doesn't produce" << op.dest;
+		return false;
+	}
+	// hashed before the download, reading it again would block the GUI thread
+	if (installed.value(op.dest).md5 != baseMd5)
+	{
+		qCritical() << "Delta patch" << op.file << "was made for another version of" << op.dest;
+		return false;
+	}
+	return true;
+}
+
 bool fixPathForOSX(QString &path)
 {
 	if (path.startsWith("MultiMC.app/"))
@@ -279,6 +439,26 @@ bool writeInstallScript(OperationList &opsList, QString scriptFile)
 		}
 		break;
 
+		case Operation::OP_PATCH:
+		{
+			// Patch the installed file.
+			QDomElement name = doc.createElement("source");
+			QDomElement path = doc.createElement("dest");
+			QDomElement mode = doc.createElement("mode");
+			QDomElement md5 = doc.createElement("delta-md5");
+			name.appendChild(doc.createTextNode(op.file));
+			path.appendChild(doc.createTextNode(op.dest));
+			mode.appendChild(doc.createTextNode("0" + QString::number(op.mode, 8)));
+			md5.appendChild(doc.createTextNode(op.md5));
+			file.appendChild(name);
+			file.appendChild(path);
+			file.appendChild(mode);
+			file.appendChild(md5);
+			installFiles.appendChild(file);
+			qDebug() << "Will patch file " << op.dest << " with " << op.file;
+		}
+		break;
+
 		case Operation::OP_DELETE:
 		{
 			// Delete the file.
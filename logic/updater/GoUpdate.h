@@ -1,5 +1,6 @@
 #pragma once
 #include <QByteArray>
+#include <QHash>
 #include <net/NetJob.h>
 
 namespace GoUpdate
@@ -36,12 +37,18 @@ struct FileSource
 
 	bool operator==(const FileSource &f2) const
 	{
-		return type == f2.type && url == f2.url && compressionType == f2.compressionType;
+		return type == f2.type && url == f2.url && compressionType == f2.compressionType &&
+			   baseMd5 == f2.baseMd5 && md5 == f2.md5;
 	}
 
 	QString type;
 	QString url;
 	QString compressionType;
+
+	//! For "delta" sources: MD5 of the installed file the patch applies to.
+	QString baseMd5;
+	//! For "delta" sources: MD5 of the patch itself.
+	QString md5;
 };
 typedef QList<FileSource> FileSourceList;
 
@@ -70,11 +77,12 @@ struct Operation
 	static Operation MoveOp(QString fsource, QString fdest, int fmode=0644) { return Operation{OP_MOVE, fsource, fdest, fmode}; }
 	static Operation DeleteOp(QString file) { return Operation{OP_DELETE, file, "", 0644}; }
 	static Operation ChmodOp(QString file, int fmode) { return Operation{OP_CHMOD, file, "", fmode}; }
+	static Operation PatchOp(QString fpatch, QString fdest, int fmode, QString fmd5) { return Operation{OP_PATCH, fpatch, fdest, fmode, fmd5}; }
 
 	// FIXME: for some types, some of the other fields are irrelevant!
 	bool operator==(const Operation &u2) const
 	{
-		return type == u2.type && file == u2.file && dest == u2.dest && mode == u2.mode;
+		return type == u2.type && file == u2.file && dest == u2.dest && mode == u2.mode && md5 == u2.md5;
 	}
 
 	//! Specifies the type of operation that this is.
@@ -84,6 +92,8 @@ struct Operation
 		OP_DELETE,
 		OP_MOVE,
 		OP_CHMOD,
+		//! Like OP_COPY, but the file is a delta patch against the installed file.
+		OP_PATCH,
 	} type;
 
 	//! The file to operate on. If this is a DELETE or CHMOD operation, this is the file that will be modified.
@@ -94,9 +104,32 @@ struct Operation
 
 	//! The mode to change the source file to. Ignored if this isn't a CHMOD operation.
 	int mode;
+
+	//! The MD5 the patched file must have. Only used by PATCH operations.
+	QString md5;
 };
 typedef QList<Operation> OperationList;
 
+/**
+ * What an installed file looks like, as far as updating it is concerned.
+ */
+struct FileState
+{
+	bool exists = false;
+	//! False if the file can't be read, written or opened - it can't be updated then.
+	bool usable = true;
+	QString md5;
+};
+//! File states keyed by the path of the VersionFileEntry.
+typedef QHash<QString, FileState> FileStateMap;
+
+/*!
+ * Looks at the installed files of the given version below rootPath, hashing them in parallel.
+ * Hashes are remembered by path, size and modification time, so files that didn't change since
+ * the last update check are not read again. Safe to call from any thread.
+ */
+FileStateMap hashInstalledFiles(const VersionFileList &files, const QString &rootPath);
+
 /**
  * Takes the @OperationList list and writes an install script for the updater to the update files directory.
  */
@@ -122,6 +155,31 @@ bool processFileLists
 	bool useLocalUpdater
 );
 
+/*!
+ * Same as above, with the installed files already looked at by hashInstalledFiles().
+ * If useDeltas is set, files with a "delta" source for the installed version are patched
+ * instead of downloaded whole.
+ */
+bool processFileLists
+(
+	const VersionFileList &currentVersion,
+	const VersionFileList &newVersion,
+	const QString &rootPath,
+	const QString &tempPath,
+	NetJobPtr job,
+	OperationList &ops,
+	bool useLocalUpdater,
+	const FileStateMap &installed,
+	bool useDeltas = true
+);
+
+/*!
+ * Checks that the header of a downloaded delta patch matches what the patch operation expects,
+ * before the updater gets to it: it must patch the installed file, as hashed by
+ * hashInstalledFiles(), into a file with the operation's MD5. Only reads the patch header.
+ */
+bool checkDeltaPatch(const Operation &op, const FileStateMap &installed);
+
 /*!
  * This fixes destination paths for OSX - removes 'MultiMC.app' prefix
  * The updater runs in MultiMC.app/Contents/MacOs by default
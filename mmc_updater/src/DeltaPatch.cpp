@@ -0,0 +1,406 @@
+#include "DeltaPatch.h"
+
+#include "DirIterator.h"
+#include "Log.h"
+#include "Md5.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unordered_map>
+
+namespace
+{
+	const char magic[] = "MMCDELTA";
+	const size_t magicLength = 8;
+	const char formatVersion = 1;
+	// magic, version, two MD5s and the target size
+	const size_t headerLength = magicLength + 1 + 16 + 16 + 8;
+
+	enum Instruction
+	{
+		End = 0,
+		Copy = 1,
+		Add = 2
+	};
+
+	// matches shorter than this are not worth a COPY instruction
+	const size_t blockSize = 32;
+	const uint32_t hashFactor = 257;
+	const uint64_t maxLength = 0xffffffff;
+
+	std::string readWholeFile(const char* path) throw (FileUtils::IOException)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file.good())
+		{
+			throw FileUtils::IOException("Failed to read file " + std::string(path));
+		}
+		std::string content;
+		char buffer[1 << 16];
+		while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+		{
+			content.append(buffer, static_cast<size_t>(file.gcount()));
+		}
+		if (file.bad())
+		{
+			throw FileUtils::IOException("Error reading file " + std::string(path));
+		}
+		return content;
+	}
+
+	void writeWholeFile(const char* path, const std::string& content) throw (FileUtils::IOException)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(content.data(), static_cast<std::streamsize>(content.size()));
+		file.close();
+		if (file.fail())
+		{
+			throw FileUtils::IOException("Error writing file " + std::string(path));
+		}
+	}
+
+	void putUint(std::string& out, uint64_t value, int bytes)
+	{
+		for (int i = 0; i < bytes; i++)
+		{
+			out += static_cast<char>((value >> (8 * i)) & 0xff);
+		}
+	}
+
+	uint64_t getUint(const std::string& in, size_t pos, int bytes)
+	{
+		uint64_t value = 0;
+		for (int i = 0; i < bytes; i++)
+		{
+			value |= static_cast<uint64_t>(static_cast<unsigned char>(in[pos + i])) << (8 * i);
+		}
+		return value;
+	}
+
+	std::string hexToRaw(const std::string& hex)
+	{
+		std::string raw;
+		for (size_t i = 0; i + 1 < hex.size(); i += 2)
+		{
+			raw += static_cast<char>(strtol(hex.substr(i, 2).c_str(), 0, 16));
+		}
+		return raw;
+	}
+
+	std::string rawToHex(const std::string& raw)
+	{
+		static const char digits[] = "0123456789abcdef";
+		std::string hex;
+		for (size_t i = 0; i < raw.size(); i++)
+		{
+			unsigned char byte = static_cast<unsigned char>(raw[i]);
+			hex += digits[byte >> 4];
+			hex += digits[byte & 0xf];
+		}
+		return hex;
+	}
+
+	std::string md5(const std::string& data)
+	{
+		Md5 hash;
+		hash.addData(data.data(), data.size());
+		return hash.hexDigest();
+	}
+
+	uint32_t blockHash(const std::string& data, size_t pos)
+	{
+		uint32_t hash = 0;
+		for (size_t i = 0; i < blockSize; i++)
+		{
+			hash = hash * hashFactor + static_cast<unsigned char>(data[pos + i]);
+		}
+		return hash;
+	}
+
+	void addLiteral(std::string& patch, const std::string& target, size_t from, size_t to)
+	{
+		while (from < to)
+		{
+			size_t length = static_cast<size_t>(std::min<uint64_t>(to - from, maxLength));
+			patch += static_cast<char>(Add);
+			putUint(patch, length, 4);
+			patch.append(target, from, length);
+			from += length;
+		}
+	}
+
+	void addCopy(std::string& patch, size_t offset, size_t length)
+	{
+		while (length > 0)
+		{
+			size_t part = static_cast<size_t>(std::min<uint64_t>(length, maxLength));
+			patch += static_cast<char>(Copy);
+			putUint(patch, offset, 8);
+			putUint(patch, part, 4);
+			offset += part;
+			length -= part;
+		}
+	}
+
+	void collectFiles(const std::string& root, const std::string& relative,
+	                  std::vector<std::string>& files)
+	{
+		std::string path = relative.empty() ? root : root + '/' + relative;
+		DirIterator dir(path.c_str());
+		while (dir.next())
+		{
+			std::string name = dir.fileName();
+			if (name == "." || name == "..")
+			{
+				continue;
+			}
+			std::string file = relative.empty() ? name : relative + '/' + name;
+			if (dir.isDir())
+			{
+				collectFiles(root, file, files);
+			}
+			else
+			{
+				files.push_back(file);
+			}
+		}
+	}
+
+	uint64_t fileSize(const std::string& path)
+	{
+		std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+		return static_cast<uint64_t>(file.tellg());
+	}
+}
+
+void DeltaPatch::create(const char* basePath, const char* targetPath, const char* patchPath)
+	throw (FileUtils::IOException)
+{
+	std::string base = readWholeFile(basePath);
+	std::string target = readWholeFile(targetPath);
+
+	std::string patch(magic, magicLength);
+	patch += formatVersion;
+	patch += hexToRaw(md5(base));
+	patch += hexToRaw(md5(target));
+	putUint(patch, target.size(), 8);
+
+	// index the blocks of the base file, then look for them at every offset of the target
+	std::unordered_map<uint32_t, size_t> blocks;
+	for (size_t offset = 0; offset + blockSize <= base.size(); offset += blockSize)
+	{
+		blocks.insert(std::make_pair(blockHash(base, offset), offset));
+	}
+	uint32_t dropFactor = 1;
+	for (size_t i = 1; i < blockSize; i++)
+	{
+		dropFactor *= hashFactor;
+	}
+
+	size_t literalStart = 0;
+	size_t pos = 0;
+	uint32_t hash = 0;
+	bool hashValid = false;
+	while (pos + blockSize <= target.size())
+	{
+		if (!hashValid)
+		{
+			hash = blockHash(target, pos);
+			hashValid = true;
+		}
+		std::unordered_map<uint32_t, size_t>::const_iterator block = blocks.find(hash);
+		if (block != blocks.end() && base.compare(block->second, blockSize, target, pos, blockSize) == 0)
+		{
+			size_t from = block->second;
+			size_t length = blockSize;
+			while (from + length < base.size() && pos + length < target.size() &&
+			       base[from + length] == target[pos + length])
+			{
+				length++;
+			}
+			// the match may also start before the block did
+			while (from > 0 && pos > literalStart && base[from - 1] == target[pos - 1])
+			{
+				from--;
+				pos--;
+				length++;
+			}
+			addLiteral(patch, target, literalStart, pos);
+			addCopy(patch, from, length);
+			pos += length;
+			literalStart = pos;
+			hashValid = false;
+			continue;
+		}
+		if (pos + blockSize < target.size())
+		{
+			hash = (hash - dropFactor * static_cast<unsigned char>(target[pos])) * hashFactor +
+			       static_cast<unsigned char>(target[pos + blockSize]);
+		}
+		pos++;
+	}
+	addLiteral(patch, target, literalStart, target.size());
+	patch += static_cast<char>(End);
+
+	writeWholeFile(patchPath, patch);
+}
+
+void DeltaPatch::apply(const char* basePath, const char* patchPath, const char* outPath,
+                       const std::string& expectedMd5)
+{
+	std::string patch = readWholeFile(patchPath);
+	const std::string malformed = "The patch " + std::string(patchPath) + " is malformed";
+	if (patch.size() < headerLength || patch.compare(0, magicLength, magic) != 0 ||
+	    patch[magicLength] != formatVersion)
+	{
+		throw malformed;
+	}
+	size_t pos = magicLength + 1;
+	std::string baseMd5 = rawToHex(patch.substr(pos, 16));
+	std::string targetMd5 = rawToHex(patch.substr(pos + 16, 16));
+	uint64_t targetSize = getUint(patch, pos + 32, 8);
+	pos = headerLength;
+	if (targetMd5 != expectedMd5)
+	{
+		throw "The patch " + std::string(patchPath) + " doesn't produce the expected file";
+	}
+
+	std::string base = readWholeFile(basePath);
+	if (md5(base) != baseMd5)
+	{
+		throw "The patch " + std::string(patchPath) + " was made for a different version of " +
+		      std::string(basePath);
+	}
+
+	std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+	if (!out.good())
+	{
+		throw FileUtils::IOException("Failed to write file " + std::string(outPath));
+	}
+	try
+	{
+		Md5 hash;
+		uint64_t written = 0;
+		bool done = false;
+		while (!done)
+		{
+			if (pos >= patch.size())
+			{
+				throw malformed;
+			}
+			const char* data = 0;
+			uint64_t length = 0;
+			switch (patch[pos++])
+			{
+				case Copy:
+				{
+					if (patch.size() - pos < 12)
+					{
+						throw malformed;
+					}
+					uint64_t offset = getUint(patch, pos, 8);
+					length = getUint(patch, pos + 8, 4);
+					pos += 12;
+					if (offset > base.size() || length > base.size() - offset)
+					{
+						throw malformed;
+					}
+					data = base.data() + offset;
+					break;
+				}
+				case Add:
+				{
+					if (patch.size() - pos < 4)
+					{
+						throw malformed;
+					}
+					length = getUint(patch, pos, 4);
+					pos += 4;
+					if (length > patch.size() - pos)
+					{
+						throw malformed;
+					}
+					data = patch.data() + pos;
+					pos += static_cast<size_t>(length);
+					break;
+				}
+				case End:
+					done = true;
+					break;
+				default:
+					throw malformed;
+			}
+			if (length > 0)
+			{
+				out.write(data, static_cast<std::streamsize>(length));
+				hash.addData(data, static_cast<size_t>(length));
+				written += length;
+			}
+		}
+		out.close();
+		if (out.fail())
+		{
+			throw FileUtils::IOException("Error writing file " + std::string(outPath));
+		}
+		if (written != targetSize || hash.hexDigest() != expectedMd5)
+		{
+			throw "Patching " + std::string(basePath) + " with " + std::string(patchPath) +
+			      " didn't produce the expected file";
+		}
+	}
+	catch (...)
+	{
+		out.close();
+		remove(outPath);
+		throw;
+	}
+	LOG(Info,"Patched " + std::string(basePath) + " with " + std::string(patchPath));
+}
+
+std::vector<std::string> DeltaPatch::createForTrees(const std::string& oldTree,
+                                                    const std::string& newTree,
+                                                    const std::string& patchDir)
+	throw (FileUtils::IOException)
+{
+	std::vector<std::string> files;
+	collectFiles(newTree, std::string(), files);
+	FileUtils::mkpath(patchDir.c_str());
+
+	std::vector<std::string> patched;
+	for (std::vector<std::string>::const_iterator iter = files.begin(); iter != files.end(); iter++)
+	{
+		std::string oldPath = oldTree + '/' + *iter;
+		std::string newPath = newTree + '/' + *iter;
+		if (!FileUtils::fileExists(oldPath.c_str()) ||
+		    Md5::fileHash(oldPath.c_str()) == Md5::fileHash(newPath.c_str()))
+		{
+			continue;
+		}
+		std::string patchPath = patchDir + '/' + patchName(*iter);
+		create(oldPath.c_str(), newPath.c_str(), patchPath.c_str());
+		if (fileSize(patchPath) >= fileSize(newPath))
+		{
+			FileUtils::removeFile(patchPath.c_str());
+			continue;
+		}
+		patched.push_back(*iter);
+	}
+	return patched;
+}
+
+std::string DeltaPatch::patchName(const std::string& path)
+{
+	std::string name = path;
+	for (size_t i = 0; i < name.size(); i++)
+	{
+		if (name[i] == '/')
+		{
+			name[i] = '_';
+		}
+	}
+	return name + ".patch";
+}
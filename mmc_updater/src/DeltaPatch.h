@@ -0,0 +1,51 @@
+#pragma once
+
+#include "FileUtils.h"
+
+#include <string>
+#include <vector>
+
+/** Binary delta patches between two versions of a file.
+  *
+  * Releases mostly change a few kilobytes inside large binaries, so instead of the whole
+  * new file the update can contain a patch against the installed one.
+  *
+  * A patch starts with the magic "MMCDELTA", a format version byte (1), the MD5 of the base
+  * file, the MD5 of the patched file (16 raw bytes each) and the size of the patched file
+  * (8 bytes, little endian). Instructions follow until an END instruction:
+  *
+  *  - COPY (1): offset (8 bytes) and length (4 bytes) of a range of the base file
+  *  - ADD  (2): length (4 bytes) followed by that many literal bytes
+  *  - END  (0)
+  */
+class DeltaPatch
+{
+	public:
+		/** Writes a patch to @p patchPath that turns the file at @p basePath
+		  * into the one at @p targetPath.
+		  */
+		static void create(const char* basePath, const char* targetPath, const char* patchPath)
+			throw (FileUtils::IOException);
+
+		/** Applies the patch at @p patchPath to the file at @p basePath, writing the result to
+		  * @p outPath. Throws a std::string if the patch is malformed, was not made for this
+		  * base file or the result doesn't have the MD5 @p expectedMd5 - nothing is left at
+		  * @p outPath in that case.
+		  */
+		static void apply(const char* basePath, const char* patchPath, const char* outPath,
+		                  const std::string& expectedMd5);
+
+		/** Creates patches in @p patchDir for every file that is in both @p oldTree and
+		  * @p newTree with different contents, if the patch is smaller than the new file.
+		  * Patches are named after the relative path of the file with '/' replaced by '_',
+		  * plus ".patch". Returns the relative paths of the patched files.
+		  */
+		static std::vector<std::string> createForTrees(const std::string& oldTree,
+		                                               const std::string& newTree,
+		                                               const std::string& patchDir)
+			throw (FileUtils::IOException);
+
+		/** Returns the name of the patch for the file at the relative path @p path. */
+		static std::string patchName(const std::string& path);
+};
+
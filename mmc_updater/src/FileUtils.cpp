@@ -23,6 +23,86 @@
 #include <errno.h>
 #endif
 
+#ifdef PLATFORM_LINUX
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+
+/** Copies @p src to @p dest with copy_file_range() or sendfile(), so the data
+  * doesn't have to be read into the updater and written out again.  Returns false
+  * if neither can be used here, without having written anything.
+  */
+static bool copyFileInKernel(const char* src, const char* dest) throw (FileUtils::IOException)
+{
+	int in = open(src,O_RDONLY);
+	if (in < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	if (fstat(in,&info) != 0)
+	{
+		close(in);
+		return false;
+	}
+	int out = open(dest,O_WRONLY | O_CREAT | O_TRUNC,0644);
+	if (out < 0)
+	{
+		close(in);
+		return false;
+	}
+
+	off_t remaining = info.st_size;
+#ifdef __NR_copy_file_range
+	bool useRange = true;
+#endif
+	while (remaining > 0)
+	{
+		ssize_t copied = -1;
+#ifdef __NR_copy_file_range
+		if (useRange)
+		{
+			copied = syscall(__NR_copy_file_range,in,0,out,0,static_cast<size_t>(remaining),0);
+			if (copied < 0 && remaining == info.st_size &&
+			    (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP))
+			{
+				// not supported for these files, sendfile() may be
+				useRange = false;
+				continue;
+			}
+		}
+		else
+#endif
+		{
+			copied = sendfile(out,in,0,static_cast<size_t>(remaining));
+			if (copied < 0 && remaining == info.st_size && (errno == ENOSYS || errno == EINVAL))
+			{
+				close(in);
+				close(out);
+				return false;
+			}
+		}
+		if (copied < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (copied <= 0)
+		{
+			int error = copied < 0 ? errno : EIO;
+			close(in);
+			close(out);
+			throw FileUtils::IOException(error,"Error copying " + std::string(src) + " to " + std::string(dest));
+		}
+		remaining -= copied;
+	}
+	close(in);
+	if (close(out) != 0)
+	{
+		throw FileUtils::IOException("Error writing file " + std::string(dest));
+	}
+	return true;
+}
+#endif
+
 FileUtils::IOException::IOException(const std::string& error)
 {
 	init(errno,error);
@@ -436,6 +516,13 @@ std::string FileUtils::readFile(const char* path) throw (IOException)
 void FileUtils::copyFile(const char* src, const char* dest) throw (IOException)
 {
 #ifdef PLATFORM_UNIX
+#ifdef PLATFORM_LINUX
+	if (copyFileInKernel(src,dest))
+	{
+		chmod(dest,fileMode(src));
+		return;
+	}
+#endif
 	std::ifstream inputFile(src,std::ios::binary);
 	std::ofstream outputFile(dest,std::ios::binary | std::ios::trunc);
 
@@ -468,6 +555,22 @@ void FileUtils::copyFile(const char* src, const char* dest) throw (IOException)
 #endif
 }
 
+bool FileUtils::sameFileSystem(const char* first, const char* second)
+{
+#ifdef PLATFORM_UNIX
+	struct stat firstInfo;
+	struct stat secondInfo;
+	return stat(first,&firstInfo) == 0 && stat(second,&secondInfo) == 0 &&
+	       firstInfo.st_dev == secondInfo.st_dev;
+#else
+	char firstVolume[MAX_PATH+1];
+	char secondVolume[MAX_PATH+1];
+	return GetVolumePathName(first,firstVolume,MAX_PATH+1) &&
+	       GetVolumePathName(second,secondVolume,MAX_PATH+1) &&
+	       _stricmp(firstVolume,secondVolume) == 0;
+#endif
+}
+
 std::string FileUtils::makeAbsolute(const char* path, const char* basePath)
 {
 	if (isRelative(path))
@@ -83,8 +83,17 @@ class FileUtils
 		static void rmdir(const char* dir) throw (IOException);
 		static void createSymLink(const char* link, const char* target) throw (IOException);
 		static void touch(const char* path) throw (IOException);
+
+		/** Copy a file.  On Linux the copy is done by the kernel, without
+		  * passing the data through the updater, where it is supported.
+		  */
 		static void copyFile(const char* src, const char* dest) throw (IOException);
 
+		/** Returns true if the files or directories at @p first and @p second
+		  * are on the same file system, so one can be renamed to the other.
+		  */
+		static bool sameFileSystem(const char* first, const char* second);
+
 		/** Create all the directories in @p path which do not yet exist.
 		  * @p path may be relative or absolute.
 		  */
@@ -0,0 +1,161 @@
+#include "Md5.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string.h>
+
+namespace
+{
+	const uint32_t sines[64] =
+	{
+		0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+		0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+		0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+		0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+		0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+		0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+		0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+		0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+	};
+
+	const int shifts[64] =
+	{
+		7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22, 7, 12, 17, 22,
+		5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20, 5,  9, 14, 20,
+		4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23, 4, 11, 16, 23,
+		6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21, 6, 10, 15, 21
+	};
+
+	uint32_t rotateLeft(uint32_t value, int bits)
+	{
+		return (value << bits) | (value >> (32 - bits));
+	}
+}
+
+Md5::Md5()
+: m_length(0)
+, m_buffered(0)
+{
+	m_state[0] = 0x67452301;
+	m_state[1] = 0xefcdab89;
+	m_state[2] = 0x98badcfe;
+	m_state[3] = 0x10325476;
+}
+
+void Md5::addData(const char* data, size_t length)
+{
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+	m_length += length;
+	while (length > 0)
+	{
+		size_t count = std::min(length, sizeof(m_buffer) - m_buffered);
+		memcpy(m_buffer + m_buffered, bytes, count);
+		m_buffered += count;
+		bytes += count;
+		length -= count;
+		if (m_buffered == sizeof(m_buffer))
+		{
+			processBlock(m_buffer);
+			m_buffered = 0;
+		}
+	}
+}
+
+std::string Md5::hexDigest()
+{
+	uint64_t bitLength = m_length * 8;
+	const char padding = static_cast<char>(0x80);
+	addData(&padding, 1);
+	const char zero = 0;
+	while (m_buffered != 56)
+	{
+		addData(&zero, 1);
+	}
+	char lengthBytes[8];
+	for (int i = 0; i < 8; i++)
+	{
+		lengthBytes[i] = static_cast<char>((bitLength >> (8 * i)) & 0xff);
+	}
+	addData(lengthBytes, 8);
+
+	static const char digits[] = "0123456789abcdef";
+	std::string result;
+	for (int i = 0; i < 16; i++)
+	{
+		unsigned char byte = static_cast<unsigned char>((m_state[i / 4] >> (8 * (i % 4))) & 0xff);
+		result += digits[byte >> 4];
+		result += digits[byte & 0xf];
+	}
+	return result;
+}
+
+void Md5::processBlock(const unsigned char* block)
+{
+	uint32_t words[16];
+	for (int i = 0; i < 16; i++)
+	{
+		words[i] = static_cast<uint32_t>(block[i * 4]) |
+		           (static_cast<uint32_t>(block[i * 4 + 1]) << 8) |
+		           (static_cast<uint32_t>(block[i * 4 + 2]) << 16) |
+		           (static_cast<uint32_t>(block[i * 4 + 3]) << 24);
+	}
+
+	uint32_t a = m_state[0];
+	uint32_t b = m_state[1];
+	uint32_t c = m_state[2];
+	uint32_t d = m_state[3];
+	for (int i = 0; i < 64; i++)
+	{
+		uint32_t f;
+		int g;
+		if (i < 16)
+		{
+			f = (b & c) | (~b & d);
+			g = i;
+		}
+		else if (i < 32)
+		{
+			f = (d & b) | (~d & c);
+			g = (5 * i + 1) % 16;
+		}
+		else if (i < 48)
+		{
+			f = b ^ c ^ d;
+			g = (3 * i + 5) % 16;
+		}
+		else
+		{
+			f = c ^ (b | ~d);
+			g = (7 * i) % 16;
+		}
+		uint32_t next = d;
+		d = c;
+		c = b;
+		b = b + rotateLeft(a + f + sines[i] + words[g], shifts[i]);
+		a = next;
+	}
+	m_state[0] += a;
+	m_state[1] += b;
+	m_state[2] += c;
+	m_state[3] += d;
+}
+
+std::string Md5::fileHash(const char* path) throw (FileUtils::IOException)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.good())
+	{
+		throw FileUtils::IOException("Failed to read file " + std::string(path));
+	}
+	Md5 hash;
+	char buffer[1 << 16];
+	while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+	{
+		hash.addData(buffer, static_cast<size_t>(file.gcount()));
+	}
+	if (file.bad())
+	{
+		throw FileUtils::IOException("Error reading file " + std::string(path));
+	}
+	return hash.hexDigest();
+}
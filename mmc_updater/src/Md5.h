@@ -0,0 +1,34 @@
+#pragma once
+
+#include "FileUtils.h"
+
+#include <stdint.h>
+#include <string>
+
+/** Incremental MD5 hash (RFC 1321), for checking files
+  * against the hashes listed in the update's file lists.
+  */
+class Md5
+{
+	public:
+		Md5();
+
+		void addData(const char* data, size_t length);
+
+		/** Finishes the hash and returns it as 32 lowercase hex digits.
+		  * The object can't be used any further afterwards.
+		  */
+		std::string hexDigest();
+
+		/** Returns the hex MD5 of the file at @p path. */
+		static std::string fileHash(const char* path) throw (FileUtils::IOException);
+
+	private:
+		void processBlock(const unsigned char* block);
+
+		uint32_t m_state[4];
+		uint64_t m_length;
+		unsigned char m_buffer[64];
+		size_t m_buffered;
+};
+
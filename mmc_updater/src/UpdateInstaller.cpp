@@ -1,11 +1,18 @@
 #include "UpdateInstaller.h"
 
 #include "AppInfo.h"
+#include "DeltaPatch.h"
 #include "FileUtils.h"
 #include "Log.h"
 #include "ProcessUtils.h"
 #include "UpdateObserver.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <set>
+#include <thread>
+
 void UpdateInstaller::setWaitPid(PLATFORM_PID pid)
 {
 	m_waitPid = pid;
@@ -277,7 +284,7 @@ void UpdateInstaller::revert()
 	}
 }
 
-void UpdateInstaller::installFile(const UpdateScriptFile& file)
+void UpdateInstaller::installFile(const UpdateScriptFile& file, bool moveSource)
 {
 	std::string sourceFile = file.source;
 	std::string destPath = file.dest;
@@ -288,24 +295,37 @@ void UpdateInstaller::installFile(const UpdateScriptFile& file)
 	// backup the existing file if any
 	backupFile(absDestPath);
 
-	// create the target directory if it does not exist
-	std::string destDir = FileUtils::dirname(absDestPath.c_str());
-	if (!FileUtils::fileExists(destDir.c_str()))
-	{
-		LOG(Info,"Destination path missing. Creating " + destDir);
-		if(!m_dryRun)
-		{
-			FileUtils::mkpath(destDir.c_str());
-		}
-	}
-
 	if (!FileUtils::fileExists(sourceFile.c_str()))
 	{
 		throw "Source file does not exist: " + sourceFile;
 	}
 	if(!m_dryRun)
 	{
-		FileUtils::copyFile(sourceFile.c_str(),absDestPath.c_str());
+		if (!file.deltaMd5.empty())
+		{
+			// backupFile() moved the installed file aside, that is what the patch applies to
+			std::string basePath;
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				std::map<std::string,std::string>::const_iterator base = m_backups.find(absDestPath);
+				if (base == m_backups.end())
+				{
+					throw "Can't patch " + absDestPath + " because it is not installed";
+				}
+				basePath = base->second;
+			}
+			LOG(Info,"Patching " + basePath + " with " + sourceFile);
+			DeltaPatch::apply(basePath.c_str(),sourceFile.c_str(),absDestPath.c_str(),file.deltaMd5);
+		}
+		else if (moveSource)
+		{
+			// the package is removed after the update anyway
+			FileUtils::moveFile(sourceFile.c_str(),absDestPath.c_str());
+		}
+		else
+		{
+			FileUtils::copyFile(sourceFile.c_str(),absDestPath.c_str());
+		}
 
 		// set the permissions on the newly extracted file
 		FileUtils::chmod(absDestPath.c_str(),file.permissions);
@@ -315,18 +335,98 @@ void UpdateInstaller::installFile(const UpdateScriptFile& file)
 void UpdateInstaller::installFiles()
 {
 	LOG(Info,"Installing files.");
-	std::vector<UpdateScriptFile>::const_iterator iter = m_script->filesToInstall().begin();
+	const std::vector<UpdateScriptFile>& files = m_script->filesToInstall();
+
+	std::map<std::string,int> sourceUses;
+	std::set<std::string> destinations;
+	bool independent = true;
+	for (std::vector<UpdateScriptFile>::const_iterator iter = files.begin(); iter != files.end(); iter++)
+	{
+		sourceUses[iter->source]++;
+		std::string absDestPath = FileUtils::makeAbsolute(iter->dest.c_str(), m_installDir.c_str());
+		if (!destinations.insert(absDestPath).second)
+		{
+			independent = false;
+		}
+
+		// create the target directories first, the files are installed in parallel
+		std::string destDir = FileUtils::dirname(absDestPath.c_str());
+		if (!FileUtils::fileExists(destDir.c_str()))
+		{
+			LOG(Info,"Destination path missing. Creating " + destDir);
+			if(!m_dryRun)
+			{
+				FileUtils::mkpath(destDir.c_str());
+			}
+		}
+	}
+
+	// Renaming a package file into place is much cheaper than copying it. That works if it is
+	// on the same file system and not installed in several places.
+	std::vector<bool> moveSource;
+	for (std::vector<UpdateScriptFile>::const_iterator iter = files.begin(); iter != files.end(); iter++)
+	{
+		std::string absDestPath = FileUtils::makeAbsolute(iter->dest.c_str(), m_installDir.c_str());
+		std::string destDir = FileUtils::dirname(absDestPath.c_str());
+		moveSource.push_back(sourceUses[iter->source] == 1 &&
+		                     FileUtils::sameFileSystem(iter->source.c_str(), destDir.c_str()));
+	}
+
+	// Files are independent of each other unless one is installed twice. More than a few
+	// threads only fight over the disk.
+	size_t threadCount = std::min<size_t>(files.size(), std::max(1u, std::min(4u, std::thread::hardware_concurrency())));
+	if (!independent)
+	{
+		threadCount = 1;
+	}
+
+	std::atomic<size_t> next(0);
+	std::exception_ptr error;
 	int filesInstalled = 0;
-	for (;iter != m_script->filesToInstall().end();iter++)
+	auto work = [&]()
 	{
-		installFile(*iter);
-		++filesInstalled;
-		if (m_observer)
+		for (size_t i = next++; i < files.size(); i = next++)
 		{
-			int toInstallCount = static_cast<int>(m_script->filesToInstall().size());
-			double percentage = ((1.0 * filesInstalled) / toInstallCount) * 100.0;
-			m_observer->updateProgress(static_cast<int>(percentage));
+			try
+			{
+				installFile(files[i], moveSource[i]);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!error)
+				{
+					error = std::current_exception();
+				}
+				next = files.size();
+				return;
+			}
+			std::lock_guard<std::mutex> lock(m_mutex);
+			++filesInstalled;
+			if (m_observer)
+			{
+				int toInstallCount = static_cast<int>(files.size());
+				double percentage = ((1.0 * filesInstalled) / toInstallCount) * 100.0;
+				m_observer->updateProgress(static_cast<int>(percentage));
+			}
 		}
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < threadCount; i++)
+	{
+		threads.push_back(std::thread(work));
+	}
+	work();
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+
+	// revert() takes care of whatever the other files got to
+	if (error)
+	{
+		std::rethrow_exception(error);
 	}
 }
 
@@ -366,6 +466,7 @@ void UpdateInstaller::backupFile(const std::string& path)
 		FileUtils::removeFile(backupPath.c_str());
 		FileUtils::moveFile(path.c_str(), backupPath.c_str());
 	}
+	std::lock_guard<std::mutex> lock(m_mutex);
 	m_backups[path] = backupPath;
 }
 
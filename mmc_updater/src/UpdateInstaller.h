@@ -7,6 +7,7 @@
 #include <list>
 #include <string>
 #include <map>
+#include <mutex>
 
 class UpdateObserver;
 
@@ -50,7 +51,7 @@ class UpdateInstaller
 
 		void installFiles();
 		void uninstallFiles();
-		void installFile(const UpdateScriptFile& file);
+		void installFile(const UpdateScriptFile& file, bool moveSource);
 		void backupFile(const std::string& path);
 		void reportError(const std::string& error);
 		void postInstallUpdate();
@@ -68,6 +69,8 @@ class UpdateInstaller
 		UpdateScript* m_script = nullptr;
 		UpdateObserver* m_observer = nullptr;
 		std::map<std::string,std::string> m_backups;
+		// guards m_backups and the observer while files are installed in parallel
+		std::mutex m_mutex;
 		bool m_forceElevated = false;
 		bool m_autoClose = false;
 		bool m_dryRun = false;
@@ -79,6 +79,9 @@ UpdateScriptFile UpdateScript::parseFile(const TiXmlElement* element)
 	std::string modeString = elementText(element->FirstChildElement("mode"));
 	sscanf(modeString.c_str(),"%i",&file.permissions);
 
+	// Only present for delta patches.
+	file.deltaMd5 = elementText(element->FirstChildElement("delta-md5"));
+
 	return file;
 }
 
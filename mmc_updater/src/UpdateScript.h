@@ -47,11 +47,17 @@ class UpdateScriptFile
 		  */
 		int permissions;
 
+		/** If set, @p source is a delta patch against the installed
+		  * file and this is the MD5 the patched file must have.
+		  */
+		std::string deltaMd5;
+
 		bool operator==(const UpdateScriptFile& other) const
 		{
 			return source == other.source &&
 			       dest == other.dest &&
-			       permissions == other.permissions;
+			       permissions == other.permissions &&
+			       deltaMd5 == other.deltaMd5;
 		}
 };
 
@@ -0,0 +1,183 @@
+#include "TestDeltaPatch.h"
+
+#include "DeltaPatch.h"
+#include "DirIterator.h"
+#include "FileUtils.h"
+#include "Md5.h"
+#include "ProcessUtils.h"
+#include "TestUtils.h"
+
+#include <stdlib.h>
+#include <string>
+
+namespace
+{
+	std::string testDir(const char* name)
+	{
+		std::string path = FileUtils::tempPath() + "/mmc-delta-" + name + "-" +
+		                   intToStr(ProcessUtils::currentProcessId());
+		FileUtils::mkpath(path.c_str());
+		return path;
+	}
+
+	void removeTree(const std::string& path)
+	{
+		DirIterator dir(path.c_str());
+		while (dir.next())
+		{
+			std::string name = dir.fileName();
+			if (name == "." || name == "..")
+			{
+				continue;
+			}
+			if (dir.isDir())
+			{
+				removeTree(dir.filePath());
+			}
+			else
+			{
+				FileUtils::removeFile(dir.filePath().c_str());
+			}
+		}
+		FileUtils::rmdir(path.c_str());
+	}
+
+	void write(const std::string& path, const std::string& data)
+	{
+		FileUtils::mkpath(FileUtils::dirname(path.c_str()).c_str());
+		FileUtils::writeFile(path.c_str(), data.data(), static_cast<int>(data.size()));
+	}
+
+	/// something that looks like a binary, a few hundred KB of it
+	std::string binary(unsigned int seed)
+	{
+		std::string data;
+		srand(seed);
+		for (int i = 0; i < 300000; i++)
+		{
+			data += static_cast<char>(rand() % 256);
+		}
+		return data;
+	}
+}
+
+void TestDeltaPatch::testMd5()
+{
+	Md5 empty;
+	TEST_COMPARE(empty.hexDigest(),"d41d8cd98f00b204e9800998ecf8427e");
+	Md5 abc;
+	abc.addData("abc",3);
+	TEST_COMPARE(abc.hexDigest(),"900150983cd24fb0d6963f7d28e17f72");
+	// longer than a block, added in pieces
+	std::string text = "12345678901234567890123456789012345678901234567890123456789012345678901234567890";
+	Md5 pieces;
+	pieces.addData(text.data(),7);
+	pieces.addData(text.data() + 7,text.size() - 7);
+	TEST_COMPARE(pieces.hexDigest(),"57edf4a22be3c955ac49da2e2107b67a");
+}
+
+void TestDeltaPatch::testTrees()
+{
+	std::string root = testDir("trees");
+	std::string oldTree = root + "/old";
+	std::string newTree = root + "/new";
+
+	// a release that changes a few bytes in a big binary and inserts a few more
+	std::string oldApp = binary(1);
+	std::string newApp = oldApp;
+	newApp[1000] = 'x';
+	newApp.insert(150000, "new code");
+	newApp.erase(250000, 100);
+	write(oldTree + "/bin/app", oldApp);
+	write(newTree + "/bin/app", newApp);
+	write(oldTree + "/lib/unchanged.so", binary(2));
+	write(newTree + "/lib/unchanged.so", binary(2));
+	// too small for a patch to be worth it
+	write(oldTree + "/version.txt", "1");
+	write(newTree + "/version.txt", "2");
+	write(newTree + "/added.txt", "new file");
+
+	std::string patchDir = root + "/patches";
+	std::vector<std::string> patched = DeltaPatch::createForTrees(oldTree, newTree, patchDir);
+	TEST_COMPARE(patched.size(),1u);
+	TEST_COMPARE(patched[0],"bin/app");
+
+	std::string patch = patchDir + "/" + DeltaPatch::patchName("bin/app");
+	TEST_COMPARE(DeltaPatch::patchName("bin/app"),"bin_app.patch");
+	TEST_COMPARE(FileUtils::readFile(patch.c_str()).size() < 1000,true);
+
+	std::string out = root + "/app";
+	DeltaPatch::apply((oldTree + "/bin/app").c_str(), patch.c_str(), out.c_str(),
+	                  Md5::fileHash((newTree + "/bin/app").c_str()));
+	TEST_COMPARE(FileUtils::readFile(out.c_str()) == newApp,true);
+
+	removeTree(root);
+}
+
+void TestDeltaPatch::testMismatch()
+{
+	std::string root = testDir("mismatch");
+	std::string base = root + "/base";
+	std::string target = root + "/target";
+	std::string patch = root + "/patch";
+	std::string out = root + "/out";
+	std::string data = binary(3);
+	write(base, data);
+	data.replace(5000, 3, "abc");
+	write(target, data);
+	DeltaPatch::create(base.c_str(), target.c_str(), patch.c_str());
+	std::string targetMd5 = Md5::fileHash(target.c_str());
+
+	// the patch was made for another file
+	write(root + "/other", binary(4));
+	bool failed = false;
+	try
+	{
+		DeltaPatch::apply((root + "/other").c_str(), patch.c_str(), out.c_str(), targetMd5);
+	}
+	catch (const std::string&)
+	{
+		failed = true;
+	}
+	TEST_COMPARE(failed,true);
+	TEST_COMPARE(FileUtils::fileExists(out.c_str()),false);
+
+	// the version list expects another file
+	failed = false;
+	try
+	{
+		DeltaPatch::apply(base.c_str(), patch.c_str(), out.c_str(), Md5::fileHash(base.c_str()));
+	}
+	catch (const std::string&)
+	{
+		failed = true;
+	}
+	TEST_COMPARE(failed,true);
+	TEST_COMPARE(FileUtils::fileExists(out.c_str()),false);
+
+	// a damaged patch
+	std::string contents = FileUtils::readFile(patch.c_str());
+	write(patch, contents.substr(0, contents.size() - 10));
+	failed = false;
+	try
+	{
+		DeltaPatch::apply(base.c_str(), patch.c_str(), out.c_str(), targetMd5);
+	}
+	catch (const std::string&)
+	{
+		failed = true;
+	}
+	TEST_COMPARE(failed,true);
+	TEST_COMPARE(FileUtils::fileExists(out.c_str()),false);
+
+	removeTree(root);
+}
+
+int main(int,char**)
+{
+	TestList<TestDeltaPatch> tests;
+	tests.addTest(&TestDeltaPatch::testMd5);
+	tests.addTest(&TestDeltaPatch::testTrees);
+	tests.addTest(&TestDeltaPatch::testMismatch);
+	return TestUtils::runTest(tests);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+class TestDeltaPatch
+{
+	public:
+		void testMd5();
+		void testTrees();
+		void testMismatch();
+};
+
@@ -0,0 +1,102 @@
+#include "TestUpdateInstaller.h"
+
+#include "FileUtils.h"
+#include "ProcessUtils.h"
+#include "TestUtils.h"
+#include "UpdateInstaller.h"
+#include "UpdateScript.h"
+
+#include <string>
+
+namespace
+{
+	std::string testDir(const char* name)
+	{
+		std::string path = FileUtils::tempPath() + "/mmc-installer-" + name + "-" +
+		                   intToStr(ProcessUtils::currentProcessId());
+		FileUtils::mkpath((path + "/install/lib").c_str());
+		FileUtils::mkpath((path + "/package").c_str());
+		return path;
+	}
+
+	void write(const std::string& path, const std::string& data)
+	{
+		FileUtils::writeFile(path.c_str(), data.data(), static_cast<int>(data.size()));
+	}
+
+	std::string read(const std::string& path)
+	{
+		return FileUtils::readFile(path.c_str());
+	}
+
+	std::string fileEntry(const std::string& source, const std::string& dest)
+	{
+		return "<file><source>" + source + "</source><dest>" + dest +
+		       "</dest><mode>0644</mode></file>";
+	}
+
+	/// installs files from the package dir, like after MultiMC exited
+	void runInstaller(const std::string& root, const std::string& files)
+	{
+		std::string scriptPath = root + "/package/file_list.xml";
+		write(scriptPath, "<update version=\"3\"><install>" + files + "</install><uninstall/></update>");
+		UpdateScript script;
+		script.parse(scriptPath);
+		UpdateInstaller installer;
+		installer.setMode(UpdateInstaller::Main);
+		installer.setInstallDir(root + "/install");
+		installer.setPackageDir(root + "/package");
+		installer.setScript(&script);
+		installer.run();
+	}
+}
+
+void TestUpdateInstaller::testInstall()
+{
+	std::string root = testDir("install");
+	std::string install = root + "/install";
+	std::string package = root + "/package";
+	write(install + "/app", "old app");
+	write(install + "/lib/one.so", "old one");
+	write(package + "/app", "new app");
+	write(package + "/lib_one.so", "new one");
+	write(package + "/new.txt", "new file");
+
+	runInstaller(root, fileEntry(package + "/app", "app") +
+	                   fileEntry(package + "/lib_one.so", "lib/one.so") +
+	                   fileEntry(package + "/new.txt", "new-dir/new.txt"));
+
+	TEST_COMPARE(read(install + "/app"),"new app");
+	TEST_COMPARE(read(install + "/lib/one.so"),"new one");
+	TEST_COMPARE(read(install + "/new-dir/new.txt"),"new file");
+	// no backups are left behind
+	TEST_COMPARE(FileUtils::fileExists((install + "/app.bak").c_str()),false);
+	TEST_COMPARE(FileUtils::fileExists((install + "/lib/one.so.bak").c_str()),false);
+}
+
+void TestUpdateInstaller::testRevert()
+{
+	std::string root = testDir("revert");
+	std::string install = root + "/install";
+	std::string package = root + "/package";
+	write(install + "/app", "old app");
+	write(install + "/lib/one.so", "old one");
+	write(package + "/app", "new app");
+
+	// the second file is missing from the package, so nothing may change
+	runInstaller(root, fileEntry(package + "/app", "app") +
+	                   fileEntry(package + "/missing.so", "lib/one.so"));
+
+	TEST_COMPARE(read(install + "/app"),"old app");
+	TEST_COMPARE(read(install + "/lib/one.so"),"old one");
+	TEST_COMPARE(FileUtils::fileExists((install + "/app.bak").c_str()),false);
+	TEST_COMPARE(FileUtils::fileExists((install + "/lib/one.so.bak").c_str()),false);
+}
+
+int main(int,char**)
+{
+	TestList<TestUpdateInstaller> tests;
+	tests.addTest(&TestUpdateInstaller::testInstall);
+	tests.addTest(&TestUpdateInstaller::testRevert);
+	return TestUtils::runTest(tests);
+}
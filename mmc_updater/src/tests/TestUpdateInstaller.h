@@ -0,0 +1,9 @@
+#pragma once
+
+class TestUpdateInstaller
+{
+	public:
+		void testInstall();
+		void testRevert();
+};
+
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <memory>
+
+/// stands in for a flaky server: drops the first connections halfway through the file
+class StandInServer
+{
+public:
+	StandInServer(QByteArray payload, int drops) : m_payload(payload), m_drops(drops)
+	{
+		QObject::connect(&m_server, &QTcpServer::newConnection, [this]()
+		{
+			auto socket = m_server.nextPendingConnection();
+			auto request = std::make_shared<QByteArray>();
+			QObject::connect(socket, &QTcpSocket::readyRead, [this, socket, request]()
+			{
+				*request += socket->readAll();
+				if (!request->contains("\r\n\r\n"))
+					return;
+				respond(socket, *request);
+			});
+		});
+		m_server.listen(QHostAddress::LocalHost);
+	}
+	QString url() const
+	{
+		return QString("http://127.0.0.1:%1/file.jar").arg(m_server.serverPort());
+	}
+	/// the Range header of every request, empty if there was none
+	QList<QByteArray> m_ranges;
+	QByteArray m_payload;
+	QByteArray m_etag = "\"one\"";
+
+private:
+	QByteArray header(const QByteArray &request, const QByteArray &name)
+	{
+		for (auto line : request.split('\n'))
+		{
+			if (line.toLower().startsWith(name.toLower() + ":"))
+				return line.mid(name.size() + 1).trimmed();
+		}
+		return QByteArray();
+	}
+	void respond(QTcpSocket *socket, const QByteArray &request)
+	{
+		QByteArray range = header(request, "Range");
+		m_ranges.append(range);
+		qint64 from = 0;
+		if (range.startsWith("bytes=") && header(request, "If-Range") == m_etag)
+			from = range.mid(6, range.indexOf('-') - 6).toLongLong();
+		QByteArray body = m_payload.mid(from);
+		if (from > 0)
+		{
+			socket->write("HTTP/1.1 206 Partial Content\r\n");
+			socket->write("Content-Range: bytes " + QByteArray::number(from) + "-" +
+						  QByteArray::number(m_payload.size() - 1) + "/" +
+						  QByteArray::number(m_payload.size()) + "\r\n");
+		}
+		else
+		{
+			socket->write("HTTP/1.1 200 OK\r\n");
+		}
+		socket->write("ETag: " + m_etag + "\r\n");
+		socket->write("Content-Length: " + QByteArray::number(body.size()) + "\r\n");
+		socket->write("Connection: close\r\n\r\n");
+		if (m_drops > 0)
+		{
+			m_drops--;
+			body = body.left(body.size() / 2);
+		}
+		socket->write(body);
+		socket->disconnectFromHost();
+	}
+
+private:
+	QTcpServer m_server;
+	int m_drops;
+};
@@ -4,6 +4,8 @@
 #include <QCoreApplication>
 #include <QTest>
 #include <QDir>
+#include <QFileInfo>
+#include <QCryptographicHash>
 
 #include "test_config.h"
 
@@ -20,6 +22,26 @@ public:
 	{
 		return QString::fromUtf8(readFile(fileName));
 	}
+	/// writes the file and the folders it is in, false if that fails
+	static bool writeFile(const QString &fileName, const QByteArray &data)
+	{
+		if (!QFileInfo(fileName).dir().mkpath("."))
+			return false;
+		QFile f(fileName);
+		return f.open(QFile::WriteOnly | QFile::Truncate) && f.write(data) == data.size();
+	}
+	/// made up file contents, different for each seed
+	static QByteArray payload(int size, char seed = 0)
+	{
+		QByteArray data;
+		for (int i = 0; i < size; i++)
+			data.append(char(seed + i * 7 % 251));
+		return data;
+	}
+	static QString md5(const QByteArray &data)
+	{
+		return QCryptographicHash::hash(data, QCryptographicHash::Md5).toHex();
+	}
 };
 
 #define MULTIMC_GET_TEST_FILE(file) TestsInternal::readFile(QFINDTESTDATA(file))
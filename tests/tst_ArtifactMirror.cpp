@@ -0,0 +1,134 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include "TestUtil.h"
+
+#include "Env.h"
+#include "net/ArtifactMirror.h"
+#include "net/MD5EtagDownload.h"
+#include "minecraft/MirrorExportTask.h"
+
+class ArtifactMirrorTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void initTestCase()
+	{
+		ENV.qnam()->setProxy(QNetworkProxy::NoProxy);
+	}
+	void cleanup()
+	{
+		ENV.updateMirrorSettings(QString(), false);
+	}
+
+	void test_map()
+	{
+		QUrl library("http://libraries.minecraft.net/com/foo/foo.jar");
+		QCOMPARE(ArtifactMirror::treePath(library),
+				 QString("libraries.minecraft.net/com/foo/foo.jar"));
+
+		ArtifactMirror server("http://lan.local/mirror", false);
+		QCOMPARE(server.map(library),
+				 QUrl("http://lan.local/mirror/libraries.minecraft.net/com/foo/foo.jar"));
+		// redirects within the mirror stay there
+		QUrl inMirror("http://lan.local/mirror/other/file");
+		QCOMPARE(server.map(inMirror), inMirror);
+
+		QTemporaryDir dir;
+		ArtifactMirror folder(dir.path(), false);
+		QUrl mapped = folder.map(library);
+		QVERIFY(mapped.isLocalFile());
+		QCOMPARE(mapped.toLocalFile(), dir.path() + "/libraries.minecraft.net/com/foo/foo.jar");
+
+		// nothing to map without a mirror
+		ArtifactMirror offline(QString(), true);
+		QCOMPARE(offline.map(library), library);
+	}
+
+	void test_downloadFromFolder()
+	{
+		QTemporaryDir mirror;
+		QTemporaryDir dir;
+		QVERIFY(TestsInternal::writeFile(mirror.path() + "/files.example/data/file.bin",
+										 QByteArray(5000, 'm')));
+		ENV.updateMirrorSettings(mirror.path(), false);
+
+		auto download = MD5EtagDownload::make(QUrl("http://files.example/data/file.bin"),
+											  dir.path() + "/file.bin");
+		QSignalSpy succeededSpy(download.get(), SIGNAL(succeeded(int)));
+		download->start();
+		QVERIFY(succeededSpy.wait());
+		QCOMPARE(TestsInternal::readFile(dir.path() + "/file.bin"), QByteArray(5000, 'm'));
+	}
+
+	void test_strictOffline()
+	{
+		QTemporaryDir dir;
+		ENV.updateMirrorSettings(QString(), true);
+
+		// nothing is requested, what isn't there fails right away
+		auto missing = MD5EtagDownload::make(QUrl("http://files.example/missing.bin"),
+											 dir.path() + "/missing.bin");
+		QSignalSpy failedSpy(missing.get(), SIGNAL(failed(int)));
+		missing->start();
+		QCOMPARE(failedSpy.count(), 1);
+
+		QVERIFY(TestsInternal::writeFile(dir.path() + "/present.bin", "data"));
+		auto present = MD5EtagDownload::make(QUrl("http://files.example/present.bin"),
+											 dir.path() + "/present.bin");
+		QSignalSpy succeededSpy(present.get(), SIGNAL(succeeded(int)));
+		present->start();
+		QCOMPARE(succeededSpy.count(), 1);
+	}
+
+	void test_export()
+	{
+		QTemporaryDir cache;
+		QTemporaryDir mirror;
+		QVERIFY(TestsInternal::writeFile(cache.path() + "/libraries/com/foo/foo.jar", "jar"));
+		QJsonObject version;
+		version.insert("id", QString("1.0"));
+		QVERIFY(TestsInternal::writeFile(cache.path() + "/versions/1.0/1.0.dat",
+										 QJsonDocument(version).toBinaryData()));
+
+		QList<MirrorExportTask::Artifact> artifacts;
+		artifacts.append({cache.path() + "/libraries/com/foo/foo.jar",
+						  QUrl("https://libraries.minecraft.net/com/foo/foo.jar"), false});
+		artifacts.append({cache.path() + "/versions/1.0/1.0.dat",
+						  QUrl("http://s3.amazonaws.com/versions/1.0/1.0.json"), true});
+		artifacts.append({cache.path() + "/libraries/never/downloaded.jar",
+						  QUrl("https://libraries.minecraft.net/never/downloaded.jar"), false});
+		{
+			MirrorExportTask task(artifacts, mirror.path());
+			QSignalSpy succeededSpy(&task, SIGNAL(succeeded()));
+			task.start();
+			QVERIFY(succeededSpy.wait());
+			auto result = task.result();
+			QCOMPARE(result.copiedFiles, 2);
+			QCOMPARE(result.missing.size(), 1);
+		}
+		QCOMPARE(
+			TestsInternal::readFile(mirror.path() + "/libraries.minecraft.net/com/foo/foo.jar"),
+			QByteArray("jar"));
+		auto json = QJsonDocument::fromJson(
+			TestsInternal::readFile(mirror.path() + "/s3.amazonaws.com/versions/1.0/1.0.json"));
+		QCOMPARE(json.object().value("id").toString(), QString("1.0"));
+
+		// again, nothing changed
+		MirrorExportTask task(artifacts, mirror.path());
+		QSignalSpy succeededSpy(&task, SIGNAL(succeeded()));
+		task.start();
+		QVERIFY(succeededSpy.wait());
+		QCOMPARE(task.result().copiedFiles, 0);
+		QCOMPARE(task.result().keptFiles, 2);
+	}
+};
+
+QTEST_GUILESS_MAIN(ArtifactMirrorTest)
+
+#include "tst_ArtifactMirror.moc"
@@ -0,0 +1,112 @@
+#include <QTest>
+#include <QSignalSpy>
+#include "TestUtil.h"
+
+#include "BaseVersionList.h"
+
+struct TestVersion : public BaseVersion
+{
+	TestVersion(QString name) : m_name(name)
+	{
+	}
+	virtual QString descriptor() override
+	{
+		return m_name;
+	}
+	virtual QString name() override
+	{
+		return m_name;
+	}
+	virtual QString typeString() const override
+	{
+		return "test";
+	}
+	QString m_name;
+};
+
+class TestVersionList : public BaseVersionList
+{
+public:
+	virtual Task *getLoadTask() override
+	{
+		return nullptr;
+	}
+	virtual bool isLoaded() override
+	{
+		return true;
+	}
+	virtual const BaseVersionPtr at(int i) const override
+	{
+		return m_vlist.at(i);
+	}
+	virtual int count() const override
+	{
+		return m_vlist.count();
+	}
+	virtual void sort() override
+	{
+	}
+	virtual void updateListData(QList<BaseVersionPtr> versions) override
+	{
+		publishUpdate(m_vlist, versions);
+	}
+	void update(QStringList names)
+	{
+		QList<BaseVersionPtr> versions;
+		for (auto name : names)
+		{
+			versions.append(std::make_shared<TestVersion>(name));
+		}
+		updateListData(versions);
+	}
+	QList<BaseVersionPtr> m_vlist;
+};
+
+class BaseVersionListTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_publishUpdate()
+	{
+		TestVersionList list;
+		QSignalSpy resets(&list, SIGNAL(modelReset()));
+		QSignalSpy inserts(&list, SIGNAL(rowsInserted(QModelIndex, int, int)));
+		QSignalSpy changes(&list, SIGNAL(dataChanged(QModelIndex, QModelIndex)));
+
+		// first fill resets
+		list.update({"1.2", "1.1"});
+		QCOMPARE(resets.size(), 1);
+		QCOMPARE(list.count(), 2);
+
+		// the same versions only refresh the rows
+		list.update({"1.2", "1.1"});
+		QCOMPARE(resets.size(), 1);
+		QCOMPARE(inserts.size(), 0);
+		QCOMPARE(changes.size(), 1);
+
+		// new versions on top are inserted
+		list.update({"1.4", "1.3", "1.2", "1.1"});
+		QCOMPARE(resets.size(), 1);
+		QCOMPARE(inserts.size(), 1);
+		QCOMPARE(inserts[0][1].toInt(), 0);
+		QCOMPARE(inserts[0][2].toInt(), 1);
+		QCOMPARE(list.at(0)->name(), QString("1.4"));
+
+		// and at the bottom too
+		list.update({"1.4", "1.3", "1.2", "1.1", "1.0"});
+		QCOMPARE(inserts.size(), 2);
+		QCOMPARE(inserts[1][1].toInt(), 4);
+
+		// anything else resets
+		list.update({"1.4", "1.2"});
+		QCOMPARE(resets.size(), 2);
+		list.update({"1.5", "1.2", "1.4"});
+		QCOMPARE(resets.size(), 3);
+		QCOMPARE(list.count(), 3);
+	}
+};
+
+QTEST_GUILESS_MAIN(BaseVersionListTest)
+
+#include "tst_BaseVersionList.moc"
@@ -0,0 +1,134 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "TestUtil.h"
+
+#include "minecraft/BatchUpdate.h"
+#include "settings/INISettingsObject.h"
+#include "tasks/Task.h"
+
+/// finishes on the next turn of the event loop, like a real update
+class FakeUpdate : public Task
+{
+	Q_OBJECT
+public:
+	explicit FakeUpdate(bool succeed) : m_succeed(succeed)
+	{
+	}
+
+protected:
+	virtual void executeTask() override
+	{
+		QMetaObject::invokeMethod(this, "finish", Qt::QueuedConnection);
+	}
+
+private
+slots:
+	void finish()
+	{
+		if (m_succeed)
+			emitSucceeded();
+		else
+			emitFailed("broken");
+	}
+
+private:
+	bool m_succeed;
+};
+
+class FakeInstance : public BaseInstance
+{
+	Q_OBJECT
+public:
+	/// @p update is what doUpdate() gives, null for an instance that needs no update
+	FakeInstance(SettingsObjectPtr global, const QString &rootDir, std::shared_ptr<Task> update)
+		: BaseInstance(global, std::make_shared<INISettingsObject>(rootDir + "/instance.cfg"),
+					   rootDir),
+		  m_update(update)
+	{
+	}
+	virtual void init() override {}
+	virtual QString intendedVersionId() const override { return QString(); }
+	virtual bool setIntendedVersionId(QString) override { return false; }
+	virtual QString currentVersionId() const override { return QString(); }
+	virtual bool shouldUpdate() const override { return true; }
+	virtual void setShouldUpdate(bool) override {}
+	virtual QSet<QString> traits() override { return QSet<QString>(); }
+	virtual std::shared_ptr<BaseVersionList> versionList() const override { return nullptr; }
+	virtual std::shared_ptr<Task> doUpdate() override { return m_update; }
+	virtual BaseProcess *prepareForLaunch(AuthSessionPtr) override { return nullptr; }
+	virtual void cleanupAfterRun() override {}
+	virtual QString getStatusbarDescription() override { return QString(); }
+	virtual QString instanceConfigFolder() const override { return instanceRoot(); }
+
+private:
+	std::shared_ptr<Task> m_update;
+};
+
+class BatchUpdateTest : public QObject
+{
+	Q_OBJECT
+private:
+	QTemporaryDir m_root;
+	SettingsObjectPtr m_global;
+
+	InstancePtr instance(QString id, std::shared_ptr<Task> update)
+	{
+		return std::make_shared<FakeInstance>(m_global, m_root.path() + "/" + id, update);
+	}
+
+private
+slots:
+	void initTestCase()
+	{
+		m_global = std::make_shared<INISettingsObject>(m_root.path() + "/multimc.cfg");
+		for (auto id : {"PreLaunchCommand", "PostExitCommand", "ShowConsole", "AutoCloseConsole",
+						"LogPrePostOutput"})
+		{
+			m_global->registerSetting(id, QVariant());
+		}
+	}
+
+	void test_nothingToUpdate()
+	{
+		BatchUpdate batch({instance("a", nullptr), instance("b", nullptr),
+						   instance("c", nullptr)});
+		QSignalSpy succeededSpy(&batch, SIGNAL(succeeded()));
+		QSignalSpy failedSpy(&batch, SIGNAL(failed(QString)));
+		QSignalSpy finishedSpy(&batch, SIGNAL(instanceFinished(QString, bool)));
+		batch.start();
+		QTest::qWait(50);
+		QCOMPARE(succeededSpy.size(), 1);
+		QCOMPARE(failedSpy.size(), 0);
+		QCOMPARE(finishedSpy.size(), 3);
+	}
+
+	void test_mixedResults()
+	{
+		// more than run at once, with instances that need no update in between
+		QList<InstancePtr> instances;
+		for (int i = 0; i < 3; i++)
+		{
+			instances.append(instance(QString("ok%1").arg(i), std::make_shared<FakeUpdate>(true)));
+			instances.append(instance(QString("none%1").arg(i), nullptr));
+		}
+		instances.append(instance("broken", std::make_shared<FakeUpdate>(false)));
+		instances.append(instance("last", nullptr));
+
+		BatchUpdate batch(instances);
+		QSignalSpy succeededSpy(&batch, SIGNAL(succeeded()));
+		QSignalSpy failedSpy(&batch, SIGNAL(failed(QString)));
+		QSignalSpy finishedSpy(&batch, SIGNAL(instanceFinished(QString, bool)));
+		batch.start();
+		QVERIFY(failedSpy.wait());
+		QTest::qWait(50);
+		QCOMPARE(failedSpy.size(), 1);
+		QCOMPARE(succeededSpy.size(), 0);
+		QCOMPARE(finishedSpy.size(), instances.size());
+		QCOMPARE(batch.failures().keys(), QStringList({"broken"}));
+	}
+};
+
+QTEST_GUILESS_MAIN(BatchUpdateTest)
+
+#include "tst_BatchUpdate.moc"
@@ -0,0 +1,174 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include "TestUtil.h"
+
+#include "net/HttpMetaCache.h"
+#include "minecraft/CacheCleanupTask.h"
+#include "minecraft/LibraryStore.h"
+
+class CacheCleanupTaskTest : public QObject
+{
+	Q_OBJECT
+private:
+	std::shared_ptr<HttpMetaCache> makeCache(QString root)
+	{
+		auto cache = std::make_shared<HttpMetaCache>(root + "/metacache");
+		cache->addBase("libraries", root + "/libraries");
+		cache->addBase("versions", root + "/versions");
+		cache->addBase("asset_objects", root + "/assets/objects");
+		cache->addBase("fmllibs", root + "/fmllibs");
+		for (auto path : {"/libraries/a/live.jar", "/libraries/b/dead.jar",
+						  "/versions/1.0/1.0.json", "/versions/1.0/1.0.jar",
+						  "/assets/objects/ab/abcd"})
+		{
+			if (!TestsInternal::writeFile(root + path, QByteArray(100, 'x')))
+				return nullptr;
+		}
+		auto entry = cache->resolveEntry("libraries", "b/dead.jar");
+		entry->stale = false;
+		cache->updateEntry(entry);
+		return cache;
+	}
+	CacheCleanupTask::Result run(std::shared_ptr<HttpMetaCache> cache, QString root,
+								 CacheCleanupTask::Budget budget, bool dryRun,
+								 QList<InstanceFiles::File> live = QList<InstanceFiles::File>())
+	{
+		live.append({QDir::cleanPath(root + "/libraries/a/live.jar"), QUrl(), false, QString()});
+		CacheCleanupTask task(cache, live, budget, dryRun);
+		QSignalSpy succeededSpy(&task, SIGNAL(succeeded()));
+		task.start();
+		succeededSpy.wait();
+		return task.result();
+	}
+
+private
+slots:
+	void test_dryRun()
+	{
+		QTemporaryDir dir;
+		auto cache = makeCache(dir.path());
+		QVERIFY(cache);
+		CacheCleanupTask::Budget budget;
+		budget.maxAgeDays = 0;
+		auto result = run(cache, dir.path(), budget, true);
+
+		QCOMPARE(result.removed.size(), 3);
+		QCOMPARE(result.removedBytes, qint64(300));
+		QCOMPARE(result.freedBytes, qint64(300));
+		QCOMPARE(result.keptFiles, 1);
+		// a dry run only reports
+		QVERIFY(QFile::exists(dir.path() + "/libraries/b/dead.jar"));
+		QVERIFY(cache->getEntry("libraries", "b/dead.jar"));
+	}
+
+	void test_ageBudget()
+	{
+		QTemporaryDir dir;
+		auto cache = makeCache(dir.path());
+		QVERIFY(cache);
+		CacheCleanupTask::Budget budget;
+		budget.maxAgeDays = 0;
+		auto result = run(cache, dir.path(), budget, false);
+
+		QCOMPARE(result.removed.size(), 3);
+		QVERIFY(QFile::exists(dir.path() + "/libraries/a/live.jar"));
+		QVERIFY(QFile::exists(dir.path() + "/versions/1.0/1.0.json"));
+		QVERIFY(!QFile::exists(dir.path() + "/libraries/b/dead.jar"));
+		QVERIFY(!QFile::exists(dir.path() + "/versions/1.0/1.0.jar"));
+		QVERIFY(!QFile::exists(dir.path() + "/assets/objects/ab/abcd"));
+		// empty folders go, the bases stay
+		QVERIFY(!QDir(dir.path() + "/libraries/b").exists());
+		QVERIFY(!QDir(dir.path() + "/assets/objects/ab").exists());
+		QVERIFY(QDir(dir.path() + "/assets/objects").exists());
+		// and the index doesn't point at the removed files any more
+		QVERIFY(!cache->getEntry("libraries", "b/dead.jar"));
+	}
+
+	void test_linkedFilesFreeNothing()
+	{
+		QTemporaryDir dir;
+		auto cache = makeCache(dir.path());
+		QVERIFY(cache);
+		// the stored copy stays behind
+		LibraryStore store(dir.path() + "/store");
+		QCOMPARE(store.dedupe(dir.path() + "/libraries/b/dead.jar"), qint64(0));
+		QCOMPARE(LibraryStore::linkCount(dir.path() + "/libraries/b/dead.jar"), 2);
+		CacheCleanupTask::Budget budget;
+		budget.maxAgeDays = 0;
+		auto result = run(cache, dir.path(), budget, false);
+
+		QCOMPARE(result.removed.size(), 3);
+		QCOMPARE(result.removedBytes, qint64(300));
+		QCOMPARE(result.freedBytes, qint64(200));
+	}
+
+	void test_assetIndexKeepsItsObjects()
+	{
+		QTemporaryDir dir;
+		auto cache = makeCache(dir.path());
+		QVERIFY(cache);
+		QString indexPath = dir.path() + "/assets/indexes/1.8.json";
+		QVERIFY(TestsInternal::writeFile(
+			indexPath, "{\"objects\": {\"a.png\": {\"hash\": \"abcd\", \"size\": 100}}}"));
+		QList<InstanceFiles::File> live;
+		live.append({indexPath, QUrl(), false, dir.path() + "/assets/objects"});
+		live.append({dir.path() + "/assets/indexes/broken.json", QUrl(), false,
+					 dir.path() + "/assets/objects"});
+		CacheCleanupTask::Budget budget;
+		budget.maxAgeDays = 0;
+		auto result = run(cache, dir.path(), budget, false, live);
+
+		QCOMPARE(result.removed.size(), 2);
+		QVERIFY(QFile::exists(dir.path() + "/assets/objects/ab/abcd"));
+		// a missing index isn't worth a mention, there is nothing of it in the cache
+		QVERIFY(result.unreadableIndexes.isEmpty());
+	}
+
+	void test_unreadableAssetIndex()
+	{
+		QTemporaryDir dir;
+		auto cache = makeCache(dir.path());
+		QVERIFY(cache);
+		QString indexPath = dir.path() + "/assets/indexes/1.8.json";
+		QVERIFY(TestsInternal::writeFile(indexPath, "not json"));
+		QList<InstanceFiles::File> live;
+		live.append({indexPath, QUrl(), false, dir.path() + "/assets/objects"});
+		CacheCleanupTask::Budget budget;
+		auto result = run(cache, dir.path(), budget, true, live);
+
+		QCOMPARE(result.unreadableIndexes, QStringList() << indexPath);
+	}
+
+	void test_recentFilesStay()
+	{
+		QTemporaryDir dir;
+		auto cache = makeCache(dir.path());
+		QVERIFY(cache);
+		CacheCleanupTask::Budget budget;
+		auto result = run(cache, dir.path(), budget, false);
+
+		QCOMPARE(result.removed.size(), 0);
+		QCOMPARE(result.keptFiles, 4);
+	}
+
+	void test_sizeBudget()
+	{
+		QTemporaryDir dir;
+		auto cache = makeCache(dir.path());
+		QVERIFY(cache);
+		CacheCleanupTask::Budget budget;
+		budget.maxAgeDays = -1;
+		budget.maxBytes = 250;
+		auto result = run(cache, dir.path(), budget, false);
+
+		// 400 bytes, the live file and the version file can't go
+		QCOMPARE(result.removed.size(), 2);
+		QCOMPARE(result.keptBytes, qint64(200));
+		QVERIFY(QFile::exists(dir.path() + "/libraries/a/live.jar"));
+	}
+};
+
+QTEST_GUILESS_MAIN(CacheCleanupTaskTest)
+
+#include "tst_CacheCleanupTask.moc"
@@ -1,5 +1,6 @@
 #include <QTest>
 #include <QSignalSpy>
+#include <QCryptographicHash>
 
 #include "TestUtil.h"
 
@@ -52,6 +53,9 @@ QDebug operator<<(QDebug dbg, const Operation::Type &t)
 	case Operation::OP_CHMOD:
 		dbg << "OP_CHMOD";
 		break;
+	case Operation::OP_PATCH:
+		dbg << "OP_PATCH";
+		break;
 	}
 	return dbg.maybeSpace();
 }
@@ -189,6 +193,26 @@ slots:
 					   PathCombine(tempFolder,
 								   QString("tests/data/fileOne").replace("/", "_")),
 					   "tests/data/fileOne", 493));
+
+		// patch fileOne, there is a delta for the installed version of it
+		FileSource delta("delta", "http://host/path/fileOne-1-2.patch");
+		delta.baseMd5 = "9eb84090956c484e32cb6c08455a667b";
+		delta.md5 = "0123456789abcdef0123456789abcdef";
+		FileSource otherDelta("delta", "http://host/path/fileOne-0-2.patch");
+		otherDelta.baseMd5 = "00000000000000000000000000000000";
+		QTest::newRow("delta")
+			<< tempFolder << VersionFileList()
+			<< (VersionFileList()
+				<< VersionFileEntry{
+					   "tests/data/fileOne", 493,
+					   FileSourceList() << otherDelta << delta
+										<< FileSource("http", "http://host/path/fileOne-2"),
+					   "42915a71277c9016668cce7b82c6b577"})
+			<< (OperationList()
+				<< Operation::PatchOp(
+					   PathCombine(tempFolder,
+								   QString("tests/data/fileOne").replace("/", "_") + ".patch"),
+					   "tests/data/fileOne", 493, "42915a71277c9016668cce7b82c6b577"));
 	}
 	void test_processFileLists()
 	{
@@ -228,6 +252,63 @@ slots:
 		QVERIFY(succeededSpy.wait());
 	}
 */
+	void test_hashInstalledFiles()
+	{
+		QTemporaryDir tempFolderObj;
+		QString root = tempFolderObj.path();
+		VersionFileList files;
+		files.append(VersionFileEntry{"installed.txt", 0644, FileSourceList(), ""});
+		files.append(VersionFileEntry{"missing.txt", 0644, FileSourceList(), ""});
+		auto write = [&](QByteArray data)
+		{
+			QFile file(PathCombine(root, "installed.txt"));
+			QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+			QCOMPARE(file.write(data), qint64(data.size()));
+		};
+
+		write("first contents");
+		auto states = hashInstalledFiles(files, root);
+		QCOMPARE(states.size(), 2);
+		QVERIFY(states["installed.txt"].exists);
+		QVERIFY(states["installed.txt"].usable);
+		QCOMPARE(states["installed.txt"].md5,
+				 QString(QCryptographicHash::hash("first contents", QCryptographicHash::Md5).toHex()));
+		QVERIFY(!states["missing.txt"].exists);
+
+		// a changed file is hashed again, not taken from the cache
+		write("changed");
+		states = hashInstalledFiles(files, root);
+		QCOMPARE(states["installed.txt"].md5,
+				 QString(QCryptographicHash::hash("changed", QCryptographicHash::Md5).toHex()));
+	}
+
+	void test_checkDeltaPatch()
+	{
+		QTemporaryDir tempFolderObj;
+		QString patchPath = PathCombine(tempFolderObj.path(), "fileOne.patch");
+		QByteArray baseMd5 = QCryptographicHash::hash("old", QCryptographicHash::Md5);
+		QByteArray targetMd5 = QCryptographicHash::hash("new", QCryptographicHash::Md5);
+		{
+			QFile patch(patchPath);
+			QVERIFY(patch.open(QFile::WriteOnly));
+			patch.write(QByteArray("MMCDELTA") + char(1) + baseMd5 + targetMd5);
+		}
+		auto op = Operation::PatchOp(patchPath, "fileOne", 0644, targetMd5.toHex());
+
+		// only the hash of the installed file is looked at, not the file
+		FileStateMap installed;
+		installed["fileOne"].exists = true;
+		installed["fileOne"].md5 = baseMd5.toHex();
+		QVERIFY(checkDeltaPatch(op, installed));
+
+		installed["fileOne"].md5 = targetMd5.toHex();
+		QVERIFY(!checkDeltaPatch(op, installed));
+
+		op.md5 = baseMd5.toHex();
+		installed["fileOne"].md5 = baseMd5.toHex();
+		QVERIFY(!checkDeltaPatch(op, installed));
+	}
+
 	void test_OSXPathFixup()
 	{
 		QString path, pathOrig;
@@ -0,0 +1,170 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QTemporaryDir>
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include "TestUtil.h"
+
+#include "forge/ForgeMirrorRanking.h"
+#include "forge/ForgeMirrorProbe.h"
+
+/// stands in for a mirror: answers every request after a delay with a fixed status
+class StandInMirror
+{
+public:
+	StandInMirror(int delayMs, int status = 206) : m_delay(delayMs), m_status(status)
+	{
+		QObject::connect(&m_server, &QTcpServer::newConnection, [this]()
+		{
+			auto socket = m_server.nextPendingConnection();
+			QObject::connect(socket, &QTcpSocket::readyRead, [this, socket]()
+			{
+				m_request += socket->readAll();
+				if (!m_request.contains("\r\n\r\n"))
+					return;
+				auto timer = new QTimer(socket);
+				timer->setSingleShot(true);
+				QObject::connect(timer, &QTimer::timeout, [this, socket]()
+				{
+					QByteArray body(ForgeMirrorProbe::PROBE_BYTES, 'x');
+					if (m_status >= 400)
+						body.clear();
+					socket->write("HTTP/1.1 " + QByteArray::number(m_status) + " Whatever\r\n");
+					socket->write("Content-Length: " + QByteArray::number(body.size()) + "\r\n");
+					socket->write("Connection: close\r\n\r\n");
+					socket->write(body);
+					socket->disconnectFromHost();
+				});
+				timer->start(m_delay);
+			});
+		});
+		m_server.listen(QHostAddress::LocalHost);
+	}
+	QString url() const
+	{
+		return QString("http://127.0.0.1:%1/maven/").arg(m_server.serverPort());
+	}
+	QByteArray m_request;
+
+private:
+	QTcpServer m_server;
+	int m_delay;
+	int m_status;
+};
+
+static ForgeMirror mirror(QString url)
+{
+	return {url, QString(), QString(), url};
+}
+
+class ForgeMirrorRankingTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_rank()
+	{
+		ForgeMirrorRanking ranking;
+		qint64 now = 1000000;
+		// 100 ms latency, 1 MiB/s
+		ranking.reportSuccess("slow", 100, 1024 * 1024, 1000, now);
+		// 20 ms latency, 10 MiB/s
+		ranking.reportSuccess("fast", 20, 10 * 1024 * 1024, 1000, now);
+		ranking.reportFailure("broken", now);
+		ranking.reportFailure("very broken", now);
+		ranking.reportFailure("very broken", now);
+
+		QList<ForgeMirror> mirrors = {mirror("very broken"), mirror("unknown"), mirror("slow"),
+									  mirror("broken"), mirror("fast"), mirror("unknown 2")};
+		auto ranked = ranking.rank(mirrors);
+		QStringList order;
+		for (auto &m : ranked)
+			order << m.mirror_url;
+		QCOMPARE(order, QStringList({"fast", "slow", "unknown", "unknown 2", "broken",
+									 "very broken"}));
+
+		QCOMPARE(ranking.expectedTimeMs("unknown"), -1.0);
+		QCOMPARE(ranking.expectedTimeMs("fast"), 120.0);
+	}
+
+	void test_recovery()
+	{
+		ForgeMirrorRanking ranking;
+		ranking.reportFailure("flaky", 0);
+		QCOMPARE(ranking.stats("flaky").failures, 1);
+		// a success clears the failures and the measurements get smoothed
+		ranking.reportSuccess("flaky", 100, 1000, 1000, 10);
+		ranking.reportSuccess("flaky", 200, 1000, 1000, 20);
+		auto stats = ranking.stats("flaky");
+		QCOMPARE(stats.failures, 0);
+		QVERIFY(stats.latencyMs > 100 && stats.latencyMs < 200);
+		QCOMPARE(stats.lastChecked, qint64(20));
+	}
+
+	void test_needsProbe()
+	{
+		ForgeMirrorRanking ranking;
+		QVERIFY(ranking.needsProbe("mirror", 0));
+		ranking.reportSuccess("mirror", 10, 1000, 100, 0);
+		QVERIFY(!ranking.needsProbe("mirror", 1000));
+		QVERIFY(ranking.needsProbe("mirror", ForgeMirrorRanking::MAX_AGE_MS + 1));
+	}
+
+	void test_persistence()
+	{
+		QTemporaryDir dir;
+		QString path = dir.path() + "/forgemirrors.json";
+		{
+			ForgeMirrorRanking ranking(path);
+			ranking.reportSuccess("a", 50, 2048, 100, 42);
+			ranking.reportFailure("b", 43);
+			ranking.SaveNow();
+		}
+		ForgeMirrorRanking loaded(path);
+		loaded.Load();
+		QCOMPARE(loaded.stats("a").latencyMs, 50.0);
+		QCOMPARE(loaded.stats("a").lastChecked, qint64(42));
+		QCOMPARE(loaded.stats("b").failures, 1);
+		QVERIFY(loaded.needsProbe("c", 43));
+	}
+
+	void test_probe()
+	{
+		StandInMirror fast(0);
+		StandInMirror slow(1500);
+		StandInMirror missing(0, 404);
+		// a port nobody listens on
+		QString dead;
+		{
+			QTcpServer server;
+			server.listen(QHostAddress::LocalHost);
+			dead = QString("http://127.0.0.1:%1/maven/").arg(server.serverPort());
+		}
+
+		auto qnam = std::make_shared<QNetworkAccessManager>();
+		qnam->setProxy(QNetworkProxy::NoProxy);
+		auto ranking = std::make_shared<ForgeMirrorRanking>();
+		QList<ForgeMirror> mirrors = {mirror(dead), mirror(slow.url()), mirror(missing.url()),
+									  mirror(fast.url())};
+		ForgeMirrorProbe probe(mirrors, "org/scala-lang/scala-library.jar.pack.xz", ranking,
+							   qnam);
+		QSignalSpy finishedSpy(&probe, SIGNAL(finished()));
+		probe.start();
+		QVERIFY(finishedSpy.wait(ForgeMirrorProbe::TIMEOUT_MS + 2000));
+
+		QVERIFY(fast.m_request.startsWith("GET /maven/org/scala-lang/scala-library.jar.pack.xz"));
+		QVERIFY(fast.m_request.contains("Range: bytes=0-"));
+		auto ranked = ranking->rank(mirrors);
+		QCOMPARE(ranked[0].mirror_url, fast.url());
+		QCOMPARE(ranked[1].mirror_url, slow.url());
+		QCOMPARE(ranking->stats(missing.url()).failures, 1);
+		QCOMPARE(ranking->stats(dead).failures, 1);
+	}
+};
+
+QTEST_GUILESS_MAIN(ForgeMirrorRankingTest)
+
+#include "tst_ForgeMirrorRanking.moc"
@@ -0,0 +1,110 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include "TestUtil.h"
+#include "StandInServer.h"
+
+#include "Env.h"
+#include "net/NetJob.h"
+#include "net/MD5EtagDownload.h"
+
+class InFlightDownloadsTest : public QObject
+{
+	Q_OBJECT
+private:
+	NetJobPtr makeJob(QString name, QString url, QString target, QString expectedMd5)
+	{
+		auto download = MD5EtagDownload::make(url, target);
+		download->m_expected_md5 = expectedMd5;
+		NetJobPtr job(new NetJob(name));
+		job->addNetAction(download);
+		return job;
+	}
+
+private
+slots:
+	void initTestCase()
+	{
+		ENV.qnam()->setProxy(QNetworkProxy::NoProxy);
+	}
+
+	void test_sameFileDownloadedOnce()
+	{
+		StandInServer server(TestsInternal::payload(200000), 0);
+		QTemporaryDir dir;
+		QString target = dir.path() + "/file.jar";
+		auto first = makeJob("First", server.url(), target, TestsInternal::md5(server.m_payload));
+		auto second = makeJob("Second", server.url(), target, TestsInternal::md5(server.m_payload));
+		QSignalSpy firstSpy(first.get(), SIGNAL(succeeded()));
+		QSignalSpy secondSpy(second.get(), SIGNAL(succeeded()));
+		first->start();
+		second->start();
+		QVERIFY(firstSpy.wait());
+		QVERIFY(secondSpy.count() || secondSpy.wait());
+
+		QCOMPARE(server.m_ranges.size(), 1);
+		QCOMPARE(TestsInternal::readFile(target), server.m_payload);
+	}
+
+	void test_followersRetryWithTheLeader()
+	{
+		StandInServer server(TestsInternal::payload(200000), 1);
+		QTemporaryDir dir;
+		QString target = dir.path() + "/file.jar";
+		auto first = makeJob("First", server.url(), target, TestsInternal::md5(server.m_payload));
+		auto second = makeJob("Second", server.url(), target, TestsInternal::md5(server.m_payload));
+		QSignalSpy firstSpy(first.get(), SIGNAL(succeeded()));
+		QSignalSpy secondSpy(second.get(), SIGNAL(succeeded()));
+		first->start();
+		second->start();
+		QVERIFY(firstSpy.wait());
+		QVERIFY(secondSpy.count() || secondSpy.wait());
+
+		// one dropped attempt and its resumption, both shared
+		QCOMPARE(server.m_ranges.size(), 2);
+		QCOMPARE(TestsInternal::readFile(target), server.m_payload);
+	}
+
+	void test_backgroundLeaderWithInteractiveFollower()
+	{
+		// bigger than the read buffer, so the leader has to be allowed to read to get it all
+		StandInServer server(TestsInternal::payload(2 * 1024 * 1024), 0);
+		QTemporaryDir dir;
+		QString target = dir.path() + "/file.jar";
+		auto first = makeJob("First", server.url(), target, TestsInternal::md5(server.m_payload));
+		auto second = makeJob("Second", server.url(), target, TestsInternal::md5(server.m_payload));
+		first->setPriority(Priority_Background);
+		second->setPriority(Priority_Interactive);
+		QSignalSpy firstSpy(first.get(), SIGNAL(succeeded()));
+		QSignalSpy secondSpy(second.get(), SIGNAL(succeeded()));
+		first->start();
+		second->start();
+		QVERIFY(firstSpy.wait());
+		QVERIFY(secondSpy.count() || secondSpy.wait());
+
+		QCOMPARE(server.m_ranges.size(), 1);
+		QCOMPARE(TestsInternal::readFile(target), server.m_payload);
+	}
+
+	void test_differentFilesAreNotShared()
+	{
+		StandInServer server(TestsInternal::payload(200000), 0);
+		QTemporaryDir dir;
+		auto first = makeJob("First", server.url(), dir.path() + "/one.jar", QString());
+		auto second = makeJob("Second", server.url(), dir.path() + "/two.jar", QString());
+		QSignalSpy firstSpy(first.get(), SIGNAL(succeeded()));
+		QSignalSpy secondSpy(second.get(), SIGNAL(succeeded()));
+		first->start();
+		second->start();
+		QVERIFY(firstSpy.wait());
+		QVERIFY(secondSpy.count() || secondSpy.wait());
+
+		QCOMPARE(server.m_ranges.size(), 2);
+	}
+};
+
+QTEST_GUILESS_MAIN(InFlightDownloadsTest)
+
+#include "tst_InFlightDownloads.moc"
@@ -0,0 +1,111 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include "TestUtil.h"
+
+#include "minecraft/LibraryStore.h"
+
+class LibraryStoreTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_place()
+	{
+		QTemporaryDir dir;
+		LibraryStore store(dir.path() + "/store");
+		QString source = dir.path() + "/cache/argo-2.25.jar";
+		QVERIFY(QDir().mkpath(dir.path() + "/cache"));
+		QVERIFY(TestsInternal::writeFile(source, "library contents"));
+
+		QString first = dir.path() + "/inst1/lib/argo-2.25.jar";
+		QString second = dir.path() + "/inst2/lib/argo-2.25.jar";
+		LibraryStore::Method method;
+		QVERIFY(store.place(source, first, nullptr, &method));
+		QVERIFY(store.place(source, second));
+		QCOMPARE(TestsInternal::readFile(first), QByteArray("library contents"));
+		QCOMPARE(TestsInternal::readFile(second), QByteArray("library contents"));
+		QString stored = store.storedPath(LibraryStore::fileSha1(source));
+		if (method == LibraryStore::Linked)
+		{
+			QVERIFY(LibraryStore::sameFile(first, second));
+			QVERIFY(LibraryStore::sameFile(first, stored));
+			// the source is copied, not linked
+			QVERIFY(!LibraryStore::sameFile(source, stored));
+		}
+		else
+		{
+			// nothing to share, so nothing is kept
+			QVERIFY(!QFile::exists(stored));
+		}
+		// placing again changes nothing
+		QVERIFY(store.place(source, first));
+		QCOMPARE(TestsInternal::readFile(first), QByteArray("library contents"));
+	}
+
+	void test_dedupe()
+	{
+		QTemporaryDir dir;
+		LibraryStore store(dir.path() + "/store");
+		QString first = dir.path() + "/first.jar";
+		QString second = dir.path() + "/second.jar";
+		QString other = dir.path() + "/other.jar";
+		QVERIFY(TestsInternal::writeFile(first, "same"));
+		QVERIFY(TestsInternal::writeFile(second, "same"));
+		QVERIFY(TestsInternal::writeFile(other, "different"));
+
+		QString hash;
+		// the first copy becomes the stored one
+		QCOMPARE(store.dedupe(first, nullptr, &hash), qint64(0));
+		QCOMPARE(hash, LibraryStore::fileSha1(first));
+		qint64 freed = store.dedupe(second);
+		QVERIFY(freed == 0 || freed == 4);
+		if (freed)
+		{
+			QVERIFY(LibraryStore::sameFile(first, second));
+		}
+		QCOMPARE(TestsInternal::readFile(second), QByteArray("same"));
+		// done already
+		QCOMPARE(store.dedupe(second), qint64(0));
+		QCOMPARE(store.dedupe(other), qint64(0));
+		QCOMPARE(TestsInternal::readFile(other), QByteArray("different"));
+		QVERIFY(store.dedupe(dir.path() + "/missing.jar") == 0);
+	}
+
+	void test_verify()
+	{
+		QTemporaryDir dir;
+		LibraryStore store(dir.path() + "/store");
+		QString good = dir.path() + "/good.jar";
+		QString bad = dir.path() + "/bad.jar";
+		QString unused = dir.path() + "/unused.jar";
+		QVERIFY(TestsInternal::writeFile(good, "good"));
+		QVERIFY(TestsInternal::writeFile(bad, "bad"));
+		QVERIFY(TestsInternal::writeFile(unused, "unused"));
+		store.dedupe(good);
+		store.dedupe(bad);
+		store.dedupe(unused);
+		QString badStored = store.storedPath(LibraryStore::fileSha1(bad));
+		QString unusedStored = store.storedPath(LibraryStore::fileSha1(unused));
+		if (!LibraryStore::sameFile(bad, badStored))
+		{
+			QSKIP("This file system can't hard link");
+		}
+		QFile::remove(unused);
+		// damage the stored file, and with it the linked one
+		QVERIFY(TestsInternal::writeFile(badStored, "damaged"));
+
+		auto result = store.verify(QStringList() << good << bad);
+		QCOMPARE(result.checked, 3);
+		QCOMPARE(result.damaged, QStringList() << QFileInfo(badStored).fileName());
+		QCOMPARE(result.removed, QStringList() << bad);
+		QCOMPARE(result.unused, 1);
+		QVERIFY(!QFile::exists(bad));
+		QVERIFY(!QFile::exists(badStored));
+		QVERIFY(!QFile::exists(unusedStored));
+		QCOMPARE(TestsInternal::readFile(good), QByteArray("good"));
+	}
+};
+
+QTEST_GUILESS_MAIN(LibraryStoreTest)
+
+#include "tst_LibraryStore.moc"
@@ -0,0 +1,134 @@
+#include <QTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include "TestUtil.h"
+
+#include "minecraft/MinecraftProfile.h"
+#include "minecraft/NullProfileStrategy.h"
+#include "minecraft/VersionFile.h"
+#include "minecraft/OpSys.h"
+#include "minecraft/VersionBuildError.h"
+
+class MinecraftProfileTest : public QObject
+{
+	Q_OBJECT
+private:
+	QJsonObject library(QString name)
+	{
+		QJsonObject lib;
+		lib.insert("name", name);
+		return lib;
+	}
+	QJsonObject nativeLibrary(QString name)
+	{
+		auto lib = library(name);
+		QJsonObject natives;
+		natives.insert(OpSys_toString(currentSystem), QString("natives"));
+		lib.insert("natives", natives);
+		return lib;
+	}
+	QJsonObject disallowedLibrary(QString name)
+	{
+		auto lib = library(name);
+		QJsonObject rule;
+		rule.insert("action", QString("disallow"));
+		lib.insert("rules", QJsonArray() << rule);
+		return lib;
+	}
+	VersionFilePtr patch(QJsonObject root)
+	{
+		return VersionFile::fromJson(QJsonDocument(root), root.value("fileId").toString(), false);
+	}
+	VersionFilePtr minecraft()
+	{
+		QJsonObject root;
+		root.insert("fileId", QString("net.minecraft"));
+		root.insert("id", QString("1.7.10"));
+		root.insert("mainClass", QString("net.minecraft.client.main.Main"));
+		QJsonArray libs;
+		libs << library("com.mojang:realms:1.3.5") << nativeLibrary("org.lwjgl.lwjgl:lwjgl-platform:2.9.1")
+			 << disallowedLibrary("tv.twitch:twitch-platform:5.16");
+		root.insert("libraries", libs);
+		return patch(root);
+	}
+	/// a mod patch adding `count` libraries
+	VersionFilePtr mod(int number, int count, QString mcVersion)
+	{
+		QJsonObject root;
+		root.insert("fileId", QString("org.example.mod%1").arg(number));
+		root.insert("mcVersion", mcVersion);
+		QJsonArray libs;
+		for (int i = 0; i < count; i++)
+		{
+			auto lib = library(QString("org.example.mod%1:lib%2:1.0").arg(number).arg(i));
+			lib.insert("insert", QString("append"));
+			libs << lib;
+		}
+		root.insert("+libraries", libs);
+		return patch(root);
+	}
+	QStringList names(QList<OneSixLibraryPtr> libs)
+	{
+		QStringList out;
+		for (auto lib : libs)
+		{
+			out.append(lib->rawName());
+		}
+		return out;
+	}
+
+private
+slots:
+	void test_resolvedLibraries()
+	{
+		MinecraftProfile profile(new NullProfileStrategy());
+		profile.appendPatch(minecraft());
+		profile.reapply();
+		QCOMPARE(names(profile.getActiveNormalLibs()), QStringList() << "com.mojang:realms:1.3.5");
+		QCOMPARE(names(profile.getActiveNativeLibs()),
+				 QStringList() << "org.lwjgl.lwjgl:lwjgl-platform:2.9.1");
+
+		// a new patch set invalidates the resolved libraries
+		profile.appendPatch(mod(1, 1, "1.7.*"));
+		profile.reapply();
+		QCOMPARE(names(profile.getActiveNormalLibs()), QStringList() << "com.mojang:realms:1.3.5"
+																	 << "org.example.mod1:lib0:1.0");
+	}
+
+	void test_mcVersionMismatch()
+	{
+		MinecraftProfile profile(new NullProfileStrategy());
+		profile.appendPatch(minecraft());
+		profile.appendPatch(mod(1, 1, "1.8"));
+		QVERIFY_EXCEPTION_THROWN(profile.reapply(), MinecraftVersionMismatch);
+	}
+
+	void test_modpackBenchmark()
+	{
+		// a modpack: vanilla plus 19 mods with a few libraries each
+		QList<VersionFilePtr> patches;
+		patches.append(minecraft());
+		for (int i = 1; i < 20; i++)
+		{
+			patches.append(mod(i, 5, i % 2 ? "1.7.10" : "1.7.*"));
+		}
+		int normal = 0;
+		QBENCHMARK
+		{
+			MinecraftProfile profile(new NullProfileStrategy());
+			for (auto file : patches)
+			{
+				profile.appendPatch(file);
+			}
+			profile.reapply();
+			normal = profile.getActiveNormalLibs().size();
+			profile.getActiveNativeLibs();
+		}
+		QCOMPARE(normal, 1 + 19 * 5);
+	}
+};
+
+QTEST_GUILESS_MAIN(MinecraftProfileTest)
+
+#include "tst_MinecraftProfile.moc"
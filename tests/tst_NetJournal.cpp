@@ -0,0 +1,108 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+#include "TestUtil.h"
+
+#include "Env.h"
+#include "net/NetJob.h"
+#include "net/NetJournal.h"
+
+class NetJournalTest : public QObject
+{
+	Q_OBJECT
+private:
+	QJsonObject part(int i)
+	{
+		QJsonObject part;
+		part.insert("type", QString("md5"));
+		part.insert("url", QString("http://example.com/%1").arg(i));
+		part.insert("target", QString("objects/%1").arg(i));
+		part.insert("size", 100.0 + i);
+		return part;
+	}
+	void writeJournal(const QString &path, const QString &context, int parts, QList<int> done)
+	{
+		NetJournal journal(path);
+		QVERIFY(journal.begin("Test job", context));
+		for (int i = 0; i < parts; i++)
+			journal.addPart(part(i));
+		for (int i : done)
+			journal.partDone(i);
+	}
+
+private
+slots:
+	void test_pendingParts()
+	{
+		QTemporaryDir dir;
+		QString path = NetJournal::pathFor(dir.path(), "job");
+		writeJournal(path, "ctx", 3, {0, 2});
+
+		NetJournal journal(path);
+		QVERIFY(journal.load());
+		QCOMPARE(journal.name(), QString("Test job"));
+		QCOMPARE(journal.context(), QString("ctx"));
+		QVERIFY(!journal.ended());
+		QCOMPARE(journal.pendingParts().size(), 1);
+		QCOMPARE(journal.pendingParts()[0], part(1));
+	}
+
+	void test_cutOffLine()
+	{
+		QTemporaryDir dir;
+		QString path = NetJournal::pathFor(dir.path(), "job");
+		writeJournal(path, "ctx", 2, {0});
+		{
+			QFile file(path);
+			QVERIFY(file.open(QIODevice::Append));
+			file.write("{\"done\":");
+		}
+		NetJournal journal(path);
+		QVERIFY(journal.load());
+		QCOMPARE(journal.pendingParts().size(), 1);
+	}
+
+	void test_interrupted()
+	{
+		QTemporaryDir dir;
+		writeJournal(NetJournal::pathFor(dir.path(), "running"), "", 2, {0});
+		writeJournal(NetJournal::pathFor(dir.path(), "finished"), "", 2, {0, 1});
+		{
+			NetJournal failed(NetJournal::pathFor(dir.path(), "failed"));
+			QVERIFY(failed.begin("Failed job", ""));
+			failed.addPart(part(0));
+			failed.partFailed(0);
+			failed.end();
+		}
+		QCOMPARE(NetJournal::interrupted(dir.path()), QStringList() << "running");
+	}
+
+	void test_resume()
+	{
+		QTemporaryDir dir;
+		ENV.initNetJournals(dir.path());
+		writeJournal(NetJournal::pathFor(dir.path(), "assets"), "index:abc", 3, {1});
+
+		auto job = NetJob::resume("assets", "index:abc");
+		QVERIFY(job);
+		QCOMPARE(job->size(), 2);
+		QCOMPARE((*job)[0]->m_url, QUrl("http://example.com/0"));
+		QCOMPARE((*job)[1]->m_url, QUrl("http://example.com/2"));
+		QCOMPARE((*job)[1]->totalProgress(), qint64(102));
+	}
+
+	void test_resumeOtherContext()
+	{
+		QTemporaryDir dir;
+		ENV.initNetJournals(dir.path());
+		QString path = NetJournal::pathFor(dir.path(), "assets");
+		writeJournal(path, "index:abc", 3, {});
+
+		QVERIFY(!NetJob::resume("assets", "index:def"));
+		QVERIFY(!QFile::exists(path));
+	}
+};
+
+QTEST_GUILESS_MAIN(NetJournalTest)
+
+#include "tst_NetJournal.moc"
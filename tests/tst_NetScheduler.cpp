@@ -0,0 +1,67 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "net/NetScheduler.h"
+#include "net/RateLimiter.h"
+
+class NetSchedulerTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_unlimited()
+	{
+		RateLimiter limiter;
+		QVERIFY(limiter.available() > 1024 * 1024 * 1024);
+		limiter.consume(1024 * 1024);
+		QCOMPARE(limiter.waitTime(), 0);
+	}
+
+	void test_bucket()
+	{
+		RateLimiter limiter(100000);
+		// a burst of up to a second worth of data
+		QCOMPARE(limiter.available(), qint64(100000));
+		limiter.consume(100000);
+		QVERIFY(limiter.available() < 1000);
+		QVERIFY(limiter.waitTime() > 0);
+		QTest::qWait(limiter.waitTime());
+		QVERIFY(limiter.available() >= 16 * 1024);
+	}
+
+	void test_backgroundWaits()
+	{
+		auto &scheduler = NetScheduler::instance();
+		QVERIFY(scheduler.mayStart(Priority_Background));
+		QCOMPARE(scheduler.take(Priority_Background, nullptr, 4096), qint64(4096));
+
+		scheduler.partStarted(Priority_Launch);
+		QVERIFY(scheduler.mayStart(Priority_Interactive));
+		QVERIFY(!scheduler.mayStart(Priority_Background));
+		// already running ones stop reading
+		QCOMPARE(scheduler.take(Priority_Background, nullptr, 4096), qint64(0));
+		QCOMPARE(scheduler.take(Priority_Launch, nullptr, 4096), qint64(4096));
+		scheduler.partFinished(Priority_Launch);
+
+		QVERIFY(scheduler.mayStart(Priority_Background));
+		// only a few at a time
+		scheduler.partStarted(Priority_Background);
+		scheduler.partStarted(Priority_Background);
+		QVERIFY(!scheduler.mayStart(Priority_Background));
+		scheduler.partFinished(Priority_Background);
+		scheduler.partFinished(Priority_Background);
+	}
+
+	void test_jobLimit()
+	{
+		auto &scheduler = NetScheduler::instance();
+		RateLimiter jobLimiter(10000);
+		QCOMPARE(scheduler.take(Priority_Interactive, &jobLimiter, 50000), qint64(10000));
+		QVERIFY(scheduler.take(Priority_Interactive, &jobLimiter, 50000) < 100);
+		QVERIFY(scheduler.waitTime(Priority_Interactive, &jobLimiter) > 0);
+	}
+};
+
+QTEST_GUILESS_MAIN(NetSchedulerTest)
+
+#include "tst_NetScheduler.moc"
@@ -0,0 +1,71 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QDir>
+#include "TestUtil.h"
+
+#include "Env.h"
+#include "settings/INISettingsObject.h"
+#include "minecraft/OneSixInstance.h"
+#include "minecraft/OneSixUpdate.h"
+#include "minecraft/MinecraftProfile.h"
+#include "minecraft/LaunchFingerprint.h"
+
+class OneSixUpdateTest : public QObject
+{
+	Q_OBJECT
+private:
+	QTemporaryDir m_root;
+	QString m_oldCurrent;
+
+private
+slots:
+	void initTestCase()
+	{
+		// the assets live relative to the working directory, like in MultiMC
+		m_oldCurrent = QDir::currentPath();
+		QDir::setCurrent(m_root.path());
+		ENV.initHttpMetaCache(m_root.path(), m_root.path());
+	}
+	void cleanupTestCase()
+	{
+		QDir::setCurrent(m_oldCurrent);
+	}
+
+	void test_failedAssetsStoreNoFingerprint()
+	{
+		auto global = std::make_shared<INISettingsObject>(m_root.path() + "/multimc.cfg");
+		for (auto id : {"PreLaunchCommand", "PostExitCommand", "ShowConsole", "AutoCloseConsole",
+						"LogPrePostOutput", "JavaPath", "JvmArgs", "LaunchMaximized",
+						"MinecraftWinWidth", "MinecraftWinHeight", "MinMemAlloc", "MaxMemAlloc",
+						"PermGen", "AutoTuneJava", "AutoTuneHeap", "AutoTuneGC", "AutoTuneJIT"})
+		{
+			global->registerSetting(id, QVariant());
+		}
+		QString instDir = m_root.path() + "/instances/broken";
+		QVERIFY(QDir().mkpath(instDir));
+		auto settings = std::make_shared<INISettingsObject>(instDir + "/instance.cfg");
+		OneSixInstance inst(global, settings, instDir);
+		inst.init();
+		inst.getMinecraftProfile()->assets = "broken";
+
+		// an asset index that can't be read
+		QVERIFY(QDir().mkpath("assets/indexes"));
+		QFile index("assets/indexes/broken.json");
+		QVERIFY(index.open(QIODevice::WriteOnly));
+		index.write("{ not json");
+		index.close();
+
+		OneSixUpdate update(&inst);
+		QSignalSpy failedSpy(&update, SIGNAL(failed(QString)));
+		QSignalSpy succeededSpy(&update, SIGNAL(succeeded()));
+		QVERIFY(QMetaObject::invokeMethod(&update, "assetIndexFinished"));
+		QCOMPARE(failedSpy.size(), 1);
+		QCOMPARE(succeededSpy.size(), 0);
+		QVERIFY(LaunchFingerprint::stored(&inst).isEmpty());
+	}
+};
+
+QTEST_GUILESS_MAIN(OneSixUpdateTest)
+
+#include "tst_OneSixUpdate.moc"
@@ -0,0 +1,95 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QNetworkAccessManager>
+#include <QNetworkProxy>
+#include "TestUtil.h"
+#include "StandInServer.h"
+
+#include "Env.h"
+#include "net/NetJob.h"
+#include "net/MD5EtagDownload.h"
+
+class PartialFileTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void initTestCase()
+	{
+		ENV.qnam()->setProxy(QNetworkProxy::NoProxy);
+	}
+
+	void test_retryResumes()
+	{
+		StandInServer server(TestsInternal::payload(200000, 1), 1);
+		QTemporaryDir dir;
+		QString target = dir.path() + "/file.jar";
+		auto download = MD5EtagDownload::make(server.url(), target);
+		download->m_expected_md5 = TestsInternal::md5(server.m_payload);
+		NetJobPtr job(new NetJob("Flaky"));
+		job->addNetAction(download);
+		QSignalSpy succeededSpy(job.get(), SIGNAL(succeeded()));
+		job->start();
+		QVERIFY(succeededSpy.wait());
+
+		// the retry only asked for the part that was missing
+		QCOMPARE(server.m_ranges.size(), 2);
+		QCOMPARE(server.m_ranges[0], QByteArray());
+		QCOMPARE(server.m_ranges[1], QByteArray("bytes=100000-"));
+		QCOMPARE(TestsInternal::readFile(target), server.m_payload);
+		QVERIFY(!QFile::exists(target + ".part"));
+		QVERIFY(!QFile::exists(target + ".part.json"));
+	}
+
+	void test_restartResumes()
+	{
+		StandInServer server(TestsInternal::payload(200000, 2), 1);
+		QTemporaryDir dir;
+		QString target = dir.path() + "/file.jar";
+		{
+			auto download = MD5EtagDownload::make(server.url(), target);
+			QSignalSpy failedSpy(download.get(), SIGNAL(failed(int)));
+			download->start();
+			QVERIFY(failedSpy.wait());
+		}
+		QVERIFY(QFile::exists(target + ".part.json"));
+
+		// as if MultiMC was started again
+		auto download = MD5EtagDownload::make(server.url(), target);
+		download->m_expected_md5 = TestsInternal::md5(server.m_payload);
+		QSignalSpy succeededSpy(download.get(), SIGNAL(succeeded(int)));
+		download->start();
+		QVERIFY(succeededSpy.wait());
+		QCOMPARE(server.m_ranges.last(), QByteArray("bytes=100000-"));
+		QCOMPARE(TestsInternal::readFile(target), server.m_payload);
+	}
+
+	void test_changedFileStartsOver()
+	{
+		StandInServer server(TestsInternal::payload(200000, 3), 1);
+		QTemporaryDir dir;
+		QString target = dir.path() + "/file.jar";
+		{
+			auto download = MD5EtagDownload::make(server.url(), target);
+			QSignalSpy failedSpy(download.get(), SIGNAL(failed(int)));
+			download->start();
+			QVERIFY(failedSpy.wait());
+		}
+
+		// a new version of the file was put up in the meantime
+		server.m_payload = TestsInternal::payload(200000, 4);
+		server.m_etag = "\"two\"";
+		auto download = MD5EtagDownload::make(server.url(), target);
+		download->m_expected_md5 = TestsInternal::md5(server.m_payload);
+		QSignalSpy succeededSpy(download.get(), SIGNAL(succeeded(int)));
+		download->start();
+		QVERIFY(succeededSpy.wait());
+		QCOMPARE(server.m_ranges.last(), QByteArray("bytes=100000-"));
+		QCOMPARE(TestsInternal::readFile(target), server.m_payload);
+	}
+};
+
+QTEST_GUILESS_MAIN(PartialFileTest)
+
+#include "tst_PartialFile.moc"
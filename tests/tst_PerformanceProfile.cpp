@@ -0,0 +1,146 @@
+#include <QTest>
+#include "TestUtil.h"
+
+#include "minecraft/PerformanceProfile.h"
+
+class PerformanceProfileTest : public QObject
+{
+	Q_OBJECT
+private:
+	HardwareInfo machine(int cores, qint64 memory, int numaNodes = 1)
+	{
+		HardwareInfo hw;
+		hw.cores = cores;
+		hw.physicalMemory = memory;
+		hw.numaNodes = numaNodes;
+		return hw;
+	}
+	JavaCheckResult java(QString version, bool is64)
+	{
+		JavaCheckResult result;
+		result.valid = true;
+		result.javaVersion = version;
+		result.is_64bit = is64;
+		return result;
+	}
+	QStringList argsOf(const PerformanceProfile &profile, QString name)
+	{
+		for (auto &choice : profile.choices())
+		{
+			if (choice.name == name)
+				return choice.args;
+		}
+		return QStringList();
+	}
+
+private
+slots:
+	void test_javaMajorVersion_data()
+	{
+		QTest::addColumn<QString>("version");
+		QTest::addColumn<int>("major");
+
+		QTest::newRow("java 6") << "1.6.0_65" << 6;
+		QTest::newRow("java 8") << "1.8.0_45" << 8;
+		QTest::newRow("java 9") << "9" << 9;
+		QTest::newRow("java 11") << "11.0.2" << 11;
+		QTest::newRow("garbage") << "derp" << 0;
+	}
+	void test_javaMajorVersion()
+	{
+		QFETCH(QString, version);
+		QFETCH(int, major);
+
+		QCOMPARE(PerformanceProfile::javaMajorVersion(version), major);
+	}
+
+	void test_vanillaHeap()
+	{
+		auto profile = PerformanceProfile::compute(machine(8, 16384), java("1.8.0_45", true), 0,
+												   PerformanceProfile::Options());
+		QCOMPARE(profile.maxHeap(), 1024);
+		QCOMPARE(argsOf(profile, "heap"), QStringList({"-Xms512m", "-Xmx1024m"}));
+		QVERIFY(argsOf(profile, "gc").contains("-XX:+UseConcMarkSweepGC"));
+	}
+
+	void test_modpackHeap()
+	{
+		auto profile = PerformanceProfile::compute(machine(8, 16384), java("1.8.0_45", true), 100,
+												   PerformanceProfile::Options());
+		QCOMPARE(profile.maxHeap(), 2560);
+		QVERIFY(argsOf(profile, "gc").contains("-XX:+UseG1GC"));
+		QVERIFY(argsOf(profile, "jit").contains("-XX:ReservedCodeCacheSize=256m"));
+	}
+
+	void test_heapCaps()
+	{
+		// half of the physical memory
+		auto small = PerformanceProfile::compute(machine(2, 2048), java("1.8.0_45", true), 100,
+												 PerformanceProfile::Options());
+		QCOMPARE(small.maxHeap(), 1024);
+
+		// 32-bit java
+		auto x86 = PerformanceProfile::compute(machine(4, 16384), java("1.7.0_80", false), 100,
+											   PerformanceProfile::Options());
+		QCOMPARE(x86.maxHeap(), 1024);
+		QVERIFY(argsOf(x86, "jit").contains("-XX:+TieredCompilation"));
+	}
+
+	void test_newJavaGC_data()
+	{
+		QTest::addColumn<QString>("version");
+
+		QTest::newRow("java 9") << "9.0.4";
+		QTest::newRow("java 11") << "11.0.2";
+		QTest::newRow("java 17") << "17.0.1";
+	}
+	void test_newJavaGC()
+	{
+		QFETCH(QString, version);
+
+		// small and large heaps alike
+		for (int mods : {0, 100})
+		{
+			auto profile = PerformanceProfile::compute(machine(8, 16384), java(version, true),
+													   mods, PerformanceProfile::Options());
+			auto gc = argsOf(profile, "gc");
+			QVERIFY(gc.contains("-XX:+UseG1GC"));
+			QVERIFY(!gc.contains("-XX:+UseConcMarkSweepGC"));
+			QVERIFY(!gc.contains("-XX:+UseParNewGC"));
+		}
+	}
+
+	void test_unknownJavaGC()
+	{
+		auto profile = PerformanceProfile::compute(machine(8, 16384, 2), java("derp", true), 0,
+												   PerformanceProfile::Options());
+		QVERIFY(argsOf(profile, "gc").isEmpty());
+		QVERIFY(!profile.arguments().join(' ').contains("GC"));
+		QVERIFY(!profile.arguments().contains("-XX:+UseNUMA"));
+	}
+
+	void test_userOverrides()
+	{
+		PerformanceProfile::Options options;
+		options.memoryOverridden = true;
+		options.userArgs = QStringList({"-XX:+UseParallelGC"});
+		auto profile = PerformanceProfile::compute(machine(4, 8192, 2), java("1.8.0_45", true),
+												   10, options);
+		QCOMPARE(profile.maxHeap(), 0);
+		QVERIFY(argsOf(profile, "heap").isEmpty());
+		QVERIFY(argsOf(profile, "gc").isEmpty());
+		QVERIFY(!profile.arguments().contains("-XX:+UseNUMA"));
+	}
+
+	void test_singleCore()
+	{
+		auto profile = PerformanceProfile::compute(machine(1, 4096, 2), java("1.8.0_45", true),
+												   0, PerformanceProfile::Options());
+		QCOMPARE(argsOf(profile, "gc"), QStringList({"-XX:+UseSerialGC", "-XX:+UseNUMA"}));
+		QVERIFY(argsOf(profile, "jit").contains("-XX:TieredStopAtLevel=1"));
+	}
+};
+
+QTEST_GUILESS_MAIN(PerformanceProfileTest)
+
+#include "tst_PerformanceProfile.moc"
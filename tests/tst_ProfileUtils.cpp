@@ -0,0 +1,79 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include "TestUtil.h"
+
+#include "minecraft/ProfileUtils.h"
+#include "MMCJson.h"
+
+class ProfileUtilsTest : public QObject
+{
+	Q_OBJECT
+private:
+	QByteArray patch(QString name, int order)
+	{
+		return QString("{\"fileId\": \"org.example.mod\", \"name\": \"%1\", \"order\": %2, "
+					   "\"+libraries\": [{\"name\": \"org.example:lib:1.0\"}]}")
+			.arg(name)
+			.arg(order)
+			.toUtf8();
+	}
+
+private
+slots:
+	void test_sharedParse()
+	{
+		QTemporaryDir dir;
+		QString first = dir.path() + "/first.json";
+		QString second = dir.path() + "/second.json";
+		QVERIFY(TestsInternal::writeFile(first, patch("Mod", 10)));
+		QVERIFY(TestsInternal::writeFile(second, patch("Mod", 10)));
+
+		auto a = ProfileUtils::parseJsonFile(QFileInfo(first), false);
+		auto b = ProfileUtils::parseJsonFile(QFileInfo(second), false);
+		QVERIFY(a != b);
+		// same contents, same parse
+		QCOMPARE(a->addLibs.size(), 1);
+		QCOMPARE(b->addLibs.size(), 1);
+		QCOMPARE(QString(a->addLibs[0]->rawName()), QString(b->addLibs[0]->rawName()));
+		QCOMPARE(a->filename, first);
+		QCOMPARE(b->filename, second);
+		QCOMPARE(b->order, 0);
+
+		// changes to one copy stay there, the libraries in it included
+		a->name = "Changed";
+		a->addLibs[0]->setRawName(GradleSpecifier("org.example:changed:2.0"));
+		auto c = ProfileUtils::parseJsonFile(QFileInfo(first), false);
+		QCOMPARE(c->name, QString("Mod"));
+		QCOMPARE(QString(c->addLibs[0]->rawName()), QString("org.example:lib:1.0"));
+		QCOMPARE(QString(b->addLibs[0]->rawName()), QString("org.example:lib:1.0"));
+
+		// the order is only there if it was asked for
+		QCOMPARE(ProfileUtils::parseJsonFile(QFileInfo(first), true)->order, 10);
+	}
+
+	void test_changedFile()
+	{
+		QTemporaryDir dir;
+		QString path = dir.path() + "/patch.json";
+		QVERIFY(TestsInternal::writeFile(path, patch("Before", 1)));
+		QCOMPARE(ProfileUtils::parseJsonFile(QFileInfo(path), false)->name, QString("Before"));
+		QVERIFY(TestsInternal::writeFile(path, patch("After the change", 1)));
+		QCOMPARE(ProfileUtils::parseJsonFile(QFileInfo(path), false)->name,
+				 QString("After the change"));
+	}
+
+	void test_brokenFile()
+	{
+		QTemporaryDir dir;
+		QString path = dir.path() + "/broken.json";
+		QVERIFY(TestsInternal::writeFile(path, "{ not json"));
+		QVERIFY_EXCEPTION_THROWN(ProfileUtils::parseJsonFile(QFileInfo(path), false),
+								 JSONValidationError);
+		QVERIFY_EXCEPTION_THROWN(ProfileUtils::parseJsonFile(QFileInfo(path), false),
+								 JSONValidationError);
+	}
+};
+
+QTEST_GUILESS_MAIN(ProfileUtilsTest)
+
+#include "tst_ProfileUtils.moc"
@@ -0,0 +1,88 @@
+#include <QTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include "TestUtil.h"
+
+#include "tasks/Timeline.h"
+
+class TimelineTest : public QObject
+{
+	Q_OBJECT
+private
+slots:
+	void test_phases()
+	{
+		Timeline timeline;
+		int outer = timeline.begin("update");
+		int inner = timeline.begin("libraries");
+		timeline.end(inner, 2048, 3);
+		timeline.end(outer);
+		// ending twice does nothing
+		timeline.end(inner, 1, 1);
+		timeline.end(42);
+
+		auto phases = timeline.phases();
+		QCOMPARE(phases.size(), 2);
+		QCOMPARE(phases[0].name, QString("update"));
+		QCOMPARE(phases[0].depth, 0);
+		QCOMPARE(phases[1].depth, 1);
+		QCOMPARE(phases[1].bytes, qint64(2048));
+		QCOMPARE(phases[1].files, 3);
+		QVERIFY(phases[1].start >= phases[0].start);
+		QVERIFY(phases[1].end <= phases[0].end);
+	}
+
+	void test_scope()
+	{
+		auto timeline = std::make_shared<Timeline>();
+		{
+			TimelineScope scope(timeline, "copy");
+			scope.addFile(10);
+			scope.addFile(20);
+		}
+		auto phases = timeline->phases();
+		QCOMPARE(phases.size(), 1);
+		QVERIFY(phases[0].end != -1);
+		QCOMPARE(phases[0].bytes, qint64(30));
+		QCOMPARE(phases[0].files, 2);
+
+		// no timeline, no crash
+		TimelineScope nothing(nullptr, "nothing");
+		nothing.addFile(1);
+	}
+
+	void test_summary()
+	{
+		Timeline timeline;
+		timeline.end(timeline.begin("assets"), 0, 5);
+		timeline.begin("game");
+		auto summary = timeline.summary();
+		QVERIFY(summary.contains("assets: "));
+		QVERIFY(summary.contains("5 file"));
+		QVERIFY(summary.contains("game: unfinished"));
+	}
+
+	void test_chromeTrace()
+	{
+		Timeline timeline;
+		timeline.end(timeline.begin("libraries"), 100, 1);
+		timeline.begin("game");
+
+		QJsonParseError error;
+		auto doc = QJsonDocument::fromJson(timeline.toChromeTrace(), &error);
+		QCOMPARE(error.error, QJsonParseError::NoError);
+		auto events = doc.object().value("traceEvents").toArray();
+		QCOMPARE(events.size(), 2);
+		auto first = events[0].toObject();
+		QCOMPARE(first.value("name").toString(), QString("libraries"));
+		QCOMPARE(first.value("ph").toString(), QString("X"));
+		QVERIFY(first.contains("dur"));
+		QCOMPARE(first.value("args").toObject().value("bytes").toInt(), 100);
+		QCOMPARE(events[1].toObject().value("ph").toString(), QString("B"));
+	}
+};
+
+QTEST_GUILESS_MAIN(TimelineTest)
+
+#include "tst_Timeline.moc"
@@ -0,0 +1,120 @@
+#include <QTest>
+#include <QTemporaryDir>
+#include <QtEndian>
+#include "TestUtil.h"
+
+#include "VersionIndex.h"
+
+class VersionIndexTest : public QObject
+{
+	Q_OBJECT
+private:
+	QByteArray sample()
+	{
+		VersionIndexWriter writer("test", 3);
+		int versions = writer.addTable(3);
+		int libraries = writer.addTable(1);
+		writer.addRecord(versions, {writer.string("1.8"), writer.string("release"), 1234});
+		writer.addRecord(versions, {writer.string("15w14a"), writer.string("snapshot")});
+		writer.addRecord(versions, {writer.string("1.7.10"), writer.string("release"), 42});
+		writer.addRecord(libraries, {writer.string("net.minecraft:launchwrapper:1.11")});
+		writer.setProperty("latest", "1.8");
+		return writer.data();
+	}
+
+private
+slots:
+	void test_roundTrip()
+	{
+		auto index = VersionIndex::fromData(sample(), "test", 3);
+		QVERIFY(index != nullptr);
+		QCOMPARE(index->tableCount(), 2);
+		QCOMPARE(index->fieldCount(0), 3);
+		QCOMPARE(index->recordCount(0), 3);
+		QCOMPARE(index->recordCount(1), 1);
+		QCOMPARE(index->string(0, 0, 0), QString("1.8"));
+		QCOMPARE(index->string(0, 1, 1), QString("snapshot"));
+		QCOMPARE(index->value(0, 0, 2), quint64(1234));
+		// missing fields are zero
+		QCOMPARE(index->value(0, 1, 2), quint64(0));
+		QCOMPARE(index->string(1, 0, 0), QString("net.minecraft:launchwrapper:1.11"));
+		QCOMPARE(index->property("latest"), QString("1.8"));
+		QVERIFY(index->property("nothing").isNull());
+		// out of range is harmless
+		QCOMPARE(index->value(5, 0, 0), quint64(0));
+		QCOMPARE(index->value(0, 3, 0), quint64(0));
+		QVERIFY(index->string(0, 0, 7).isNull());
+	}
+
+	void test_interning()
+	{
+		VersionIndexWriter writer("test", 1);
+		auto first = writer.string("release");
+		QCOMPARE(writer.string("release"), first);
+		QVERIFY(writer.string("snapshot") != first);
+		QCOMPARE(writer.string(QString()), quint64(0));
+		QCOMPARE(writer.string(""), quint64(0));
+
+		auto index = VersionIndex::fromData(sample(), "test", 3);
+		QVERIFY(index != nullptr);
+		// both records point at the same string
+		QCOMPARE(index->value(0, 0, 1), index->value(0, 2, 1));
+	}
+
+	void test_tooManyFields()
+	{
+		VersionIndexWriter writer("test", 1);
+		int table = writer.addTable(2);
+		QVERIFY(!writer.addRecord(table, {1, 2, 3}));
+		QVERIFY(!writer.addRecord(table + 1, {1}));
+		QCOMPARE(writer.recordCount(table), 0);
+	}
+
+	void test_rejectsOtherKinds()
+	{
+		QVERIFY(VersionIndex::fromData(sample(), "other", 3) == nullptr);
+		QVERIFY(VersionIndex::fromData(sample(), "test", 4) == nullptr);
+		QVERIFY(VersionIndex::fromData(QByteArray("garbage"), "test", 3) == nullptr);
+	}
+
+	void test_rejectsDamage()
+	{
+		auto data = sample();
+		// every truncation is caught
+		for (int size = 0; size < data.size(); size++)
+		{
+			QVERIFY(VersionIndex::fromData(data.left(size), "test", 3) == nullptr);
+		}
+		QString error;
+		auto badTable = data;
+		// the record count of the first table
+		badTable[72 + 4] = char(0xFF);
+		QVERIFY(VersionIndex::fromData(badTable, "test", 3, &error) == nullptr);
+		QVERIFY(!error.isEmpty());
+
+		auto badString = data;
+		// the size of the first string in the pool
+		auto stringTable = qFromLittleEndian<quint64>((const uchar *)data.constData() + 48);
+		badString[int(stringTable) + 5] = char(0xFF);
+		QVERIFY(VersionIndex::fromData(badString, "test", 3) == nullptr);
+	}
+
+	void test_file()
+	{
+		QTemporaryDir dir;
+		QString path = dir.path() + "/sub/test.idx";
+		VersionIndexWriter writer("test", 1);
+		writer.addRecord(writer.addTable(1), {writer.string("hello")});
+		QVERIFY(writer.save(path));
+		auto index = VersionIndex::open(path, "test", 1);
+		QVERIFY(index != nullptr);
+		QCOMPARE(index->string(0, 0, 0), QString("hello"));
+		QString error;
+		QVERIFY(VersionIndex::open(dir.path() + "/missing.idx", "test", 1, &error) == nullptr);
+		QVERIFY(!error.isEmpty());
+	}
+};
+
+QTEST_GUILESS_MAIN(VersionIndexTest)
+
+#include "tst_VersionIndex.moc"